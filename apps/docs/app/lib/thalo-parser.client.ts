@@ -8,7 +8,12 @@
  * For server-side parsing, use thalo-parser.server.ts instead.
  */
 
-import { createParser, type ThaloParser, type Tree } from "@rejot-dev/thalo/web";
+import {
+  createParser,
+  supportsWasmSimd,
+  type ThaloParser,
+  type Tree,
+} from "@rejot-dev/thalo/web";
 
 // Re-export parser types for convenience
 export type { ThaloParser, Tree } from "@rejot-dev/thalo/web";
@@ -16,6 +21,7 @@ export type { ThaloParser, Tree } from "@rejot-dev/thalo/web";
 // WASM files are served from public/wasm/ as static assets
 const TREE_SITTER_WASM_URL = "/wasm/tree-sitter.wasm";
 const LANGUAGE_WASM_URL = "/wasm/tree-sitter-thalo.wasm";
+const LANGUAGE_SIMD_WASM_URL = "/wasm/tree-sitter-thalo.simd.wasm";
 
 // Singleton parser promise
 let parserPromise: Promise<ThaloParser<Tree>> | null = null;
@@ -28,18 +34,34 @@ async function fetchWasm(url: string): Promise<Uint8Array> {
   return new Uint8Array(await response.arrayBuffer());
 }
 
+/**
+ * Fetch the SIMD build of the language WASM if the browser can run it. Returns undefined when
+ * SIMD is unsupported or the build was not deployed, so the baseline build is used instead.
+ */
+async function fetchSimdWasm(): Promise<Uint8Array | undefined> {
+  if (!supportsWasmSimd()) {
+    return undefined;
+  }
+  try {
+    return await fetchWasm(LANGUAGE_SIMD_WASM_URL);
+  } catch {
+    return undefined;
+  }
+}
+
 /**
  * Get or initialize the WASM parser singleton.
  *
- * Uses fetch to load WASM files from the server.
+ * Uses fetch to load WASM files from the server, preferring the SIMD build of the language.
  */
 export async function getParser(): Promise<ThaloParser<Tree>> {
   if (!parserPromise) {
     parserPromise = (async () => {
-      const [treeSitterWasm, languageWasm] = await Promise.all([
+      const [treeSitterWasm, simdLanguageWasm] = await Promise.all([
         fetchWasm(TREE_SITTER_WASM_URL),
-        fetchWasm(LANGUAGE_WASM_URL),
+        fetchSimdWasm(),
       ]);
+      const languageWasm = simdLanguageWasm ?? (await fetchWasm(LANGUAGE_WASM_URL));
       return createParser({ treeSitterWasm, languageWasm });
     })().catch((err) => {
       parserPromise = null; // Reset so next call retries
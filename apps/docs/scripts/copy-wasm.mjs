@@ -30,6 +30,17 @@ async function copyWasmFiles() {
   const thaloWasmPath = require.resolve("@rejot-dev/tree-sitter-thalo/tree-sitter-thalo.wasm");
   await copyFile(thaloWasmPath, join(targetDir, "tree-sitter-thalo.wasm"));
   console.log("✓ Copied tree-sitter-thalo.wasm to public/wasm/");
+
+  // Copy the SIMD build of the language WASM, if the grammar package has one
+  let thaloSimdWasmPath;
+  try {
+    thaloSimdWasmPath = require.resolve("@rejot-dev/tree-sitter-thalo/tree-sitter-thalo.simd.wasm");
+  } catch {
+    console.log("- No tree-sitter-thalo.simd.wasm to copy; browsers use the baseline build");
+    return;
+  }
+  await copyFile(thaloSimdWasmPath, join(targetDir, "tree-sitter-thalo.simd.wasm"));
+  console.log("✓ Copied tree-sitter-thalo.simd.wasm to public/wasm/");
 }
 
 copyWasmFiles().catch((err) => {
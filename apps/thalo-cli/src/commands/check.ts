@@ -10,6 +10,10 @@ import {
   type DiagnosticSeverity,
 } from "@rejot-dev/thalo";
 import { createWorkspace } from "@rejot-dev/thalo/node";
+import { toCheckResult } from "@rejot-dev/thalo/commands/check";
+import { checkFilesParallel } from "@rejot-dev/thalo/checker/parallel";
+import { checkFilesSince } from "@rejot-dev/thalo/checker/since";
+import type { ParseStats } from "@rejot-dev/thalo/native";
 import pc from "picocolors";
 import type { CommandDef, CommandContext } from "../cli.js";
 import { resolveFilesSync, relativePath } from "../files.js";
@@ -53,23 +57,183 @@ function formatDiagnostic(d: DiagnosticInfo, format: OutputFormat): string {
 interface RunResult {
   files: string[];
   result: CheckResult;
+  profile?: Profile;
 }
 
-function executeCheck(files: string[], config: CheckConfig): RunResult {
-  const workspace = createWorkspace();
+/**
+ * Reads the native binding's cumulative counters; the scanner's part of the difference between
+ * two reads is the scanner work of whatever was parsed in between.
+ */
+interface Profiler {
+  readStats: () => ParseStats;
+  diffStats: (after: ParseStats, before: ParseStats) => ParseStats;
+}
+
+interface FileProfile {
+  file: string;
+  bytes: number;
+  /** Time to parse the file and build its model */
+  loadMs: number;
+  scanner?: ParseStats["scanner"];
+}
+
+interface Profile {
+  files: FileProfile[];
+  loadMs: number;
+  checkMs: number;
+}
+
+/**
+ * Turn on the native binding's counters, if a binding with stats is loaded.
+ */
+async function startProfiler(): Promise<Profiler | undefined> {
+  let native: typeof import("@rejot-dev/thalo/native") | undefined;
+  try {
+    native = await import("@rejot-dev/thalo/native");
+  } catch {
+    native = undefined;
+  }
+  if (!native?.hasNativeStats()) {
+    return undefined;
+  }
+  native.setParseStatsEnabled(true);
+  return { readStats: native.readParseStats, diffStats: native.diffParseStats };
+}
+
+/**
+ * @param profile - Time each file and the check; with a profiler, also count scanner work
+ */
+function executeCheck(
+  files: string[],
+  config: CheckConfig,
+  profile?: { profiler: Profiler | undefined },
+): RunResult {
+  // Rules only read the models, so trees are dropped once each file is analyzed
+  const workspace = createWorkspace({ treeRetention: "release" });
+  const profiler = profile?.profiler;
+  const fileProfiles: FileProfile[] = [];
+  const loadStart = performance.now();
 
   for (const file of files) {
     try {
       const source = fs.readFileSync(file, "utf-8");
+      const before = profiler?.readStats();
+      const start = performance.now();
       workspace.addDocument(source, { filename: file });
+      if (profile) {
+        const loadMs = performance.now() - start;
+        const scanner = before && profiler?.diffStats(profiler.readStats(), before).scanner;
+        fileProfiles.push({ file, bytes: Buffer.byteLength(source), loadMs, scanner });
+      }
     } catch (err) {
       console.error(pc.red(`Error reading ${file}: ${err instanceof Error ? err.message : err}`));
     }
   }
 
+  const checkStart = performance.now();
   const result = runCheck(workspace, { config });
 
-  return { files, result };
+  if (!profile) {
+    return { files, result };
+  }
+  const end = performance.now();
+  return {
+    files,
+    result,
+    profile: { files: fileProfiles, loadMs: checkStart - loadStart, checkMs: end - checkStart },
+  };
+}
+
+/**
+ * Check only the files changed since `ref` and the files depending on them; the rest are
+ * taken to report what they reported at `ref`.
+ */
+async function executeSinceCheck(
+  files: string[],
+  ref: string,
+  config: CheckConfig,
+  cacheDir: string | undefined,
+): Promise<RunResult> {
+  const { diagnostics, checkedFiles } = await checkFilesSince(files, ref, { config, cacheDir });
+  return { files: checkedFiles, result: toCheckResult(diagnostics, checkedFiles.length) };
+}
+
+/**
+ * Check every file, running entry-local rules on up to `threads` worker threads.
+ */
+async function executeParallelCheck(
+  files: string[],
+  threads: number,
+  config: CheckConfig,
+  cacheDir: string | undefined,
+): Promise<RunResult> {
+  const { diagnostics } = await checkFilesParallel(files, { config, threads, cacheDir });
+  return { files, result: toCheckResult(diagnostics, files.length) };
+}
+
+const PROFILE_TOP_FILES = 10;
+
+function formatBytes(bytes: number): string {
+  return bytes < 1024 ? `${bytes} B` : `${(bytes / 1024).toFixed(1)} KiB`;
+}
+
+/**
+ * Print the profile to stderr, so it never mixes with JSON output.
+ */
+function outputProfile(profile: Profile): void {
+  const print = (line = ""): void => console.error(line);
+  const { files } = profile;
+  const totalBytes = files.reduce((sum, file) => sum + file.bytes, 0);
+
+  print();
+  print(pc.bold(`Profile (${files.length} files, ${formatBytes(totalBytes)})`));
+  print(`  load   ${profile.loadMs.toFixed(1)}ms`);
+  print(`  check  ${profile.checkMs.toFixed(1)}ms`);
+
+  const scanned = files.filter(
+    (file): file is FileProfile & { scanner: ParseStats["scanner"] } => file.scanner !== undefined,
+  );
+  if (scanned.length > 0) {
+    const sum = (pick: (scanner: ParseStats["scanner"]) => number): number =>
+      scanned.reduce((total, file) => total + pick(file.scanner), 0);
+    const lookahead = sum((s) => s.lookaheadChars);
+    print(
+      `  scanner ${sum((s) => s.scans)} calls, ` +
+        `${sum((s) => s.tokens.indent)} indent + ` +
+        `${sum((s) => s.tokens.contentBlank)} blank-line tokens, ` +
+        `${sum((s) => s.memoHits)} from memo, ` +
+        `${sum((s) => s.errorRecovery)} error-recovery bailouts`,
+    );
+    print(
+      `  look-ahead ${lookahead} chars ` +
+        `(${(lookahead / Math.max(totalBytes, 1)).toFixed(2)} per byte of source)`,
+    );
+  } else {
+    print(pc.dim("  scanner counters need the native binding with stats; rebuild it"));
+  }
+
+  print();
+  print(pc.bold("  Slowest files"));
+  for (const file of [...files].sort((a, b) => b.loadMs - a.loadMs).slice(0, PROFILE_TOP_FILES)) {
+    print(
+      `  ${file.loadMs.toFixed(1).padStart(8)}ms  ${relativePath(file.file)} ` +
+        pc.dim(`(${formatBytes(file.bytes)})`),
+    );
+  }
+
+  if (scanned.length > 0) {
+    const ratio = (file: (typeof scanned)[number]): number =>
+      file.scanner.lookaheadChars / Math.max(file.bytes, 1);
+    print();
+    print(pc.bold("  Most scanner look-ahead per byte"));
+    const worst = [...scanned].sort((a, b) => ratio(b) - ratio(a)).slice(0, PROFILE_TOP_FILES);
+    for (const file of worst) {
+      print(
+        `  ${ratio(file).toFixed(2).padStart(8)}   ${relativePath(file.file)} ` +
+          pc.dim(`(${file.scanner.lookaheadChars} chars, ${file.scanner.errorRecovery} bailouts)`),
+      );
+    }
+  }
 }
 
 interface OutputOptions {
@@ -260,7 +424,7 @@ function parseRuleOverrides(ruleArgs: string | string[] | undefined): Map<string
   return rules;
 }
 
-function checkAction(ctx: CommandContext): void {
+async function checkAction(ctx: CommandContext): Promise<void> {
   const { options, args } = ctx;
 
   // Handle format-dependent color disabling
@@ -291,6 +455,23 @@ function checkAction(ctx: CommandContext): void {
   // Determine target paths
   const targetPaths = args.length > 0 ? args : ["."];
 
+  const since = options["since"] as string | undefined;
+  if (since !== undefined && (options["watch"] || options["profile"])) {
+    console.error("--since cannot be combined with --watch or --profile");
+    process.exit(2);
+  }
+
+  const threadsArg = options["threads"] as string | undefined;
+  const threads = threadsArg === undefined ? undefined : parseInt(threadsArg, 10);
+  if (threads !== undefined && (isNaN(threads) || threads < 0)) {
+    console.error(`Invalid threads value: ${threadsArg}`);
+    process.exit(2);
+  }
+  if (threads !== undefined && (since !== undefined || options["watch"] || options["profile"])) {
+    console.error("--threads cannot be combined with --since, --watch or --profile");
+    process.exit(2);
+  }
+
   // Watch mode
   if (options["watch"]) {
     watchFiles(targetPaths, fileTypes, { format, severity }, config);
@@ -307,10 +488,32 @@ function checkAction(ctx: CommandContext): void {
   }
 
   // Run checks
-  const runResult = executeCheck(files, config);
+  const cacheDir = options["cache-dir"] as string | undefined;
+  let runResult: RunResult;
+  if (threads !== undefined) {
+    try {
+      runResult = await executeParallelCheck(files, threads, config, cacheDir);
+    } catch (err) {
+      console.error(pc.red(err instanceof Error ? err.message : String(err)));
+      process.exit(2);
+    }
+  } else if (since !== undefined) {
+    try {
+      runResult = await executeSinceCheck(files, since, config, cacheDir);
+    } catch (err) {
+      console.error(pc.red(err instanceof Error ? err.message : String(err)));
+      process.exit(2);
+    }
+  } else {
+    const profile = options["profile"] ? { profiler: await startProfiler() } : undefined;
+    runResult = executeCheck(files, config, profile);
+  }
 
   // Output results
   outputResults(runResult, { format, severity });
+  if (runResult.profile) {
+    outputProfile(runResult.profile);
+  }
 
   // Determine exit code
   if (runResult.result.errorCount > 0) {
@@ -388,6 +591,23 @@ export const checkCommand: CommandDef = {
       description: "Comma-separated list of file types to check (e.g., 'md,thalo')",
       default: "md,thalo",
     },
+    profile: {
+      type: "boolean",
+      description: "Print parse timings and scanner counters, with the slowest files, to stderr",
+      default: false,
+    },
+    since: {
+      type: "string",
+      description: "Only check files changed since a git ref, and the files depending on them",
+    },
+    threads: {
+      type: "string",
+      description: "Run per-entry rules on up to this many worker threads (0: inline)",
+    },
+    "cache-dir": {
+      type: "string",
+      description: "Directory for a parse cache used by --since and --threads",
+    },
   },
   action: checkAction,
 };
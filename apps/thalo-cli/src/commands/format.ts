@@ -104,9 +104,17 @@ function getParser(filePath: string): string {
   return "thalo"; // default
 }
 
-async function createPrettierFormatter(): Promise<
-  (source: string, filepath: string) => Promise<string>
-> {
+/**
+ * A character range of the input to format, from a `--range-start` and `--range-end` pair
+ */
+interface FormatRange {
+  start: number;
+  end: number;
+}
+
+async function createPrettierFormatter(
+  ranges?: FormatRange[],
+): Promise<(source: string, filepath: string) => Promise<string>> {
   const prettier = await import("prettier");
 
   let thaloPrettier: Awaited<typeof import("@rejot-dev/thalo-prettier")>;
@@ -132,6 +140,10 @@ async function createPrettierFormatter(): Promise<
     const parser = getParser(filepath);
     // Load project's prettier config (prettier.config.mjs, .prettierrc, etc.)
     const resolvedConfig = await prettier.resolveConfig(filepath);
+    if (ranges && parser === "thalo") {
+      // Re-prints only the entries in the ranges (markdown files are always formatted whole)
+      return thaloPrettier.formatRanges(source, ranges, { ...resolvedConfig, filepath });
+    }
     return prettier.format(source, {
       ...resolvedConfig,
       filepath,
@@ -192,6 +204,39 @@ async function readStdin(): Promise<string> {
   });
 }
 
+/**
+ * Parse `--range-start` and `--range-end`, which pair up in order. Either may be left out
+ * entirely to mean the start or end of the input for every range. Returns undefined when
+ * neither is given.
+ */
+function parseRanges(
+  starts: string[] | undefined,
+  ends: string[] | undefined,
+): FormatRange[] | undefined {
+  if (!starts?.length && !ends?.length) {
+    return undefined;
+  }
+  if (starts?.length && ends?.length && starts.length !== ends.length) {
+    console.error(pc.red("Error: give --range-start and --range-end the same number of times"));
+    process.exit(2);
+  }
+
+  const count = Math.max(starts?.length ?? 0, ends?.length ?? 0);
+  const ranges: FormatRange[] = [];
+  for (let i = 0; i < count; i++) {
+    const range = {
+      start: starts?.length ? Number(starts[i]) : 0,
+      end: ends?.length ? Number(ends[i]) : Number.MAX_SAFE_INTEGER,
+    };
+    if (!Number.isInteger(range.start) || !Number.isInteger(range.end) || range.start < 0) {
+      console.error(pc.red("Error: --range-start and --range-end must be character offsets"));
+      process.exit(2);
+    }
+    ranges.push(range);
+  }
+  return ranges;
+}
+
 async function formatAction(ctx: CommandContext): Promise<void> {
   const { options, args } = ctx;
   const checkOnly = options["check"] as boolean;
@@ -200,11 +245,20 @@ async function formatAction(ctx: CommandContext): Promise<void> {
   const fileTypeStr = (options["file-type"] as string) || "md,thalo";
   const fileTypes = fileTypeStr.split(",").map((t) => t.trim());
 
+  const ranges = parseRanges(
+    options["range-start"] as string[] | undefined,
+    options["range-end"] as string[] | undefined,
+  );
+  if (ranges && !useStdin) {
+    console.error(pc.red("Error: --range-start and --range-end require --stdin"));
+    process.exit(2);
+  }
+
   // Handle stdin mode - read from stdin, output to stdout
   if (useStdin) {
     const content = await readStdin();
     const workspace = createWorkspace();
-    const formatter = await createPrettierFormatter();
+    const formatter = await createPrettierFormatter(ranges);
 
     // Use a placeholder filepath for parser detection (default to .thalo)
     const filepath = args[0] || "stdin.thalo";
@@ -366,6 +420,16 @@ export const formatCommand: CommandDef = {
       description: "Comma-separated list of file types to format (e.g., 'md,thalo')",
       default: "md,thalo",
     },
+    "range-start": {
+      type: "string",
+      description: "With --stdin, format only the entries from this character offset (repeatable)",
+      multiple: true,
+    },
+    "range-end": {
+      type: "string",
+      description: "With --stdin, format only the entries up to this character offset (repeatable)",
+      multiple: true,
+    },
   },
   action: formatAction,
 };
@@ -1,8 +1,46 @@
 import * as fs from "node:fs";
-import { mergeThaloFiles } from "@rejot-dev/thalo";
+import { mergeThaloFiles, type MergeInput, type MergeOptions } from "@rejot-dev/thalo";
 import type { CommandDef, CommandContext } from "../cli.js";
 import pc from "picocolors";
 
+/**
+ * The three versions to merge, and the parser to parse them with.
+ */
+interface Versions {
+  inputs: MergeInput[];
+  parser?: MergeOptions["parser"];
+}
+
+/**
+ * Read the base, ours and theirs files.
+ *
+ * With native bindings, the files are read and parsed in parallel on native threads, and the
+ * merge reuses those trees. With a cache directory they are only read, since most trees then
+ * come from the cache: during a rebase, each base is usually a version an earlier merge parsed.
+ * Without native bindings the files are read here and parsed by the initialized parser.
+ */
+async function readVersions(paths: string[], cacheDir: string | undefined): Promise<Versions> {
+  let native: typeof import("@rejot-dev/thalo/native") | undefined;
+  try {
+    native = await import("@rejot-dev/thalo/native");
+  } catch {
+    native = undefined;
+  }
+
+  if (native?.hasNativeLoader()) {
+    // Git passes temporary files without an extension
+    const inputs = await native.loadFilesNative(paths, {
+      parse: cacheDir === undefined,
+      fileType: "thalo",
+    });
+    const cache = cacheDir === undefined ? undefined : native.openParseCache(cacheDir);
+    return { inputs, parser: native.createExtractionParser(cache) };
+  }
+
+  const inputs = await Promise.all(paths.map((p) => fs.promises.readFile(p, "utf-8")));
+  return { inputs };
+}
+
 /**
  * Git merge driver command
  *
@@ -29,23 +67,23 @@ async function mergeDriverAction(ctx: CommandContext): Promise<void> {
   const [basePath, oursPath, theirsPath] = args;
   const repoPath = args[3] || oursPath;
 
-  let base: string, ours: string, theirs: string;
+  const showBase = options["diff3"] as boolean;
+  const cacheDir = options["cache-dir"] as string | undefined;
+
+  let versions: Versions;
   try {
-    [base, ours, theirs] = await Promise.all([
-      fs.promises.readFile(basePath, "utf-8"),
-      fs.promises.readFile(oursPath, "utf-8"),
-      fs.promises.readFile(theirsPath, "utf-8"),
-    ]);
+    versions = await readVersions([basePath, oursPath, theirsPath], cacheDir);
   } catch (err) {
     const message = err instanceof Error ? err.message : String(err);
     console.error(pc.red(`Error reading files: ${message}`));
     process.exit(2);
   }
 
-  const showBase = options["diff3"] as boolean;
+  const [base, ours, theirs] = versions.inputs;
   const result = mergeThaloFiles(base, ours, theirs, {
     showBase,
     markerStyle: showBase ? "diff3" : "git",
+    parser: versions.parser,
   });
 
   try {
@@ -105,6 +143,10 @@ export const mergeDriverCommand: CommandDef = {
       description: "Use diff3 conflict style (show base)",
       default: false,
     },
+    "cache-dir": {
+      type: "string",
+      description: "Directory for a parse cache shared across merges",
+    },
   },
   action: mergeDriverAction,
 };
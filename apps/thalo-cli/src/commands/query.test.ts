@@ -1,6 +1,11 @@
+import { mkdtempSync, writeFileSync } from "node:fs";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
 import { describe, it, expect, beforeAll, beforeEach } from "vitest";
-import { executeQueries, parseQueryString } from "@rejot-dev/thalo";
+import { executeQueries, parseQueryString, runQuery, type QueryResult } from "@rejot-dev/thalo";
 import { createWorkspace, Workspace, initParser } from "@rejot-dev/thalo/node";
+import { hasNativeStreaming } from "@rejot-dev/thalo/native";
+import { loadStreamedWorkspace } from "../files.js";
 
 describe("query command", () => {
   // Initialize parser once for all tests
@@ -233,4 +238,25 @@ describe("query command", () => {
       expect(results[2].header.title.value).toBe("Personal growth");
     });
   });
+
+  describe.skipIf(!hasNativeStreaming())("loadStreamedWorkspace", () => {
+    it("adds large files in chunks whose entries map back to the file", async () => {
+      let source = `2026-01-01T00:00Z define-entity lore "Lore"\n  # Metadata\n  type: string\n\n`;
+      for (let i = 0; i < 100; i++) {
+        source += `2026-01-02T00:00Z create lore "Entry ${i}" ^entry-${i}\n  type: "fact"\n\n`;
+      }
+      const file = join(mkdtempSync(join(tmpdir(), "thalo-query-")), "large.thalo");
+      writeFileSync(file, source);
+
+      const { workspace, chunks } = await loadStreamedWorkspace([file], { chunkSize: 512 });
+      expect(chunks.size).toBeGreaterThan(1);
+
+      const result = (await runQuery(workspace, "lore")) as QueryResult;
+      expect(result.totalCount).toBe(100);
+      const entry = result.entries.find((e) => e.title === "Entry 50")!;
+      const chunk = chunks.get(entry.file)!;
+      expect(chunk.file).toBe(file);
+      expect(entry.startLine + chunk.lineOffset).toBe(4 + 50 * 3 + 1);
+    });
+  });
 });
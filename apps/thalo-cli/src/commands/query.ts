@@ -9,7 +9,13 @@ import { createChangeTracker, NotInGitRepoError } from "@rejot-dev/thalo/change-
 import { parseCheckpoint } from "@rejot-dev/thalo";
 import pc from "picocolors";
 import type { CommandDef, CommandContext } from "../cli.js";
-import { resolveFiles, loadWorkspace, relativePath } from "../files.js";
+import {
+  resolveFiles,
+  loadWorkspace,
+  loadStreamedWorkspace,
+  relativePath,
+  type StreamedChunk,
+} from "../files.js";
 
 type OutputFormat = "default" | "json" | "raw";
 
@@ -86,12 +92,16 @@ async function queryAction(ctx: CommandContext): Promise<void> {
     process.exit(0);
   }
 
-  const workspace = await loadWorkspace(files);
+  // Git checkpoints diff whole files, so those need one document per file
+  const marker = since ? parseCheckpoint(since) : null;
+  const { workspace, chunks } =
+    marker?.type === "git"
+      ? { workspace: await loadWorkspace(files), chunks: new Map<string, StreamedChunk>() }
+      : await loadStreamedWorkspace(files);
 
   // Create tracker if git checkpoint is used
   let tracker;
   if (since) {
-    const marker = parseCheckpoint(since);
     if (marker?.type === "git") {
       try {
         tracker = await createChangeTracker({ cwd: process.cwd() });
@@ -137,6 +147,16 @@ async function queryAction(ctx: CommandContext): Promise<void> {
     process.exit(2);
   }
 
+  // Report entries of chunk documents at their place in the file
+  for (const entry of result.entries) {
+    const chunk = chunks.get(entry.file);
+    if (chunk) {
+      entry.file = chunk.file;
+      entry.startLine += chunk.lineOffset;
+      entry.endLine += chunk.lineOffset;
+    }
+  }
+
   // Output results
   if (format === "json") {
     console.log(
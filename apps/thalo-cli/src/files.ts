@@ -7,7 +7,8 @@ import { readdir, readFile, stat } from "node:fs/promises";
 import * as path from "node:path";
 import { join, resolve } from "node:path";
 import pc from "picocolors";
-import { createWorkspace, type Workspace } from "@rejot-dev/thalo/node";
+import { createWorkspace, Workspace } from "@rejot-dev/thalo/node";
+import type { EncodedSyntaxTree, StreamBlocksOptions } from "@rejot-dev/thalo/native";
 
 /**
  * Default file extensions for thalo files.
@@ -108,7 +109,8 @@ export function resolveFilesSync(
  * Load workspace from files (sync).
  */
 export function loadWorkspaceSync(files: string[]): Workspace {
-  const workspace = createWorkspace();
+  // Batch commands only read the models; any tree they do need is re-parsed on demand
+  const workspace = createWorkspace({ treeRetention: "release" });
 
   for (const file of files) {
     try {
@@ -202,7 +204,7 @@ export async function resolveFiles(
  * Load workspace from files (async).
  */
 export async function loadWorkspace(files: string[]): Promise<Workspace> {
-  const workspace = createWorkspace();
+  const workspace = createWorkspace({ treeRetention: "release" });
 
   for (const file of files) {
     try {
@@ -216,6 +218,78 @@ export async function loadWorkspace(files: string[]): Promise<Workspace> {
   return workspace;
 }
 
+/**
+ * Where a document of a streamed workspace came from.
+ */
+export interface StreamedChunk {
+  /** The file the chunk was read from */
+  file: string;
+  /** Line of the file the chunk starts at (0-based) */
+  lineOffset: number;
+}
+
+/**
+ * A workspace from `loadStreamedWorkspace`, with the origin of each chunk document.
+ */
+export interface StreamedWorkspace {
+  workspace: Workspace;
+  /** Chunk documents by document name; documents not listed are whole files */
+  chunks: Map<string, StreamedChunk>;
+}
+
+/**
+ * Load a workspace, parsing `.thalo` files in chunks of whole entries so that no file is read
+ * and parsed in one piece. Each chunk is its own document: the first keeps the file's name,
+ * later ones are named `<file>#<n>`, and `chunks` maps them back to their file and line.
+ *
+ * Falls back to loadWorkspace() when the native binding cannot stream.
+ */
+export async function loadStreamedWorkspace(
+  files: string[],
+  options: StreamBlocksOptions = {},
+): Promise<StreamedWorkspace> {
+  const chunks = new Map<string, StreamedChunk>();
+  let native: typeof import("@rejot-dev/thalo/native") | undefined;
+  try {
+    native = await import("@rejot-dev/thalo/native");
+  } catch {
+    native = undefined;
+  }
+  if (!native?.hasNativeStreaming()) {
+    return { workspace: await loadWorkspace(files), chunks };
+  }
+
+  // Each chunk is added right after it is parsed, so only its tree is held here
+  const trees = new Map<string, EncodedSyntaxTree>();
+  const workspace = new Workspace(native.createPreparsedParser(trees), {
+    treeRetention: "release",
+  });
+  for (const file of files) {
+    try {
+      if (!file.endsWith(".thalo")) {
+        workspace.addDocument(await readFile(file, "utf-8"), { filename: file });
+        continue;
+      }
+
+      let index = 0;
+      for (const block of native.streamBlocks(file, options)) {
+        const filename = index === 0 ? file : `${file}#${index}`;
+        index++;
+        chunks.set(filename, { file, lineOffset: block.sourceMap.lineOffset });
+        if (block.tree instanceof native.EncodedTree) {
+          trees.set(block.source, block.tree.encoded);
+        }
+        workspace.addDocument(block.source, { filename, fileType: "thalo" });
+        trees.clear();
+      }
+    } catch (err) {
+      console.error(pc.red(`Error reading ${file}: ${err instanceof Error ? err.message : err}`));
+    }
+  }
+
+  return { workspace, chunks };
+}
+
 /**
  * Load the full workspace from the current working directory (async).
  * This is the standard way to load a workspace - always includes all files from CWD.
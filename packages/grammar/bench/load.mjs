@@ -0,0 +1,91 @@
+#!/usr/bin/env node
+/**
+ * Batch-load benchmark for the native binding's `loadFiles`: many short files, parsed with the
+ * per-file arena allocator and with the system allocator.
+ *
+ * For each file count this reports files/s for both allocators, where every file holds a few
+ * entries, and the speedup of the arena. Runs alternate between the two allocators, so drift in
+ * machine load affects both alike.
+ *
+ * Usage: node bench/load.mjs [files...] [--entries=N] [--threads=N] [--json]
+ * Defaults to 1000 and 10000 files of 5 entries each on all cores.
+ */
+import { mkdtempSync, rmSync, writeFileSync } from "node:fs";
+import { availableParallelism, tmpdir } from "node:os";
+import { join } from "node:path";
+import thalo from "../bindings/node/index.js";
+import { generateWorkspace } from "./workspace.mjs";
+
+const args = process.argv.slice(2);
+const json = args.includes("--json");
+const option = (name, fallback) => {
+  const arg = args.find((a) => a.startsWith(`--${name}=`));
+  return arg ? Number(arg.slice(name.length + 3)) : fallback;
+};
+const entriesPerFile = option("entries", 5);
+const threads = option("threads", availableParallelism());
+const counts = args.filter((arg) => !arg.startsWith("--")).map(Number);
+if (counts.length === 0) {
+  counts.push(1_000, 10_000);
+}
+
+function writeFiles(dir, count) {
+  const files = [];
+  for (let i = 0; i < count; i++) {
+    const path = join(dir, `file-${i}.thalo`);
+    writeFileSync(path, generateWorkspace(entriesPerFile, i + 1));
+    files.push({ path, parse: true });
+  }
+  return files;
+}
+
+async function timeLoad(files, arena) {
+  const start = performance.now();
+  await thalo.loadFiles(files, threads, arena);
+  return performance.now() - start;
+}
+
+async function benchLoad(files) {
+  // Warm up the page cache and both allocators, then alternate until ~2s or 6 runs
+  await timeLoad(files, true);
+  await timeLoad(files, false);
+  const arena = { ms: 0, runs: 0 };
+  const system = { ms: 0, runs: 0 };
+  const start = performance.now();
+  while (arena.runs + system.runs < 6 || performance.now() - start < 2000) {
+    const useArena = arena.runs === system.runs;
+    const stats = useArena ? arena : system;
+    stats.ms += await timeLoad(files, useArena);
+    stats.runs++;
+  }
+  return {
+    arenaFilesPerSecond: (files.length * arena.runs * 1000) / arena.ms,
+    systemFilesPerSecond: (files.length * system.runs * 1000) / system.ms,
+  };
+}
+
+const dir = mkdtempSync(join(tmpdir(), "thalo-load-bench-"));
+const results = [];
+try {
+  for (const count of counts) {
+    const rates = await benchLoad(writeFiles(dir, count));
+    const result = { files: count, entriesPerFile, threads, ...rates };
+    result.speedup = result.arenaFilesPerSecond / result.systemFilesPerSecond;
+    results.push(result);
+
+    if (!json) {
+      console.log(
+        `${String(count).padStart(6)} files x ${entriesPerFile} entries, ${threads} threads` +
+          `  arena ${result.arenaFilesPerSecond.toFixed(0).padStart(8)} files/s` +
+          `  system ${result.systemFilesPerSecond.toFixed(0).padStart(8)} files/s` +
+          `  speedup ${result.speedup.toFixed(2)}x`,
+      );
+    }
+  }
+} finally {
+  rmSync(dir, { recursive: true, force: true });
+}
+
+if (json) {
+  console.log(JSON.stringify(results, null, 2));
+}
@@ -0,0 +1,127 @@
+#!/usr/bin/env node
+/**
+ * Parse benchmarks for the thalo grammar, using the native binding.
+ *
+ * For each synthetic workspace size this reports:
+ * - full parse throughput (MB/s)
+ * - p50/p99 latency of a single-keystroke `tree.edit` + incremental reparse
+ * - external scanner calls per byte (counted from the parser's debug log)
+ *
+ * Usage: node bench/parse.mjs [entries...] [--edits=N] [--json]
+ * Defaults to 1000, 10000 and 100000 entries.
+ */
+import Parser from "tree-sitter";
+import thalo from "../bindings/node/index.js";
+import { generateWorkspace, pickEditOffsets } from "./workspace.mjs";
+
+const args = process.argv.slice(2);
+const json = args.includes("--json");
+const editsArg = args.find((arg) => arg.startsWith("--edits="));
+const editCount = editsArg ? Number(editsArg.slice("--edits=".length)) : 200;
+const sizes = args.filter((arg) => !arg.startsWith("--")).map(Number);
+if (sizes.length === 0) {
+  sizes.push(1_000, 10_000, 100_000);
+}
+
+function percentile(sorted, p) {
+  return sorted[Math.min(sorted.length - 1, Math.floor((sorted.length * p) / 100))];
+}
+
+/**
+ * Track tree-sitter points for ascending offsets without rescanning the source each time
+ * (the generated sources are ASCII, so columns equal UTF-16 offsets).
+ */
+function createPointTracker(source) {
+  let offset = 0;
+  let row = 0;
+  return (target) => {
+    let i = source.indexOf("\n", offset);
+    while (i !== -1 && i < target) {
+      row++;
+      offset = i + 1;
+      i = source.indexOf("\n", offset);
+    }
+    return { row, column: target - offset };
+  };
+}
+
+function benchFullParse(parser, source) {
+  // Warm up, then repeat until at least ~1s or 3 runs have been measured
+  parser.parse(source);
+  let runs = 0;
+  const start = performance.now();
+  while (runs < 3 || performance.now() - start < 1000) {
+    parser.parse(source);
+    runs++;
+  }
+  const seconds = (performance.now() - start) / 1000;
+  return (Buffer.byteLength(source) * runs) / seconds / 1e6;
+}
+
+function benchIncremental(parser, source) {
+  let tree = parser.parse(source);
+  const latencies = [];
+  // Each edit inserts one character on a different line, so rows and columns can be computed on
+  // the original source; only the offsets of later edits shift, by one per earlier edit
+  const pointAt = createPointTracker(source);
+  pickEditOffsets(source, editCount).forEach((offset, i) => {
+    const position = pointAt(offset);
+    const at = offset + i;
+    source = source.slice(0, at) + "x" + source.slice(at);
+    const start = performance.now();
+    tree.edit({
+      startIndex: at,
+      oldEndIndex: at,
+      newEndIndex: at + 1,
+      startPosition: position,
+      oldEndPosition: position,
+      newEndPosition: { row: position.row, column: position.column + 1 },
+    });
+    tree = parser.parse(source, tree);
+    latencies.push(performance.now() - start);
+  });
+  latencies.sort((a, b) => a - b);
+  return { p50: percentile(latencies, 50), p99: percentile(latencies, 99) };
+}
+
+function countScannerCalls(source) {
+  const parser = new Parser();
+  parser.setLanguage(thalo);
+  let calls = 0;
+  parser.setLogger((message) => {
+    if (message.startsWith("lex_external")) {
+      calls++;
+    }
+  });
+  parser.parse(source);
+  return calls / Buffer.byteLength(source);
+}
+
+const parser = new Parser();
+parser.setLanguage(thalo);
+const results = [];
+
+for (const entries of sizes) {
+  const source = generateWorkspace(entries);
+  const result = {
+    entries,
+    bytes: Buffer.byteLength(source),
+    fullParseMBps: benchFullParse(parser, source),
+    ...benchIncremental(parser, source),
+    scannerCallsPerByte: countScannerCalls(source),
+  };
+  results.push(result);
+
+  if (!json) {
+    console.log(
+      `${String(entries).padStart(7)} entries ${(result.bytes / 1e6).toFixed(1).padStart(6)} MB` +
+        `  full ${result.fullParseMBps.toFixed(1).padStart(6)} MB/s` +
+        `  edit p50 ${result.p50.toFixed(2).padStart(7)} ms  p99 ${result.p99.toFixed(2).padStart(7)} ms` +
+        `  scanner ${result.scannerCallsPerByte.toFixed(4)} calls/byte`,
+    );
+  }
+}
+
+if (json) {
+  console.log(JSON.stringify(results, null, 2));
+}
@@ -0,0 +1,236 @@
+/**
+ * @file scanner_bench.c
+ * @brief Micro-benchmark for the external scanner
+ *
+ * Drives src/scanner.c over synthetic inputs through an in-memory TSLexer, calling the scanner
+ * at every line end like the parser does inside entries. Reports throughput and the number of
+ * lexer callbacks per input byte, which is what the scanner's cost is dominated by.
+ *
+ * Build with `make bench` or the `scanner-bench` CMake target
+ * (-DTREE_SITTER_THALO_BENCHMARKS=ON).
+ */
+
+#include "../src/scanner.c"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct
+{
+    TSLexer lexer;
+    const char *data;
+    size_t length;
+    size_t position;
+    size_t token_end;
+    size_t advance_calls;
+    size_t eof_calls;
+} BenchLexer;
+
+static void bench_advance(TSLexer *lexer, bool skip)
+{
+    (void)skip;
+    BenchLexer *self = (BenchLexer *)lexer;
+    self->advance_calls++;
+    if (self->position < self->length)
+    {
+        self->position++;
+    }
+    lexer->lookahead = self->position < self->length ? (unsigned char)self->data[self->position] : 0;
+}
+
+static void bench_mark_end(TSLexer *lexer)
+{
+    BenchLexer *self = (BenchLexer *)lexer;
+    self->token_end = self->position;
+}
+
+static uint32_t bench_get_column(TSLexer *lexer)
+{
+    BenchLexer *self = (BenchLexer *)lexer;
+    size_t start = self->position;
+    while (start > 0 && self->data[start - 1] != '\n')
+    {
+        start--;
+    }
+    return (uint32_t)(self->position - start);
+}
+
+static bool bench_is_at_included_range_start(const TSLexer *lexer)
+{
+    (void)lexer;
+    return false;
+}
+
+static bool bench_eof(const TSLexer *lexer)
+{
+    BenchLexer *self = (BenchLexer *)lexer;
+    self->eof_calls++;
+    return self->position >= self->length;
+}
+
+static void bench_seek(BenchLexer *self, size_t position)
+{
+    self->position = position;
+    self->token_end = position;
+    self->lexer.lookahead = position < self->length ? (unsigned char)self->data[position] : 0;
+}
+
+/**
+ * @brief Call the scanner at every line end, advancing past each token it produces
+ *
+ * Like the parser, the scanner state is restored from the last token before every call and
+ * saved again after each token. Returns the number of scanner calls.
+ */
+static size_t run_scanner(BenchLexer *lexer, void *scanner)
+{
+    const bool valid_symbols[] = {[INDENT] = true, [CONTENT_BLANK] = true, [ERROR_SENTINEL] = false};
+    char state[TREE_SITTER_SERIALIZATION_BUFFER_SIZE];
+    unsigned state_length = 0;
+    size_t calls = 0;
+    size_t line_end = 0;
+
+    while (line_end < lexer->length)
+    {
+        while (line_end < lexer->length && lexer->data[line_end] != '\n')
+        {
+            line_end++;
+        }
+
+        bench_seek(lexer, line_end);
+        calls++;
+        tree_sitter_thalo_external_scanner_deserialize(scanner, state, state_length);
+        bool matched = tree_sitter_thalo_external_scanner_scan(scanner, &lexer->lexer, valid_symbols);
+        if (matched)
+        {
+            state_length = tree_sitter_thalo_external_scanner_serialize(scanner, state);
+        }
+        // Resume after the token, or let the "grammar" consume the newline itself
+        size_t next = matched ? lexer->token_end : line_end + 1;
+        line_end = next > line_end ? next : line_end + 1;
+    }
+
+    return calls;
+}
+
+typedef struct
+{
+    char *data;
+    size_t length;
+    size_t capacity;
+} Buffer;
+
+static void buffer_append(Buffer *buffer, const char *text)
+{
+    size_t length = strlen(text);
+    if (buffer->length + length + 1 > buffer->capacity)
+    {
+        buffer->capacity = (buffer->length + length + 1) * 2;
+        buffer->data = realloc(buffer->data, buffer->capacity);
+    }
+    memcpy(buffer->data + buffer->length, text, length + 1);
+    buffer->length += length;
+}
+
+/** Entries with long indented markdown content bodies */
+static Buffer make_content(size_t entries)
+{
+    Buffer buffer = {0};
+    for (size_t i = 0; i < entries; i++)
+    {
+        buffer_append(&buffer, "2026-01-05T10:00Z create lore \"Entry\" #bench\n  type: \"fact\"\n\n  # Body\n");
+        for (int line = 0; line < 20; line++)
+        {
+            buffer_append(&buffer, "  Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor "
+                                   "incididunt ut labore et dolore magna aliqua.\n");
+            if (line % 5 == 4)
+            {
+                buffer_append(&buffer, "\n");
+            }
+        }
+        buffer_append(&buffer, "\n");
+    }
+    return buffer;
+}
+
+/** Content bodies split by long runs of blank lines */
+static Buffer make_blank_runs(size_t entries, int run)
+{
+    Buffer buffer = {0};
+    for (size_t i = 0; i < entries; i++)
+    {
+        buffer_append(&buffer, "2026-01-05T10:00Z create lore \"Entry\"\n  type: \"fact\"\n\n  # Body\n  First paragraph.\n");
+        for (int line = 0; line < run; line++)
+        {
+            buffer_append(&buffer, line % 2 ? "\n" : "    \n");
+        }
+        buffer_append(&buffer, "  Second paragraph.\n\n");
+    }
+    return buffer;
+}
+
+/** Metadata interleaved with long runs of column-0 comments */
+static Buffer make_comment_runs(size_t entries, int run)
+{
+    Buffer buffer = {0};
+    for (size_t i = 0; i < entries; i++)
+    {
+        buffer_append(&buffer, "2026-01-05T10:00Z create lore \"Entry\"\n  type: \"fact\"\n");
+        for (int line = 0; line < run; line++)
+        {
+            buffer_append(&buffer, "// generated comment line between metadata fields\n");
+        }
+        buffer_append(&buffer, "  subject: ^self\n\n");
+    }
+    return buffer;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void bench(const char *name, Buffer input, int iterations)
+{
+    void *scanner = tree_sitter_thalo_external_scanner_create();
+    BenchLexer lexer = {
+        .lexer = {
+            .advance = bench_advance,
+            .mark_end = bench_mark_end,
+            .get_column = bench_get_column,
+            .is_at_included_range_start = bench_is_at_included_range_start,
+            .eof = bench_eof,
+        },
+        .data = input.data,
+        .length = input.length,
+    };
+
+    size_t calls = 0;
+    double start = now_seconds();
+    for (int i = 0; i < iterations; i++)
+    {
+        calls += run_scanner(&lexer, scanner);
+    }
+    double elapsed = now_seconds() - start;
+    double bytes = (double)input.length * iterations;
+
+    printf("%-14s %9zu bytes %9.1f MB/s %6.2f advance/byte %6.2f eof/byte %6.3f scans/byte\n", name,
+           input.length, bytes / elapsed / 1e6, (double)lexer.advance_calls / bytes,
+           (double)lexer.eof_calls / bytes, (double)calls / bytes);
+
+    tree_sitter_thalo_external_scanner_destroy(scanner);
+    free(input.data);
+}
+
+int main(int argc, char **argv)
+{
+    // Scale factor: number of entries per input
+    size_t entries = argc > 1 ? (size_t)strtoul(argv[1], NULL, 10) : 1000;
+
+    bench("content", make_content(entries), 10);
+    bench("blank-runs", make_blank_runs(entries, 50), 10);
+    bench("comment-runs", make_comment_runs(entries, 50), 10);
+    return 0;
+}
@@ -0,0 +1,176 @@
+/**
+ * Deterministic synthetic thalo workspaces for the grammar benchmarks.
+ *
+ * Entries cycle through templates that together exercise every construct in grammar.js:
+ * schema blocks (metadata, sections, removals, all type expressions and defaults), instance
+ * metadata of every value type, queries, dateranges, comments, and markdown content.
+ */
+
+/**
+ * Small seeded PRNG (mulberry32), so every run benchmarks the same input.
+ */
+function createRandom(seed) {
+  let state = seed >>> 0;
+  return () => {
+    state = (state + 0x6d2b79f5) >>> 0;
+    let t = state;
+    t = Math.imul(t ^ (t >>> 15), t | 1);
+    t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
+const ENTITIES = ["lore", "opinion", "journal", "reference"];
+const WORDS = ["system", "latency", "editor", "grammar", "parser", "cache", "index", "query"];
+
+function pad(value) {
+  return String(value).padStart(2, "0");
+}
+
+function timestamp(i) {
+  const day = (i % 28) + 1;
+  const month = (Math.floor(i / 28) % 12) + 1;
+  const year = 2020 + (Math.floor(i / 336) % 7);
+  return `${year}-${pad(month)}-${pad(day)}T${pad(i % 24)}:${pad(i % 60)}Z`;
+}
+
+function sentence(random, words) {
+  const parts = [];
+  for (let i = 0; i < words; i++) {
+    parts.push(WORDS[Math.floor(random() * WORDS.length)]);
+  }
+  const text = parts.join(" ");
+  return text[0].toUpperCase() + text.slice(1) + ".";
+}
+
+function defineEntity(i, random) {
+  const entity = ENTITIES[i % ENTITIES.length];
+  return `${timestamp(i)} define-entity ${entity}-${i} "Schema ${i}" ^schema-${i} #schema
+  # Metadata
+  type: "fact" | "insight" ; "Kind of ${entity}"
+  subject?: link
+  tags: string[] = "none"
+  rating?: number = 3
+  due: datetime = 2026-01-01
+  period?: daterange
+  choices: ("a" | "b")[] ; "Allowed choices"
+  custom: unknown-type
+
+  # Sections
+  Summary ; "${sentence(random, 4)}"
+  Key Takeaways?
+  Notes
+`;
+}
+
+function alterEntity(i) {
+  return `${timestamp(i)} alter-entity ${ENTITIES[i % ENTITIES.length]} "Alter ${i}"
+  # Remove Metadata
+  rating ; "No longer tracked"
+  # Remove Sections
+  Notes
+  # Metadata
+  reviewed?: datetime
+`;
+}
+
+function createInstance(i, random) {
+  const lines = [];
+  for (let p = 0; p < 3; p++) {
+    lines.push(`  ${sentence(random, 12)}`);
+    lines.push(`  ${sentence(random, 10)} See ^entry-${Math.max(0, i - p - 1)} for context.`);
+    lines.push("");
+  }
+  return `${timestamp(i)} create ${ENTITIES[i % ENTITIES.length]} "Entry ${i}" ^entry-${i} #tag-${i % 10} #bench
+  type: "insight"
+  subject: ^self
+  // Indented comment between metadata
+  rating: ${(i % 5) + 0.5}
+  score: -${i % 100}
+  due: 2026-0${(i % 9) + 1}-1${i % 10}T09:30+02:00
+  period: 202${i % 7} Q${(i % 4) + 1}
+  range: 2024-01 ~ 2025-06
+  open: 2023 ~
+  month: 2024-0${(i % 9) + 1}
+  related: ^entry-${i + 1}, ^entry-${i + 2}, "external", 2025-03-01
+// Unindented comment that still belongs to the entry
+  sources: lore where #career and subject = ^self
+
+  # Summary
+${lines.join("\n")}
+  ## Details
+  /path-like text that is not a comment
+`;
+}
+
+function defineSynthesis(i) {
+  return `${timestamp(i)} define-synthesis "Synthesis ${i}" ^synthesis-${i} #synthesis
+  sources: lore where #tag-${i % 10} and type = "insight", opinion where ^entry-${i}
+
+  # Prompt
+  Summarize the insights tagged with tag-${i % 10}.
+`;
+}
+
+function actualizeSynthesis(i) {
+  return `${timestamp(i)} actualize-synthesis ^synthesis-${i - 1}
+  updated: ${timestamp(i).slice(0, 16)}
+`;
+}
+
+function updateEntry(i) {
+  return `${timestamp(i)} update ^entry-${i - 1} "Update ${i}"
+  reason: "Corrected details"
+`;
+}
+
+// Weighted so instance entries (the common case) dominate, like real workspaces
+const TEMPLATES = [
+  defineEntity,
+  createInstance,
+  createInstance,
+  createInstance,
+  defineSynthesis,
+  createInstance,
+  actualizeSynthesis,
+  alterEntity,
+  createInstance,
+  updateEntry,
+];
+
+/**
+ * Generate a single thalo document with `entries` entries.
+ *
+ * @param {number} entries - Number of entries
+ * @param {number} [seed] - PRNG seed
+ * @returns {string}
+ */
+export function generateWorkspace(entries, seed = 1) {
+  const random = createRandom(seed);
+  const parts = ["// Synthetic benchmark workspace\n\n"];
+  for (let i = 0; i < entries; i++) {
+    parts.push(TEMPLATES[i % TEMPLATES.length](i, random), "\n");
+  }
+  return parts.join("");
+}
+
+/**
+ * Find offsets inside content lines, where single-keystroke edits are typical.
+ *
+ * @param {string} source
+ * @param {number} count - Maximum number of offsets
+ * @param {number} [seed]
+ * @returns {number[]} Distinct offsets on distinct lines, in ascending order
+ */
+export function pickEditOffsets(source, count, seed = 2) {
+  const random = createRandom(seed);
+  const offsets = new Set();
+  const markers = ["\n  Summarize", "\n  /path-like"];
+  for (let i = 0; i < count; i++) {
+    const marker = markers[i % markers.length];
+    const from = Math.floor(random() * source.length);
+    const found = source.indexOf(marker, from);
+    offsets.add((found === -1 ? source.indexOf(marker) : found) + marker.length);
+  }
+  return [...offsets].sort((a, b) => a - b);
+}
@@ -1,15 +1,133 @@
 {
+  "variables": {
+    # The tree-sitter runtime is compiled from the sources vendored by the `tree-sitter`
+    # package, so the binding can parse and walk trees natively (see bindings/node/encode.cc).
+    "tree_sitter_lib": "<!(node -p \"require('path').join(require('path').dirname(require.resolve('tree-sitter/package.json')), 'vendor', 'tree-sitter', 'lib')\")",
+    # Release profile for prebuilds (see scripts/build-release.mjs), set with e.g.
+    # `node-gyp rebuild --thalo_release=true --thalo_pgo=use`:
+    # - thalo_release: link-time optimization across the parser, scanner, runtime and binding,
+    #   and on Linux a statically linked C++ runtime
+    # - thalo_pgo: "generate" to build an instrumented binding, "use" to optimize with the
+    #   profiles it wrote to thalo_pgo_dir (GCC and Clang only)
+    "thalo_release%": "false",
+    "thalo_pgo%": "",
+    "thalo_pgo_dir%": "<(module_root_dir)/.pgo",
+  },
+  "target_defaults": {
+    "conditions": [
+      ["thalo_release=='true' and OS=='linux'", {
+        "cflags": ["-flto=auto"],
+        "ldflags": ["-flto=auto", "-static-libstdc++", "-static-libgcc"],
+      }],
+      ["thalo_release=='true' and OS=='mac'", {
+        "xcode_settings": {
+          "LLVM_LTO": "YES",
+        },
+      }],
+      ["thalo_release=='true' and OS=='win'", {
+        "msvs_settings": {
+          "VCCLCompilerTool": {
+            "WholeProgramOptimization": "true",
+          },
+          "VCLinkerTool": {
+            "LinkTimeCodeGeneration": 1,
+          },
+        },
+      }],
+      # Threads from loadFiles update the counters concurrently, hence atomic updates
+      ["thalo_pgo=='generate' and OS!='win'", {
+        "cflags": ["-fprofile-generate=<(thalo_pgo_dir)", "-fprofile-update=atomic"],
+        "ldflags": ["-fprofile-generate=<(thalo_pgo_dir)"],
+        "xcode_settings": {
+          "OTHER_CFLAGS": ["-fprofile-generate=<(thalo_pgo_dir)", "-fprofile-update=atomic"],
+          "OTHER_LDFLAGS": ["-fprofile-generate=<(thalo_pgo_dir)"],
+        },
+      }],
+      # Only flags GCC and Clang share, since gyp cannot tell which one CC is (GCC's
+      # -fprofile-partial-training is left out)
+      ["thalo_pgo=='use' and OS!='win'", {
+        "cflags": ["-fprofile-use=<(thalo_pgo_dir)"],
+        "xcode_settings": {
+          "OTHER_CFLAGS": ["-fprofile-use=<(thalo_pgo_dir)"],
+        },
+      }],
+    ],
+  },
   "targets": [
+    {
+      "target_name": "tree_sitter_runtime",
+      "type": "static_library",
+      "include_dirs": [
+        "<(tree_sitter_lib)/src",
+        "<(tree_sitter_lib)/include",
+      ],
+      "sources": [
+        "<(tree_sitter_lib)/src/lib.c",
+      ],
+      "defines": [
+        "_POSIX_C_SOURCE=200112L",
+        "_DEFAULT_SOURCE",
+      ],
+      "direct_dependent_settings": {
+        "include_dirs": [
+          "<(tree_sitter_lib)/include",
+        ],
+      },
+      "conditions": [
+        ["OS!='win'", {
+          "cflags_c": [
+            "-std=c11",
+          ],
+        }, { # OS == "win"
+          "cflags_c": [
+            "/std:c11",
+            "/utf-8",
+          ],
+        }],
+      ],
+    },
     {
       "target_name": "tree_sitter_thalo_binding",
       "dependencies": [
         "<!(node -p \"require('node-addon-api').targets\"):node_addon_api_except",
+        "tree_sitter_runtime",
       ],
       "include_dirs": [
         "src",
+        "<(INTERMEDIATE_DIR)",
+      ],
+      # build_id.h: a hash of the sources that shape encoded trees (see scripts/build-id.mjs)
+      "actions": [
+        {
+          "action_name": "build_id",
+          "inputs": [
+            "scripts/build-id.mjs",
+            "src/parser.c",
+            "src/scanner.c",
+            "src/scanner_stats.h",
+            "bindings/node/encode.cc",
+            "bindings/node/encode.h",
+            "bindings/node/times.cc",
+            "bindings/node/times.h",
+          ],
+          "outputs": ["<(INTERMEDIATE_DIR)/build_id.h"],
+          "action": ["node", "scripts/build-id.mjs", "<@(_outputs)"],
+        },
+      ],
+      "defines": [
+        # Route the scanner's ts_malloc/ts_free through the runtime's hooks (see arena.h)
+        "TREE_SITTER_REUSE_ALLOCATOR",
       ],
       "sources": [
+        "bindings/node/arena.cc",
         "bindings/node/binding.cc",
+        "bindings/node/encode.cc",
+        "bindings/node/fences.cc",
+        "bindings/node/hash.cc",
+        "bindings/node/loader.cc",
+        "bindings/node/stats.cc",
+        "bindings/node/stream.cc",
+        "bindings/node/times.cc",
         "src/parser.c",
       ],
       "variables": {
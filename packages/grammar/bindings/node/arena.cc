@@ -0,0 +1,196 @@
+#include "arena.h"
+
+#include <tree_sitter/api.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace thalo {
+
+namespace {
+
+// Every allocation is preceded by a header holding its size, padded to keep payloads aligned
+constexpr size_t ALIGNMENT = 16;
+constexpr size_t HEADER_SIZE = ALIGNMENT;
+// Also the chunks' alignment, so a pointer's chunk base is found by masking
+constexpr size_t CHUNK_SIZE = 256 * 1024;
+
+thread_local Arena *current_arena = nullptr;
+
+size_t align_up(size_t size) { return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+
+[[noreturn]] void out_of_memory(size_t size) {
+    // Same as the runtime's default allocator
+    fprintf(stderr, "tree-sitter failed to allocate %zu bytes", size);
+    abort();
+}
+
+uintptr_t block_base(const void *ptr) {
+    return reinterpret_cast<uintptr_t>(ptr) & ~static_cast<uintptr_t>(CHUNK_SIZE - 1);
+}
+
+char *allocate_chunk(size_t size) {
+#ifdef _WIN32
+    void *data = _aligned_malloc(size, CHUNK_SIZE);
+#else
+    void *data = nullptr;
+    if (posix_memalign(&data, CHUNK_SIZE, size) != 0) {
+        data = nullptr;
+    }
+#endif
+    if (data == nullptr) {
+        out_of_memory(size);
+    }
+    return static_cast<char *>(data);
+}
+
+void free_chunk(char *data) {
+#ifdef _WIN32
+    _aligned_free(data);
+#else
+    free(data);
+#endif
+}
+
+size_t allocation_size(const void *ptr) {
+    size_t size;
+    memcpy(&size, static_cast<const char *>(ptr) - HEADER_SIZE, sizeof(size));
+    return size;
+}
+
+void *arena_malloc(size_t size) {
+    if (current_arena != nullptr) {
+        return current_arena->allocate(size);
+    }
+    void *result = malloc(size);
+    if (size > 0 && result == nullptr) {
+        out_of_memory(size);
+    }
+    return result;
+}
+
+void *arena_calloc(size_t count, size_t size) {
+    if (current_arena != nullptr) {
+        if (size != 0 && count > SIZE_MAX / size) {
+            out_of_memory(SIZE_MAX);
+        }
+        void *result = current_arena->allocate(count * size);
+        memset(result, 0, count * size);
+        return result;
+    }
+    void *result = calloc(count, size);
+    if (count > 0 && size > 0 && result == nullptr) {
+        out_of_memory(count * size);
+    }
+    return result;
+}
+
+void *arena_realloc(void *ptr, size_t size) {
+    if (current_arena != nullptr && (ptr == nullptr || current_arena->owns(ptr))) {
+        return current_arena->reallocate(ptr, size);
+    }
+    void *result = realloc(ptr, size);
+    if (size > 0 && result == nullptr) {
+        out_of_memory(size);
+    }
+    return result;
+}
+
+void arena_free(void *ptr) {
+    if (current_arena != nullptr && ptr != nullptr && current_arena->owns(ptr)) {
+        current_arena->release(ptr);
+        return;
+    }
+    free(ptr);
+}
+
+} // namespace
+
+Arena::~Arena() {
+    for (const Chunk &chunk : chunks_) {
+        free_chunk(chunk.data);
+    }
+}
+
+void *Arena::allocate(size_t size) {
+    size_t needed = HEADER_SIZE + align_up(size);
+
+    // Move on to the first chunk with room; after a reset this reuses the existing chunks
+    while (current_ < chunks_.size() && chunks_[current_].size - offset_ < needed) {
+        current_++;
+        offset_ = 0;
+    }
+    if (current_ == chunks_.size()) {
+        // Whole blocks, so every block of an oversized chunk is registered too
+        size_t chunk_size = (needed + CHUNK_SIZE - 1) / CHUNK_SIZE * CHUNK_SIZE;
+        char *data = allocate_chunk(chunk_size);
+        chunks_.push_back({data, chunk_size});
+        for (size_t block = 0; block < chunk_size; block += CHUNK_SIZE) {
+            blocks_.insert(reinterpret_cast<uintptr_t>(data + block));
+        }
+        offset_ = 0;
+    }
+
+    char *header = chunks_[current_].data + offset_;
+    memcpy(header, &size, sizeof(size));
+    offset_ += needed;
+    last_ = header + HEADER_SIZE;
+    return last_;
+}
+
+void *Arena::reallocate(void *ptr, size_t size) {
+    if (ptr == nullptr) {
+        return allocate(size);
+    }
+    size_t old_size = allocation_size(ptr);
+
+    // Arrays grow by repeated reallocs of the newest allocation; extend it where it lies
+    if (ptr == last_) {
+        const Chunk &chunk = chunks_[current_];
+        size_t start = static_cast<char *>(ptr) - chunk.data;
+        if (start + align_up(size) <= chunk.size) {
+            offset_ = start + align_up(size);
+            memcpy(static_cast<char *>(ptr) - HEADER_SIZE, &size, sizeof(size));
+            return ptr;
+        }
+    }
+
+    void *result = allocate(size);
+    memcpy(result, ptr, old_size < size ? old_size : size);
+    return result;
+}
+
+void Arena::release(void *ptr) {
+    if (ptr != last_) {
+        return;
+    }
+    offset_ = static_cast<size_t>(static_cast<char *>(ptr) - HEADER_SIZE - chunks_[current_].data);
+    last_ = nullptr;
+}
+
+bool Arena::owns(const void *ptr) const { return blocks_.count(block_base(ptr)) > 0; }
+
+void Arena::reset() {
+    current_ = 0;
+    offset_ = 0;
+    last_ = nullptr;
+}
+
+ArenaScope::ArenaScope(Arena &arena) : previous_(current_arena) { current_arena = &arena; }
+
+ArenaScope::~ArenaScope() { current_arena = previous_; }
+
+void install_arena_allocator() {
+    static std::once_flag installed;
+    std::call_once(installed,
+                   [] { ts_set_allocator(arena_malloc, arena_calloc, arena_realloc, arena_free); });
+}
+
+} // namespace thalo
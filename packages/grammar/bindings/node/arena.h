@@ -0,0 +1,90 @@
+#ifndef TREE_SITTER_THALO_ARENA_H_
+#define TREE_SITTER_THALO_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+namespace thalo {
+
+/**
+ * A bump allocator for the tree-sitter runtime and the external scanner.
+ *
+ * While an ArenaScope is active on a thread, every ts_malloc, ts_calloc and ts_realloc on that
+ * thread is served from the arena. ts_free only gives back the most recent allocation, which
+ * covers stack-like push and pop; other freed memory stays in use until reset(). reset()
+ * releases everything at once and keeps the chunks for the next job, so a thread parsing many
+ * short files stops calling malloc after the first few.
+ *
+ * Since freed memory is not reused, the arena's footprint grows with everything a job ever
+ * allocates rather than what it holds at once. It suits many small jobs, not one large one.
+ *
+ * Chunks are aligned to their size, so telling arena memory from system memory in ts_free and
+ * ts_realloc is one hash lookup of the chunk base.
+ *
+ * Everything allocated in a scope must be dead by the time the arena is reset. For a parse job,
+ * the TSParser, its trees and the scanner are all created and deleted inside the scope.
+ */
+class Arena {
+  public:
+    Arena() = default;
+    ~Arena();
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *allocate(size_t size);
+    void *reallocate(void *ptr, size_t size);
+
+    /** Give back `ptr` if it is the most recent allocation; otherwise do nothing. */
+    void release(void *ptr);
+
+    /** Whether `ptr` lies in one of the arena's chunks. */
+    bool owns(const void *ptr) const;
+
+    /** Release every allocation at once, keeping the chunks. */
+    void reset();
+
+  private:
+    struct Chunk {
+        char *data;
+        size_t size;
+    };
+
+    std::vector<Chunk> chunks_;
+    // Base address of every chunk-sized block in chunks_
+    std::unordered_set<uintptr_t> blocks_;
+    // The chunk being bumped, and the offset of its first free byte
+    size_t current_ = 0;
+    size_t offset_ = 0;
+    // The most recent allocation, which reallocate can grow in place
+    char *last_ = nullptr;
+};
+
+/**
+ * Serve the calling thread's tree-sitter allocations from an arena for the scope's lifetime.
+ * Scopes nest; the innermost one wins.
+ */
+class ArenaScope {
+  public:
+    explicit ArenaScope(Arena &arena);
+    ~ArenaScope();
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope &operator=(const ArenaScope &) = delete;
+
+  private:
+    Arena *previous_;
+};
+
+/**
+ * Route the tree-sitter allocator through the arena hooks (`ts_set_allocator`), once per
+ * process. Allocations on threads without an ArenaScope still go to the system allocator, and
+ * memory from before the switch is freed there too, so it may be called with parsers and trees
+ * alive. Until then nothing pays for the hooks; call it from the JS thread when the first arena
+ * job is requested, before its threads start.
+ */
+void install_arena_allocator();
+
+} // namespace thalo
+
+#endif // TREE_SITTER_THALO_ARENA_H_
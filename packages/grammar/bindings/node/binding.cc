@@ -1,6 +1,23 @@
 #include <napi.h>
+#include <tree_sitter/api.h>
 
-typedef struct TSLanguage TSLanguage;
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "arena.h"
+#include "build_id.h"
+#include "encode.h"
+#include "fences.h"
+#include "hash.h"
+#include "loader.h"
+#include "stats.h"
+#include "stream.h"
 
 extern "C" TSLanguage *tree_sitter_thalo();
 
@@ -9,10 +26,473 @@ const napi_type_tag LANGUAGE_TYPE_TAG = {
     0x8AF2E5212AD58ABF, 0xD5006CAD83ABBA16
 };
 
+/**
+ * Per-environment state, so the binding stays safe to load from worker threads.
+ */
+struct AddonData {
+    TSParser *parser;
+
+    AddonData() : parser(ts_parser_new()) {
+        ts_parser_set_language(parser, tree_sitter_thalo());
+    }
+
+    ~AddonData() {
+        ts_parser_delete(parser);
+    }
+};
+
+/**
+ * Copy a vector into a freshly allocated JS typed array of the matching element type.
+ */
+template <typename T>
+static Napi::TypedArrayOf<T> ToTypedArray(Napi::Env env, const std::vector<T> &values) {
+    auto buffer = Napi::ArrayBuffer::New(env, values.size() * sizeof(T));
+    if (!values.empty()) {
+        std::memcpy(buffer.Data(), values.data(), values.size() * sizeof(T));
+    }
+    return Napi::TypedArrayOf<T>::New(env, values.size(), buffer, 0);
+}
+
+/**
+ * Hand bytes to JS as a Buffer without copying; the finalizer frees them with the Buffer. Empty
+ * vectors may have no storage to point an external buffer at, so they get a plain empty Buffer.
+ */
+static Napi::Buffer<char> ToBuffer(Napi::Env env, std::vector<char> &&values) {
+    if (values.empty()) {
+        return Napi::Buffer<char>::New(env, 0);
+    }
+    auto *bytes = new std::vector<char>(std::move(values));
+    return Napi::Buffer<char>::NewOrCopy(
+        env, bytes->data(), bytes->size(),
+        [](Napi::Env, char *, std::vector<char> *owned) { delete owned; }, bytes);
+}
+
+static Napi::Object EncodedTreeToObject(Napi::Env env, const thalo::EncodedTree &encoded) {
+    Napi::Object result = Napi::Object::New(env);
+    result["nodeCount"] = Napi::Number::New(env, static_cast<double>(encoded.types.size()));
+    result["types"] = ToTypedArray(env, encoded.types);
+    result["flags"] = ToTypedArray(env, encoded.flags);
+    result["ranges"] = ToTypedArray(env, encoded.ranges);
+    result["fields"] = ToTypedArray(env, encoded.fields);
+    result["parents"] = ToTypedArray(env, encoded.parents);
+    result["subtreeEnds"] = ToTypedArray(env, encoded.subtree_ends);
+    result["timeNodes"] = ToTypedArray(env, encoded.time_nodes);
+    result["times"] = ToTypedArray(env, encoded.times);
+    return result;
+}
+
+/**
+ * Convert parse counters to { parses, bytes, parseNs, maxParseNs, scanner: {...} }.
+ */
+static Napi::Object StatsToObject(Napi::Env env, const thalo::ParseStats &stats) {
+    auto number = [env](uint64_t value) {
+        return Napi::Number::New(env, static_cast<double>(value));
+    };
+    const TSThaloScannerStats &scanner = stats.scanner;
+
+    Napi::Object tokens = Napi::Object::New(env);
+    tokens["indent"] = number(scanner.tokens[0]);
+    tokens["contentBlank"] = number(scanner.tokens[1]);
+    tokens["errorSentinel"] = number(scanner.tokens[2]);
+
+    Napi::Object scannerObject = Napi::Object::New(env);
+    scannerObject["scans"] = number(scanner.scans);
+    scannerObject["errorRecovery"] = number(scanner.error_recovery);
+    scannerObject["tokens"] = tokens;
+    scannerObject["memoHits"] = number(scanner.memo_hits);
+    scannerObject["lookaheadChars"] = number(scanner.lookahead_chars);
+
+    Napi::Object result = Napi::Object::New(env);
+    result["parses"] = number(stats.parses);
+    result["bytes"] = number(stats.bytes);
+    result["parseNs"] = number(stats.parse_ns);
+    result["maxParseNs"] = number(stats.max_parse_ns);
+    result["scanner"] = scannerObject;
+    return result;
+}
+
+/**
+ * extractEntries(source: string): EncodedSyntaxTree
+ *
+ * Parse `source` and flatten the whole tree in a single native walk, so JS can build the AST
+ * without one N-API round trip per node. The source is handed to tree-sitter as UTF-16 so the
+ * encoded indices line up with JS string offsets.
+ */
+static Napi::Value ExtractEntries(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        throw Napi::TypeError::New(env, "extractEntries expects a source string");
+    }
+
+    std::u16string source = info[0].As<Napi::String>().Utf16Value();
+    TSParser *parser = env.GetInstanceData<AddonData>()->parser;
+    thalo::ParseProfile profile;
+    TSTree *tree = ts_parser_parse_string_encoding(
+        parser, nullptr, reinterpret_cast<const char *>(source.data()),
+        static_cast<uint32_t>(source.size() * sizeof(char16_t)), TSInputEncodingUTF16LE);
+    profile.finish(source.size() * sizeof(char16_t));
+    if (tree == nullptr) {
+        throw Napi::Error::New(env, "Failed to parse source");
+    }
+
+    thalo::EncodedTree encoded;
+    thalo::SourceView view{reinterpret_cast<const char *>(source.data()),
+                           source.size() * sizeof(char16_t), TSInputEncodingUTF16LE};
+    thalo::encode_tree(tree, view, thalo::OffsetMap::utf16(), encoded);
+    ts_tree_delete(tree);
+
+    return EncodedTreeToObject(env, encoded);
+}
+
+/**
+ * A borrowed byte range handed to tree-sitter through a TSInput read callback.
+ */
+struct ByteInput {
+    const char *data;
+    uint32_t length;
+
+    static const char *Read(void *payload, uint32_t byte, TSPoint, uint32_t *bytes_read) {
+        auto *input = static_cast<ByteInput *>(payload);
+        if (byte >= input->length) {
+            *bytes_read = 0;
+            return "";
+        }
+        *bytes_read = input->length - byte;
+        return input->data + byte;
+    }
+};
+
+/**
+ * extractEntriesFromBuffer(source: Uint8Array): EncodedSyntaxTree
+ *
+ * Like extractEntries, but parses UTF-8 bytes in place: tree-sitter reads straight from the
+ * buffer's memory, so the source is never transcoded or copied. Encoded indices are still
+ * converted to UTF-16 code units so they line up with the decoded JS string.
+ */
+static Napi::Value ExtractEntriesFromBuffer(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsTypedArray() ||
+        info[0].As<Napi::TypedArray>().TypedArrayType() != napi_uint8_array) {
+        throw Napi::TypeError::New(env, "extractEntriesFromBuffer expects a Uint8Array");
+    }
+
+    auto bytes = info[0].As<Napi::Uint8Array>();
+    if (bytes.ByteLength() > UINT32_MAX) {
+        throw Napi::RangeError::New(env, "Source is too large to parse");
+    }
+    ByteInput input{reinterpret_cast<const char *>(bytes.Data()),
+                    static_cast<uint32_t>(bytes.ByteLength())};
+
+    TSParser *parser = env.GetInstanceData<AddonData>()->parser;
+    thalo::ParseProfile profile;
+    TSTree *tree = ts_parser_parse(
+        parser, nullptr, TSInput{&input, ByteInput::Read, TSInputEncodingUTF8, nullptr});
+    profile.finish(input.length);
+    if (tree == nullptr) {
+        throw Napi::Error::New(env, "Failed to parse source");
+    }
+
+    thalo::EncodedTree encoded;
+    thalo::encode_tree(tree, {input.data, input.length, TSInputEncodingUTF8},
+                       thalo::OffsetMap::utf8(input.data, input.length), encoded);
+    ts_tree_delete(tree);
+
+    return EncodedTreeToObject(env, encoded);
+}
+
+/**
+ * findThaloFences(source: string): Uint32Array
+ *
+ * Find the content of every ```thalo fence in a markdown source in one native pass, see
+ * thalo::find_fences. Returns flat [start, end) pairs of UTF-16 offsets.
+ */
+static Napi::Value FindThaloFences(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        throw Napi::TypeError::New(env, "findThaloFences expects a source string");
+    }
+
+    std::u16string source = info[0].As<Napi::String>().Utf16Value();
+    std::vector<uint32_t> fences;
+    thalo::find_fences(source.data(), source.size(), fences);
+    return ToTypedArray(env, fences);
+}
+
+/**
+ * hashRanges(source: string, ranges: Uint32Array): Uint32Array
+ *
+ * Hash each [start, end) range of UTF-16 code units in `ranges` (a flat list of pairs), see
+ * thalo::hash_utf16. Returns one (high, low) pair of 32-bit words per range; ranges are clamped
+ * to the source.
+ */
+static Napi::Value HashRanges(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsTypedArray() ||
+        info[1].As<Napi::TypedArray>().TypedArrayType() != napi_uint32_array) {
+        throw Napi::TypeError::New(env, "hashRanges expects a source string and a Uint32Array");
+    }
+
+    std::u16string source = info[0].As<Napi::String>().Utf16Value();
+    auto ranges = info[1].As<Napi::Uint32Array>();
+    size_t count = ranges.ElementLength() / 2;
+
+    std::vector<uint32_t> hashes(count * 2);
+    for (size_t i = 0; i < count; i++) {
+        size_t end = std::min<size_t>(ranges[2 * i + 1], source.size());
+        size_t start = std::min<size_t>(ranges[2 * i], end);
+        uint64_t hash = thalo::hash_utf16(source.data() + start, end - start);
+        hashes[2 * i] = static_cast<uint32_t>(hash >> 32);
+        hashes[2 * i + 1] = static_cast<uint32_t>(hash);
+    }
+    return ToTypedArray(env, hashes);
+}
+
+/**
+ * Reads and parses a batch of files off the JS thread, resolving a promise with the results.
+ */
+class LoadFilesWorker : public Napi::AsyncWorker {
+  public:
+    LoadFilesWorker(Napi::Env env, std::vector<thalo::LoadedFile> files, unsigned threads,
+                    bool arena)
+        : Napi::AsyncWorker(env), deferred_(Napi::Promise::Deferred::New(env)),
+          files_(std::move(files)), threads_(threads), arena_(arena) {}
+
+    Napi::Promise Promise() { return deferred_.Promise(); }
+
+  protected:
+    void Execute() override {
+        thalo::load_files(files_, threads_, arena_);
+        for (const auto &file : files_) {
+            if (!file.error.empty()) {
+                SetError(file.error);
+                return;
+            }
+        }
+    }
+
+    void OnOK() override {
+        Napi::Env env = Env();
+        Napi::Array results = Napi::Array::New(env, files_.size());
+
+        for (size_t i = 0; i < files_.size(); i++) {
+            thalo::LoadedFile &file = files_[i];
+            Napi::Object result = Napi::Object::New(env);
+
+            result["source"] = ToBuffer(env, std::move(file.bytes));
+            result["tree"] = file.parsed ? EncodedTreeToObject(env, file.tree) : env.Null();
+            if (file.stats.parses > 0) {
+                result["stats"] = StatsToObject(env, file.stats);
+            }
+            results[static_cast<uint32_t>(i)] = result;
+        }
+
+        deferred_.Resolve(results);
+    }
+
+    void OnError(const Napi::Error &error) override { deferred_.Reject(error.Value()); }
+
+  private:
+    Napi::Promise::Deferred deferred_;
+    std::vector<thalo::LoadedFile> files_;
+    unsigned threads_;
+    bool arena_;
+};
+
+/**
+ * loadFiles(files: { path: string, parse: boolean }[], threads?: number, arena?: boolean):
+ *     Promise<LoadedFile[]>
+ *
+ * Read every file, and parse those marked `parse` as whole thalo documents, on a pool of native
+ * threads with one TSParser each. Rejects with the first read error. With `arena`, parses of
+ * small files allocate from a per-thread arena (see thalo::Arena). While stats are enabled,
+ * each parsed file also carries its own `stats`.
+ */
+static Napi::Value LoadFiles(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        throw Napi::TypeError::New(env, "loadFiles expects an array of files");
+    }
+
+    Napi::Array requests = info[0].As<Napi::Array>();
+    std::vector<thalo::LoadedFile> files(requests.Length());
+    for (uint32_t i = 0; i < requests.Length(); i++) {
+        Napi::Value request = requests[i];
+        if (!request.IsObject() || !request.As<Napi::Object>().Get("path").IsString()) {
+            throw Napi::TypeError::New(env, "loadFiles expects { path, parse } objects");
+        }
+        Napi::Object object = request.As<Napi::Object>();
+        files[i].path = object.Get("path").As<Napi::String>().Utf8Value();
+        files[i].parse = object.Get("parse").ToBoolean().Value();
+    }
+
+    unsigned threads = std::thread::hardware_concurrency();
+    if (info.Length() > 1 && info[1].IsNumber()) {
+        threads = info[1].As<Napi::Number>().Uint32Value();
+    }
+
+    bool arena = info.Length() > 2 && info[2].ToBoolean().Value();
+    if (arena) {
+        // Only now, so parses that never use the arena keep the runtime's default allocator
+        thalo::install_arena_allocator();
+    }
+
+    auto *worker = new LoadFilesWorker(env, std::move(files), threads, arena);
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+/**
+ * new EntryStream(path: string, chunkSize?: number)
+ *
+ * Parses a file in chunks of whole entries, see thalo::EntryStream. Each call to next() reads
+ * and parses roughly `chunkSize` more bytes, so memory stays bounded for arbitrarily large files.
+ */
+class EntryStreamWrap : public Napi::ObjectWrap<EntryStreamWrap> {
+  public:
+    static Napi::Function Define(Napi::Env env) {
+        return DefineClass(env, "EntryStream",
+                           {
+                               InstanceMethod("next", &EntryStreamWrap::Next),
+                               InstanceMethod("close", &EntryStreamWrap::Close),
+                           });
+    }
+
+    explicit EntryStreamWrap(const Napi::CallbackInfo &info)
+        : Napi::ObjectWrap<EntryStreamWrap>(info) {
+        Napi::Env env = info.Env();
+        if (info.Length() < 1 || !info[0].IsString()) {
+            throw Napi::TypeError::New(env, "EntryStream expects a file path");
+        }
+
+        size_t chunk_size = DEFAULT_CHUNK_SIZE;
+        if (info.Length() > 1 && info[1].IsNumber()) {
+            chunk_size = info[1].As<Napi::Number>().Uint32Value();
+        }
+
+        std::string path = info[0].As<Napi::String>().Utf8Value();
+        stream_ = std::make_unique<thalo::EntryStream>(path, chunk_size);
+        if (!stream_->is_open()) {
+            throw Napi::Error::New(env, "Failed to open " + path);
+        }
+    }
+
+  private:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 1 << 20;
+
+    /**
+     * next(): { source: Buffer, tree: EncodedSyntaxTree | null, startRow: number } | null
+     */
+    Napi::Value Next(const Napi::CallbackInfo &info) {
+        Napi::Env env = info.Env();
+        TSParser *parser = env.GetInstanceData<AddonData>()->parser;
+
+        thalo::StreamChunk chunk;
+        if (!stream_->next(parser, chunk)) {
+            if (stream_->failed()) {
+                throw Napi::Error::New(env, "Failed to read file");
+            }
+            return env.Null();
+        }
+
+        Napi::Object result = Napi::Object::New(env);
+        result["source"] = ToBuffer(env, std::move(chunk.bytes));
+        result["tree"] = chunk.parsed ? EncodedTreeToObject(env, chunk.tree) : env.Null();
+        result["startRow"] = Napi::Number::New(env, chunk.start_row);
+        if (chunk.stats.parses > 0) {
+            result["stats"] = StatsToObject(env, chunk.stats);
+        }
+        return result;
+    }
+
+    Napi::Value Close(const Napi::CallbackInfo &info) {
+        stream_->close();
+        return info.Env().Undefined();
+    }
+
+    std::unique_ptr<thalo::EntryStream> stream_;
+};
+
+/**
+ * setStatsEnabled(enabled: boolean): void
+ *
+ * Turn parse and scanner counters on or off for the process, see thalo::set_stats_enabled.
+ */
+static Napi::Value SetStatsEnabled(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsBoolean()) {
+        throw Napi::TypeError::New(env, "setStatsEnabled expects a boolean");
+    }
+    thalo::set_stats_enabled(info[0].As<Napi::Boolean>().Value());
+    return env.Undefined();
+}
+
+/**
+ * getStats(): ParseStats
+ *
+ * The counters collected since the last resetStats(), including scanner work on the JS thread
+ * from parsers other than the binding's own (e.g. node-tree-sitter).
+ */
+static Napi::Value GetStats(const Napi::CallbackInfo &info) {
+    return StatsToObject(info.Env(), thalo::read_stats());
+}
+
+/**
+ * resetStats(): void
+ */
+static Napi::Value ResetStats(const Napi::CallbackInfo &info) {
+    thalo::reset_stats();
+    return info.Env().Undefined();
+}
+
+/**
+ * Names of every public symbol, indexed by the ids stored in EncodedSyntaxTree.types.
+ */
+static Napi::Array SymbolNames(Napi::Env env) {
+    const TSLanguage *language = tree_sitter_thalo();
+    uint32_t count = ts_language_symbol_count(language);
+    Napi::Array names = Napi::Array::New(env, count);
+    for (uint32_t i = 0; i < count; i++) {
+        names[i] = Napi::String::New(env, ts_language_symbol_name(language, static_cast<TSSymbol>(i)));
+    }
+    return names;
+}
+
+/**
+ * Names of every field, indexed by the ids stored in EncodedSyntaxTree.fields (0 = no field).
+ */
+static Napi::Array FieldNames(Napi::Env env) {
+    const TSLanguage *language = tree_sitter_thalo();
+    uint32_t count = ts_language_field_count(language);
+    Napi::Array names = Napi::Array::New(env, count + 1);
+    names[0u] = Napi::String::New(env, "");
+    for (uint32_t i = 1; i <= count; i++) {
+        const char *name = ts_language_field_name_for_id(language, static_cast<TSFieldId>(i));
+        names[i] = Napi::String::New(env, name != nullptr ? name : "");
+    }
+    return names;
+}
+
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
+    env.SetInstanceData(new AddonData());
+
     auto language = Napi::External<TSLanguage>::New(env, tree_sitter_thalo());
     language.TypeTag(&LANGUAGE_TYPE_TAG);
     exports["language"] = language;
+    exports["abiVersion"] = Napi::Number::New(env, ts_language_abi_version(tree_sitter_thalo()));
+    exports["buildId"] = Napi::String::New(env, THALO_BUILD_ID);
+    exports["symbolNames"] = SymbolNames(env);
+    exports["fieldNames"] = FieldNames(env);
+    exports["extractEntries"] = Napi::Function::New(env, ExtractEntries, "extractEntries");
+    exports["extractEntriesFromBuffer"] =
+        Napi::Function::New(env, ExtractEntriesFromBuffer, "extractEntriesFromBuffer");
+    exports["findThaloFences"] = Napi::Function::New(env, FindThaloFences, "findThaloFences");
+    exports["hashRanges"] = Napi::Function::New(env, HashRanges, "hashRanges");
+    exports["loadFiles"] = Napi::Function::New(env, LoadFiles, "loadFiles");
+    exports["EntryStream"] = EntryStreamWrap::Define(env);
+    exports["setStatsEnabled"] = Napi::Function::New(env, SetStatsEnabled, "setStatsEnabled");
+    exports["getStats"] = Napi::Function::New(env, GetStats, "getStats");
+    exports["resetStats"] = Napi::Function::New(env, ResetStats, "resetStats");
     return exports;
 }
 
@@ -1,4 +1,7 @@
 import assert from "node:assert";
+import { mkdtempSync, writeFileSync } from "node:fs";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
 import { test } from "node:test";
 import Parser from "tree-sitter";
 
@@ -9,3 +12,291 @@ test("can load grammar", () => {
     parser.setLanguage(language);
   });
 });
+
+test("extractEntries flattens the tree in pre-order", async () => {
+  const { default: binding } = await import("./index.js");
+  const source = '2026-01-01T00:00Z create lore "Title" #tag\n  key: "value"\n';
+
+  const encoded = binding.extractEntries(source);
+  const parser = new Parser();
+  parser.setLanguage(binding);
+  const tree = parser.parse(source);
+
+  const expected = [];
+  const visit = (node) => {
+    expected.push(node);
+    for (const child of node.children) {
+      visit(child);
+    }
+  };
+  visit(tree.rootNode);
+
+  assert.strictEqual(encoded.nodeCount, expected.length);
+  assert.strictEqual(encoded.parents[0], -1);
+  assert.strictEqual(encoded.subtreeEnds[0], expected.length);
+  expected.forEach((node, i) => {
+    assert.strictEqual(binding.symbolNames[encoded.types[i]], node.type);
+    assert.strictEqual(encoded.ranges[i * 6], node.startIndex);
+    assert.strictEqual(encoded.ranges[i * 6 + 1], node.endIndex);
+  });
+});
+
+test("extractEntriesFromBuffer matches extractEntries on non-ASCII input", async () => {
+  const { default: binding } = await import("./index.js");
+  const source = '2026-01-01T00:00Z create lore "Café 🚀" #tag\n  key: "naïve ✓"\n';
+
+  const fromString = binding.extractEntries(source);
+  const fromBuffer = binding.extractEntriesFromBuffer(Buffer.from(source, "utf-8"));
+
+  assert.strictEqual(fromBuffer.nodeCount, fromString.nodeCount);
+  assert.deepStrictEqual(fromBuffer.types, fromString.types);
+  assert.deepStrictEqual(fromBuffer.ranges, fromString.ranges);
+  assert.deepStrictEqual(fromBuffer.subtreeEnds, fromString.subtreeEnds);
+});
+
+test("extractEntries decodes timestamps and dates into epoch minutes", async () => {
+  const { default: binding } = await import("./index.js");
+  const source =
+    '2026-01-05T10:00+01:00 create lore "Title"\n  when: 2026-01-05\n  period: 2026 Q1\n' +
+    "  since: 2025 ~\n";
+
+  for (const encoded of [
+    binding.extractEntries(source),
+    binding.extractEntriesFromBuffer(Buffer.from(source, "utf-8")),
+  ]) {
+    const spans = {};
+    encoded.timeNodes.forEach((node, i) => {
+      spans[binding.symbolNames[encoded.types[node]]] ??= [];
+      spans[binding.symbolNames[encoded.types[node]]].push([
+        encoded.times[i * 2],
+        encoded.times[i * 2 + 1],
+      ]);
+    });
+
+    const minutes = (iso) => Date.parse(iso) / 60_000;
+    assert.deepStrictEqual(spans.timestamp, [
+      [minutes("2026-01-05T09:00Z"), minutes("2026-01-05T09:01Z")],
+    ]);
+    assert.deepStrictEqual(spans.datetime_value, [
+      [minutes("2026-01-05T00:00Z"), minutes("2026-01-06T00:00Z")],
+    ]);
+    assert.deepStrictEqual(spans.daterange, [
+      [minutes("2026-01-01T00:00Z"), minutes("2026-04-01T00:00Z")],
+      [minutes("2025-01-01T00:00Z"), Infinity],
+    ]);
+  }
+});
+
+test("findThaloFences finds the content of each thalo fence", async () => {
+  const { default: binding } = await import("./index.js");
+  const source =
+    "# Notes\n\n```thalo\nfirst\n```\n\n```js\nnot thalo\n```\n" +
+    "```thalo  \r\n\nsecond ✓\n```\n```thalo\nunclosed\n";
+
+  const fences = binding.findThaloFences(source);
+  const contents = [];
+  for (let i = 0; i < fences.length; i += 2) {
+    contents.push(source.slice(fences[i], fences[i + 1]));
+  }
+
+  assert.deepStrictEqual(contents, ["first\n", "second ✓\n"]);
+});
+
+test("hashRanges computes 64-bit FNV-1a over UTF-16 code units", async () => {
+  const { default: binding } = await import("./index.js");
+  const source = 'a key: "✓" 😀';
+
+  // [start, end) pairs: empty, "a", 'key: "✓"', the surrogate pair, and one clamped to the end
+  const hashes = binding.hashRanges(source, new Uint32Array([0, 0, 0, 1, 2, 10, 11, 13, 11, 99]));
+
+  assert.deepStrictEqual(
+    Array.from(hashes),
+    [
+      0xcbf29ce4, 0x84222325, 0xaf63dc4c, 0x8601ec8c, 0xf96d77a4, 0x9da119fd, 0xe5e45a0a,
+      0x241b88d8, 0xe5e45a0a, 0x241b88d8,
+    ],
+  );
+});
+
+test("loadFiles reads and parses files across threads in order", async () => {
+  const { default: binding } = await import("./index.js");
+  const dir = mkdtempSync(join(tmpdir(), "thalo-load-"));
+  const files = [];
+  for (let i = 0; i < 8; i++) {
+    const path = join(dir, `entry-${i}.thalo`);
+    writeFileSync(path, `2026-01-0${i + 1}T00:00Z create lore "Entry ${i}"\n`);
+    files.push({ path, parse: i !== 3 });
+  }
+
+  const loaded = await binding.loadFiles(files, 4);
+
+  assert.strictEqual(loaded.length, files.length);
+  loaded.forEach((file, i) => {
+    const source = file.source.toString("utf-8");
+    assert.ok(source.includes(`"Entry ${i}"`));
+    if (i === 3) {
+      assert.strictEqual(file.tree, null);
+    } else {
+      assert.deepStrictEqual(file.tree, binding.extractEntries(source));
+    }
+  });
+
+  await assert.rejects(binding.loadFiles([{ path: join(dir, "missing.thalo"), parse: true }]));
+});
+
+test("loadFiles returns empty files as empty Buffers", async () => {
+  const { default: binding } = await import("./index.js");
+  const dir = mkdtempSync(join(tmpdir(), "thalo-empty-"));
+  const path = join(dir, "empty.thalo");
+  writeFileSync(path, "");
+
+  const [file] = await binding.loadFiles([{ path, parse: true }]);
+
+  assert.strictEqual(file.source.length, 0);
+  assert.deepStrictEqual(file.tree, binding.extractEntries(""));
+});
+
+test("loadFiles parses the same trees with the arena and the system allocator", async () => {
+  const { default: binding } = await import("./index.js");
+  const dir = mkdtempSync(join(tmpdir(), "thalo-arena-"));
+  const files = [];
+  for (let i = 0; i < 64; i++) {
+    const path = join(dir, `entry-${i}.thalo`);
+    const entries = Array.from(
+      { length: (i % 7) + 1 },
+      (_, j) =>
+        `2026-01-0${(j % 9) + 1}T00:00Z create lore "Entry ${i}.${j}" ^e${i}-${j}\n` +
+        `  type: "fact"\n  subject: ^self\n\n  # Summary\n  ${"text ".repeat(i)}\n\n`,
+    );
+    writeFileSync(path, entries.join(""));
+    files.push({ path, parse: true });
+  }
+
+  const [arena, system] = await Promise.all([
+    binding.loadFiles(files, 4, true),
+    binding.loadFiles(files, 4, false),
+  ]);
+
+  assert.strictEqual(arena.length, files.length);
+  arena.forEach((file, i) => {
+    assert.deepStrictEqual(file.tree, system[i].tree);
+    assert.deepStrictEqual(file.tree, binding.extractEntries(file.source.toString("utf-8")));
+  });
+});
+
+test("EntryStream splits a file into chunks of whole entries", async () => {
+  const { default: binding } = await import("./index.js");
+  const dir = mkdtempSync(join(tmpdir(), "thalo-stream-"));
+  const path = join(dir, "large.thalo");
+  let source = "";
+  for (let i = 0; i < 200; i++) {
+    source += `2026-01-01T00:00Z create lore "Entry ${i}" ^entry-${i}\n  key: "✓ ${i}"\n\n`;
+  }
+  writeFileSync(path, source);
+
+  const stream = new binding.EntryStream(path, 1024);
+  const chunks = [];
+  for (let chunk = stream.next(); chunk; chunk = stream.next()) {
+    chunks.push(chunk);
+  }
+  stream.close();
+
+  assert.ok(chunks.length > 1);
+  assert.strictEqual(chunks.map((chunk) => chunk.source.toString("utf-8")).join(""), source);
+
+  let row = 0;
+  for (const chunk of chunks) {
+    const text = chunk.source.toString("utf-8");
+    assert.ok(text.startsWith("2026-"));
+    assert.strictEqual(chunk.startRow, row);
+    assert.deepStrictEqual(chunk.tree, binding.extractEntries(text));
+    row += text.split("\n").length - 1;
+  }
+});
+
+test("EntryStream does not cut inside a multi-line quoted value", async () => {
+  const { default: binding } = await import("./index.js");
+  const dir = mkdtempSync(join(tmpdir(), "thalo-stream-"));
+  const path = join(dir, "quoted.thalo");
+  const continuation = "2026-01-02T00:00Z is not an entry";
+  let source = "";
+  for (let i = 0; i < 20; i++) {
+    source += `2026-01-01T00:00Z create lore "Entry ${i}" ^entry-${i}\n`;
+    source += `  note: "spans lines\n${continuation}"\n\n`;
+  }
+  writeFileSync(path, source);
+
+  const stream = new binding.EntryStream(path, 16);
+  const chunks = [];
+  for (let chunk = stream.next(); chunk; chunk = stream.next()) {
+    chunks.push(chunk.source.toString("utf-8"));
+  }
+  stream.close();
+
+  assert.strictEqual(chunks.length, 20);
+  assert.strictEqual(chunks.join(""), source);
+  for (const text of chunks) {
+    assert.ok(!text.startsWith(continuation));
+  }
+});
+
+test("EntryStream resumes cutting after an unclosed quote", async () => {
+  const { default: binding } = await import("./index.js");
+  const dir = mkdtempSync(join(tmpdir(), "thalo-stream-"));
+  const path = join(dir, "unclosed.thalo");
+  let source = `2026-01-01T00:00Z create lore "Entry 0" ^entry-0\n  note: "unclosed\n\n`;
+  for (let i = 1; i < 20; i++) {
+    source += `2026-01-01T00:00Z create lore "Entry ${i}" ^entry-${i}\n  key: "value"\n\n`;
+  }
+  writeFileSync(path, source);
+
+  const stream = new binding.EntryStream(path, 16);
+  const chunks = [];
+  for (let chunk = stream.next(); chunk; chunk = stream.next()) {
+    chunks.push(chunk.source.toString("utf-8"));
+  }
+  stream.close();
+
+  // The header after the stray quote ends it, so only the first two entries share a chunk
+  assert.strictEqual(chunks.length, 19);
+  assert.strictEqual(chunks.join(""), source);
+  for (const text of chunks) {
+    assert.ok(text.startsWith("2026-"));
+  }
+});
+
+test("getStats counts parses and scanner tokens only while enabled", async () => {
+  const { default: binding } = await import("./index.js");
+  const source =
+    `2026-01-01T00:00Z create lore "Entry" ^entry\n  type: "fact"\n\n` + `  # Summary\n  Text\n`;
+
+  binding.resetStats();
+  binding.extractEntries(source);
+  assert.strictEqual(binding.getStats().parses, 0);
+  assert.strictEqual(binding.getStats().scanner.scans, 0);
+
+  binding.setStatsEnabled(true);
+  try {
+    binding.extractEntries(source);
+    binding.extractEntries(source);
+    const stats = binding.getStats();
+    assert.strictEqual(stats.parses, 2);
+    assert.strictEqual(stats.bytes, 4 * source.length);
+    assert.ok(stats.parseNs >= stats.maxParseNs && stats.maxParseNs > 0);
+    assert.ok(stats.scanner.scans > 0);
+    assert.ok(stats.scanner.tokens.indent > 0);
+
+    binding.resetStats();
+    assert.strictEqual(binding.getStats().scanner.scans, 0);
+  } finally {
+    binding.setStatsEnabled(false);
+  }
+});
+
+test("buildId hashes the sources that shape encoded trees", async () => {
+  const { default: binding } = await import("./index.js");
+  const { computeBuildId } = await import("../../scripts/build-id.mjs");
+
+  assert.match(binding.buildId, /^[0-9a-f]{16}$/);
+  assert.strictEqual(binding.buildId, computeBuildId());
+});
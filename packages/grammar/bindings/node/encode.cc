@@ -0,0 +1,191 @@
+#include "encode.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "times.h"
+
+namespace thalo {
+
+namespace {
+
+uint8_t node_flags(TSNode node) {
+    uint8_t flags = 0;
+    if (ts_node_is_named(node)) {
+        flags |= NODE_NAMED;
+    }
+    if (ts_node_has_error(node)) {
+        flags |= NODE_HAS_ERROR;
+    }
+    if (ts_node_is_missing(node)) {
+        flags |= NODE_MISSING;
+    }
+    if (ts_node_is_extra(node)) {
+        flags |= NODE_EXTRA;
+    }
+    return flags;
+}
+
+/** Longest node text decoded as a time; daterange tokens are the longest, at 23 characters. */
+constexpr size_t MAX_TIME_TEXT = 32;
+
+/**
+ * Symbol ids of the time-valued node types, looked up once per encoded tree.
+ */
+struct TimeSymbols {
+    TSSymbol timestamp;
+    TSSymbol datetime;
+    TSSymbol daterange;
+
+    explicit TimeSymbols(const TSLanguage *language)
+        : timestamp(lookup(language, "timestamp")), datetime(lookup(language, "datetime_value")),
+          daterange(lookup(language, "daterange")) {}
+
+    bool kind_of(TSSymbol symbol, TimeKind &kind) const {
+        if (symbol == timestamp) {
+            kind = TimeKind::Timestamp;
+        } else if (symbol == datetime) {
+            kind = TimeKind::Datetime;
+        } else if (symbol == daterange) {
+            kind = TimeKind::Daterange;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+  private:
+    static TSSymbol lookup(const TSLanguage *language, const char *name) {
+        return ts_language_symbol_for_name(language, name, static_cast<uint32_t>(std::strlen(name)),
+                                           true);
+    }
+};
+
+/**
+ * Copy a node's text into `out` as ASCII, which is all a time-valued node may contain.
+ *
+ * @return The text length, or 0 if the text is too long or not ASCII
+ */
+size_t ascii_text(const SourceView &source, uint32_t start_byte, uint32_t end_byte,
+                  char (&out)[MAX_TIME_TEXT]) {
+    if (end_byte > source.length || end_byte <= start_byte) {
+        return 0;
+    }
+    const auto *bytes = reinterpret_cast<const uint8_t *>(source.data);
+    size_t length = 0;
+
+    if (source.encoding == TSInputEncodingUTF16LE) {
+        for (uint32_t i = start_byte; i + 1 < end_byte; i += 2) {
+            if (length == MAX_TIME_TEXT || bytes[i] >= 0x80 || bytes[i + 1] != 0) {
+                return 0;
+            }
+            out[length++] = static_cast<char>(bytes[i]);
+        }
+        return length;
+    }
+
+    for (uint32_t i = start_byte; i < end_byte; i++) {
+        if (length == MAX_TIME_TEXT || bytes[i] >= 0x80) {
+            return 0;
+        }
+        out[length++] = static_cast<char>(bytes[i]);
+    }
+    return length;
+}
+
+} // namespace
+
+OffsetMap OffsetMap::utf16() {
+    return OffsetMap(1);
+}
+
+OffsetMap OffsetMap::utf8(const char *data, size_t length) {
+    OffsetMap map(0);
+    const auto *bytes = reinterpret_cast<const uint8_t *>(data);
+    uint32_t savings = 0;
+
+    for (size_t i = 0; i < length;) {
+        uint8_t lead = bytes[i];
+        if (lead < 0x80) {
+            i++;
+            continue;
+        }
+        // 2- and 3-byte sequences become one UTF-16 unit, 4-byte sequences a surrogate pair
+        size_t width = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : 2;
+        savings += width == 4 ? 2 : static_cast<uint32_t>(width - 1);
+        i += width;
+        map.char_ends_.push_back(static_cast<uint32_t>(std::min(i, length)));
+        map.savings_.push_back(savings);
+    }
+
+    return map;
+}
+
+uint32_t OffsetMap::index(uint32_t byte) const {
+    if (char_ends_.empty()) {
+        return byte >> shift_;
+    }
+    auto it = std::upper_bound(char_ends_.begin(), char_ends_.end(), byte);
+    if (it == char_ends_.begin()) {
+        return byte;
+    }
+    return byte - savings_[static_cast<size_t>(it - char_ends_.begin()) - 1];
+}
+
+void encode_tree(const TSTree *tree, const SourceView &source, const OffsetMap &offsets,
+                 EncodedTree &out) {
+    const TimeSymbols time_symbols(ts_tree_language(tree));
+    char text[MAX_TIME_TEXT];
+    TSTreeCursor cursor = ts_tree_cursor_new(ts_tree_root_node(tree));
+    // Indices of the nodes on the path from the root to the cursor
+    std::vector<uint32_t> ancestors;
+
+    for (;;) {
+        TSNode node = ts_tree_cursor_current_node(&cursor);
+        TSPoint start = ts_node_start_point(node);
+        TSPoint end = ts_node_end_point(node);
+        uint32_t start_byte = ts_node_start_byte(node);
+        uint32_t end_byte = ts_node_end_byte(node);
+        auto index = static_cast<uint32_t>(out.types.size());
+
+        out.types.push_back(ts_node_symbol(node));
+        out.flags.push_back(node_flags(node));
+        out.ranges.push_back(offsets.index(start_byte));
+        out.ranges.push_back(offsets.index(end_byte));
+        out.ranges.push_back(start.row);
+        out.ranges.push_back(offsets.column(start_byte, start.column));
+        out.ranges.push_back(end.row);
+        out.ranges.push_back(offsets.column(end_byte, end.column));
+        out.fields.push_back(ts_tree_cursor_current_field_id(&cursor));
+        out.parents.push_back(ancestors.empty() ? -1 : static_cast<int32_t>(ancestors.back()));
+        out.subtree_ends.push_back(index + 1);
+
+        TimeKind kind;
+        TimeSpan span;
+        if (time_symbols.kind_of(ts_node_symbol(node), kind) && !ts_node_has_error(node)) {
+            size_t length = ascii_text(source, start_byte, end_byte, text);
+            if (length > 0 && decode_time(kind, text, length, span)) {
+                out.time_nodes.push_back(index);
+                out.times.push_back(span.start);
+                out.times.push_back(span.end);
+            }
+        }
+
+        if (ts_tree_cursor_goto_first_child(&cursor)) {
+            ancestors.push_back(index);
+            continue;
+        }
+
+        // Leaf: climb until a sibling is found, closing each finished subtree on the way up
+        while (!ts_tree_cursor_goto_next_sibling(&cursor)) {
+            if (ancestors.empty() || !ts_tree_cursor_goto_parent(&cursor)) {
+                ts_tree_cursor_delete(&cursor);
+                return;
+            }
+            out.subtree_ends[ancestors.back()] = static_cast<uint32_t>(out.types.size());
+            ancestors.pop_back();
+        }
+    }
+}
+
+} // namespace thalo
@@ -0,0 +1,105 @@
+#ifndef TREE_SITTER_THALO_ENCODE_H_
+#define TREE_SITTER_THALO_ENCODE_H_
+
+#include <tree_sitter/api.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace thalo {
+
+/**
+ * Per-node flag bits stored in EncodedTree::flags.
+ *
+ * These must match the NODE_* constants in packages/thalo/src/ast/encoded-tree.ts.
+ */
+enum NodeFlag : uint8_t {
+    NODE_NAMED = 1 << 0,
+    NODE_HAS_ERROR = 1 << 1,
+    NODE_MISSING = 1 << 2,
+    NODE_EXTRA = 1 << 3,
+};
+
+/** Number of uint32 values stored per node in EncodedTree::ranges. */
+constexpr size_t RANGE_STRIDE = 6;
+
+/**
+ * A syntax tree flattened into parallel arrays, one slot per visible node in pre-order.
+ *
+ * - types: public symbol id (alias-resolved, ts_builtin_sym_error for ERROR nodes)
+ * - flags: NodeFlag bits
+ * - ranges: startIndex, endIndex, startRow, startColumn, endRow, endColumn
+ * - fields: field id of the node within its parent (0 = none)
+ * - parents: index of the parent node (-1 for the root)
+ * - subtree_ends: index one past the node's last descendant
+ *
+ * Indices and columns are expressed in UTF-16 code units, matching `SyntaxNode.startIndex`,
+ * whatever the encoding of the parsed input (see OffsetMap).
+ *
+ * Time-valued nodes (timestamp, datetime_value, daterange) are decoded as well, into a sparse
+ * side table:
+ * - time_nodes: indices of the decoded nodes, ascending
+ * - times: start and end of each decoded node's TimeSpan (see times.h), two values per node
+ */
+struct EncodedTree {
+    std::vector<uint16_t> types;
+    std::vector<uint8_t> flags;
+    std::vector<uint32_t> ranges;
+    std::vector<uint16_t> fields;
+    std::vector<int32_t> parents;
+    std::vector<uint32_t> subtree_ends;
+    std::vector<uint32_t> time_nodes;
+    std::vector<double> times;
+};
+
+/**
+ * The input a tree was parsed from, so node text can be read while encoding.
+ */
+struct SourceView {
+    const char *data;
+    size_t length;
+    TSInputEncoding encoding;
+};
+
+/**
+ * Converts tree-sitter byte offsets into UTF-16 code unit offsets.
+ *
+ * For UTF-16 input this is a shift. For UTF-8 input it keeps a sparse table with one entry per
+ * multi-byte character, so ASCII-only sources (the common case) convert without any lookup.
+ */
+class OffsetMap {
+  public:
+    /** Offsets into UTF-16LE input. */
+    static OffsetMap utf16();
+
+    /** Offsets into the given UTF-8 input, which must be valid UTF-8. */
+    static OffsetMap utf8(const char *data, size_t length);
+
+    /** UTF-16 offset of the character starting at `byte`. */
+    uint32_t index(uint32_t byte) const;
+
+    /** UTF-16 column of `byte`, given its tree-sitter (byte) column. */
+    uint32_t column(uint32_t byte, uint32_t byte_column) const {
+        return index(byte) - index(byte - byte_column);
+    }
+
+  private:
+    explicit OffsetMap(unsigned shift) : shift_(shift) {}
+
+    unsigned shift_;
+    // Byte offset just past each multi-byte character, ascending
+    std::vector<uint32_t> char_ends_;
+    // Bytes saved by UTF-16 up to and including the matching character in char_ends_
+    std::vector<uint32_t> savings_;
+};
+
+/**
+ * Walk `tree` once with a TSTreeCursor and append every visible node to `out`.
+ */
+void encode_tree(const TSTree *tree, const SourceView &source, const OffsetMap &offsets,
+                 EncodedTree &out);
+
+} // namespace thalo
+
+#endif // TREE_SITTER_THALO_ENCODE_H_
@@ -0,0 +1,103 @@
+#include "fences.h"
+
+namespace thalo {
+
+namespace {
+
+bool is_line_terminator(char16_t c) {
+    return c == u'\n' || c == u'\r' || c == 0x2028 || c == 0x2029;
+}
+
+/** The characters matched by `\s` in JS regular expressions. */
+bool is_space(char16_t c) {
+    return (c >= 0x09 && c <= 0x0d) || c == 0x20 || c == 0xa0 || c == 0x1680 ||
+           (c >= 0x2000 && c <= 0x200a) || c == 0x2028 || c == 0x2029 || c == 0x202f ||
+           c == 0x205f || c == 0x3000 || c == 0xfeff;
+}
+
+/**
+ * A cursor over the line starts of a UTF-16 source.
+ */
+struct Lines {
+    const char16_t *source;
+    size_t length;
+
+    bool starts_with(size_t at, const char16_t *prefix, size_t prefix_length) const {
+        if (length - at < prefix_length) {
+            return false;
+        }
+        for (size_t i = 0; i < prefix_length; i++) {
+            if (source[at + i] != prefix[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** The first line start at or after `at`, or `length + 1` if there is none. */
+    size_t line_start(size_t at) const {
+        if (at == 0 || (at <= length && is_line_terminator(source[at - 1]))) {
+            return at;
+        }
+        while (at < length && !is_line_terminator(source[at])) {
+            at++;
+        }
+        return at + 1;
+    }
+};
+
+constexpr char16_t OPEN[] = u"```thalo";
+constexpr size_t OPEN_LENGTH = 8;
+constexpr char16_t CLOSE[] = u"```";
+constexpr size_t CLOSE_LENGTH = 3;
+
+} // namespace
+
+void find_fences(const char16_t *source, size_t length, std::vector<uint32_t> &out) {
+    Lines lines{source, length};
+    size_t at = 0;
+
+    while (true) {
+        // The next line opening a fence: ```thalo, then whitespace containing a newline. The
+        // content starts after the last newline of that whitespace, as `\s*\n` backtracks.
+        size_t content_start = 0;
+        bool opened = false;
+        size_t line = lines.line_start(at);
+        for (; line <= length; line = lines.line_start(line + 1)) {
+            if (!lines.starts_with(line, OPEN, OPEN_LENGTH)) {
+                continue;
+            }
+            for (size_t i = line + OPEN_LENGTH; i < length && is_space(source[i]); i++) {
+                if (source[i] == u'\n') {
+                    content_start = i + 1;
+                    opened = true;
+                }
+            }
+            if (opened) {
+                break;
+            }
+        }
+        if (!opened) {
+            return;
+        }
+
+        // The content runs lazily to the next line starting with ```. An unclosed fence ends the
+        // search: any later opening line would itself have closed it.
+        size_t close = length + 1;
+        for (size_t line = content_start; line <= length; line = lines.line_start(line + 1)) {
+            if (lines.starts_with(line, CLOSE, CLOSE_LENGTH)) {
+                close = line;
+                break;
+            }
+        }
+        if (close > length) {
+            return;
+        }
+
+        out.push_back(static_cast<uint32_t>(content_start));
+        out.push_back(static_cast<uint32_t>(close));
+        at = close + CLOSE_LENGTH;
+    }
+}
+
+} // namespace thalo
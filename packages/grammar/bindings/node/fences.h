@@ -0,0 +1,24 @@
+#ifndef TREE_SITTER_THALO_FENCES_H_
+#define TREE_SITTER_THALO_FENCES_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace thalo {
+
+/**
+ * Find the content of every ```thalo fence in a markdown source, in one pass.
+ *
+ * Matches exactly what `/^```thalo\s*\n([\s\S]*?)^```/gm` matches in JS: an opening line
+ * starting with ```thalo followed only by whitespace, then everything up to the next line that
+ * starts with ```. `^` follows any JS line terminator and `\s` is the JS whitespace set.
+ *
+ * Appends one [start, end) pair of UTF-16 offsets per fence to `out`. Must match
+ * `findThaloFences` in packages/thalo/src/parser.shared.ts.
+ */
+void find_fences(const char16_t *source, size_t length, std::vector<uint32_t> &out);
+
+} // namespace thalo
+
+#endif // TREE_SITTER_THALO_FENCES_H_
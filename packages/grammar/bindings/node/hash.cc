@@ -0,0 +1,21 @@
+#include "hash.h"
+
+namespace thalo {
+
+namespace {
+
+constexpr uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ull;
+constexpr uint64_t FNV_PRIME = 0x100000001b3ull;
+
+} // namespace
+
+uint64_t hash_utf16(const char16_t *text, size_t length) {
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= static_cast<uint64_t>(text[i]);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+} // namespace thalo
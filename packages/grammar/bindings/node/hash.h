@@ -0,0 +1,20 @@
+#ifndef TREE_SITTER_THALO_HASH_H_
+#define TREE_SITTER_THALO_HASH_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace thalo {
+
+/**
+ * 64-bit FNV-1a over UTF-16 code units: each unit is XORed in whole, then multiplied by the
+ * FNV prime.
+ *
+ * Hashing code units rather than UTF-8 bytes lets ranges be JS string offsets. Must match
+ * `hashRanges` in packages/thalo/src/range-hash.ts.
+ */
+uint64_t hash_utf16(const char16_t *text, size_t length);
+
+} // namespace thalo
+
+#endif // TREE_SITTER_THALO_HASH_H_
@@ -18,6 +18,106 @@ type NodeInfo =
       children: ChildNode[];
     });
 
+/**
+ * A syntax tree flattened by {@linkcode binding.extractEntries}.
+ *
+ * Every visible node occupies one slot in each array, in pre-order (the root is index 0).
+ * Indices and columns are in UTF-16 code units, like `SyntaxNode.startIndex`.
+ */
+type EncodedSyntaxTree = {
+  /** Number of nodes in the tree. */
+  nodeCount: number;
+  /** Symbol id per node, indexing {@linkcode binding.symbolNames} (`0xffff` for ERROR). */
+  types: Uint16Array;
+  /** Bit set per node: 1 = named, 2 = has error, 4 = missing, 8 = extra. */
+  flags: Uint8Array;
+  /** Six values per node: startIndex, endIndex, startRow, startColumn, endRow, endColumn. */
+  ranges: Uint32Array;
+  /** Field id of each node within its parent, indexing {@linkcode binding.fieldNames} (0 = none). */
+  fields: Uint16Array;
+  /** Index of each node's parent (-1 for the root). */
+  parents: Int32Array;
+  /** Index one past each node's last descendant. */
+  subtreeEnds: Uint32Array;
+  /** Indices of the `timestamp`, `datetime_value` and `daterange` nodes that were decoded. */
+  timeNodes: Uint32Array;
+  /**
+   * Two values per decoded node: the start and end of its half-open span, in minutes since the
+   * Unix epoch (UTC). Open-ended dateranges end at `Infinity`.
+   */
+  times: Float64Array;
+};
+
+/**
+ * Counters collected while {@linkcode binding.setStatsEnabled} is on.
+ *
+ * `parses`, `bytes` and the times cover parses made by the binding itself; the scanner counters
+ * also include parses through other parsers on the JS thread, such as node-tree-sitter.
+ */
+type ParseStats = {
+  /** Number of parses. */
+  parses: number;
+  /** Bytes of source parsed (UTF-16 sources count two bytes per code unit). */
+  bytes: number;
+  /** Wall time spent parsing, summed over all parses, in nanoseconds. */
+  parseNs: number;
+  /** The longest single parse, in nanoseconds. */
+  maxParseNs: number;
+  scanner: {
+    /** Calls to the external scanner. */
+    scans: number;
+    /** Calls that bailed out because the parser was in error recovery. */
+    errorRecovery: number;
+    /** Tokens produced, per external token type. */
+    tokens: { indent: number; contentBlank: number; errorSentinel: number };
+    /** Tokens served from the scanner's look-ahead memo. */
+    memoHits: number;
+    /** Characters read past the end of each produced token, or read without producing one. */
+    lookaheadChars: number;
+  };
+};
+
+/** A file to read with {@linkcode binding.loadFiles}. */
+type LoadFileRequest = {
+  path: string;
+  /** Parse the whole file as a thalo document (leave false for markdown). */
+  parse: boolean;
+};
+
+/** A file read by {@linkcode binding.loadFiles}. */
+type LoadedFile = {
+  /** The raw file contents (a Node.js `Buffer`). */
+  source: Uint8Array;
+  /** The encoded tree, or `null` if parsing was not requested or the file is not valid UTF-8. */
+  tree: EncodedSyntaxTree | null;
+  /** Counters for this file's parse, if it was parsed while stats were enabled. */
+  stats?: ParseStats;
+};
+
+/** A run of whole entries returned by {@linkcode EntryStream.next}. */
+type StreamChunk = {
+  /** The raw bytes of the chunk (a Node.js `Buffer`). */
+  source: Uint8Array;
+  /** The chunk's encoded tree, or `null` if the chunk is not valid UTF-8. */
+  tree: EncodedSyntaxTree | null;
+  /** Row of the chunk's first line within the file. */
+  startRow: number;
+  /** Counters for this chunk's parse, which includes reading it, if stats were enabled. */
+  stats?: ParseStats;
+};
+
+/**
+ * Parses a `.thalo` file in chunks that each end on an entry boundary, so a file of any size
+ * can be processed without holding it in memory. Positions in each tree are relative to the
+ * start of its chunk.
+ */
+interface EntryStream {
+  /** Read and parse the next chunk, or return `null` at the end of the file. */
+  next(): StreamChunk | null;
+  /** Close the file; later calls to `next()` return `null`. */
+  close(): void;
+}
+
 /**
  * The tree-sitter language object for this grammar.
  *
@@ -44,6 +144,86 @@ declare const binding: {
    */
   nodeTypeInfo: NodeInfo[];
 
+  /** The tree-sitter ABI version the parser was generated for. */
+  abiVersion: number;
+
+  /**
+   * Hash of the parser, scanner and tree encoder sources the binding was built from. Unlike
+   * the grammar and ABI versions, it changes with every change to what the binding parses or
+   * encodes, so caches of encoded trees key on it.
+   */
+  buildId: string;
+
+  /** The grammar version from `tree-sitter.json`, if it could be read. */
+  grammarVersion?: string;
+
+  /** Names of the grammar's symbols, indexed by {@linkcode EncodedSyntaxTree.types}. */
+  symbolNames: string[];
+
+  /** Names of the grammar's fields, indexed by {@linkcode EncodedSyntaxTree.fields}. */
+  fieldNames: string[];
+
+  /**
+   * Parse `source` and flatten the resulting tree in a single native walk.
+   *
+   * Use this to build an AST without one N-API call per node.
+   */
+  extractEntries(source: string): EncodedSyntaxTree;
+
+  /**
+   * Like {@linkcode binding.extractEntries}, but parses UTF-8 bytes in place without decoding
+   * them to a string first. Indices in the result are still UTF-16 code units, so they match
+   * the decoded source. The bytes must be valid UTF-8.
+   */
+  extractEntriesFromBuffer(source: Uint8Array): EncodedSyntaxTree;
+
+  /**
+   * Find the content of every ```thalo fence in a markdown source, matching
+   * /^```thalo\s*\n([\s\S]*?)^```/gm.
+   *
+   * @returns Flat [start, end) pairs of UTF-16 offsets, one per fence
+   */
+  findThaloFences(source: string): Uint32Array;
+
+  /**
+   * Hash ranges of `source` with 64-bit FNV-1a over UTF-16 code units.
+   *
+   * @param ranges - Flat [start, end) pairs of UTF-16 offsets; ranges are clamped to the source
+   * @returns The high and low 32-bit words of each range's hash, in order
+   */
+  hashRanges(source: string, ranges: Uint32Array): Uint32Array;
+
+  /**
+   * Read, and optionally parse, a batch of files on a pool of native threads with one parser
+   * each. Results are in the same order as `files`. Rejects if any file cannot be read.
+   *
+   * @param threads - Maximum number of threads (defaults to the number of cores)
+   * @param arena - Serve the allocations of each parse of a small file from a per-thread arena
+   *   freed in one shot after the file, instead of the system allocator (default false). The
+   *   first call with `arena` switches the binding's tree-sitter runtime to the arena hooks for
+   *   the rest of the process; until then parses use the runtime's default allocator.
+   */
+  loadFiles(files: LoadFileRequest[], threads?: number, arena?: boolean): Promise<LoadedFile[]>;
+
+  /**
+   * Open a `.thalo` file for chunked parsing.
+   *
+   * @param chunkSize - Minimum bytes per chunk before it is cut at the next entry (default 1 MiB)
+   */
+  EntryStream: new (path: string, chunkSize?: number) => EntryStream;
+
+  /**
+   * Turn parse and scanner counters on or off for the whole process (off by default). While
+   * off, parsing only pays for a flag check per scanner call.
+   */
+  setStatsEnabled(enabled: boolean): void;
+
+  /** The counters collected since the last {@linkcode binding.resetStats}. */
+  getStats(): ParseStats;
+
+  /** Zero the counters. */
+  resetStats(): void;
+
   /** The syntax highlighting query for this grammar. */
   HIGHLIGHTS_QUERY?: string;
 
@@ -57,4 +237,13 @@ declare const binding: {
   TAGS_QUERY?: string;
 };
 
+export type {
+  EncodedSyntaxTree,
+  EntryStream,
+  LoadFileRequest,
+  LoadedFile,
+  ParseStats,
+  StreamChunk,
+};
+
 export default binding;
@@ -14,6 +14,11 @@ try {
   binding.nodeTypeInfo = nodeTypes.default;
 } catch {}
 
+try {
+  const config = JSON.parse(readFileSync(`${root}/tree-sitter.json`, "utf8"));
+  binding.grammarVersion = config.metadata.version;
+} catch {}
+
 const queries = [
   ["HIGHLIGHTS_QUERY", `${root}/queries/highlights.scm`],
   ["INJECTIONS_QUERY", `${root}/queries/injections.scm`],
@@ -0,0 +1,160 @@
+#include "loader.h"
+
+#include "arena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <thread>
+
+extern "C" TSLanguage *tree_sitter_thalo();
+
+namespace thalo {
+
+namespace {
+
+bool read_file(const std::string &path, std::vector<char> &out) {
+    std::ifstream stream(path, std::ios::binary | std::ios::ate);
+    if (!stream) {
+        return false;
+    }
+    std::streamoff size = stream.tellg();
+    if (size < 0) {
+        return false;
+    }
+    out.resize(static_cast<size_t>(size));
+    stream.seekg(0);
+    return size == 0 || static_cast<bool>(stream.read(out.data(), size));
+}
+
+/** Read `file`, and return whether it should then be parsed. */
+bool read_for_parse(LoadedFile &file) {
+    if (!read_file(file.path, file.bytes)) {
+        file.error = "Failed to read file: " + file.path;
+        return false;
+    }
+    return file.parse && file.bytes.size() <= UINT32_MAX &&
+           is_valid_utf8(file.bytes.data(), file.bytes.size());
+}
+
+void parse_file(TSParser *parser, LoadedFile &file) {
+    ParseProfile profile;
+    TSTree *tree = ts_parser_parse_string_encoding(
+        parser, nullptr, file.bytes.data(), static_cast<uint32_t>(file.bytes.size()),
+        TSInputEncodingUTF8);
+    file.stats = profile.finish(file.bytes.size());
+    if (tree == nullptr) {
+        return;
+    }
+    encode_tree(tree, {file.bytes.data(), file.bytes.size(), TSInputEncodingUTF8},
+                OffsetMap::utf8(file.bytes.data(), file.bytes.size()), file.tree);
+    ts_tree_delete(tree);
+    file.parsed = true;
+}
+
+} // namespace
+
+bool is_valid_utf8(const char *data, size_t length) {
+    const auto *bytes = reinterpret_cast<const uint8_t *>(data);
+    size_t i = 0;
+
+    while (i < length) {
+        uint8_t lead = bytes[i];
+        if (lead < 0x80) {
+            i++;
+            continue;
+        }
+
+        size_t width;
+        uint8_t min_second = 0x80;
+        uint8_t max_second = 0xBF;
+        if (lead >= 0xC2 && lead <= 0xDF) {
+            width = 2;
+        } else if (lead >= 0xE0 && lead <= 0xEF) {
+            width = 3;
+            // Reject overlong encodings and UTF-16 surrogates
+            if (lead == 0xE0) {
+                min_second = 0xA0;
+            } else if (lead == 0xED) {
+                max_second = 0x9F;
+            }
+        } else if (lead >= 0xF0 && lead <= 0xF4) {
+            width = 4;
+            // Reject overlong encodings and code points above U+10FFFF
+            if (lead == 0xF0) {
+                min_second = 0x90;
+            } else if (lead == 0xF4) {
+                max_second = 0x8F;
+            }
+        } else {
+            return false;
+        }
+
+        if (i + width > length || bytes[i + 1] < min_second || bytes[i + 1] > max_second) {
+            return false;
+        }
+        for (size_t k = 2; k < width; k++) {
+            if ((bytes[i + k] & 0xC0) != 0x80) {
+                return false;
+            }
+        }
+        i += width;
+    }
+
+    return true;
+}
+
+void load_files(std::vector<LoadedFile> &files, unsigned max_threads, bool use_arena) {
+    if (files.empty()) {
+        return;
+    }
+    size_t thread_count = std::min<size_t>(files.size(), std::max(1u, max_threads));
+    std::atomic<size_t> next{0};
+
+    auto work = [&files, &next, use_arena]() {
+        // Created on the first file that is not parsed in the arena
+        TSParser *parser = nullptr;
+        Arena arena;
+        for (size_t i = next++; i < files.size(); i = next++) {
+            LoadedFile &file = files[i];
+            if (!read_for_parse(file)) {
+                continue;
+            }
+            // Arena memory grows with every allocation a parse makes, freed or not, so only
+            // small files are worth it. Each is one arena job: the parser, tree and scanner live
+            // and die inside it.
+            if (use_arena && file.bytes.size() <= ARENA_MAX_FILE_SIZE) {
+                {
+                    ArenaScope scope(arena);
+                    TSParser *arena_parser = ts_parser_new();
+                    ts_parser_set_language(arena_parser, tree_sitter_thalo());
+                    parse_file(arena_parser, file);
+                    ts_parser_delete(arena_parser);
+                }
+                arena.reset();
+                continue;
+            }
+            if (parser == nullptr) {
+                parser = ts_parser_new();
+                ts_parser_set_language(parser, tree_sitter_thalo());
+            }
+            parse_file(parser, file);
+        }
+        if (parser != nullptr) {
+            ts_parser_delete(parser);
+        }
+    };
+
+    // The calling thread takes part in the work instead of idling in join()
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < thread_count; t++) {
+        pool.emplace_back(work);
+    }
+    work();
+    for (auto &thread : pool) {
+        thread.join();
+    }
+}
+
+} // namespace thalo
@@ -0,0 +1,55 @@
+#ifndef TREE_SITTER_THALO_LOADER_H_
+#define TREE_SITTER_THALO_LOADER_H_
+
+#include <string>
+#include <vector>
+
+#include "encode.h"
+#include "stats.h"
+
+namespace thalo {
+
+/**
+ * One file handled by load_files: the request (path, parse) and its result.
+ */
+struct LoadedFile {
+    std::string path;
+    /** Whether to parse the file as a whole thalo document (false for e.g. markdown) */
+    bool parse = false;
+
+    /** Raw file contents */
+    std::vector<char> bytes;
+    /** Whether `tree` holds a parse of `bytes` (false if not requested or not valid UTF-8) */
+    bool parsed = false;
+    EncodedTree tree;
+    /** Counters for the file's parse, if it was parsed with stats enabled (see stats.h) */
+    ParseStats stats;
+    /** Non-empty if the file could not be read */
+    std::string error;
+};
+
+/**
+ * Whether `data` is well-formed UTF-8, i.e. decodes without replacement characters.
+ */
+bool is_valid_utf8(const char *data, size_t length);
+
+/**
+ * Read and, where requested, parse every file on a pool of up to `max_threads` threads.
+ *
+ * Each thread owns its own TSParser and claims files from a shared counter, so a few large
+ * files don't leave the other threads idle. Results are written into `files` in place; the
+ * order of `files` is preserved.
+ *
+ * With `use_arena`, each file up to ARENA_MAX_FILE_SIZE is parsed by a fresh TSParser whose
+ * allocations, and the scanner's, come from a per-thread Arena that is reset after the file (see
+ * arena.h). Larger files use the system allocator, since the arena never reuses freed memory.
+ * This requires install_arena_allocator() to have been called first.
+ */
+void load_files(std::vector<LoadedFile> &files, unsigned max_threads, bool use_arena);
+
+/** Largest file, in bytes, that load_files() parses in an arena. */
+constexpr size_t ARENA_MAX_FILE_SIZE = 256 * 1024;
+
+} // namespace thalo
+
+#endif // TREE_SITTER_THALO_LOADER_H_
@@ -0,0 +1,111 @@
+#include "stats.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace thalo {
+
+namespace {
+
+std::atomic<bool> enabled{false};
+std::mutex totals_mutex;
+ParseStats totals;
+
+// The calling thread's scanner totals that have been added to `totals`
+thread_local TSThaloScannerStats accounted = {};
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+TSThaloScannerStats scanner_diff(const TSThaloScannerStats &end, const TSThaloScannerStats &start) {
+    TSThaloScannerStats diff;
+    diff.scans = end.scans - start.scans;
+    diff.error_recovery = end.error_recovery - start.error_recovery;
+    for (size_t i = 0; i < sizeof(diff.tokens) / sizeof(diff.tokens[0]); i++) {
+        diff.tokens[i] = end.tokens[i] - start.tokens[i];
+    }
+    diff.memo_hits = end.memo_hits - start.memo_hits;
+    diff.lookahead_chars = end.lookahead_chars - start.lookahead_chars;
+    return diff;
+}
+
+void scanner_add(TSThaloScannerStats &into, const TSThaloScannerStats &other) {
+    into.scans += other.scans;
+    into.error_recovery += other.error_recovery;
+    for (size_t i = 0; i < sizeof(into.tokens) / sizeof(into.tokens[0]); i++) {
+        into.tokens[i] += other.tokens[i];
+    }
+    into.memo_hits += other.memo_hits;
+    into.lookahead_chars += other.lookahead_chars;
+}
+
+/** Add the calling thread's unaccounted scanner work to the totals; needs totals_mutex. */
+TSThaloScannerStats flush_thread_scanner() {
+    TSThaloScannerStats current;
+    tree_sitter_thalo_scanner_stats_read(&current);
+    scanner_add(totals.scanner, scanner_diff(current, accounted));
+    accounted = current;
+    return current;
+}
+
+} // namespace
+
+void set_stats_enabled(bool value) {
+    enabled = value;
+    // Other threads pick the flag up at their next ParseProfile
+    tree_sitter_thalo_scanner_stats_enable(value);
+}
+
+bool stats_enabled() { return enabled; }
+
+ParseStats read_stats() {
+    std::lock_guard<std::mutex> lock(totals_mutex);
+    flush_thread_scanner();
+    return totals;
+}
+
+void reset_stats() {
+    std::lock_guard<std::mutex> lock(totals_mutex);
+    totals = ParseStats();
+    tree_sitter_thalo_scanner_stats_read(&accounted);
+}
+
+ParseProfile::ParseProfile() : enabled_(enabled) {
+    tree_sitter_thalo_scanner_stats_enable(enabled_);
+    if (!enabled_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(totals_mutex);
+        scanner_start_ = flush_thread_scanner();
+    }
+    start_ns_ = now_ns();
+}
+
+ParseStats ParseProfile::finish(size_t bytes) {
+    ParseStats stats;
+    if (!enabled_) {
+        return stats;
+    }
+    uint64_t elapsed = now_ns() - start_ns_;
+
+    stats.parses = 1;
+    stats.bytes = bytes;
+    stats.parse_ns = elapsed;
+    stats.max_parse_ns = elapsed;
+
+    std::lock_guard<std::mutex> lock(totals_mutex);
+    // Flushing adds the scanner's part to the totals
+    stats.scanner = scanner_diff(flush_thread_scanner(), scanner_start_);
+    totals.parses++;
+    totals.bytes += stats.bytes;
+    totals.parse_ns += elapsed;
+    totals.max_parse_ns = totals.max_parse_ns > elapsed ? totals.max_parse_ns : elapsed;
+    return stats;
+}
+
+} // namespace thalo
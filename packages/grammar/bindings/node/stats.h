@@ -0,0 +1,62 @@
+#ifndef TREE_SITTER_THALO_STATS_H_
+#define TREE_SITTER_THALO_STATS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "scanner_stats.h"
+
+namespace thalo {
+
+/**
+ * Counters for parses made by the binding, and the external scanner's counters for those
+ * parses (see scanner_stats.h).
+ */
+struct ParseStats {
+    uint64_t parses = 0;
+    uint64_t bytes = 0;
+    /** Wall time spent in ts_parser_parse, summed over parses and the longest single parse */
+    uint64_t parse_ns = 0;
+    uint64_t max_parse_ns = 0;
+    TSThaloScannerStats scanner = {};
+};
+
+/**
+ * Turn stats collection on or off for the whole process. Off by default; while off,
+ * ParseProfile does nothing and the scanner only checks a flag per call.
+ */
+void set_stats_enabled(bool enabled);
+bool stats_enabled();
+
+/**
+ * The process-wide totals since the last reset_stats(). Also folds in the scanner work done on
+ * the calling thread outside a ParseProfile, such as parses through node-tree-sitter.
+ */
+ParseStats read_stats();
+void reset_stats();
+
+/**
+ * Measures one parse on the calling thread: construct it right before ts_parser_parse and call
+ * finish() right after. The parse is added to the process-wide totals.
+ */
+class ParseProfile {
+  public:
+    ParseProfile();
+    ParseProfile(const ParseProfile &) = delete;
+    ParseProfile &operator=(const ParseProfile &) = delete;
+
+    /**
+     * Record the parse of `bytes` bytes and return its own counters (all zero if stats are
+     * disabled).
+     */
+    ParseStats finish(size_t bytes);
+
+  private:
+    bool enabled_;
+    uint64_t start_ns_ = 0;
+    TSThaloScannerStats scanner_start_ = {};
+};
+
+} // namespace thalo
+
+#endif // TREE_SITTER_THALO_STATS_H_
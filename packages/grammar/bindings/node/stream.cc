@@ -0,0 +1,240 @@
+#include "stream.h"
+
+#include "loader.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <string_view>
+
+namespace thalo {
+
+namespace {
+
+/** Size of each read from the file. */
+constexpr size_t READ_BLOCK_SIZE = 64 * 1024;
+
+/** Bytes needed after a newline to recognise an entry start: "YYYY-". */
+constexpr size_t BOUNDARY_LOOKAHEAD = 5;
+
+/**
+ * Whether the line starting at `line` looks like an entry header (`[12]\d{3}-`), matching the
+ * start of the grammar's timestamp_date token.
+ */
+bool is_entry_start(const char *line) {
+    return (line[0] == '1' || line[0] == '2') && std::isdigit(static_cast<unsigned char>(line[1])) &&
+           std::isdigit(static_cast<unsigned char>(line[2])) &&
+           std::isdigit(static_cast<unsigned char>(line[3])) && line[4] == '-';
+}
+
+/** The directive of the header line `[line, end)`: the word after its timestamp. */
+std::string_view header_directive(const char *line, const char *end) {
+    const char *word = std::find(line, end, ' ');
+    word = std::find_if(word, end, [](char c) { return c != ' '; });
+    const char *word_end = std::find_if(word, end, [](char c) { return c == ' ' || c == '\r'; });
+    return std::string_view(word, static_cast<size_t>(word_end - word));
+}
+
+/**
+ * Whether the header line `[line, end)` has a schema directive, whose `# Metadata` and
+ * `# Sections` blocks hold quoted values rather than content.
+ */
+bool is_schema_header(const char *line, const char *end) {
+    std::string_view directive = header_directive(line, end);
+    return directive == "define-entity" || directive == "alter-entity";
+}
+
+/** Whether the line `[line, end)` is a whole entry header, not just a line starting with a date. */
+bool is_entry_header(const char *line, const char *end) {
+    std::string_view directive = header_directive(line, end);
+    return is_schema_header(line, end) || directive == "create" || directive == "update" ||
+           directive == "define-synthesis" || directive == "actualize-synthesis";
+}
+
+} // namespace
+
+EntryStream::EntryStream(const std::string &path, size_t chunk_size)
+    : file_(std::fopen(path.c_str(), "rb")), chunk_size_(std::max<size_t>(chunk_size, 1)) {}
+
+EntryStream::~EntryStream() {
+    close();
+}
+
+void EntryStream::close() {
+    if (file_ != nullptr) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+    at_eof_ = true;
+    buffer_.clear();
+    chunk_end_ = scanned_ = 0;
+}
+
+bool EntryStream::fill() {
+    if (at_eof_ || file_ == nullptr) {
+        return false;
+    }
+    size_t size = buffer_.size();
+    buffer_.resize(size + READ_BLOCK_SIZE);
+    size_t read = std::fread(buffer_.data() + size, 1, READ_BLOCK_SIZE, file_);
+    buffer_.resize(size + read);
+    if (read < READ_BLOCK_SIZE) {
+        at_eof_ = true;
+        failed_ = std::ferror(file_) != 0;
+    }
+    return read > 0;
+}
+
+void EntryStream::extend_chunk() {
+    if (chunk_closed_) {
+        return;
+    }
+
+    // Past the target size, stop at the first line that starts an entry outside a quoted
+    // value. Every byte is scanned for quotes, and a line start can only be judged once the
+    // bytes after it are buffered (or the file has ended).
+    size_t end = buffer_.size();
+    size_t position = scanned_;
+    for (; position < end; position++) {
+        if (position == 0 || buffer_[position - 1] == '\n') {
+            if (position + BOUNDARY_LOOKAHEAD > end && !at_eof_) {
+                break;
+            }
+            bool entry_start = position + BOUNDARY_LOOKAHEAD <= end &&
+                               is_entry_start(buffer_.data() + position);
+            if (in_quote_) {
+                // Checked at the end of the line; see scan_byte()
+                quoted_header_ = entry_start;
+                line_start_ = position;
+            } else if (entry_start && position >= chunk_size_) {
+                chunk_end_ = scanned_ = position;
+                chunk_closed_ = true;
+                return;
+            } else {
+                line_ = entry_start ? Line::header : Line::indent;
+                line_start_ = position;
+            }
+        }
+        scan_byte(position);
+    }
+
+    chunk_end_ = scanned_ = position;
+    if (at_eof_ && position == end) {
+        chunk_closed_ = true;
+    }
+}
+
+void EntryStream::scan_byte(size_t position) {
+    char c = buffer_[position];
+    switch (line_) {
+    case Line::header:
+        if (c == '\n') {
+            const char *line = buffer_.data() + line_start_;
+            schema_entry_ = is_schema_header(line, buffer_.data() + position);
+            in_content_ = false;
+        }
+        break;
+    case Line::indent:
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            break;
+        }
+        if (c == '#') {
+            // A section header starts a data entry's content; schema blocks stay values
+            in_content_ = in_content_ || !schema_entry_;
+            line_ = Line::ignored;
+            break;
+        }
+        if (c == '/' || in_content_) {
+            line_ = Line::ignored;
+            break;
+        }
+        line_ = Line::value;
+        [[fallthrough]];
+    case Line::value:
+        if (c == '"') {
+            in_quote_ = !in_quote_;
+        } else if (c == '\n' && quoted_header_) {
+            // A whole entry header inside a quote means the quote was never closed. End it
+            // there so one stray `"` does not stop chunking for the rest of the file.
+            quoted_header_ = false;
+            const char *line = buffer_.data() + line_start_;
+            if (is_entry_header(line, buffer_.data() + position)) {
+                in_quote_ = false;
+                schema_entry_ = is_schema_header(line, buffer_.data() + position);
+                in_content_ = false;
+            }
+        }
+        break;
+    case Line::ignored:
+        break;
+    }
+}
+
+const char *EntryStream::read(void *payload, uint32_t byte, TSPoint, uint32_t *bytes_read) {
+    auto *self = static_cast<EntryStream *>(payload);
+    while (byte >= self->chunk_end_ && !self->chunk_closed_) {
+        if (!self->fill()) {
+            self->extend_chunk();
+            self->chunk_closed_ = true;
+            break;
+        }
+        self->extend_chunk();
+    }
+
+    if (byte >= self->chunk_end_) {
+        *bytes_read = 0;
+        return "";
+    }
+    *bytes_read = static_cast<uint32_t>(self->chunk_end_ - byte);
+    return self->buffer_.data() + byte;
+}
+
+bool EntryStream::next(TSParser *parser, StreamChunk &out) {
+    chunk_closed_ = false;
+    scanned_ = 0;
+    line_ = Line::indent;
+    in_quote_ = quoted_header_ = in_content_ = schema_entry_ = false;
+    extend_chunk();
+    if (chunk_end_ == 0 && !fill()) {
+        return false;
+    }
+    extend_chunk();
+
+    // The read callback fills the buffer from the file, so this also times that I/O
+    ParseProfile profile;
+    TSTree *tree = ts_parser_parse(parser, nullptr, TSInput{this, read, TSInputEncodingUTF8, nullptr});
+    out.stats = profile.finish(chunk_end_);
+
+    // The parser stops reading at the end of the input, but the chunk boundary may not have
+    // been reached yet if the tail was never requested
+    while (!chunk_closed_) {
+        if (!fill()) {
+            extend_chunk();
+            chunk_closed_ = true;
+            break;
+        }
+        extend_chunk();
+    }
+
+    out.bytes.assign(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(chunk_end_));
+    buffer_.erase(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(chunk_end_));
+    chunk_end_ = 0;
+
+    // Offsets can only be mapped to UTF-16 for valid input; callers re-parse the rest after
+    // decoding it leniently
+    out.tree = EncodedTree();
+    out.parsed = tree != nullptr && is_valid_utf8(out.bytes.data(), out.bytes.size());
+    if (out.parsed) {
+        encode_tree(tree, {out.bytes.data(), out.bytes.size(), TSInputEncodingUTF8},
+                    OffsetMap::utf8(out.bytes.data(), out.bytes.size()), out.tree);
+    }
+    if (tree != nullptr) {
+        ts_tree_delete(tree);
+    }
+
+    out.start_row = next_row_;
+    next_row_ += static_cast<uint32_t>(std::count(out.bytes.begin(), out.bytes.end(), '\n'));
+    return true;
+}
+
+} // namespace thalo
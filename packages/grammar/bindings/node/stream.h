@@ -0,0 +1,112 @@
+#ifndef TREE_SITTER_THALO_STREAM_H_
+#define TREE_SITTER_THALO_STREAM_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "encode.h"
+#include "stats.h"
+
+namespace thalo {
+
+/**
+ * A run of whole top-level entries parsed from an EntryStream.
+ */
+struct StreamChunk {
+    /** Raw bytes of the chunk */
+    std::vector<char> bytes;
+    /** Whether `tree` was filled in; false when the chunk is not valid UTF-8 */
+    bool parsed = false;
+    EncodedTree tree;
+    /** Row of the chunk's first line within the file */
+    uint32_t start_row = 0;
+    /** Counters for the chunk's parse, if stats are enabled (see stats.h) */
+    ParseStats stats;
+};
+
+/**
+ * Parses a file chunk by chunk without ever holding all of it in memory.
+ *
+ * `source_file` is a flat repeat of entries, comments and newlines, and an entry can only
+ * start at a column-0 timestamp. A chunk is therefore cut at the first line starting with a
+ * timestamp-like date once it has reached the target size, and parsing each chunk on its own
+ * gives the same entries as parsing the whole file. Quoted values in metadata and schema
+ * blocks may span lines, so a line inside an open `"` is never a boundary. A whole entry header
+ * inside one ends the quote instead: the quote was left unclosed, and cutting resumes at the
+ * next entry. Such a chunk is an error either way, but its parse can differ from the file's.
+ *
+ * The parser reads each chunk through a TSInput callback that pulls more of the file on demand,
+ * so only the chunk being parsed, plus at most one read block past it, is buffered.
+ */
+class EntryStream {
+  public:
+    EntryStream(const std::string &path, size_t chunk_size);
+    ~EntryStream();
+
+    EntryStream(const EntryStream &) = delete;
+    EntryStream &operator=(const EntryStream &) = delete;
+
+    /** Whether the file was opened successfully. */
+    bool is_open() const { return file_ != nullptr; }
+
+    /** Whether a read error occurred. */
+    bool failed() const { return failed_; }
+
+    /**
+     * Parse the next chunk with `parser`. Returns false once the whole file has been consumed.
+     */
+    bool next(TSParser *parser, StreamChunk &out);
+
+    /** Close the file early; later calls to next() return false. */
+    void close();
+
+  private:
+    static const char *read(void *payload, uint32_t byte, TSPoint position, uint32_t *bytes_read);
+
+    /** Read another block from the file into buffer_. Returns false at EOF or on error. */
+    bool fill();
+
+    /** Extend chunk_end_ over buffered bytes, closing the chunk at an entry boundary. */
+    void extend_chunk();
+
+    /** Update the quoting state for the byte at `position`, the end of the scanned bytes. */
+    void scan_byte(size_t position);
+
+    FILE *file_;
+    size_t chunk_size_;
+    bool at_eof_ = false;
+    bool failed_ = false;
+
+    // Bytes of the current chunk, followed by any bytes read past its end
+    std::vector<char> buffer_;
+    // End of the bytes handed to tree-sitter so far; never moves past an entry boundary
+    size_t chunk_end_ = 0;
+    // How far extend_chunk() has checked for boundaries
+    size_t scanned_ = 0;
+    bool chunk_closed_ = false;
+
+    // What the line being scanned is, as far as quoting goes
+    enum class Line {
+        header,  // An entry header; its title cannot span lines
+        indent,  // Leading whitespace, not yet classified
+        value,   // Metadata or schema line, where quotes open and close values
+        ignored, // Comment or content, where quotes are plain text
+    };
+    Line line_ = Line::indent;
+    size_t line_start_ = 0;
+    // Inside a quoted value that has not been closed yet
+    bool in_quote_ = false;
+    // The line being scanned is inside a quote but starts with a timestamp-like date
+    bool quoted_header_ = false;
+    // Past the first section header of a data entry, where every line is content
+    bool in_content_ = false;
+    bool schema_entry_ = false;
+
+    uint32_t next_row_ = 0;
+};
+
+} // namespace thalo
+
+#endif // TREE_SITTER_THALO_STREAM_H_
@@ -0,0 +1,236 @@
+#include "times.h"
+
+#include <cstdint>
+#include <limits>
+
+namespace thalo {
+
+namespace {
+
+constexpr int64_t MINUTES_PER_DAY = 24 * 60;
+
+int64_t floor_div(int64_t a, int64_t b) {
+    return a / b - (a % b != 0 && (a < 0) != (b < 0));
+}
+
+/**
+ * Days from 1970-01-01 to the given civil date (proleptic Gregorian).
+ *
+ * Months outside 1-12 carry into the year first and days are linear, matching `Date.UTC`.
+ */
+int64_t days_from_civil(int64_t year, int64_t month, int64_t day) {
+    int64_t carry = floor_div(month - 1, 12);
+    year += carry;
+    month -= carry * 12;
+
+    year -= month <= 2;
+    const int64_t era = floor_div(year, 400);
+    const int64_t yoe = year - era * 400;
+    const int64_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+int64_t minutes_from_civil(int64_t year, int64_t month, int64_t day) {
+    return days_from_civil(year, month, day) * MINUTES_PER_DAY;
+}
+
+/**
+ * A cursor over the ASCII text of one node.
+ */
+struct Reader {
+    const char *p;
+    const char *end;
+
+    bool done() const { return p == end; }
+
+    bool peek(char c) const { return p != end && *p == c; }
+
+    bool consume(char c) {
+        if (!peek(c)) {
+            return false;
+        }
+        p++;
+        return true;
+    }
+
+    bool number(int digits, int64_t &value) {
+        if (end - p < digits) {
+            return false;
+        }
+        value = 0;
+        for (int i = 0; i < digits; i++, p++) {
+            if (*p < '0' || *p > '9') {
+                return false;
+            }
+            value = value * 10 + (*p - '0');
+        }
+        return true;
+    }
+
+    void skip_spaces() {
+        while (p != end && *p == ' ') {
+            p++;
+        }
+    }
+};
+
+bool read_date(Reader &in, int64_t &year, int64_t &month, int64_t &day) {
+    return in.number(4, year) && in.consume('-') && in.number(2, month) && in.consume('-') &&
+           in.number(2, day);
+}
+
+/** HH:MM, as minutes after midnight. */
+bool read_time(Reader &in, int64_t &minutes) {
+    int64_t hour = 0;
+    int64_t minute = 0;
+    if (!(in.number(2, hour) && in.consume(':') && in.number(2, minute))) {
+        return false;
+    }
+    minutes = hour * 60 + minute;
+    return true;
+}
+
+/** An optional Z or ±HH:MM, as minutes east of UTC. */
+bool read_timezone(Reader &in, int64_t &offset) {
+    offset = 0;
+    if (in.done() || in.consume('Z')) {
+        return true;
+    }
+    int64_t sign = in.consume('+') ? 1 : in.consume('-') ? -1 : 0;
+    int64_t minutes = 0;
+    if (sign == 0 || !read_time(in, minutes)) {
+        return false;
+    }
+    offset = sign * minutes;
+    return true;
+}
+
+/**
+ * YYYY, YYYY-MM or YYYY-MM-DD, as the span of the year, month or day it names.
+ */
+bool read_period(Reader &in, TimeSpan &out) {
+    int64_t year = 0;
+    int64_t month = 1;
+    int64_t day = 1;
+    if (!in.number(4, year)) {
+        return false;
+    }
+
+    int64_t start_month = month;
+    int64_t end_year = year + 1;
+    int64_t end_month = 1;
+    int64_t end_day = 1;
+    if (in.consume('-')) {
+        if (!in.number(2, month)) {
+            return false;
+        }
+        start_month = month;
+        end_year = year;
+        end_month = month + 1;
+        if (in.consume('-')) {
+            if (!in.number(2, day)) {
+                return false;
+            }
+            end_month = month;
+            end_day = day + 1;
+        }
+    }
+
+    out.start = static_cast<double>(minutes_from_civil(year, start_month, day));
+    out.end = static_cast<double>(minutes_from_civil(end_year, end_month, end_day));
+    return true;
+}
+
+bool decode_timestamp(Reader &in, TimeSpan &out) {
+    int64_t year = 0, month = 0, day = 0, time = 0, offset = 0;
+    if (!(read_date(in, year, month, day) && in.consume('T') && read_time(in, time) &&
+          read_timezone(in, offset) && in.done())) {
+        return false;
+    }
+    int64_t start = minutes_from_civil(year, month, day) + time - offset;
+    out.start = static_cast<double>(start);
+    out.end = static_cast<double>(start + 1);
+    return true;
+}
+
+bool decode_datetime(Reader &in, TimeSpan &out) {
+    int64_t year = 0, month = 0, day = 0;
+    if (!read_date(in, year, month, day)) {
+        return false;
+    }
+    if (in.done()) {
+        out.start = static_cast<double>(minutes_from_civil(year, month, day));
+        out.end = out.start + MINUTES_PER_DAY;
+        return true;
+    }
+
+    int64_t time = 0, offset = 0;
+    if (!(in.consume('T') && read_time(in, time) && read_timezone(in, offset) && in.done())) {
+        return false;
+    }
+    int64_t start = minutes_from_civil(year, month, day) + time - offset;
+    out.start = static_cast<double>(start);
+    out.end = static_cast<double>(start + 1);
+    return true;
+}
+
+bool decode_daterange(Reader &in, TimeSpan &out) {
+    // YYYY Qn: at least one space, then the quarter
+    Reader quarter = in;
+    int64_t year = 0;
+    int64_t q = 0;
+    if (quarter.number(4, year) && quarter.peek(' ')) {
+        quarter.skip_spaces();
+        if (quarter.consume('Q') && quarter.number(1, q) && quarter.done()) {
+            int64_t month = (q - 1) * 3 + 1;
+            out.start = static_cast<double>(minutes_from_civil(year, month, 1));
+            out.end = static_cast<double>(minutes_from_civil(year, month + 3, 1));
+            return true;
+        }
+    }
+
+    TimeSpan first{};
+    if (!read_period(in, first)) {
+        return false;
+    }
+    in.skip_spaces();
+    if (in.done()) {
+        out = first;
+        return true;
+    }
+    if (!in.consume('~')) {
+        return false;
+    }
+    in.skip_spaces();
+    out.start = first.start;
+    if (in.done()) {
+        out.end = std::numeric_limits<double>::infinity();
+        return true;
+    }
+
+    TimeSpan last{};
+    if (!read_period(in, last)) {
+        return false;
+    }
+    in.skip_spaces();
+    out.end = last.end;
+    return in.done();
+}
+
+} // namespace
+
+bool decode_time(TimeKind kind, const char *text, size_t length, TimeSpan &out) {
+    Reader in{text, text + length};
+    switch (kind) {
+    case TimeKind::Timestamp:
+        return decode_timestamp(in, out);
+    case TimeKind::Datetime:
+        return decode_datetime(in, out);
+    case TimeKind::Daterange:
+        return decode_daterange(in, out);
+    }
+    return false;
+}
+
+} // namespace thalo
@@ -0,0 +1,46 @@
+#ifndef TREE_SITTER_THALO_TIMES_H_
+#define TREE_SITTER_THALO_TIMES_H_
+
+#include <cstddef>
+
+namespace thalo {
+
+/**
+ * The kinds of time-valued nodes decoded during encoding.
+ */
+enum class TimeKind {
+    /** `timestamp`: YYYY-MM-DDTHH:MM with an optional timezone */
+    Timestamp,
+    /** `datetime_value`: YYYY-MM-DD with an optional THH:MM and timezone */
+    Datetime,
+    /** `daterange`: YYYY Qn, YYYY-MM, or partial dates around `~` */
+    Daterange,
+};
+
+/**
+ * A half-open interval [start, end) in minutes since the Unix epoch, UTC.
+ *
+ * Instants (timestamps and datetimes with a time) span one minute, dates one day, and periods
+ * their whole length; an open-ended range ends at +infinity. Values are integers stored as
+ * doubles so JS reads them from a Float64Array without BigInt conversions.
+ *
+ * Must match `TimeSpan` and the decoders in packages/thalo/src/ast/time.ts.
+ */
+struct TimeSpan {
+    double start;
+    double end;
+};
+
+/**
+ * Decode the ASCII text of a time-valued node. A missing timezone is read as UTC.
+ *
+ * Calendar fields are not range-checked; out-of-range months, days and times carry over into
+ * the next larger unit, as they do with JS `Date.UTC`.
+ *
+ * @return false if the text does not have the shape of `kind`
+ */
+bool decode_time(TimeKind kind, const char *text, size_t length, TimeSpan &out);
+
+} // namespace thalo
+
+#endif // TREE_SITTER_THALO_TIMES_H_
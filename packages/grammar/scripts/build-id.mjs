@@ -0,0 +1,51 @@
+#!/usr/bin/env node
+/**
+ * Writes the binding's build identity: a hash of every source that decides what an encoded
+ * syntax tree looks like, so caches of encoded trees can tell when a rebuild changed them even
+ * though the grammar version and ABI did not.
+ *
+ * Run by binding.gyp before compiling the binding; the hash is exported as `binding.buildId`.
+ *
+ * Usage: node scripts/build-id.mjs <output header>
+ */
+import { createHash } from "node:crypto";
+import { mkdirSync, readFileSync, writeFileSync } from "node:fs";
+import { dirname, join } from "node:path";
+import { fileURLToPath } from "node:url";
+
+const root = join(dirname(fileURLToPath(import.meta.url)), "..");
+
+/** Sources hashed into the build id, relative to the package root. */
+export const BUILD_ID_SOURCES = [
+  "src/parser.c",
+  "src/scanner.c",
+  "src/scanner_stats.h",
+  "bindings/node/encode.cc",
+  "bindings/node/encode.h",
+  "bindings/node/times.cc",
+  "bindings/node/times.h",
+];
+
+export function computeBuildId() {
+  const hash = createHash("sha256");
+  for (const source of BUILD_ID_SOURCES) {
+    hash.update(source);
+    hash.update("\0");
+    hash.update(readFileSync(join(root, source)));
+    hash.update("\0");
+  }
+  return hash.digest("hex").slice(0, 16);
+}
+
+if (process.argv[1] === fileURLToPath(import.meta.url)) {
+  const output = process.argv[2];
+  if (!output) {
+    console.error("Usage: node scripts/build-id.mjs <output header>");
+    process.exit(1);
+  }
+  mkdirSync(dirname(output), { recursive: true });
+  writeFileSync(
+    output,
+    `// Generated by scripts/build-id.mjs\n#define THALO_BUILD_ID "${computeBuildId()}"\n`,
+  );
+}
@@ -0,0 +1,136 @@
+#!/usr/bin/env node
+/**
+ * Builds the release prebuild of the native binding: parser, scanner, tree-sitter runtime and
+ * binding compiled with link-time and profile-guided optimization.
+ *
+ * 1. Builds the default binding and runs the benchmarks for the baseline numbers.
+ * 2. Builds an instrumented binding (`--thalo_pgo=generate`) and trains it on the same
+ *    benchmarks: full parses and keystroke reparses through node-tree-sitter, which spend their
+ *    time in the generated lexer and parse tables, and batch loads through `loadFiles`.
+ * 3. Builds the optimized binding (`--thalo_pgo=use`) from those profiles and benchmarks it.
+ *
+ * The result is copied to prebuilds/<platform>-<arch>/tree-sitter-thalo.node, where
+ * node-gyp-build and `bun build --compile` pick it up, and the before/after numbers are written
+ * to build/release-profile.json and printed as a markdown table.
+ *
+ * PGO needs GCC or Clang; with Clang, llvm-profdata (or $LLVM_PROFDATA) merges the profiles.
+ * On Windows only LTO is applied.
+ *
+ * Usage: node scripts/build-release.mjs [--no-pgo]
+ */
+import { execFileSync } from "node:child_process";
+import { copyFileSync, mkdirSync, readdirSync, rmSync, writeFileSync } from "node:fs";
+import { join, dirname } from "node:path";
+import { fileURLToPath } from "node:url";
+
+const __dirname = dirname(fileURLToPath(import.meta.url));
+const root = join(__dirname, "..");
+// Outside build/, which every `node-gyp rebuild` deletes
+const pgoDir = join(root, ".pgo");
+const output = join(root, "build", "Release", "tree_sitter_thalo_binding.node");
+const prebuild = join(root, "prebuilds", `${process.platform}-${process.arch}`);
+
+const pgo = !process.argv.includes("--no-pgo") && process.platform !== "win32";
+const parseSizes = ["1000", "10000"];
+const loadCounts = ["1000"];
+
+function run(command, args) {
+  execFileSync(command, args, { cwd: root, stdio: "inherit" });
+}
+
+function build(...options) {
+  run("pnpm", ["exec", "node-gyp", "rebuild", `--thalo_pgo_dir=${pgoDir}`, ...options]);
+}
+
+/** Run a benchmark in a fresh process, so it loads the binding just built. */
+function bench(script, args) {
+  const stdout = execFileSync(process.execPath, [join("bench", script), ...args, "--json"], {
+    cwd: root,
+    encoding: "utf8",
+    stdio: ["ignore", "pipe", "inherit"],
+  });
+  return JSON.parse(stdout);
+}
+
+function benchAll() {
+  return { parse: bench("parse.mjs", parseSizes), load: bench("load.mjs", loadCounts) };
+}
+
+/** Merge Clang's raw profiles into the default.profdata that -fprofile-use=<dir> reads. */
+function mergeClangProfiles() {
+  const raw = readdirSync(pgoDir).filter((file) => file.endsWith(".profraw"));
+  if (raw.length === 0) {
+    return; // GCC writes .gcda files that are used as they are
+  }
+  const profdata = process.env.LLVM_PROFDATA ?? "llvm-profdata";
+  const args = ["merge", `--output=${join(pgoDir, "default.profdata")}`];
+  args.push(...raw.map((file) => join(pgoDir, file)));
+  if (process.platform === "darwin" && !process.env.LLVM_PROFDATA) {
+    run("xcrun", [profdata, ...args]);
+  } else {
+    run(profdata, args);
+  }
+}
+
+function change(before, after) {
+  const percent = (after / before - 1) * 100;
+  return `${percent >= 0 ? "+" : ""}${percent.toFixed(1)}%`;
+}
+
+function table(baseline, release) {
+  const rows = [
+    "| Benchmark | Baseline | Release | Change |",
+    "| --- | ---: | ---: | ---: |",
+  ];
+  baseline.parse.forEach((before, i) => {
+    const after = release.parse[i];
+    const name = `${before.entries} entries`;
+    rows.push(
+      `| Full parse, ${name} | ${before.fullParseMBps.toFixed(1)} MB/s | ` +
+        `${after.fullParseMBps.toFixed(1)} MB/s | ` +
+        `${change(before.fullParseMBps, after.fullParseMBps)} |`,
+      `| Edit p50, ${name} | ${before.p50.toFixed(2)} ms | ${after.p50.toFixed(2)} ms | ` +
+        `${change(before.p50, after.p50)} |`,
+    );
+  });
+  baseline.load.forEach((before, i) => {
+    const after = release.load[i];
+    rows.push(
+      `| loadFiles, ${before.files} files | ${before.arenaFilesPerSecond.toFixed(0)} files/s | ` +
+        `${after.arenaFilesPerSecond.toFixed(0)} files/s | ` +
+        `${change(before.arenaFilesPerSecond, after.arenaFilesPerSecond)} |`,
+    );
+  });
+  return rows.join("\n");
+}
+
+build();
+const baseline = benchAll();
+
+rmSync(pgoDir, { recursive: true, force: true });
+if (pgo) {
+  mkdirSync(pgoDir, { recursive: true });
+  build("--thalo_release=true", "--thalo_pgo=generate");
+  benchAll();
+  mergeClangProfiles();
+  build("--thalo_release=true", "--thalo_pgo=use");
+} else {
+  build("--thalo_release=true");
+}
+const release = benchAll();
+
+mkdirSync(prebuild, { recursive: true });
+copyFileSync(output, join(prebuild, "tree-sitter-thalo.node"));
+
+const report = {
+  platform: process.platform,
+  arch: process.arch,
+  node: process.version,
+  pgo,
+  baseline,
+  release,
+};
+writeFileSync(join(root, "build", "release-profile.json"), JSON.stringify(report, null, 2) + "\n");
+
+console.log(`\n✅ Built prebuilds/${process.platform}-${process.arch}/tree-sitter-thalo.node\n`);
+console.log(table(baseline, release));
@@ -0,0 +1,47 @@
+#!/usr/bin/env node
+/**
+ * Builds tree-sitter-thalo.simd.wasm: the language module compiled with 128-bit WASM SIMD.
+ *
+ * `tree-sitter build --wasm` has no way to pass extra compiler flags, so this runs emcc with the
+ * same side-module settings the CLI uses, plus -msimd128. web-tree-sitter loads the result like
+ * tree-sitter-thalo.wasm; `@rejot-dev/thalo/web` picks it when the host supports SIMD.
+ *
+ * Shared-memory threads are not enabled: a side module can only use them when the
+ * web-tree-sitter runtime is itself built with threads, which the published one is not.
+ * Parallel parsing in the browser uses a pool of workers instead (`@rejot-dev/thalo/web-pool`).
+ */
+import { execFileSync } from "node:child_process";
+import { join, dirname } from "node:path";
+import { fileURLToPath } from "node:url";
+
+const __dirname = dirname(fileURLToPath(import.meta.url));
+const root = join(__dirname, "..");
+
+const args = [
+  "-o",
+  "tree-sitter-thalo.simd.wasm",
+  "-Os",
+  "-msimd128",
+  "-fno-exceptions",
+  "-fvisibility=hidden",
+  "-s",
+  "WASM=1",
+  "-s",
+  "SIDE_MODULE=2",
+  "-s",
+  "EXPORTED_FUNCTIONS=_tree_sitter_thalo",
+  "-I",
+  "src",
+  "src/parser.c",
+  "src/scanner.c",
+];
+
+try {
+  execFileSync("emcc", args, { cwd: root, stdio: "inherit" });
+} catch (error) {
+  if (error.code === "ENOENT") {
+    console.error("emcc not found; install the Emscripten SDK to build the SIMD WASM module");
+  }
+  process.exit(1);
+}
+console.log("✅ Built tree-sitter-thalo.simd.wasm");
@@ -5,6 +5,7 @@
  * Checks:
  * - Native binding: build/Release/tree_sitter_thalo_binding.node
  * - WASM module: tree-sitter-thalo.wasm
+ * - SIMD WASM module: tree-sitter-thalo.simd.wasm, only if it has been built
  *
  * Source files: grammar.js, src/parser.c, src/scanner.c
  */
@@ -21,13 +22,35 @@ const sourceFiles = [
   join(root, "grammar.js"),
   join(root, "src/parser.c"),
   join(root, "src/scanner.c"),
+  join(root, "src/scanner_stats.h"),
 ];
 
 // Native-specific source
-const nativeSourceFiles = [...sourceFiles, join(root, "bindings/node/binding.cc")];
+const nativeSourceFiles = [
+  ...sourceFiles,
+  join(root, "bindings/node/arena.cc"),
+  join(root, "bindings/node/arena.h"),
+  join(root, "bindings/node/binding.cc"),
+  join(root, "bindings/node/encode.cc"),
+  join(root, "bindings/node/encode.h"),
+  join(root, "bindings/node/fences.cc"),
+  join(root, "bindings/node/fences.h"),
+  join(root, "bindings/node/hash.cc"),
+  join(root, "bindings/node/hash.h"),
+  join(root, "bindings/node/loader.cc"),
+  join(root, "bindings/node/loader.h"),
+  join(root, "bindings/node/stats.cc"),
+  join(root, "bindings/node/stats.h"),
+  join(root, "bindings/node/stream.cc"),
+  join(root, "bindings/node/stream.h"),
+  join(root, "bindings/node/times.cc"),
+  join(root, "bindings/node/times.h"),
+  join(root, "scripts/build-id.mjs"),
+];
 
 const nativeOutput = join(root, "build/Release/tree_sitter_thalo_binding.node");
 const wasmOutput = join(root, "tree-sitter-thalo.wasm");
+const simdWasmOutput = join(root, "tree-sitter-thalo.simd.wasm");
 
 function getMtime(path) {
   try {
@@ -91,3 +114,23 @@ if (wasmResult.needed) {
 } else {
   console.log("✅ WASM module is up to date");
 }
+
+// Check SIMD WASM module (optional: building it needs emcc)
+if (existsSync(simdWasmOutput)) {
+  const simdResult = checkNeedsRebuild(simdWasmOutput, sourceFiles, ".simd.wasm file");
+
+  if (simdResult.needed) {
+    console.log(`⚠️  SIMD WASM rebuild needed: ${simdResult.reason}`);
+
+    if (fix) {
+      console.log("Running pnpm build:wasm:simd...");
+      execSync("pnpm build:wasm:simd", { cwd: root, stdio: "inherit" });
+      console.log("✅ SIMD WASM rebuild complete");
+    } else {
+      console.log("Run with --fix to automatically rebuild, or run: pnpm build:wasm:simd");
+      process.exit(1);
+    }
+  } else {
+    console.log("✅ SIMD WASM module is up to date");
+  }
+}
@@ -14,8 +14,10 @@
 #include "tree_sitter/alloc.h"
 #include "tree_sitter/array.h"
 #include "tree_sitter/parser.h"
+#include "scanner_stats.h"
 
 #include <stdio.h>
+#include <string.h>
 
 // Debug mode - set to 1 to enable debug output
 #define DEBUG_SCANNER 0
@@ -38,26 +40,98 @@ enum TokenType
     ERROR_SENTINEL, // Sentinel for error recovery detection
 };
 
+/**
+ * @brief Kind of run remembered by the look-ahead memo
+ */
+enum MemoKind
+{
+    MEMO_NONE,
+    MEMO_COMMENT_RUN, // Unindented `//` comment lines (and blank lines) before indented content
+    MEMO_BLANK_RUN,   // Blank lines before indented content
+};
+
 /**
  * @brief Scanner state
  *
- * Currently stateless since we don't track indent levels across parses.
- * Tree-sitter handles the grammar-level block structure.
+ * Tree-sitter handles the grammar-level block structure, so the only state is a memo of the
+ * last successful look-ahead. A look-ahead from the first line of a comment or blank run
+ * reaches the same verdict for every later line of that run, so the memo records how many more
+ * lines of the run are known to be followed by indented content. Tokens on those lines are
+ * produced without scanning ahead again, which keeps long runs linear instead of quadratic.
+ *
+ * The state is serialized with every external token, so tree-sitter restores it before each
+ * scan and drops it for tokens whose look-ahead range an edit touched.
  */
 typedef struct
 {
-    // Reserved for future use if we need state
-    uint8_t _reserved;
+    uint8_t memo_kind;
+    // Remaining lines of the run covered by the memo
+    uint32_t memo_lines;
+
+    // Characters advanced over in the current scan, and at its last mark_end (UINT32_MAX if
+    // none); not serialized
+    uint32_t advanced;
+    uint32_t marked;
 } Scanner;
 
+/** Size of the serialized scanner state */
+#define SCANNER_STATE_SIZE (sizeof(uint8_t) + sizeof(uint32_t))
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define THREAD_LOCAL __declspec(thread)
+#elif defined(__wasm__) && !defined(__wasm_atomics__)
+// WASM builds without atomics (`build:wasm`) run on one thread, so plain statics do, without
+// relying on how emcc or wasi-sdk lower _Thread_local in a module without shared memory
+#define THREAD_LOCAL
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+
+// Whether the calling thread collects stats, and its running totals (see scanner_stats.h)
+static THREAD_LOCAL bool stats_enabled;
+static THREAD_LOCAL TSThaloScannerStats thread_stats;
+
+void tree_sitter_thalo_scanner_stats_enable(bool enabled)
+{
+    stats_enabled = enabled;
+}
+
+void tree_sitter_thalo_scanner_stats_read(TSThaloScannerStats *stats)
+{
+    *stats = thread_stats;
+}
+
 /**
  * @brief Advance the lexer to the next character (include in parse result)
+ *
+ * Counting the character is a plain increment, so it stays in even with stats disabled.
  */
-static inline void advance(TSLexer *lexer)
+static inline void advance(Scanner *scanner, TSLexer *lexer)
 {
+    scanner->advanced++;
     lexer->advance(lexer, false);
 }
 
+/**
+ * @brief End the token at the current position
+ */
+static inline void mark_end(Scanner *scanner, TSLexer *lexer)
+{
+    scanner->marked = scanner->advanced;
+    lexer->mark_end(lexer);
+}
+
+/**
+ * @brief Check for end of input
+ *
+ * The lexer reports a lookahead of 0 at EOF, so eof() only needs to be consulted when the
+ * lookahead is 0. This saves a second callback per character in the scanning loops below.
+ */
+static inline bool at_eof(const TSLexer *lexer)
+{
+    return lexer->lookahead == 0 && lexer->eof(lexer);
+}
+
 /**
  * @brief Check if character is a newline
  */
@@ -98,13 +172,13 @@ static bool has_valid_indent(int indent, bool has_tab)
 /**
  * @brief Consume a newline sequence (\n or \r\n)
  */
-static void consume_newline(TSLexer *lexer)
+static void consume_newline(Scanner *scanner, TSLexer *lexer)
 {
     bool was_cr = lexer->lookahead == '\r';
-    advance(lexer);
+    advance(scanner, lexer);
     if (was_cr && lexer->lookahead == '\n')
     {
-        advance(lexer);
+        advance(scanner, lexer);
     }
 }
 
@@ -113,7 +187,7 @@ static void consume_newline(TSLexer *lexer)
  *
  * Returns the indent count and sets has_tab if a tab was found.
  */
-static int consume_indentation(TSLexer *lexer, bool *has_tab)
+static int consume_indentation(Scanner *scanner, TSLexer *lexer, bool *has_tab)
 {
     int indent = 0;
     *has_tab = false;
@@ -125,7 +199,7 @@ static int consume_indentation(TSLexer *lexer, bool *has_tab)
             *has_tab = true;
         }
         indent++;
-        advance(lexer);
+        advance(scanner, lexer);
     }
 
     return indent;
@@ -134,11 +208,11 @@ static int consume_indentation(TSLexer *lexer, bool *has_tab)
 /**
  * @brief Skip to end of line (past comment content)
  */
-static void skip_to_eol(TSLexer *lexer)
+static void skip_to_eol(Scanner *scanner, TSLexer *lexer)
 {
-    while (!is_newline(lexer->lookahead) && !lexer->eof(lexer))
+    while (!is_newline(lexer->lookahead) && !at_eof(lexer))
     {
-        advance(lexer);
+        advance(scanner, lexer);
     }
 }
 
@@ -146,24 +220,28 @@ static void skip_to_eol(TSLexer *lexer)
  * @brief Look ahead past comment(s) to see if indented content follows
  *
  * Called when we're at '//' (already advanced past first '/').
- * Returns true if there's indented content after the comment(s).
+ * Returns true if there's indented content after the comment(s), and sets `comment_lines` to
+ * the number of further unindented comment lines skipped on the way.
  */
-static bool look_ahead_for_indented_content(TSLexer *lexer)
+static bool look_ahead_for_indented_content(Scanner *scanner, TSLexer *lexer,
+                                            uint32_t *comment_lines)
 {
+    *comment_lines = 0;
+
     // Skip rest of current comment line
-    skip_to_eol(lexer);
+    skip_to_eol(scanner, lexer);
 
-    while (!lexer->eof(lexer))
+    while (!at_eof(lexer))
     {
         if (!is_newline(lexer->lookahead))
             break;
 
-        consume_newline(lexer);
+        consume_newline(scanner, lexer);
 
         bool next_has_tab = false;
-        int next_indent = consume_indentation(lexer, &next_has_tab);
+        int next_indent = consume_indentation(scanner, lexer, &next_has_tab);
 
-        if (is_newline(lexer->lookahead) || lexer->eof(lexer))
+        if (is_newline(lexer->lookahead) || at_eof(lexer))
         {
             // Blank line, continue looking
             continue;
@@ -172,11 +250,12 @@ static bool look_ahead_for_indented_content(TSLexer *lexer)
         // Check if this is another unindented comment
         if (next_indent == 0 && !next_has_tab && lexer->lookahead == '/')
         {
-            advance(lexer);
+            advance(scanner, lexer);
             if (lexer->lookahead == '/')
             {
                 // Another unindented comment, skip it and continue
-                skip_to_eol(lexer);
+                (*comment_lines)++;
+                skip_to_eol(scanner, lexer);
                 continue;
             }
             // Single slash at start of line - not a comment, not indented
@@ -221,7 +300,7 @@ static void skip_hspace(TSLexer *lexer)
  *    - If indented content follows: return CONTENT_BLANK
  *    - Otherwise: return false (let grammar handle the newline)
  */
-static bool scan_newline(TSLexer *lexer, const bool *valid_symbols)
+static bool scan_newline(Scanner *scanner, TSLexer *lexer, const bool *valid_symbols)
 {
     // Skip any trailing whitespace before the newline
     // (tree-sitter extras are not automatically consumed for external scanners)
@@ -234,14 +313,14 @@ static bool scan_newline(TSLexer *lexer, const bool *valid_symbols)
     }
 
     // Consume the newline
-    consume_newline(lexer);
+    consume_newline(scanner, lexer);
 
     // Count indentation on this line
     bool has_tab = false;
-    int indent = consume_indentation(lexer, &has_tab);
+    int indent = consume_indentation(scanner, lexer, &has_tab);
 
     // Check what's on this line
-    bool at_eol = is_newline(lexer->lookahead) || lexer->eof(lexer);
+    bool at_eol = is_newline(lexer->lookahead) || at_eof(lexer);
     bool valid_indent = has_valid_indent(indent, has_tab);
 
     DEBUG_LOG("[SCANNER] line: indent=%d, has_tab=%d, at_eol=%d, valid_indent=%d, lookahead='%c'(%d)\n",
@@ -254,7 +333,9 @@ static bool scan_newline(TSLexer *lexer, const bool *valid_symbols)
     // Case 1: Valid indented line with content (including comments) -> INDENT
     if (!at_eol && valid_indent && valid_symbols[INDENT])
     {
-        lexer->mark_end(lexer);
+        mark_end(scanner, lexer);
+        scanner->memo_kind = MEMO_NONE;
+        scanner->memo_lines = 0;
         lexer->result_symbol = INDENT;
         DEBUG_LOG("[SCANNER] -> INDENT\n");
         return true;
@@ -265,15 +346,31 @@ static bool scan_newline(TSLexer *lexer, const bool *valid_symbols)
     if (!at_eol && indent == 0 && !has_tab && valid_symbols[INDENT] && lexer->lookahead == '/')
     {
         // Mark end here (token is just the newline, no indentation)
-        lexer->mark_end(lexer);
+        mark_end(scanner, lexer);
 
         // Check if this is a comment and if indented content follows
-        advance(lexer); // Consume first '/'
+        advance(scanner, lexer); // Consume first '/'
         if (lexer->lookahead == '/')
         {
+            // A previous look-ahead already passed this comment on its way to indented content
+            if (scanner->memo_kind == MEMO_COMMENT_RUN && scanner->memo_lines > 0)
+            {
+                scanner->memo_lines--;
+                if (stats_enabled)
+                {
+                    thread_stats.memo_hits++;
+                }
+                lexer->result_symbol = INDENT;
+                DEBUG_LOG("[SCANNER] -> INDENT (memoized, %u comment lines left)\n", scanner->memo_lines);
+                return true;
+            }
+
             // It's a comment, look ahead past it
-            if (look_ahead_for_indented_content(lexer))
+            uint32_t comment_lines = 0;
+            if (look_ahead_for_indented_content(scanner, lexer, &comment_lines))
             {
+                scanner->memo_kind = MEMO_COMMENT_RUN;
+                scanner->memo_lines = comment_lines;
                 lexer->result_symbol = INDENT;
                 DEBUG_LOG("[SCANNER] -> INDENT (unindented comment with indented content after)\n");
                 return true;
@@ -289,24 +386,40 @@ static bool scan_newline(TSLexer *lexer, const bool *valid_symbols)
     if (at_eol && valid_symbols[CONTENT_BLANK])
     {
         // Mark the end after this blank line
-        lexer->mark_end(lexer);
+        mark_end(scanner, lexer);
+
+        // A previous look-ahead already passed this blank line on its way to indented content
+        if (scanner->memo_kind == MEMO_BLANK_RUN && scanner->memo_lines > 0)
+        {
+            scanner->memo_lines--;
+            if (stats_enabled)
+            {
+                thread_stats.memo_hits++;
+            }
+            lexer->result_symbol = CONTENT_BLANK;
+            DEBUG_LOG("[SCANNER] -> CONTENT_BLANK (memoized, %u blank lines left)\n", scanner->memo_lines);
+            return true;
+        }
 
         // Look ahead to see if indented content follows
+        uint32_t blank_lines = 0;
         while (is_newline(lexer->lookahead))
         {
-            consume_newline(lexer);
+            consume_newline(scanner, lexer);
 
             // Count indent on this next line
             bool next_has_tab = false;
-            int next_indent = consume_indentation(lexer, &next_has_tab);
+            int next_indent = consume_indentation(scanner, lexer, &next_has_tab);
 
             // Check what's on this line
-            if (!is_newline(lexer->lookahead) && !lexer->eof(lexer))
+            if (!is_newline(lexer->lookahead) && !at_eof(lexer))
             {
                 // Found a line with content
                 if (has_valid_indent(next_indent, next_has_tab))
                 {
                     // Indented content follows - match CONTENT_BLANK
+                    scanner->memo_kind = MEMO_BLANK_RUN;
+                    scanner->memo_lines = blank_lines;
                     lexer->result_symbol = CONTENT_BLANK;
                     DEBUG_LOG("[SCANNER] -> CONTENT_BLANK (indented content follows)\n");
                     return true;
@@ -319,6 +432,7 @@ static bool scan_newline(TSLexer *lexer, const bool *valid_symbols)
                 }
             }
             // Another blank line - continue looking
+            blank_lines++;
         }
 
         // Reached EOF without finding indented content
@@ -338,8 +452,6 @@ static bool scan_newline(TSLexer *lexer, const bool *valid_symbols)
  */
 static bool scan(Scanner *scanner, TSLexer *lexer, const bool *valid_symbols)
 {
-    (void)scanner; // Currently unused
-
     DEBUG_LOG("[SCANNER] called: lookahead='%c'(%d) valid=[%d,%d,%d]\n",
               lexer->lookahead > 31 && lexer->lookahead < 127
                   ? (char)lexer->lookahead
@@ -357,7 +469,7 @@ static bool scan(Scanner *scanner, TSLexer *lexer, const bool *valid_symbols)
     // Only scan if we might want INDENT or CONTENT_BLANK
     if (valid_symbols[INDENT] || valid_symbols[CONTENT_BLANK])
     {
-        return scan_newline(lexer, valid_symbols);
+        return scan_newline(scanner, lexer, valid_symbols);
     }
 
     return false;
@@ -384,28 +496,41 @@ void tree_sitter_thalo_external_scanner_destroy(void *payload)
 /**
  * @brief Serialize scanner state
  *
- * Currently stateless, so nothing to serialize.
+ * Writes the look-ahead memo, or nothing when there is no memo so that memo-free tokens keep
+ * the empty state and stay reusable across edits.
  */
 unsigned tree_sitter_thalo_external_scanner_serialize(void *payload,
                                                       char *buffer)
 {
-    (void)payload;
-    (void)buffer;
-    return 0;
+    Scanner *scanner = (Scanner *)payload;
+    if (scanner->memo_kind == MEMO_NONE || scanner->memo_lines == 0)
+    {
+        return 0;
+    }
+
+    buffer[0] = (char)scanner->memo_kind;
+    memcpy(buffer + 1, &scanner->memo_lines, sizeof(scanner->memo_lines));
+    return SCANNER_STATE_SIZE;
 }
 
 /**
  * @brief Deserialize scanner state
  *
- * Currently stateless, so nothing to deserialize.
+ * An empty buffer (the initial state, or a token without memo) clears the memo.
  */
 void tree_sitter_thalo_external_scanner_deserialize(void *payload,
                                                     const char *buffer,
                                                     unsigned length)
 {
-    (void)payload;
-    (void)buffer;
-    (void)length;
+    Scanner *scanner = (Scanner *)payload;
+    scanner->memo_kind = MEMO_NONE;
+    scanner->memo_lines = 0;
+
+    if (length == SCANNER_STATE_SIZE)
+    {
+        scanner->memo_kind = (uint8_t)buffer[0];
+        memcpy(&scanner->memo_lines, buffer + 1, sizeof(scanner->memo_lines));
+    }
 }
 
 /**
@@ -415,5 +540,27 @@ bool tree_sitter_thalo_external_scanner_scan(void *payload, TSLexer *lexer,
                                              const bool *valid_symbols)
 {
     Scanner *scanner = (Scanner *)payload;
-    return scan(scanner, lexer, valid_symbols);
+    scanner->advanced = 0;
+    scanner->marked = UINT32_MAX;
+    bool found = scan(scanner, lexer, valid_symbols);
+
+    if (stats_enabled)
+    {
+        thread_stats.scans++;
+        if (in_error_recovery(valid_symbols))
+        {
+            thread_stats.error_recovery++;
+        }
+        if (found)
+        {
+            thread_stats.tokens[lexer->result_symbol]++;
+        }
+        // Tree-sitter rewinds to the token end (the current position if it was never marked), or
+        // to the start if there is no token
+        uint32_t token_end = !found                       ? 0
+                             : scanner->marked == UINT32_MAX ? scanner->advanced
+                                                             : scanner->marked;
+        thread_stats.lookahead_chars += scanner->advanced - token_end;
+    }
+    return found;
 }
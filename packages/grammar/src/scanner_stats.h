@@ -0,0 +1,46 @@
+#ifndef TREE_SITTER_THALO_SCANNER_STATS_H_
+#define TREE_SITTER_THALO_SCANNER_STATS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Counters kept by the external scanner, per thread
+ *
+ * Collection is off by default and switched on per thread, so parsing without stats only pays
+ * for one thread-local flag check per scan. Totals only ever grow; measure a parse by reading
+ * them before and after it on the same thread.
+ */
+typedef struct
+{
+    // Calls to the external scanner
+    uint64_t scans;
+    // Calls that produced nothing because the parser was in error recovery
+    uint64_t error_recovery;
+    // Tokens produced, indexed by the scanner's TokenType (INDENT, CONTENT_BLANK, ERROR_SENTINEL)
+    uint64_t tokens[3];
+    // Tokens produced from the look-ahead memo, without scanning ahead again
+    uint64_t memo_hits;
+    // Characters read past the end of the produced token, or all characters read if none was
+    uint64_t lookahead_chars;
+} TSThaloScannerStats;
+
+/**
+ * @brief Start or stop collecting scanner stats on the calling thread
+ */
+void tree_sitter_thalo_scanner_stats_enable(bool enabled);
+
+/**
+ * @brief Read the calling thread's scanner totals
+ */
+void tree_sitter_thalo_scanner_stats_read(TSThaloScannerStats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_THALO_SCANNER_STATS_H_
@@ -36,7 +36,7 @@ export const serverCapabilities: ServerCapabilities = {
   // Document sync - full document sync for simplicity
   textDocumentSync: {
     openClose: true,
-    change: 2, // Full sync
+    change: 2, // Incremental sync
     save: {
       includeText: true,
     },
@@ -60,8 +60,8 @@ export const serverCapabilities: ServerCapabilities = {
   // Semantic tokens - syntax highlighting based on semantics
   semanticTokensProvider: {
     legend: tokenLegend,
-    full: true,
-    range: false,
+    full: { delta: true },
+    range: true,
   },
 
   // Workspace features - file operations for cross-file updates
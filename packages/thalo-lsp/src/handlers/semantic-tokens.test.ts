@@ -1,7 +1,13 @@
 import { describe, it, expect, beforeAll } from "vitest";
 import { TextDocument } from "vscode-languageserver-textdocument";
-import { initParser } from "@rejot-dev/thalo/node";
-import { handleSemanticTokens } from "./semantic-tokens.js";
+import { initParser, createWorkspace } from "@rejot-dev/thalo/node";
+import {
+  SemanticTokensCache,
+  handleSemanticTokens,
+  handleSemanticTokensDelta,
+  handleSemanticTokensFull,
+  handleSemanticTokensRange,
+} from "./semantic-tokens.js";
 
 // Initialize parser once for all tests
 beforeAll(async () => {
@@ -281,3 +287,88 @@ random text here
     });
   });
 });
+
+describe("semantic tokens with a cache", () => {
+  const uri = "file:///notes/test.thalo";
+  const path = "/notes/test.thalo";
+  const source = `2026-01-05T18:00Z create lore "First" ^first #tag
+  type: "fact"
+
+2026-01-05T19:00Z create lore "Second" ^second #tag
+  type: "insight"
+`;
+
+  it("returns the edits to the previous result after an edit", () => {
+    const workspace = createWorkspace();
+    workspace.updateDocument(path, source);
+    const cache = new SemanticTokensCache();
+    const full = handleSemanticTokensFull(cache, uri, workspace.getDocument(path)!);
+
+    const invalidation = workspace.applyEdit(path, 3, 31, 3, 31, "Renamed ");
+    cache.recordEdit(uri, invalidation.changedLines);
+    const delta = handleSemanticTokensDelta(
+      cache,
+      uri,
+      workspace.getDocument(path)!,
+      full.resultId!,
+    );
+
+    expect("edits" in delta).toBe(true);
+    const data = [...full.data];
+    if ("edits" in delta) {
+      for (const edit of delta.edits) {
+        data.splice(edit.start, edit.deleteCount, ...(edit.data ?? []));
+      }
+    }
+    const expected = handleSemanticTokens(
+      TextDocument.create(uri, "thalo", 2, workspace.getDocument(path)!.source),
+    );
+    expect(data).toEqual(expected.data);
+    expect(delta.resultId).not.toBe(full.resultId);
+  });
+
+  it("returns full tokens for an unknown result id", () => {
+    const workspace = createWorkspace();
+    workspace.updateDocument(path, source);
+    const cache = new SemanticTokensCache();
+
+    const result = handleSemanticTokensDelta(cache, uri, workspace.getDocument(path)!, "stale");
+
+    expect("data" in result).toBe(true);
+    expect(result.resultId).toBeDefined();
+  });
+
+  it("re-extracts everything after an edit without changed lines", () => {
+    const workspace = createWorkspace();
+    workspace.updateDocument(path, source);
+    const cache = new SemanticTokensCache();
+    handleSemanticTokensFull(cache, uri, workspace.getDocument(path)!);
+
+    workspace.updateDocument(path, source.replace("First", "Changed"));
+    cache.recordEdit(uri, undefined);
+    const result = handleSemanticTokensFull(cache, uri, workspace.getDocument(path)!);
+
+    const expected = handleSemanticTokens(
+      TextDocument.create(uri, "thalo", 2, source.replace("First", "Changed")),
+    );
+    expect(result.data).toEqual(expected.data);
+  });
+
+  it("returns only the tokens of the requested lines", () => {
+    const workspace = createWorkspace();
+    workspace.updateDocument(path, source);
+    const doc = workspace.getDocument(path)!;
+
+    const ranged = handleSemanticTokensRange(doc, {
+      start: { line: 3, character: 0 },
+      end: { line: 4, character: 0 },
+    });
+    const full = handleSemanticTokens(createDocument(source));
+
+    expect(ranged.data.length).toBeGreaterThan(0);
+    expect(ranged.data.length).toBeLessThan(full.data.length);
+    // The first token is on line 3, encoded relative to the start of the file
+    expect(ranged.data[0]).toBe(3);
+  });
+});
+
@@ -1,6 +1,15 @@
-import type { SemanticTokens } from "vscode-languageserver";
+import type { Range, SemanticTokens, SemanticTokensDelta } from "vscode-languageserver";
 import type { TextDocument } from "vscode-languageserver-textdocument";
-import { extractSemanticTokens, encodeSemanticTokens, type FileType } from "@rejot-dev/thalo";
+import {
+  extractSemanticTokens,
+  updateSemanticTokens,
+  encodeSemanticTokens,
+  diffSemanticTokens,
+  type ChangedLines,
+  type FileType,
+  type SemanticToken,
+  type SemanticTokensSource,
+} from "@rejot-dev/thalo";
 import { parseDocument } from "@rejot-dev/thalo/node";
 
 /**
@@ -16,6 +25,98 @@ function getFileType(uri: string): FileType {
   return "thalo";
 }
 
+/**
+ * Combine two consecutive line changes into one covering both.
+ */
+function composeChanges(first: ChangedLines, second: ChangedLines): ChangedLines {
+  // Work in the lines between the two edits: `first` produced them, `second` consumed them
+  const startLine = Math.min(first.startLine, second.startLine);
+  const endLine = Math.max(first.newEndLine, second.oldEndLine);
+  return {
+    startLine,
+    oldEndLine: endLine - (first.newEndLine - first.oldEndLine),
+    newEndLine: endLine + (second.newEndLine - second.oldEndLine),
+  };
+}
+
+/**
+ * The tokens last returned for a document.
+ */
+interface CachedTokens {
+  resultId: string;
+  tokens: SemanticToken[];
+  data: number[];
+  /** Lines changed since the tokens were extracted, or "all" if they must be re-extracted */
+  changes: ChangedLines | "all" | undefined;
+}
+
+/**
+ * Semantic tokens of open documents, by URI.
+ *
+ * Keeping the tokens last returned lets delta requests send only the edited part of the token
+ * array, and lets edits that report their changed lines re-extract only those entries.
+ */
+export class SemanticTokensCache {
+  private readonly entries = new Map<string, CachedTokens>();
+  private nextResultId = 1;
+
+  /**
+   * Record an edit to a document.
+   *
+   * @param uri - The document URI
+   * @param changed - The lines the edit changed, or undefined if it was not incremental
+   */
+  recordEdit(uri: string, changed: ChangedLines | undefined): void {
+    const entry = this.entries.get(uri);
+    if (!entry || entry.changes === "all") {
+      return;
+    }
+    if (!changed) {
+      entry.changes = "all";
+    } else {
+      entry.changes = entry.changes ? composeChanges(entry.changes, changed) : changed;
+    }
+  }
+
+  /**
+   * Forget the tokens of a document, e.g. when it is closed.
+   */
+  delete(uri: string): void {
+    this.entries.delete(uri);
+  }
+
+  /**
+   * Get the tokens of a document as last returned, if they are still cached.
+   */
+  get(uri: string): { resultId: string; data: number[] } | undefined {
+    return this.entries.get(uri);
+  }
+
+  /**
+   * Bring the tokens of a document up to date and give them a new result id.
+   */
+  refresh(uri: string, source: SemanticTokensSource): { resultId: string; data: number[] } {
+    const entry = this.entries.get(uri);
+    let tokens: SemanticToken[];
+    if (!entry || entry.changes === "all") {
+      tokens = extractSemanticTokens(source);
+    } else if (entry.changes) {
+      tokens = updateSemanticTokens(entry.tokens, source, entry.changes);
+    } else {
+      tokens = entry.tokens;
+    }
+
+    const updated: CachedTokens = {
+      resultId: String(this.nextResultId++),
+      tokens,
+      data: entry && tokens === entry.tokens ? entry.data : encodeSemanticTokens(tokens),
+      changes: undefined,
+    };
+    this.entries.set(uri, updated);
+    return updated;
+  }
+}
+
 /**
  * Handle textDocument/semanticTokens/full request
  *
@@ -46,3 +147,79 @@ export function handleSemanticTokens(document: TextDocument): SemanticTokens {
     return { data: [] };
   }
 }
+
+/**
+ * Handle textDocument/semanticTokens/full for a document whose tokens are cached
+ *
+ * @param cache - The semantic tokens cache
+ * @param uri - The document URI
+ * @param source - The document's current parsed blocks
+ * @returns Semantic tokens in LSP format, with a result id for later delta requests
+ */
+export function handleSemanticTokensFull(
+  cache: SemanticTokensCache,
+  uri: string,
+  source: SemanticTokensSource,
+): SemanticTokens {
+  try {
+    return cache.refresh(uri, source);
+  } catch (error) {
+    console.error(`[thalo-lsp] Error extracting semantic tokens:`, error);
+    cache.delete(uri);
+    return { data: [] };
+  }
+}
+
+/**
+ * Handle textDocument/semanticTokens/full/delta request
+ *
+ * Returns the edits from the tokens returned as `previousResultId` to the current ones, or
+ * the full tokens if those are no longer cached.
+ *
+ * @param cache - The semantic tokens cache
+ * @param uri - The document URI
+ * @param source - The document's current parsed blocks
+ * @param previousResultId - The result id of the tokens the client has
+ * @returns Semantic token edits, or semantic tokens
+ */
+export function handleSemanticTokensDelta(
+  cache: SemanticTokensCache,
+  uri: string,
+  source: SemanticTokensSource,
+  previousResultId: string,
+): SemanticTokens | SemanticTokensDelta {
+  const previous = cache.get(uri);
+  const current = handleSemanticTokensFull(cache, uri, source);
+  if (!previous || previous.resultId !== previousResultId || current.resultId === undefined) {
+    return current;
+  }
+  return {
+    resultId: current.resultId,
+    edits: diffSemanticTokens(previous.data, current.data),
+  };
+}
+
+/**
+ * Handle textDocument/semanticTokens/range request
+ *
+ * Only the part of the tree covering the range's lines is walked.
+ *
+ * @param source - The document's parsed blocks
+ * @param range - The requested range
+ * @returns Semantic tokens starting on the range's lines, in LSP format
+ */
+export function handleSemanticTokensRange(
+  source: SemanticTokensSource,
+  range: Range,
+): SemanticTokens {
+  try {
+    const tokens = extractSemanticTokens(source, {
+      startLine: range.start.line,
+      endLine: range.end.line,
+    });
+    return { data: encodeSemanticTokens(tokens) };
+  } catch (error) {
+    console.error(`[thalo-lsp] Error extracting semantic tokens:`, error);
+    return { data: [] };
+  }
+}
@@ -29,12 +29,12 @@ describe("thalo-lsp", () => {
     it("should enable semantic tokens provider", () => {
       expect(serverCapabilities.semanticTokensProvider).toBeDefined();
       const provider = serverCapabilities.semanticTokensProvider as {
-        full: boolean;
+        full: { delta: boolean };
         range: boolean;
         legend: typeof tokenLegend;
       };
-      expect(provider.full).toBe(true);
-      expect(provider.range).toBe(false);
+      expect(provider.full.delta).toBe(true);
+      expect(provider.range).toBe(true);
     });
 
     it("should enable file operations for thalo and markdown files", () => {
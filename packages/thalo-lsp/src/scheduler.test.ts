@@ -0,0 +1,146 @@
+import { describe, it, expect } from "vitest";
+import { Scheduler, type Timing } from "./scheduler.js";
+
+/**
+ * A scheduler with a manual clock and event loop: `turn()` runs one deferred slice.
+ */
+function createTestScheduler(sliceMs = 10) {
+  let time = 0;
+  const deferred: (() => void)[] = [];
+  const timings: Timing[] = [];
+  const scheduler = new Scheduler({
+    sliceMs,
+    now: () => time,
+    defer: (callback) => deferred.push(callback),
+    onTiming: (timing) => timings.push(timing),
+  });
+  return {
+    scheduler,
+    timings,
+    advance: (ms: number) => {
+      time += ms;
+    },
+    turn: () => {
+      deferred.shift()?.();
+    },
+  };
+}
+
+describe("Scheduler", () => {
+  it("runs foreground jobs before background ones", () => {
+    const { scheduler, turn } = createTestScheduler();
+    const order: string[] = [];
+    scheduler.schedule("a", "background", () => void order.push("background"));
+    scheduler.schedule("b", "foreground", () => void order.push("foreground"));
+
+    expect(order).toEqual([]);
+    turn();
+    expect(order).toEqual(["foreground", "background"]);
+    expect(scheduler.pending).toBe(0);
+  });
+
+  it("yields to the event loop once a slice is used up", () => {
+    const { scheduler, advance, turn, timings } = createTestScheduler(10);
+    let steps = 0;
+    scheduler.schedule("load", "background", function* () {
+      for (let i = 0; i < 5; i++) {
+        steps++;
+        advance(4);
+        yield;
+      }
+    });
+
+    turn();
+    expect(steps).toBe(3);
+    // A job queued meanwhile, e.g. by an edit, runs at the start of the next slice
+    let ranFirst = false;
+    scheduler.schedule("diagnostics", "foreground", () => {
+      ranFirst = steps === 3;
+    });
+    turn();
+    expect(ranFirst).toBe(true);
+    expect(steps).toBe(5);
+    expect(timings.find((t) => t.name === "load")).toMatchObject({
+      durationMs: 20,
+      cancelled: false,
+    });
+  });
+
+  it("replaces a queued job with the same key", () => {
+    const { scheduler, turn, timings } = createTestScheduler();
+    const runs: number[] = [];
+    scheduler.schedule("diagnostics", "background", () => void runs.push(1), "doc");
+    scheduler.schedule("diagnostics", "background", () => void runs.push(2), "doc");
+
+    turn();
+    expect(runs).toEqual([2]);
+    expect(timings.map((t) => t.cancelled)).toEqual([true, false]);
+  });
+
+  it("abandons a started job when it is cancelled", () => {
+    const { scheduler, advance, turn } = createTestScheduler(10);
+    let closed = false;
+    let steps = 0;
+    scheduler.schedule(
+      "load",
+      "background",
+      function* () {
+        try {
+          for (;;) {
+            steps++;
+            advance(10);
+            yield;
+          }
+        } finally {
+          closed = true;
+        }
+      },
+      "load",
+    );
+
+    turn();
+    expect(scheduler.cancel("load")).toBe(true);
+    expect(closed).toBe(true);
+    turn();
+    expect(steps).toBe(1);
+    expect(scheduler.cancel("load")).toBe(false);
+  });
+
+  it("answers cancelled requests without running them", () => {
+    const { scheduler, timings } = createTestScheduler();
+    const live = { isCancellationRequested: false };
+    const cancelledToken = { isCancellationRequested: true };
+    const cancelled = () => "cancelled";
+    let runs = 0;
+    const handler = () => ++runs;
+
+    expect(scheduler.request("hover", live, handler, cancelled)).toBe(1);
+    expect(scheduler.request("hover", cancelledToken, handler, cancelled)).toBe("cancelled");
+    expect(runs).toBe(1);
+    expect(timings.map((t) => [t.name, t.cancelled])).toEqual([
+      ["hover", false],
+      ["hover", true],
+    ]);
+  });
+
+  it("keeps running jobs after one throws", async () => {
+    const { scheduler, turn } = createTestScheduler();
+    let ran = false;
+    const error = console.error;
+    console.error = () => {};
+    try {
+      scheduler.schedule("broken", "foreground", () => {
+        throw new Error("boom");
+      });
+      scheduler.schedule("next", "foreground", () => {
+        ran = true;
+      });
+      const idle = scheduler.whenIdle();
+      turn();
+      await idle;
+    } finally {
+      console.error = error;
+    }
+    expect(ran).toBe(true);
+  });
+});
@@ -0,0 +1,252 @@
+/**
+ * Cooperative scheduling of the server's work.
+ *
+ * Request handlers (hover, completion, ...) run as soon as their message arrives. Work the server
+ * does on its own, such as publishing diagnostics after an edit or loading the workspace, is
+ * queued here instead and run in slices of a few milliseconds, yielding to the event loop in
+ * between, so a request never waits for more than one slice. Foreground jobs run before
+ * background ones. A job can be a generator that yields between units of work; scheduling a job
+ * under the key of a pending one replaces it, so superseded runs are dropped.
+ */
+
+export type JobPriority = "foreground" | "background";
+
+/**
+ * A job's work: a function, or a generator function that yields between units of work.
+ */
+export type JobWork = () => Iterator<unknown> | void;
+
+/**
+ * How long a request handler or job took.
+ */
+export interface Timing {
+  /** Handler or job name, e.g. "hover" or "diagnostics" */
+  name: string;
+  /** Time spent running, not counting time other work ran in between */
+  durationMs: number;
+  /** For jobs, time from being scheduled to finishing or being cancelled */
+  latencyMs?: number;
+  /** Whether it was cancelled or superseded instead of running to the end */
+  cancelled: boolean;
+}
+
+/**
+ * The part of an LSP `CancellationToken` the scheduler reads.
+ */
+export interface CancellationTokenLike {
+  readonly isCancellationRequested: boolean;
+}
+
+export interface SchedulerOptions {
+  /** Longest time to run jobs before yielding to the event loop (default 10ms) */
+  sliceMs?: number;
+  /** Called with the timing of every request handler and job */
+  onTiming?: (timing: Timing) => void;
+  /** Clock in milliseconds (default `performance.now`) */
+  now?: () => number;
+  /** Run a callback after pending I/O (default `setImmediate`) */
+  defer?: (callback: () => void) => void;
+}
+
+const DEFAULT_SLICE_MS = 10;
+
+interface Job {
+  name: string;
+  key: string | undefined;
+  priority: JobPriority;
+  work: JobWork;
+  iterator: Iterator<unknown> | undefined;
+  scheduledAt: number;
+  durationMs: number;
+}
+
+export class Scheduler {
+  private readonly sliceMs: number;
+  private readonly onTiming: ((timing: Timing) => void) | undefined;
+  private readonly now: () => number;
+  private readonly defer: (callback: () => void) => void;
+  private readonly queues: Record<JobPriority, Job[]> = { foreground: [], background: [] };
+  private readonly keyed = new Map<string, Job>();
+  private sliceScheduled = false;
+  private running: Job | undefined;
+  private idleWaiters: (() => void)[] = [];
+
+  constructor(options: SchedulerOptions = {}) {
+    this.sliceMs = options.sliceMs ?? DEFAULT_SLICE_MS;
+    this.onTiming = options.onTiming;
+    this.now = options.now ?? (() => performance.now());
+    this.defer = options.defer ?? ((callback) => setImmediate(callback));
+  }
+
+  /** Number of jobs waiting or in progress. */
+  get pending(): number {
+    return this.queues.foreground.length + this.queues.background.length;
+  }
+
+  /**
+   * Queue a job. With a `key`, a pending job with the same key is cancelled first.
+   */
+  schedule(name: string, priority: JobPriority, work: JobWork, key?: string): void {
+    if (key !== undefined) {
+      this.cancel(key);
+    }
+    const job: Job = {
+      name,
+      key,
+      priority,
+      work,
+      iterator: undefined,
+      scheduledAt: this.now(),
+      durationMs: 0,
+    };
+    this.queues[priority].push(job);
+    if (key !== undefined) {
+      this.keyed.set(key, job);
+    }
+    this.requestSlice();
+  }
+
+  /**
+   * Cancel the pending job with this key, if any. A job already started is abandoned at its
+   * next yield.
+   *
+   * @returns Whether a job was cancelled
+   */
+  cancel(key: string): boolean {
+    const job = this.keyed.get(key);
+    if (!job) {
+      return false;
+    }
+    this.remove(job);
+    // A job cancelling itself is closed once its step returns
+    if (job !== this.running) {
+      job.iterator?.return?.();
+    }
+    this.report(job, true);
+    return true;
+  }
+
+  /**
+   * Run a request handler now and time it, or return `cancelled()` without running it if the
+   * client already cancelled the request (`$/cancelRequest`).
+   */
+  request<T, C>(
+    name: string,
+    token: CancellationTokenLike,
+    handler: () => T,
+    cancelled: () => C,
+  ): T | C {
+    if (token.isCancellationRequested) {
+      this.onTiming?.({ name, durationMs: 0, cancelled: true });
+      return cancelled();
+    }
+    const start = this.now();
+    try {
+      return handler();
+    } finally {
+      this.onTiming?.({ name, durationMs: this.now() - start, cancelled: false });
+    }
+  }
+
+  /**
+   * Resolve once no jobs are pending.
+   */
+  whenIdle(): Promise<void> {
+    if (this.pending === 0) {
+      return Promise.resolve();
+    }
+    return new Promise((resolve) => this.idleWaiters.push(resolve));
+  }
+
+  private requestSlice(): void {
+    if (!this.sliceScheduled) {
+      this.sliceScheduled = true;
+      this.defer(() => this.runSlice());
+    }
+  }
+
+  private runSlice(): void {
+    this.sliceScheduled = false;
+    const deadline = this.now() + this.sliceMs;
+
+    let job: Job | undefined;
+    while ((job = this.queues.foreground[0] ?? this.queues.background[0])) {
+      const start = this.now();
+      let finished: boolean;
+      this.running = job;
+      try {
+        finished = this.step(job);
+      } catch (error) {
+        console.error(`[thalo-lsp] Error in ${job.name}:`, error);
+        finished = true;
+      } finally {
+        this.running = undefined;
+      }
+      const end = this.now();
+      job.durationMs += end - start;
+
+      // A step may have cancelled its own job, e.g. by scheduling its replacement
+      if (finished && this.remove(job)) {
+        this.report(job, false);
+      } else if (!finished && !this.queues[job.priority].includes(job)) {
+        job.iterator?.return?.();
+      }
+      if (end >= deadline) {
+        break;
+      }
+    }
+
+    if (this.pending > 0) {
+      this.requestSlice();
+    } else {
+      const waiters = this.idleWaiters;
+      this.idleWaiters = [];
+      for (const resolve of waiters) {
+        resolve();
+      }
+    }
+  }
+
+  /**
+   * Run one unit of a job's work.
+   *
+   * @returns Whether the job is done
+   */
+  private step(job: Job): boolean {
+    if (!job.iterator) {
+      const iterator = job.work();
+      if (!iterator) {
+        return true;
+      }
+      job.iterator = iterator;
+    }
+    return job.iterator.next().done === true;
+  }
+
+  /**
+   * Take a job out of its queue.
+   *
+   * @returns Whether it was still queued
+   */
+  private remove(job: Job): boolean {
+    const queue = this.queues[job.priority];
+    const index = queue.indexOf(job);
+    if (index === -1) {
+      return false;
+    }
+    queue.splice(index, 1);
+    if (job.key !== undefined && this.keyed.get(job.key) === job) {
+      this.keyed.delete(job.key);
+    }
+    return true;
+  }
+
+  private report(job: Job, cancelled: boolean): void {
+    this.onTiming?.({
+      name: job.name,
+      durationMs: job.durationMs,
+      latencyMs: this.now() - job.scheduledAt,
+      cancelled,
+    });
+  }
+}
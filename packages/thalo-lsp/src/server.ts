@@ -8,18 +8,34 @@ import {
   type Connection,
   DidChangeConfigurationNotification,
   FileChangeType,
+  LSPErrorCodes,
+  ResponseError,
+  type CancellationToken,
+  type TextDocumentContentChangeEvent,
 } from "vscode-languageserver/node.js";
 import { TextDocument } from "vscode-languageserver-textdocument";
-import type { FileType } from "@rejot-dev/thalo";
-import { initParser, createWorkspace, Workspace } from "@rejot-dev/thalo/node";
+import type { FileType, InvalidationResult, SemanticTokensSource } from "@rejot-dev/thalo";
+import { initParser, createWorkspace, parseDocument, Workspace } from "@rejot-dev/thalo/node";
 
 import { serverCapabilities, tokenLegend } from "./capabilities.js";
 import { handleDefinition } from "./handlers/definition.js";
 import { handleReferences } from "./handlers/references.js";
-import { handleSemanticTokens } from "./handlers/semantic-tokens.js";
+import {
+  SemanticTokensCache,
+  handleSemanticTokensDelta,
+  handleSemanticTokensFull,
+  handleSemanticTokensRange,
+} from "./handlers/semantic-tokens.js";
 import { getDiagnostics } from "./handlers/diagnostics.js";
 import { handleHover } from "./handlers/hover.js";
 import { handleCompletion, handleCompletionResolve } from "./handlers/completions/completions.js";
+import { Scheduler, type JobPriority } from "./scheduler.js";
+
+/**
+ * Set THALO_LSP_CHECK_SYNC=1 to check after each edit that the workspace copy of the document
+ * equals the client's text. Costs a full text comparison per edit.
+ */
+const CHECK_SYNC = process.env["THALO_LSP_CHECK_SYNC"] === "1";
 
 /**
  * Server state
@@ -29,22 +45,45 @@ interface ServerState {
   workspace: Workspace;
   /** Text documents managed by the server */
   documents: Map<string, TextDocument>;
+  /**
+   * For each open file, the client version its workspace copy matches. Code that writes the
+   * workspace copy of a file from anywhere else removes its entry.
+   */
+  syncedVersions: Map<string, number>;
   /** The LSP connection */
   connection: Connection;
   /** Workspace folder paths (file system paths, not URIs) */
   workspaceFolders: string[];
+  /** Semantic tokens last sent for open documents */
+  semanticTokens: SemanticTokensCache;
+  /** Runs diagnostics and workspace loading between requests */
+  scheduler: Scheduler;
+  /** Whether to send handler timings as telemetry events (`timingTelemetry` init option) */
+  timingTelemetry: boolean;
 }
 
 /**
  * Create the initial server state
  */
 function createServerState(connection: Connection): ServerState {
-  return {
-    workspace: createWorkspace(),
+  const state: ServerState = {
+    // Files that are not open keep no trees; open documents are edited with theirs
+    workspace: createWorkspace({ treeRetention: "release" }),
     documents: new Map(),
+    syncedVersions: new Map(),
     connection,
     workspaceFolders: [],
+    semanticTokens: new SemanticTokensCache(),
+    scheduler: new Scheduler({
+      onTiming: (timing) => {
+        if (state.timingTelemetry) {
+          connection.telemetry.logEvent({ type: "timing", ...timing });
+        }
+      },
+    }),
+    timingTelemetry: false,
   };
+  return state;
 }
 
 /**
@@ -109,8 +148,11 @@ function collectThaloFiles(dir: string): string[] {
 /**
  * Load all thalo files from the workspace folders into the workspace.
  * This ensures cross-file features work correctly even for files not yet opened.
+ *
+ * Yields after each file, so it can run as a background job; once done, refreshes the
+ * diagnostics of documents opened while it ran.
  */
-function loadWorkspaceFiles(state: ServerState): void {
+function* loadWorkspaceFiles(state: ServerState): Generator<void> {
   for (const folder of state.workspaceFolders) {
     const files = collectThaloFiles(folder);
 
@@ -129,10 +171,15 @@ function loadWorkspaceFiles(state: ServerState): void {
           `[thalo-lsp] Error loading ${file}: ${err instanceof Error ? err.message : err}`,
         );
       }
+      yield;
     }
 
     console.error(`[thalo-lsp] Loaded ${files.length} files from ${folder}`);
   }
+
+  for (const doc of state.documents.values()) {
+    scheduleDiagnostics(state, doc, "background");
+  }
 }
 
 /**
@@ -165,9 +212,33 @@ function publishDiagnosticsForDocument(state: ServerState, doc: TextDocument): v
   }
 }
 
+function diagnosticsKey(uri: string): string {
+  return `diagnostics:${uri}`;
+}
+
+/**
+ * Queue publishing a document's diagnostics, replacing a run queued for it earlier. The run
+ * checks the document as it is when the run starts, and is skipped if it was closed by then.
+ */
+function scheduleDiagnostics(state: ServerState, doc: TextDocument, priority: JobPriority): void {
+  const { uri } = doc;
+  state.scheduler.schedule(
+    "diagnostics",
+    priority,
+    () => {
+      const current = state.documents.get(uri);
+      if (current) {
+        publishDiagnosticsForDocument(state, current);
+      }
+    },
+    diagnosticsKey(uri),
+  );
+}
+
 /**
  * Refresh diagnostics for specific files based on invalidation result.
- * Only refreshes open documents that are in the affected files list.
+ * Only refreshes open documents that are in the affected files list; the changed file comes
+ * first and the others run in the background.
  */
 function refreshDiagnosticsForFiles(
   state: ServerState,
@@ -179,21 +250,146 @@ function refreshDiagnosticsForFiles(
   // Always refresh the changed file
   for (const doc of state.documents.values()) {
     const docPath = uriToPath(doc.uri);
-    if (docPath === changedFile || affectedSet.has(docPath)) {
-      publishDiagnosticsForDocument(state, doc);
+    if (docPath === changedFile) {
+      scheduleDiagnostics(state, doc, "foreground");
+    } else if (affectedSet.has(docPath)) {
+      scheduleDiagnostics(state, doc, "background");
+    }
+  }
+}
+
+/**
+ * Refresh diagnostics of the open documents among `affectedFiles` in the background.
+ */
+function refreshAffectedDocuments(state: ServerState, affectedFiles: string[]): void {
+  if (affectedFiles.length === 0) {
+    return;
+  }
+  const affectedSet = new Set(affectedFiles);
+  for (const doc of state.documents.values()) {
+    if (affectedSet.has(uriToPath(doc.uri))) {
+      scheduleDiagnostics(state, doc, "background");
     }
   }
 }
 
+/**
+ * Run a request handler through the scheduler, answering `RequestCancelled` if the client
+ * cancelled the request before it ran.
+ */
+function serve<T>(
+  state: ServerState,
+  name: string,
+  token: CancellationToken,
+  handler: () => T,
+): T | ResponseError<void> {
+  return state.scheduler.request(
+    name,
+    token,
+    handler,
+    () => new ResponseError<void>(LSPErrorCodes.RequestCancelled, "Request cancelled"),
+  );
+}
+
+/**
+ * Combine the invalidation results of several edits to one file.
+ */
+function mergeInvalidations(a: InvalidationResult, b: InvalidationResult): InvalidationResult {
+  return {
+    affectedFiles: Array.from(new Set([...a.affectedFiles, ...b.affectedFiles])),
+    schemasChanged: a.schemasChanged || b.schemasChanged,
+    linksChanged: a.linksChanged || b.linksChanged,
+    changedEntityNames: [...a.changedEntityNames, ...b.changedEntityNames],
+    changedLinkIds: [...a.changedLinkIds, ...b.changedLinkIds],
+  };
+}
+
+/**
+ * Apply a document's content changes to its workspace copy, incrementally where the client
+ * sent ranges and the copy was in sync with `previousVersion`, and record them for semantic
+ * tokens.
+ */
+function applyContentChanges(
+  state: ServerState,
+  doc: TextDocument,
+  changes: readonly TextDocumentContentChangeEvent[] | undefined,
+  previousVersion: number | undefined,
+): InvalidationResult {
+  const filePath = uriToPath(doc.uri);
+  const workspaceDoc = state.workspace.getDocument(filePath);
+  const inSync =
+    previousVersion !== undefined && state.syncedVersions.get(filePath) === previousVersion;
+  state.syncedVersions.delete(filePath);
+  if (!changes || !workspaceDoc || !inSync || !changes.every((change) => "range" in change)) {
+    state.semanticTokens.recordEdit(doc.uri, undefined);
+    const result = state.workspace.updateDocument(filePath, doc.getText());
+    state.syncedVersions.set(filePath, doc.version);
+    return result;
+  }
+
+  let invalidation: InvalidationResult | undefined;
+  for (const change of changes) {
+    if (!("range" in change)) {
+      continue;
+    }
+    const { start, end } = change.range;
+    const result = state.workspace.applyEdit(
+      filePath,
+      start.line,
+      start.character,
+      end.line,
+      end.character,
+      change.text,
+    );
+    state.semanticTokens.recordEdit(doc.uri, result.changedLines);
+    invalidation = invalidation ? mergeInvalidations(invalidation, result) : result;
+  }
+
+  // The edits leave the workspace copy equal to the client's text. Comparing the two flattens
+  // the rope, so it is only done when asked for.
+  if (!invalidation || (CHECK_SYNC && workspaceDoc.text.toString() !== doc.getText())) {
+    if (invalidation) {
+      console.error(`[thalo-lsp] Workspace copy out of sync after edits: ${doc.uri}`);
+    }
+    state.semanticTokens.recordEdit(doc.uri, undefined);
+    const result = state.workspace.updateDocument(filePath, doc.getText());
+    invalidation = invalidation ? mergeInvalidations(invalidation, result) : result;
+  }
+  state.syncedVersions.set(filePath, doc.version);
+  return invalidation;
+}
+
+/**
+ * Get the parsed blocks to extract a document's semantic tokens from: the workspace copy if
+ * it is in sync with the client's text, or a fresh parse otherwise.
+ */
+function getTokensSource(state: ServerState, doc: TextDocument): SemanticTokensSource {
+  const filePath = uriToPath(doc.uri);
+  const workspaceDoc = state.workspace.getDocument(filePath);
+  if (workspaceDoc && state.syncedVersions.get(filePath) === doc.version) {
+    return workspaceDoc;
+  }
+  state.semanticTokens.recordEdit(doc.uri, undefined);
+  return parseDocument(doc.getText(), { fileType: getFileType(doc.uri), filename: doc.uri });
+}
+
 /**
  * Update a document in the workspace and publish diagnostics
+ *
+ * @param changes - The changes the client sent, if known, to apply incrementally
+ * @param previousVersion - The version of the document the changes were made to
  */
-function updateDocument(state: ServerState, doc: TextDocument): void {
+function updateDocument(
+  state: ServerState,
+  doc: TextDocument,
+  changes?: readonly TextDocumentContentChangeEvent[],
+  previousVersion?: number,
+): void {
   const filePath = uriToPath(doc.uri);
 
   try {
-    // Use the new updateDocument method which returns affected files
-    const invalidation = state.workspace.updateDocument(filePath, doc.getText());
+    // Apply the changes and find out which files they affect
+    const invalidation = applyContentChanges(state, doc, changes, previousVersion);
 
     // Refresh diagnostics for affected files only (more efficient)
     if (invalidation.schemasChanged || invalidation.linksChanged) {
@@ -201,11 +397,13 @@ function updateDocument(state: ServerState, doc: TextDocument): void {
       refreshDiagnosticsForFiles(state, invalidation.affectedFiles, filePath);
     } else {
       // Only the changed file is affected
-      publishDiagnosticsForDocument(state, doc);
+      scheduleDiagnostics(state, doc, "foreground");
     }
   } catch (error) {
     // Log parse errors but don't crash
     console.error(`[thalo-lsp] Parse error in ${filePath}:`, error);
+    state.semanticTokens.recordEdit(doc.uri, undefined);
+    state.scheduler.cancel(diagnosticsKey(doc.uri));
 
     // Send a parse error diagnostic for the changed document
     state.connection.sendDiagnostics({
@@ -250,6 +448,8 @@ export function startServer(connection: Connection = createConnection()): void {
     } else if (params.rootUri) {
       state.workspaceFolders = [uriToPath(params.rootUri)];
     }
+    const initOptions = params.initializationOptions as { timingTelemetry?: boolean } | undefined;
+    state.timingTelemetry = initOptions?.timingTelemetry === true;
 
     return {
       capabilities: serverCapabilities,
@@ -266,8 +466,9 @@ export function startServer(connection: Connection = createConnection()): void {
     // Register for configuration changes
     connection.client.register(DidChangeConfigurationNotification.type, undefined);
 
-    // Load all workspace files for cross-file features (entity definitions, links, etc.)
-    loadWorkspaceFiles(state);
+    // Load all workspace files for cross-file features (entity definitions, links, etc.),
+    // between requests so the editor stays responsive while a large workspace loads
+    state.scheduler.schedule("load-workspace", "background", () => loadWorkspaceFiles(state));
   });
 
   // Document lifecycle
@@ -289,13 +490,15 @@ export function startServer(connection: Connection = createConnection()): void {
     if (doc) {
       const updated = TextDocument.update(doc, params.contentChanges, params.textDocument.version);
       state.documents.set(params.textDocument.uri, updated);
-      updateDocument(state, updated);
+      updateDocument(state, updated, params.contentChanges, doc.version);
     }
   });
 
   connection.onDidCloseTextDocument((params) => {
     state.documents.delete(params.textDocument.uri);
+    state.semanticTokens.delete(params.textDocument.uri);
     const filePath = uriToPath(params.textDocument.uri);
+    state.syncedVersions.delete(filePath);
 
     // Reload from disk to pick up saved changes and keep cross-file features working
     try {
@@ -313,6 +516,7 @@ export function startServer(connection: Connection = createConnection()): void {
     }
 
     // Clear diagnostics for closed document (not actively editing it)
+    state.scheduler.cancel(diagnosticsKey(params.textDocument.uri));
     connection.sendDiagnostics({
       uri: params.textDocument.uri,
       diagnostics: [],
@@ -340,8 +544,10 @@ export function startServer(connection: Connection = createConnection()): void {
         const affected = state.workspace.getAffectedFiles(filePath);
         allAffectedFiles.push(...affected);
         state.workspace.removeDocument(filePath);
+        state.syncedVersions.delete(filePath);
         state.documents.delete(change.uri);
         // Clear diagnostics for the deleted file
+        state.scheduler.cancel(diagnosticsKey(change.uri));
         connection.sendDiagnostics({ uri: change.uri, diagnostics: [] });
         console.error(`[thalo-lsp] Removed deleted file: ${filePath}`);
         continue;
@@ -374,14 +580,7 @@ export function startServer(connection: Connection = createConnection()): void {
     }
 
     // Refresh diagnostics only for affected open documents
-    if (allAffectedFiles.length > 0) {
-      const affectedSet = new Set(allAffectedFiles);
-      for (const doc of state.documents.values()) {
-        if (affectedSet.has(uriToPath(doc.uri))) {
-          publishDiagnosticsForDocument(state, doc);
-        }
-      }
-    }
+    refreshAffectedDocuments(state, allAffectedFiles);
   });
 
   // File operation notifications - handles user-initiated file operations in the editor
@@ -401,6 +600,7 @@ export function startServer(connection: Connection = createConnection()): void {
         if (fs.existsSync(filePath)) {
           const source = fs.readFileSync(filePath, "utf-8");
           const invalidation = state.workspace.updateDocument(filePath, source);
+          state.syncedVersions.delete(filePath);
           allAffectedFiles.push(...invalidation.affectedFiles);
           console.error(`[thalo-lsp] Loaded created file: ${filePath}`);
         }
@@ -412,14 +612,7 @@ export function startServer(connection: Connection = createConnection()): void {
     }
 
     // Refresh diagnostics for affected files
-    if (allAffectedFiles.length > 0) {
-      const affectedSet = new Set(allAffectedFiles);
-      for (const doc of state.documents.values()) {
-        if (affectedSet.has(uriToPath(doc.uri))) {
-          publishDiagnosticsForDocument(state, doc);
-        }
-      }
-    }
+    refreshAffectedDocuments(state, allAffectedFiles);
   });
 
   connection.workspace.onDidDeleteFiles((params) => {
@@ -437,18 +630,12 @@ export function startServer(connection: Connection = createConnection()): void {
       const affected = state.workspace.getAffectedFiles(filePath);
       allAffectedFiles.push(...affected);
       state.workspace.removeDocument(filePath);
+      state.syncedVersions.delete(filePath);
       console.error(`[thalo-lsp] Removed file: ${filePath}`);
     }
 
     // Refresh diagnostics for affected files
-    if (allAffectedFiles.length > 0) {
-      const affectedSet = new Set(allAffectedFiles);
-      for (const doc of state.documents.values()) {
-        if (affectedSet.has(uriToPath(doc.uri))) {
-          publishDiagnosticsForDocument(state, doc);
-        }
-      }
-    }
+    refreshAffectedDocuments(state, allAffectedFiles);
   });
 
   connection.workspace.onDidRenameFiles((params) => {
@@ -467,6 +654,7 @@ export function startServer(connection: Connection = createConnection()): void {
         const affected = state.workspace.getAffectedFiles(oldPath);
         allAffectedFiles.push(...affected);
         state.workspace.removeDocument(oldPath);
+        state.syncedVersions.delete(oldPath);
         console.error(`[thalo-lsp] Removed renamed file: ${oldPath}`);
       }
 
@@ -476,6 +664,7 @@ export function startServer(connection: Connection = createConnection()): void {
           if (fs.existsSync(newPath)) {
             const source = fs.readFileSync(newPath, "utf-8");
             const invalidation = state.workspace.updateDocument(newPath, source);
+            state.syncedVersions.delete(newPath);
             allAffectedFiles.push(...invalidation.affectedFiles);
             console.error(`[thalo-lsp] Loaded renamed file: ${newPath}`);
           }
@@ -488,70 +677,102 @@ export function startServer(connection: Connection = createConnection()): void {
     }
 
     // Refresh diagnostics for affected files
-    if (allAffectedFiles.length > 0) {
-      const affectedSet = new Set(allAffectedFiles);
-      for (const doc of state.documents.values()) {
-        if (affectedSet.has(uriToPath(doc.uri))) {
-          publishDiagnosticsForDocument(state, doc);
-        }
-      }
-    }
+    refreshAffectedDocuments(state, allAffectedFiles);
   });
 
   // Go to Definition
-  connection.onDefinition((params) => {
-    const doc = state.documents.get(params.textDocument.uri);
-    if (!doc) {
-      return null;
-    }
+  connection.onDefinition((params, token) =>
+    serve(state, "definition", token, () => {
+      const doc = state.documents.get(params.textDocument.uri);
+      if (!doc) {
+        return null;
+      }
 
-    return handleDefinition(state.workspace, doc, params.position);
-  });
+      return handleDefinition(state.workspace, doc, params.position);
+    }),
+  );
 
   // Find All References
-  connection.onReferences((params) => {
-    const doc = state.documents.get(params.textDocument.uri);
-    if (!doc) {
-      return null;
-    }
+  connection.onReferences((params, token) =>
+    serve(state, "references", token, () => {
+      const doc = state.documents.get(params.textDocument.uri);
+      if (!doc) {
+        return null;
+      }
 
-    return handleReferences(state.workspace, doc, params.position, params.context);
-  });
+      return handleReferences(state.workspace, doc, params.position, params.context);
+    }),
+  );
 
   // Hover
-  connection.onHover((params) => {
-    const doc = state.documents.get(params.textDocument.uri);
-    if (!doc) {
-      return null;
-    }
+  connection.onHover((params, token) =>
+    serve(state, "hover", token, () => {
+      const doc = state.documents.get(params.textDocument.uri);
+      if (!doc) {
+        return null;
+      }
 
-    return handleHover(state.workspace, doc, params.position);
-  });
+      return handleHover(state.workspace, doc, params.position);
+    }),
+  );
 
   // Completion
-  connection.onCompletion((params) => {
-    const doc = state.documents.get(params.textDocument.uri);
-    if (!doc) {
-      return [];
-    }
+  connection.onCompletion((params, token) =>
+    serve(state, "completion", token, () => {
+      const doc = state.documents.get(params.textDocument.uri);
+      if (!doc) {
+        return [];
+      }
 
-    return handleCompletion(state.workspace, doc, params);
-  });
+      return handleCompletion(state.workspace, doc, params);
+    }),
+  );
 
   // Completion resolve
-  connection.onCompletionResolve((item) => {
-    return handleCompletionResolve(item);
-  });
+  connection.onCompletionResolve((item, token) =>
+    serve(state, "completionResolve", token, () => handleCompletionResolve(item)),
+  );
 
   // Semantic Tokens (full)
-  connection.onRequest("textDocument/semanticTokens/full", (params) => {
-    const doc = state.documents.get(params.textDocument.uri);
-    if (!doc) {
-      return { data: [] };
-    }
+  connection.onRequest("textDocument/semanticTokens/full", (params, token) =>
+    serve(state, "semanticTokens/full", token, () => {
+      const doc = state.documents.get(params.textDocument.uri);
+      if (!doc) {
+        return { data: [] };
+      }
 
-    return handleSemanticTokens(doc);
-  });
+      return handleSemanticTokensFull(state.semanticTokens, doc.uri, getTokensSource(state, doc));
+    }),
+  );
+
+  // Semantic Tokens (delta against a previous full or delta result)
+  connection.onRequest("textDocument/semanticTokens/full/delta", (params, token) =>
+    serve(state, "semanticTokens/delta", token, () => {
+      const doc = state.documents.get(params.textDocument.uri);
+      if (!doc) {
+        return { data: [] };
+      }
+
+      return handleSemanticTokensDelta(
+        state.semanticTokens,
+        doc.uri,
+        getTokensSource(state, doc),
+        params.previousResultId,
+      );
+    }),
+  );
+
+  // Semantic Tokens (range, e.g. the visible part of a large file)
+  connection.onRequest("textDocument/semanticTokens/range", (params, token) =>
+    serve(state, "semanticTokens/range", token, () => {
+      const doc = state.documents.get(params.textDocument.uri);
+      if (!doc) {
+        return { data: [] };
+      }
+
+      return handleSemanticTokensRange(getTokensSource(state, doc), params.range);
+    }),
+  );
 
   // Start listening
   connection.listen();
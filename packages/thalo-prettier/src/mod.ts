@@ -3,6 +3,13 @@ import type { SyntaxNode } from "tree-sitter";
 import { parser } from "./parser";
 import { printer } from "./printer";
 
+export {
+  formatRange,
+  formatRanges,
+  type RangeFormatOptions,
+  type TextRange,
+} from "./range";
+
 export const languages: Plugin<SyntaxNode>["languages"] = [
   {
     name: "thalo",
@@ -0,0 +1,167 @@
+/**
+ * Formatting of part of a file.
+ *
+ * Prettier's own `rangeStart`/`rangeEnd` only work for languages it knows, so these functions do
+ * it for thalo: they find the top-level entries in a range, format just their text, and splice
+ * the result into the original. Every entry prints the same on its own as inside a file, and
+ * the blank lines between entries depend only on the kinds of their neighbours, so splicing
+ * gives the same text as formatting the whole file would for those entries.
+ */
+import type { Options, Plugin } from "prettier";
+import { format } from "prettier";
+import type { SyntaxNode } from "tree-sitter";
+import { parser, parseThalo } from "./parser";
+import { printer } from "./printer";
+
+const plugin: Plugin<SyntaxNode> = {
+  parsers: { thalo: parser },
+  printers: { "thalo-ast": printer },
+};
+
+/**
+ * A top-level span formatted as a whole: an entry with the indented comments after it, or a
+ * top-level comment. `start` and `end` exclude surrounding whitespace.
+ */
+interface Unit {
+  start: number;
+  end: number;
+}
+
+export type RangeFormatOptions = Omit<Options, "parser" | "plugins"> & {
+  /** Start of the range to format (default 0) */
+  rangeStart?: number;
+  /** End of the range to format (default the end of the text) */
+  rangeEnd?: number;
+};
+
+type FormatOptions = Omit<RangeFormatOptions, "rangeStart" | "rangeEnd">;
+
+/**
+ * Split a file into units, or return null if it has syntax errors; those files are never
+ * formatted.
+ */
+const findUnits = async (text: string): Promise<Unit[] | null> => {
+  const tree = await parseThalo(text);
+  try {
+    if (tree.rootNode.hasError) {
+      return null;
+    }
+
+    const units: Unit[] = [];
+    for (const child of tree.rootNode.children) {
+      if (!child || child.type === "") {
+        continue;
+      }
+      let end = child.endIndex;
+      while (end > child.startIndex && /\s/.test(text[end - 1])) {
+        end--;
+      }
+      // Indented comments belong to the entry before them, as in `printSourceFile`
+      const isIndentedComment = child.type === "comment" && child.startPosition.column > 0;
+      if (isIndentedComment && units.length > 0) {
+        units[units.length - 1].end = end;
+      } else {
+        units.push({ start: child.startIndex, end });
+      }
+    }
+    return units;
+  } finally {
+    // web-tree-sitter trees live in WASM memory
+    (tree as { delete?: () => void }).delete?.();
+  }
+};
+
+/**
+ * Format `units[first..last]` and splice them into `text`.
+ */
+const spliceUnits = async (
+  text: string,
+  units: Unit[],
+  first: number,
+  last: number,
+  options: FormatOptions,
+): Promise<string> => {
+  const start = units[first].start;
+  const end = units[last].end;
+  const formatted = await format(text.slice(start, end), {
+    ...options,
+    parser: "thalo",
+    plugins: [plugin],
+  });
+  return text.slice(0, start) + formatted.replace(/\r?\n$/, "") + text.slice(end);
+};
+
+/**
+ * The first and last unit overlapping `[start, end)`, or null if there are none. An empty range
+ * selects the unit it is in.
+ */
+const unitsInRange = (units: Unit[], start: number, end: number): [number, number] | null => {
+  const first = units.findIndex((unit) => unit.end > start);
+  let last = -1;
+  for (let i = units.length - 1; i >= 0; i--) {
+    if (units[i].start < end || (start === end && units[i].start <= end)) {
+      last = i;
+      break;
+    }
+  }
+  return first === -1 || last < first ? null : [first, last];
+};
+
+/**
+ * Format the top-level entries and comments that overlap `[rangeStart, rangeEnd)`, leaving the
+ * rest of the text, including the blank lines around the range, as it is.
+ *
+ * Files with syntax errors are returned unchanged, as with a full format.
+ */
+export const formatRange = async (text: string, options: RangeFormatOptions): Promise<string> => {
+  const { rangeStart = 0, rangeEnd = text.length, ...formatOptions } = options;
+  return formatRanges(text, [{ start: rangeStart, end: rangeEnd }], formatOptions);
+};
+
+/**
+ * A character range `[start, end)` of a file.
+ */
+export interface TextRange {
+  start: number;
+  end: number;
+}
+
+/**
+ * Like `formatRange` for several ranges at once, e.g. every range modified since the last save.
+ * The file is parsed once, and entries covered by more than one range are formatted once.
+ */
+export const formatRanges = async (
+  text: string,
+  ranges: readonly TextRange[],
+  options: FormatOptions,
+): Promise<string> => {
+  const units = await findUnits(text);
+  if (!units) {
+    return text;
+  }
+
+  const runs: [number, number][] = [];
+  for (const range of ranges) {
+    const run = unitsInRange(units, range.start, range.end);
+    if (run) {
+      runs.push(run);
+    }
+  }
+  runs.sort((a, b) => a[0] - b[0]);
+  const merged: [number, number][] = [];
+  for (const [first, last] of runs) {
+    const previous = merged[merged.length - 1];
+    if (previous && first <= previous[1]) {
+      previous[1] = Math.max(previous[1], last);
+    } else {
+      merged.push([first, last]);
+    }
+  }
+
+  // From the end, so the offsets of the units before each run stay valid
+  let result = text;
+  for (let i = merged.length - 1; i >= 0; i--) {
+    result = await spliceUnits(result, units, merged[i][0], merged[i][1], options);
+  }
+  return result;
+};
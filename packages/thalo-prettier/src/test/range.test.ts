@@ -0,0 +1,106 @@
+import { describe, expect, it } from "vitest";
+import * as prettier from "prettier";
+import * as plugin from "../mod";
+
+const format = async (code: string): Promise<string> => {
+  return prettier.format(code, {
+    parser: "thalo",
+    plugins: [plugin],
+  });
+};
+
+const formatted = `2026-01-05T15:00Z create lore "First entry" #test
+  type: "fact"
+
+2026-01-05T16:00Z create lore "Second entry" #test
+  type: "fact"
+  // A note on the second entry
+
+// A top-level comment
+
+2026-01-05T17:00Z create lore "Third entry" #test
+  type: "fact"
+`;
+
+describe("formatRange", () => {
+  const messy = `2026-01-05T15:00Z create lore "First entry" #test
+  type:   "fact"
+
+
+
+2026-01-05T16:00Z   create lore "Second entry"   #test
+  type:   "fact"
+`;
+
+  it("formats only the entries overlapping the range", async () => {
+    const start = messy.indexOf("2026-01-05T16:00Z");
+    const output = await plugin.formatRange(messy, { rangeStart: start, rangeEnd: start + 5 });
+
+    expect(output).toBe(`2026-01-05T15:00Z create lore "First entry" #test
+  type:   "fact"
+
+
+
+2026-01-05T16:00Z create lore "Second entry" #test
+  type: "fact"
+`);
+  });
+
+  it("formats the whole file when the range covers it", async () => {
+    const output = await plugin.formatRange(messy, { rangeStart: 0, rangeEnd: messy.length });
+    // The blank lines between the entries are outside every entry and stay as they are
+    expect(output).toBe(`2026-01-05T15:00Z create lore "First entry" #test
+  type: "fact"
+
+
+
+2026-01-05T16:00Z create lore "Second entry" #test
+  type: "fact"
+`);
+  });
+
+  it("leaves files with syntax errors unchanged", async () => {
+    const input = `2026-01-05T15:00Z create lore "Broken
+  type: "fact"
+`;
+    expect(await plugin.formatRange(input, { rangeStart: 0, rangeEnd: 5 })).toBe(input);
+  });
+});
+
+describe("formatRanges", () => {
+  const messy = formatted
+    .replace('"First entry" #test', '"First entry"   #test')
+    .replace('"Second entry" #test', '"Second entry"   #test')
+    .replace('"Third entry" #test', '"Third entry"   #test');
+
+  it("formats the entries of every range and nothing between them", async () => {
+    const first = messy.indexOf("2026-01-05T15:00Z");
+    const third = messy.indexOf("2026-01-05T17:00Z");
+    const output = await plugin.formatRanges(
+      messy,
+      [
+        { start: third, end: third + 5 },
+        { start: first, end: first + 5 },
+      ],
+      {},
+    );
+
+    expect(output).toBe(formatted.replace('"Second entry" #test', '"Second entry"   #test'));
+  });
+
+  it("formats entries covered by overlapping ranges once", async () => {
+    const second = messy.indexOf("2026-01-05T16:00Z");
+    const ranges = [
+      { start: second, end: second + 10 },
+      { start: second + 5, end: messy.length },
+    ];
+    expect(await plugin.formatRanges(messy, ranges, {})).toBe(
+      await plugin.formatRange(messy, { rangeStart: second, rangeEnd: messy.length }),
+    );
+  });
+
+  it("starts from formatted text", async () => {
+    expect(await format(formatted)).toBe(formatted);
+    expect(await plugin.formatRanges(messy, [{ start: 0, end: messy.length }], {})).toBe(formatted);
+  });
+});
@@ -45,36 +45,31 @@ export async function activate(context: vscode.ExtensionContext): Promise<void>
     vscode.window.showErrorMessage(`Failed to start Thalo language server: ${message}`);
   }
 
-  // Register the formatter (uses CLI)
+  // Register the formatters (use CLI). The range formatter lets format-on-save re-print only
+  // the modified entries, all of them in one CLI run.
   const formatter = vscode.languages.registerDocumentFormattingEditProvider("thalo", {
     async provideDocumentFormattingEdits(
       document: vscode.TextDocument,
     ): Promise<vscode.TextEdit[]> {
-      const currentCliPath = getCliPath();
-      const text = document.getText();
-
-      try {
-        const formatted = await formatWithCli(currentCliPath, text);
-
-        if (formatted === text) {
-          return [];
-        }
-
-        const fullRange = new vscode.Range(
-          document.positionAt(0),
-          document.positionAt(text.length),
-        );
-
-        return [vscode.TextEdit.replace(fullRange, formatted)];
-      } catch (error) {
-        const message = error instanceof Error ? error.message : String(error);
-        vscode.window.showErrorMessage(`Thalo formatting failed: ${message}`);
-        return [];
-      }
+      return formatDocument(document);
+    },
+  });
+  const rangeFormatter = vscode.languages.registerDocumentRangeFormattingEditProvider("thalo", {
+    async provideDocumentRangeFormattingEdits(
+      document: vscode.TextDocument,
+      range: vscode.Range,
+    ): Promise<vscode.TextEdit[]> {
+      return formatDocument(document, [range]);
+    },
+    async provideDocumentRangesFormattingEdits(
+      document: vscode.TextDocument,
+      ranges: vscode.Range[],
+    ): Promise<vscode.TextEdit[]> {
+      return formatDocument(document, ranges);
     },
   });
 
-  context.subscriptions.push(formatter);
+  context.subscriptions.push(formatter, rangeFormatter);
 
   // Register command to restart the language server
   const restartCommand = vscode.commands.registerCommand("thalo.restartServer", async () => {
@@ -127,11 +122,70 @@ async function checkCliAvailable(cliPath: string): Promise<boolean> {
 }
 
 /**
- * Format text using the CLI
+ * Format a document, or only the entries in `ranges`, as one edit covering just the changed text
  */
-async function formatWithCli(cliPath: string, text: string): Promise<string> {
+async function formatDocument(
+  document: vscode.TextDocument,
+  ranges?: readonly vscode.Range[],
+): Promise<vscode.TextEdit[]> {
+  const currentCliPath = getCliPath();
+  const text = document.getText();
+  const offsets = ranges?.map((range) => ({
+    start: document.offsetAt(range.start),
+    end: document.offsetAt(range.end),
+  }));
+
+  try {
+    const formatted = await formatWithCli(currentCliPath, text, offsets);
+
+    if (formatted === text) {
+      return [];
+    }
+
+    // Replace only what differs, so a large file is not rewritten for a small change
+    let prefix = 0;
+    const limit = Math.min(text.length, formatted.length);
+    while (prefix < limit && text[prefix] === formatted[prefix]) {
+      prefix++;
+    }
+    let suffix = 0;
+    while (
+      suffix < limit - prefix &&
+      text[text.length - 1 - suffix] === formatted[formatted.length - 1 - suffix]
+    ) {
+      suffix++;
+    }
+
+    const changedRange = new vscode.Range(
+      document.positionAt(prefix),
+      document.positionAt(text.length - suffix),
+    );
+
+    return [
+      vscode.TextEdit.replace(changedRange, formatted.slice(prefix, formatted.length - suffix)),
+    ];
+  } catch (error) {
+    const message = error instanceof Error ? error.message : String(error);
+    vscode.window.showErrorMessage(`Thalo formatting failed: ${message}`);
+    return [];
+  }
+}
+
+/**
+ * Format text using the CLI, optionally only the entries in the given character ranges
+ */
+async function formatWithCli(
+  cliPath: string,
+  text: string,
+  ranges?: readonly { start: number; end: number }[],
+): Promise<string> {
+  const args = ["format", "--stdin"];
+  for (const range of ranges ?? []) {
+    args.push("--range-start", String(range.start), "--range-end", String(range.end));
+  }
+
   return new Promise((resolve, reject) => {
-    const proc = spawn(cliPath, ["format", "--stdin"], {
+    const proc = spawn(cliPath, args, {
       shell: true,
       stdio: ["pipe", "pipe", "pipe"],
     });
@@ -0,0 +1,102 @@
+#!/usr/bin/env node
+/**
+ * Check benchmark: `check` on a workspace loaded by `loadWorkspaceFromFiles` against
+ * `checkFilesParallel`, which `thalo check --threads N` runs. Both times include loading the
+ * files, since the parallel checker loads them itself.
+ *
+ * For each thread count this reports the wall time of both paths and the speedup of the
+ * parallel one. Runs alternate between the two, so drift in machine load affects both alike.
+ * Reads the built package, so run `pnpm build` first.
+ *
+ * Usage: node bench/check.mjs [threads...] [--files=N] [--entries=N] [--json]
+ * Defaults to 2, 4 and 8 threads on 200 files of 250 entries each.
+ */
+import { mkdtempSync, rmSync, writeFileSync } from "node:fs";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { generateWorkspace } from "../../grammar/bench/workspace.mjs";
+import { check } from "../dist/checker/check.js";
+import { loadWorkspaceFromFiles } from "../dist/files.js";
+import { checkFilesParallel } from "../dist/checker/parallel.js";
+
+const args = process.argv.slice(2);
+const json = args.includes("--json");
+const option = (name, fallback) => {
+  const arg = args.find((a) => a.startsWith(`--${name}=`));
+  return arg ? Number(arg.slice(name.length + 3)) : fallback;
+};
+const fileCount = option("files", 200);
+const entriesPerFile = option("entries", 250);
+const threadCounts = args.filter((arg) => !arg.startsWith("--")).map(Number);
+if (threadCounts.length === 0) {
+  threadCounts.push(2, 4, 8);
+}
+
+function writeFiles(dir) {
+  const files = [];
+  for (let i = 0; i < fileCount; i++) {
+    const path = join(dir, `file-${i}.thalo`);
+    writeFileSync(path, generateWorkspace(entriesPerFile, i + 1));
+    files.push(path);
+  }
+  return files;
+}
+
+async function timeSerial(files) {
+  const start = performance.now();
+  const workspace = await loadWorkspaceFromFiles(files, { bulkExtraction: true });
+  const count = check(workspace).length;
+  return { ms: performance.now() - start, count };
+}
+
+async function timeParallel(files, threads) {
+  const start = performance.now();
+  // Always shard, so small runs measure the workers rather than the serial fallback
+  const { diagnostics } = await checkFilesParallel(files, { threads, minEntriesPerWorker: 1 });
+  return { ms: performance.now() - start, count: diagnostics.length };
+}
+
+async function benchCheck(files, threads) {
+  // Warm up both paths, then alternate until ~3s or 6 runs
+  const expected = (await timeSerial(files)).count;
+  if ((await timeParallel(files, threads)).count !== expected) {
+    throw new Error("checkFilesParallel and check report different diagnostics");
+  }
+  const serial = { ms: 0, runs: 0 };
+  const parallel = { ms: 0, runs: 0 };
+  const start = performance.now();
+  while (serial.runs + parallel.runs < 6 || performance.now() - start < 3000) {
+    const useSerial = serial.runs === parallel.runs;
+    const stats = useSerial ? serial : parallel;
+    stats.ms += (useSerial ? await timeSerial(files) : await timeParallel(files, threads)).ms;
+    stats.runs++;
+  }
+  return { serialMs: serial.ms / serial.runs, parallelMs: parallel.ms / parallel.runs };
+}
+
+const dir = mkdtempSync(join(tmpdir(), "thalo-check-bench-"));
+const results = [];
+try {
+  const files = writeFiles(dir);
+  for (const threads of threadCounts) {
+    const times = await benchCheck(files, threads);
+    const result = { files: fileCount, entriesPerFile, threads, ...times };
+    result.speedup = result.serialMs / result.parallelMs;
+    results.push(result);
+
+    if (!json) {
+      console.log(
+        `${fileCount} files x ${entriesPerFile} entries, ${String(threads).padStart(2)} threads` +
+          `  serial ${result.serialMs.toFixed(0).padStart(6)} ms` +
+          `  parallel ${result.parallelMs.toFixed(0).padStart(6)} ms` +
+          `  speedup ${result.speedup.toFixed(2)}x`,
+      );
+    }
+  }
+} finally {
+  rmSync(dir, { recursive: true, force: true });
+}
+
+if (json) {
+  console.log(JSON.stringify(results, null, 2));
+}
@@ -250,6 +250,40 @@ describe("Thalo Scripting API", () => {
       await fs.rm(tempDir, { recursive: true, force: true });
     });
 
+    it("only reports entries whose source changed", async () => {
+      const tempDir = await fs.mkdtemp(path.join(os.tmpdir(), "thalo-watch-"));
+      const filePath = path.join(tempDir, "entries.thalo");
+      const first = `2026-01-05T10:00Z create opinion "Entry 1" ^entry-1\n  # Claim\n  First.\n`;
+      await fs.writeFile(
+        filePath,
+        `${first}\n2026-01-06T09:00Z create opinion "Entry 2" ^entry-2\n  # Claim\n  Second.\n`,
+        "utf8",
+      );
+
+      const workspace = await loadThalo(tempDir);
+      const controller = new AbortController();
+      const iterator = workspace
+        .watch({ includeExisting: true, debounceMs: 10, signal: controller.signal })
+        [Symbol.asyncIterator]();
+
+      await waitForEvent(iterator);
+
+      // Shift the first entry down and edit the second
+      await fs.writeFile(
+        filePath,
+        `\n\n${first}\n2026-01-06T09:00Z create opinion "Entry 2" ^entry-2\n  # Claim\n  Edited.\n`,
+        "utf8",
+      );
+
+      const event = await waitForEvent(iterator);
+      expect(event.added).toEqual([]);
+      expect(event.removed).toEqual([]);
+      expect(event.updated.map((entry) => entry.title)).toEqual(["Entry 2"]);
+
+      controller.abort();
+      await fs.rm(tempDir, { recursive: true, force: true });
+    });
+
     it("emits removed entries when files are deleted", async () => {
       const tempDir = await fs.mkdtemp(path.join(os.tmpdir(), "thalo-watch-"));
       const filePath = path.join(tempDir, "entries.thalo");
@@ -315,6 +315,11 @@ export interface LoadOptions {
    * File extensions to include (default: [".thalo", ".md"])
    */
   extensions?: string[];
+  /**
+   * Directory for a persistent syntax tree cache (e.g. ".thalo-cache"). Unchanged files are
+   * not re-parsed on later loads. Off by default.
+   */
+  cacheDir?: string;
 }
 
 /**
@@ -1192,7 +1197,8 @@ class ThaloWorkspace implements ThaloWorkspaceInterface {
       opts?: WorkspaceWatchOptions,
     ): AsyncIterable<WorkspaceWatchEvent> {
       const { watchWorkspace } = await import("./watch.js");
-      for await (const event of watchWorkspace(workspace, opts)) {
+      const { loadRangeHasher } = await import("./range-hash.js");
+      for await (const event of watchWorkspace(workspace, opts, await loadRangeHasher())) {
         yield event;
       }
     })(this, options);
@@ -1233,7 +1239,9 @@ export async function loadThalo(
   options: LoadOptions = {},
 ): Promise<ThaloWorkspaceInterface> {
   const extensions = options.extensions ?? [".thalo", ".md"];
-  const workspace = await loadWorkspaceFromDirectory(path, extensions);
+  const workspace = await loadWorkspaceFromDirectory(path, extensions, {
+    cacheDir: options.cacheDir,
+  });
   return new ThaloWorkspace(workspace);
 }
 
@@ -1253,8 +1261,11 @@ export async function loadThalo(
  * ]);
  * ```
  */
-export async function loadThaloFiles(files: string[]): Promise<ThaloWorkspaceInterface> {
-  const workspace = await loadWorkspaceFromFiles(files);
+export async function loadThaloFiles(
+  files: string[],
+  options: Pick<LoadOptions, "cacheDir"> = {},
+): Promise<ThaloWorkspaceInterface> {
+  const workspace = await loadWorkspaceFromFiles(files, options);
   return new ThaloWorkspace(workspace);
 }
 
@@ -442,7 +442,8 @@ export interface TimezonePart extends AstNode {
  *   value: "2026-01-05T18:00Z",
  *   date: { type: "date_part", year: 2026, month: 1, day: 5, value: "2026-01-05", ... },
  *   time: { type: "time_part", hour: 18, minute: 0, value: "18:00", ... },
- *   timezone: { type: "timezone_part", value: "Z", offsetMinutes: 0, ... }
+ *   timezone: { type: "timezone_part", value: "Z", offsetMinutes: 0, ... },
+ *   epochMinutes: 29461200
  * }
  *
  * @example
@@ -465,6 +466,8 @@ export interface Timestamp extends AstNode {
   time: TimePart;
   /** Decomposed timezone part, or SyntaxErrorNode if missing */
   timezone: Result<TimezonePart, "missing_timezone">;
+  /** Minutes since the Unix epoch, normalized to UTC (a missing timezone is read as UTC) */
+  epochMinutes: number;
 }
 
 export interface Title extends AstNode {
@@ -538,12 +541,20 @@ export interface DatetimeValue extends AstNode {
   time: string | null;
   /** The timezone if present (Z or +/-HH:MM) */
   tz: string | null;
+  /** Start of the day or minute this value names, in epoch minutes (see `TimeSpan`) */
+  start: number;
+  /** End (exclusive) of the day or minute this value names, in epoch minutes */
+  end: number;
 }
 
 export interface DaterangeValue extends AstNode {
   type: "daterange";
   /** The raw date range text */
   raw: string;
+  /** Start of the range in epoch minutes (see `TimeSpan`) */
+  start: number;
+  /** End (exclusive) of the range in epoch minutes; `Infinity` for open-ended ranges */
+  end: number;
 }
 
 export interface NumberValue extends AstNode {
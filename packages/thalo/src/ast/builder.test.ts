@@ -283,6 +283,14 @@ describe("buildTimestamp", () => {
     }
   });
 
+  it("should normalize the timestamp to epoch minutes in UTC", () => {
+    const utc = buildTimestamp(mockTimestampNode("2026-01-05T13:00Z", 0));
+    const offset = buildTimestamp(mockTimestampNode("2026-01-05T18:30+05:30", 0));
+
+    expect(utc.epochMinutes).toBe(Date.parse("2026-01-05T13:00Z") / 60_000);
+    expect(offset.epochMinutes).toBe(utc.epochMinutes);
+  });
+
   it("should create syntax error for missing timezone", () => {
     const node = mockTimestampNode("2026-01-05T18:30", 0);
     const timestamp = buildTimestamp(node);
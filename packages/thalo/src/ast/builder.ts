@@ -21,6 +21,7 @@ import type {
   Timestamp,
   Result,
 } from "./ast-types.js";
+import { epochMinutes, nativeTimeSpan } from "./time.js";
 
 // ===================
 // Location Utilities
@@ -242,12 +243,25 @@ export function buildTimestamp(node: SyntaxNode): Timestamp {
     );
   }
 
+  // The native binding decodes timestamps while encoding; otherwise compute from the parts
+  const minutes =
+    nativeTimeSpan(node)?.start ??
+    epochMinutes(
+      datePart.year,
+      datePart.month,
+      datePart.day,
+      timePart.hour,
+      timePart.minute,
+      timezone.type === "syntax_error" ? 0 : timezone.offsetMinutes,
+    );
+
   return {
     type: "timestamp",
     value: text,
     date: datePart,
     time: timePart,
     timezone,
+    epochMinutes: minutes,
     location: extractLocation(node),
     syntaxNode: node,
   };
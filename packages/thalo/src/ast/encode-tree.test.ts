@@ -0,0 +1,160 @@
+import { describe, it, expect } from "vitest";
+import type { Point } from "./ast-types.js";
+import { createExtractionParser, createParser, hasNativeExtraction } from "../parser.native.js";
+import { encodeTree, encodedTreeBuffers, type EncodableCursor } from "./encode-tree.js";
+import { EncodedTree, type EncodedLanguage } from "./encoded-tree.js";
+
+interface FakeNode {
+  typeId: number;
+  named?: boolean;
+  fieldId?: number;
+  start: number;
+  end: number;
+  children?: FakeNode[];
+}
+
+/** A cursor over a tree of plain objects, all on one line */
+function fakeCursor(root: FakeNode): EncodableCursor {
+  const path: { node: FakeNode; siblings: FakeNode[]; index: number }[] = [
+    { node: root, siblings: [root], index: 0 },
+  ];
+  const current = () => path[path.length - 1].node;
+  const point = (column: number): Point => ({ row: 0, column });
+  const move = (index: number): boolean => {
+    const top = path[path.length - 1];
+    if (index >= top.siblings.length) {
+      return false;
+    }
+    path[path.length - 1] = { node: top.siblings[index], siblings: top.siblings, index };
+    return true;
+  };
+
+  return {
+    get nodeTypeId() {
+      return current().typeId;
+    },
+    get nodeIsNamed() {
+      return current().named ?? true;
+    },
+    nodeIsMissing: false,
+    get currentFieldId() {
+      return current().fieldId ?? 0;
+    },
+    get startIndex() {
+      return current().start;
+    },
+    get endIndex() {
+      return current().end;
+    },
+    get startPosition() {
+      return point(current().start);
+    },
+    get endPosition() {
+      return point(current().end);
+    },
+    get currentNode() {
+      return { hasError: current().typeId === 0xffff, isExtra: false };
+    },
+    gotoFirstChild() {
+      const children = current().children ?? [];
+      if (children.length === 0) {
+        return false;
+      }
+      path.push({ node: children[0], siblings: children, index: 0 });
+      return true;
+    },
+    gotoNextSibling: () => move(path[path.length - 1].index + 1),
+    gotoParent() {
+      if (path.length === 1) {
+        return false;
+      }
+      path.pop();
+      return true;
+    },
+  };
+}
+
+const language: EncodedLanguage = {
+  symbolNames: ["end", "source_file", "entry", "timestamp", "title", '"'],
+  fieldNames: ["", "timestamp", "title"],
+};
+
+describe("encodeTree", () => {
+  const source = 'T "x" T';
+  const tree = encodeTree(
+    fakeCursor({
+      typeId: 1,
+      start: 0,
+      end: 7,
+      children: [
+        {
+          typeId: 2,
+          start: 0,
+          end: 5,
+          children: [
+            { typeId: 3, fieldId: 1, start: 0, end: 1 },
+            {
+              typeId: 4,
+              fieldId: 2,
+              start: 2,
+              end: 5,
+              children: [
+                { typeId: 5, named: false, start: 2, end: 3 },
+                { typeId: 5, named: false, start: 4, end: 5 },
+              ],
+            },
+          ],
+        },
+        { typeId: 0xffff, start: 6, end: 7 },
+      ],
+    }),
+  );
+
+  it("lays out nodes in pre-order with parents and subtree ends", () => {
+    expect(tree.nodeCount).toBe(7);
+    expect([...tree.types]).toEqual([1, 2, 3, 4, 5, 5, 0xffff]);
+    expect([...tree.parents]).toEqual([-1, 0, 1, 1, 3, 3, 0]);
+    expect([...tree.subtreeEnds]).toEqual([7, 6, 3, 6, 5, 6, 7]);
+    expect([...tree.fields]).toEqual([0, 0, 1, 2, 0, 0, 0]);
+  });
+
+  it("decodes through EncodedTree", () => {
+    const root = new EncodedTree(tree, source, language).rootNode;
+    expect(root.namedChildren.map((child) => child.type)).toEqual(["entry", "ERROR"]);
+    expect(root.hasError).toBe(false);
+
+    const entry = root.namedChildren[0];
+    expect(entry.childForFieldName("timestamp")?.text).toBe("T");
+    expect(entry.childForFieldName("title")?.text).toBe('"x"');
+    expect(entry.childForFieldName("title")?.namedChildren).toHaveLength(0);
+    expect(entry.childForFieldName("title")?.children).toHaveLength(2);
+  });
+
+  it("lists one distinct buffer per array", () => {
+    const buffers = encodedTreeBuffers(tree);
+    expect(buffers).toHaveLength(6);
+    expect(new Set(buffers).size).toBe(6);
+  });
+});
+
+describe.skipIf(!hasNativeExtraction())("encodeTree with tree-sitter", () => {
+  const source = `2026-01-07T11:40Z define-entity lore "Insights" #knowledge
+  # Metadata
+  type: "fact" | "insight"
+
+2026-01-07T12:00Z create lore "First insight" ^first
+  type: "insight"
+this line is not valid
+`;
+
+  it("matches the native binding's encoding", () => {
+    const tree = createParser().parse(source);
+    const encoded = encodeTree(tree.walk() as unknown as EncodableCursor);
+    const native = (createExtractionParser().parse(source) as EncodedTree).encoded;
+
+    expect(encoded.nodeCount).toBe(native.nodeCount);
+    for (const key of ["types", "flags", "ranges", "fields", "parents", "subtreeEnds"] as const) {
+      expect([...encoded[key]]).toEqual([...native[key]]);
+    }
+  });
+});
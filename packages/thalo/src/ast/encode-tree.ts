@@ -0,0 +1,98 @@
+/**
+ * Encoder producing the `EncodedSyntaxTree` layout from a tree-sitter tree cursor.
+ *
+ * The native binding encodes trees in C++ (bindings/node/encode.cc). This is the same walk for
+ * parsers without it, such as web-tree-sitter in a worker: the typed arrays can be transferred
+ * between threads and decoded on the other side with `EncodedTree`.
+ */
+import type { Point } from "./ast-types.js";
+import {
+  NODE_EXTRA,
+  NODE_HAS_ERROR,
+  NODE_MISSING,
+  NODE_NAMED,
+  type EncodedSyntaxTree,
+} from "./encoded-tree.js";
+
+/**
+ * The parts of a tree-sitter `TreeCursor` the encoder reads. Both tree-sitter and
+ * web-tree-sitter cursors satisfy it.
+ */
+export interface EncodableCursor {
+  readonly nodeTypeId: number;
+  readonly nodeIsNamed: boolean;
+  readonly nodeIsMissing: boolean;
+  readonly currentFieldId: number;
+  readonly startIndex: number;
+  readonly endIndex: number;
+  readonly startPosition: Point;
+  readonly endPosition: Point;
+  readonly currentNode: { readonly hasError: boolean; readonly isExtra: boolean };
+  gotoFirstChild(): boolean;
+  gotoNextSibling(): boolean;
+  gotoParent(): boolean;
+}
+
+/**
+ * Walk a tree once, from a cursor at its root, and encode every visible node in pre-order.
+ *
+ * Time-valued nodes are not decoded; consumers parse their text instead.
+ */
+export function encodeTree(cursor: EncodableCursor): EncodedSyntaxTree {
+  const types: number[] = [];
+  const flags: number[] = [];
+  const ranges: number[] = [];
+  const fields: number[] = [];
+  const parents: number[] = [];
+  const subtreeEnds: number[] = [];
+  // Indices of the nodes between the root and the cursor
+  const ancestors: number[] = [];
+
+  for (;;) {
+    const index = types.length;
+    const node = cursor.currentNode;
+    types.push(cursor.nodeTypeId);
+    flags.push(
+      (cursor.nodeIsNamed ? NODE_NAMED : 0) |
+        (node.hasError ? NODE_HAS_ERROR : 0) |
+        (cursor.nodeIsMissing ? NODE_MISSING : 0) |
+        (node.isExtra ? NODE_EXTRA : 0),
+    );
+    const start = cursor.startPosition;
+    const end = cursor.endPosition;
+    ranges.push(cursor.startIndex, cursor.endIndex, start.row, start.column, end.row, end.column);
+    fields.push(cursor.currentFieldId);
+    parents.push(ancestors.length > 0 ? ancestors[ancestors.length - 1] : -1);
+    subtreeEnds.push(index + 1);
+
+    if (cursor.gotoFirstChild()) {
+      ancestors.push(index);
+      continue;
+    }
+    while (!cursor.gotoNextSibling()) {
+      if (!cursor.gotoParent()) {
+        return {
+          nodeCount: types.length,
+          types: Uint16Array.from(types),
+          flags: Uint8Array.from(flags),
+          ranges: Uint32Array.from(ranges),
+          fields: Uint16Array.from(fields),
+          parents: Int32Array.from(parents),
+          subtreeEnds: Uint32Array.from(subtreeEnds),
+        };
+      }
+      subtreeEnds[ancestors.pop()!] = types.length;
+    }
+  }
+}
+
+/**
+ * The buffers backing an encoded tree, for a `postMessage` transfer list.
+ */
+export function encodedTreeBuffers(tree: EncodedSyntaxTree): ArrayBuffer[] {
+  const arrays = [tree.types, tree.flags, tree.ranges, tree.fields, tree.parents, tree.subtreeEnds];
+  if (tree.timeNodes && tree.times) {
+    arrays.push(tree.timeNodes, tree.times);
+  }
+  return arrays.map((array) => array.buffer as ArrayBuffer);
+}
@@ -0,0 +1,169 @@
+import { describe, it, expect } from "vitest";
+import { mkdtempSync, writeFileSync } from "node:fs";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import type { SyntaxNode } from "./ast-types.js";
+import {
+  createExtractionParser,
+  createParser,
+  hasNativeExtraction,
+  hasNativeStreaming,
+  streamBlocks,
+} from "../parser.native.js";
+import { toFilePosition } from "../source-map.js";
+import { extractSourceFile } from "./extract.js";
+import { EncodedTree } from "./encoded-tree.js";
+
+const source = `2026-01-07T11:40Z define-entity lore "Insights" #knowledge
+  # Metadata
+  type: "fact" | "insight" ; "Kind of lore"
+  subject?: link
+  tags: string[] = "none"
+
+  # Sections
+  Summary ; "Short summary"
+
+2026-01-07T12:00Z create lore "First insight" ^first #career
+  type: "insight"
+  subject: ^self
+  // a comment between metadata
+  period: 2024 ~ 2025
+
+  # Summary
+  Encoded trees should match native ones.
+
+2026-01-08T09:00Z define-synthesis "Career summary" ^career-summary
+  sources: lore where #career and subject = ^self
+
+2026-01-08T10:00 create lore "Missing timezone"
+  type: "fact"
+this line is not valid
+`;
+
+/** Collect every node in pre-order */
+function flatten(node: SyntaxNode, out: SyntaxNode[] = []): SyntaxNode[] {
+  out.push(node);
+  for (const child of node.children) {
+    if (child) {
+      flatten(child, out);
+    }
+  }
+  return out;
+}
+
+/** Drop syntaxNode references so ASTs from different trees can be compared */
+function stripSyntaxNodes(value: unknown): unknown {
+  if (Array.isArray(value)) {
+    return value.map(stripSyntaxNodes);
+  }
+  if (value && typeof value === "object") {
+    return Object.fromEntries(
+      Object.entries(value)
+        .filter(([key]) => key !== "syntaxNode")
+        .map(([key, child]) => [key, stripSyntaxNodes(child)]),
+    );
+  }
+  return value;
+}
+
+describe.skipIf(!hasNativeExtraction())("EncodedTree", () => {
+  const nativeTree = createParser().parse(source);
+  const encodedTree = createExtractionParser().parse(source) as EncodedTree;
+
+  it("decodes every node with the same type, range and flags", () => {
+    const nativeNodes = flatten(nativeTree.rootNode as SyntaxNode);
+    const encodedNodes = flatten(encodedTree.rootNode);
+
+    expect(encodedNodes).toHaveLength(nativeNodes.length);
+    nativeNodes.forEach((nativeNode, i) => {
+      const encodedNode = encodedNodes[i];
+      expect(encodedNode.type).toBe(nativeNode.type);
+      expect(encodedNode.text).toBe(nativeNode.text);
+      expect(encodedNode.startPosition).toEqual(nativeNode.startPosition);
+      expect(encodedNode.endPosition).toEqual(nativeNode.endPosition);
+      expect(encodedNode.hasError).toBe(nativeNode.hasError);
+      expect(encodedNode.namedChildren.map((c) => c?.type)).toEqual(
+        nativeNode.namedChildren.map((c) => c?.type),
+      );
+    });
+  });
+
+  it("resolves fields like tree-sitter", () => {
+    const nativeNodes = flatten(nativeTree.rootNode as SyntaxNode);
+    const encodedNodes = flatten(encodedTree.rootNode);
+
+    for (const field of ["timestamp", "directive", "argument", "title", "key", "value", "tz"]) {
+      nativeNodes.forEach((nativeNode, i) => {
+        expect(encodedNodes[i].childForFieldName(field)?.startIndex).toBe(
+          nativeNode.childForFieldName(field)?.startIndex,
+        );
+      });
+    }
+  });
+
+  it("produces the same AST as the native tree", () => {
+    const nativeAst = extractSourceFile(nativeTree.rootNode as SyntaxNode);
+    const encodedAst = extractSourceFile(encodedTree.rootNode);
+
+    expect(stripSyntaxNodes(encodedAst)).toEqual(stripSyntaxNodes(nativeAst));
+  });
+
+  it("finds the same descendant for a position", () => {
+    const nativeRoot = nativeTree.rootNode as SyntaxNode;
+    for (const point of [
+      { row: 0, column: 0 },
+      { row: 2, column: 5 },
+      { row: 9, column: 40 },
+      { row: 20, column: 30 },
+    ]) {
+      const nativeNode = nativeRoot.descendantForPosition(point);
+      const encodedNode = encodedTree.rootNode.descendantForPosition(point);
+      expect(encodedNode?.type).toBe(nativeNode?.type);
+      expect(encodedNode?.startIndex).toBe(nativeNode?.startIndex);
+    }
+  });
+
+  it("returns stable node identities", () => {
+    const entry = encodedTree.rootNode.namedChildren[0];
+    expect(entry?.parent).toBe(encodedTree.rootNode);
+    expect(encodedTree.rootNode.namedChildren[0]).toBe(entry);
+  });
+});
+
+describe.skipIf(!hasNativeStreaming())("streamBlocks", () => {
+  it("yields the same entries at the same file positions as a whole-file parse", () => {
+    // Only the well-formed entries, so error recovery cannot reach across chunk boundaries
+    const entries = source.slice(0, source.indexOf("2026-01-08T10:00 "));
+    const large = Array.from({ length: 50 }, () => entries).join("");
+    const path = join(mkdtempSync(join(tmpdir(), "thalo-stream-")), "large.thalo");
+    writeFileSync(path, large);
+
+    const whole = extractSourceFile(createParser().parse(large).rootNode as SyntaxNode);
+    const streamed = [];
+    let blockCount = 0;
+    for (const block of streamBlocks(path, { chunkSize: 2048 })) {
+      blockCount++;
+      expect(large.slice(block.sourceMap.charOffset).startsWith(block.source)).toBe(true);
+      for (const entry of extractSourceFile(block.tree.rootNode).entries) {
+        const { row, column } = entry.location.startPosition;
+        streamed.push({
+          type: entry.type,
+          text: entry.syntaxNode.text,
+          position: toFilePosition(block.sourceMap, { line: row, column }),
+        });
+      }
+    }
+
+    expect(blockCount).toBeGreaterThan(1);
+    expect(streamed).toEqual(
+      whole.entries.map((entry) => ({
+        type: entry.type,
+        text: entry.syntaxNode.text,
+        position: {
+          line: entry.location.startPosition.row,
+          column: entry.location.startPosition.column,
+        },
+      })),
+    );
+  });
+});
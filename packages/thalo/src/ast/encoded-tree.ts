@@ -0,0 +1,384 @@
+/**
+ * Decoder for syntax trees flattened by the native binding's `extractEntries`.
+ *
+ * The binding walks the tree-sitter tree once in C++ and returns typed arrays describing every
+ * visible node in pre-order. `EncodedTree` exposes that encoding through the `SyntaxNode`
+ * interface, so `extractSourceFile` and the other CST consumers work unchanged while reading
+ * plain JS memory instead of calling back into the binding for every node.
+ */
+import type { Point, SyntaxNode } from "./ast-types.js";
+import type { TreeEdit } from "../parser.shared.js";
+
+/** Flag bit: the node is named. Must match `NodeFlag` in bindings/node/encode.h. */
+export const NODE_NAMED = 1 << 0;
+/** Flag bit: the node or one of its descendants is an error. */
+export const NODE_HAS_ERROR = 1 << 1;
+/** Flag bit: the node was inserted by error recovery. */
+export const NODE_MISSING = 1 << 2;
+/** Flag bit: the node is an extra (e.g. whitespace matched by `extras`). */
+export const NODE_EXTRA = 1 << 3;
+
+/** Symbol id tree-sitter uses for ERROR nodes. */
+const ERROR_SYMBOL = 0xffff;
+
+/** Number of values stored per node in `EncodedSyntaxTree.ranges`. */
+const RANGE_STRIDE = 6;
+
+/**
+ * A syntax tree flattened into typed arrays, one slot per node in pre-order.
+ *
+ * Structurally identical to the `EncodedSyntaxTree` returned by
+ * `@rejot-dev/tree-sitter-thalo`; redeclared here so this module stays platform-agnostic.
+ */
+export interface EncodedSyntaxTree {
+  nodeCount: number;
+  /** Symbol id per node, indexing `EncodedLanguage.symbolNames` */
+  types: Uint16Array;
+  /** NODE_* flag bits per node */
+  flags: Uint8Array;
+  /** startIndex, endIndex, startRow, startColumn, endRow, endColumn per node */
+  ranges: Uint32Array;
+  /** Field id per node, indexing `EncodedLanguage.fieldNames` (0 = none) */
+  fields: Uint16Array;
+  /** Parent index per node (-1 for the root) */
+  parents: Int32Array;
+  /** Index one past each node's last descendant */
+  subtreeEnds: Uint32Array;
+  /** Indices of the time-valued nodes the binding decoded, ascending */
+  timeNodes?: Uint32Array;
+  /** Start and end of each decoded node's span in epoch minutes, two values per node */
+  times?: Float64Array;
+}
+
+/**
+ * Symbol and field name tables needed to decode an `EncodedSyntaxTree`.
+ */
+export interface EncodedLanguage {
+  readonly symbolNames: readonly string[];
+  readonly fieldNames: readonly string[];
+}
+
+// Field name -> id lookups, computed once per language
+const fieldIdCache = new WeakMap<EncodedLanguage, Map<string, number>>();
+
+function getFieldIds(language: EncodedLanguage): Map<string, number> {
+  let ids = fieldIdCache.get(language);
+  if (!ids) {
+    ids = new Map();
+    for (let i = 1; i < language.fieldNames.length; i++) {
+      ids.set(language.fieldNames[i], i);
+    }
+    fieldIdCache.set(language, ids);
+  }
+  return ids;
+}
+
+function pointLessThan(a: Point, b: Point): boolean {
+  return a.row < b.row || (a.row === b.row && a.column < b.column);
+}
+
+function pointLessOrEqual(a: Point, b: Point): boolean {
+  return a.row < b.row || (a.row === b.row && a.column <= b.column);
+}
+
+/**
+ * A read-only tree decoded from an `EncodedSyntaxTree`.
+ *
+ * Satisfies `GenericTree`, so it can be stored in parsed blocks like a tree-sitter tree.
+ * Encoded trees are snapshots: `edit()` is a no-op and re-parsing always rebuilds the tree.
+ */
+export class EncodedTree {
+  /** The source the tree was parsed from */
+  readonly source: string;
+  /** The raw encoding */
+  readonly encoded: EncodedSyntaxTree;
+  /** Name tables for the grammar that produced the encoding */
+  readonly language: EncodedLanguage;
+  /** Field name -> id lookup for `language` */
+  readonly fieldIds: Map<string, number>;
+
+  // Nodes are materialized lazily and cached so identity comparisons behave
+  private readonly nodes: (EncodedNode | undefined)[];
+
+  constructor(encoded: EncodedSyntaxTree, source: string, language: EncodedLanguage) {
+    this.encoded = encoded;
+    this.source = source;
+    this.language = language;
+    this.fieldIds = getFieldIds(language);
+    this.nodes = new Array(encoded.nodeCount);
+  }
+
+  get rootNode(): SyntaxNode {
+    return this.node(0);
+  }
+
+  /**
+   * Encoded trees cannot be edited in place; callers re-parse the new source instead.
+   */
+  edit(_edit: TreeEdit): void {}
+
+  /**
+   * Create a cursor positioned at the root node.
+   */
+  walk(): EncodedTreeCursor {
+    return new EncodedTreeCursor(this);
+  }
+
+  /**
+   * Get the decoded time span of the node at a pre-order index, if the binding decoded one.
+   */
+  timeSpan(index: number): { start: number; end: number } | undefined {
+    const { timeNodes, times } = this.encoded;
+    if (!timeNodes || !times) {
+      return undefined;
+    }
+    let lo = 0;
+    let hi = timeNodes.length;
+    while (lo < hi) {
+      const mid = (lo + hi) >>> 1;
+      if (timeNodes[mid] < index) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    if (lo === timeNodes.length || timeNodes[lo] !== index) {
+      return undefined;
+    }
+    return { start: times[lo * 2], end: times[lo * 2 + 1] };
+  }
+
+  /**
+   * Get the node at a pre-order index.
+   */
+  node(index: number): EncodedNode {
+    let node = this.nodes[index];
+    if (!node) {
+      node = new EncodedNode(this, index);
+      this.nodes[index] = node;
+    }
+    return node;
+  }
+}
+
+/**
+ * A `SyntaxNode` view over one slot of an `EncodedTree`.
+ */
+export class EncodedNode implements SyntaxNode {
+  readonly tree: EncodedTree;
+  readonly id: number;
+
+  constructor(tree: EncodedTree, id: number) {
+    this.tree = tree;
+    this.id = id;
+  }
+
+  get type(): string {
+    const symbol = this.tree.encoded.types[this.id];
+    return symbol === ERROR_SYMBOL ? "ERROR" : this.tree.language.symbolNames[symbol];
+  }
+
+  get text(): string {
+    return this.tree.source.slice(this.startIndex, this.endIndex);
+  }
+
+  get startIndex(): number {
+    return this.tree.encoded.ranges[this.id * RANGE_STRIDE];
+  }
+
+  get endIndex(): number {
+    return this.tree.encoded.ranges[this.id * RANGE_STRIDE + 1];
+  }
+
+  get startPosition(): Point {
+    const ranges = this.tree.encoded.ranges;
+    const base = this.id * RANGE_STRIDE;
+    return { row: ranges[base + 2], column: ranges[base + 3] };
+  }
+
+  get endPosition(): Point {
+    const ranges = this.tree.encoded.ranges;
+    const base = this.id * RANGE_STRIDE;
+    return { row: ranges[base + 4], column: ranges[base + 5] };
+  }
+
+  get isNamed(): boolean {
+    return (this.tree.encoded.flags[this.id] & NODE_NAMED) !== 0;
+  }
+
+  get isMissing(): boolean {
+    return (this.tree.encoded.flags[this.id] & NODE_MISSING) !== 0;
+  }
+
+  get hasError(): boolean {
+    return (this.tree.encoded.flags[this.id] & NODE_HAS_ERROR) !== 0;
+  }
+
+  get parent(): SyntaxNode | null {
+    const parent = this.tree.encoded.parents[this.id];
+    return parent < 0 ? null : this.tree.node(parent);
+  }
+
+  get children(): SyntaxNode[] {
+    const children: SyntaxNode[] = [];
+    const ends = this.tree.encoded.subtreeEnds;
+    for (let child = this.id + 1; child < ends[this.id]; child = ends[child]) {
+      children.push(this.tree.node(child));
+    }
+    return children;
+  }
+
+  get namedChildren(): SyntaxNode[] {
+    const children: SyntaxNode[] = [];
+    const { subtreeEnds: ends, flags } = this.tree.encoded;
+    for (let child = this.id + 1; child < ends[this.id]; child = ends[child]) {
+      if (flags[child] & NODE_NAMED) {
+        children.push(this.tree.node(child));
+      }
+    }
+    return children;
+  }
+
+  childForFieldName(fieldName: string): SyntaxNode | null {
+    const fieldId = this.tree.fieldIds.get(fieldName);
+    if (fieldId === undefined) {
+      return null;
+    }
+    const { subtreeEnds: ends, fields } = this.tree.encoded;
+    for (let child = this.id + 1; child < ends[this.id]; child = ends[child]) {
+      if (fields[child] === fieldId) {
+        return this.tree.node(child);
+      }
+    }
+    return null;
+  }
+
+  childrenForFieldName(fieldName: string): SyntaxNode[] {
+    const fieldId = this.tree.fieldIds.get(fieldName);
+    if (fieldId === undefined) {
+      return [];
+    }
+    const children: SyntaxNode[] = [];
+    const { subtreeEnds: ends, fields } = this.tree.encoded;
+    for (let child = this.id + 1; child < ends[this.id]; child = ends[child]) {
+      if (fields[child] === fieldId) {
+        children.push(this.tree.node(child));
+      }
+    }
+    return children;
+  }
+
+  /**
+   * Find the smallest node spanning the given range, mirroring
+   * `ts_node_descendant_for_point_range`.
+   */
+  descendantForPosition(start: Point, end: Point = start): SyntaxNode | null {
+    const ends = this.tree.encoded.subtreeEnds;
+    let node = this.tree.node(this.id);
+    let descended = true;
+
+    while (descended) {
+      descended = false;
+      for (let index = node.id + 1; index < ends[node.id]; index = ends[index]) {
+        const child = this.tree.node(index);
+        const childStart = child.startPosition;
+        const childEnd = child.endPosition;
+
+        // The child must reach the end of the range...
+        if (pointLessThan(childEnd, end)) {
+          continue;
+        }
+        // ...and extend past its start (empty nodes may touch it)
+        const isEmpty = childStart.row === childEnd.row && childStart.column === childEnd.column;
+        if (isEmpty ? pointLessThan(childEnd, start) : pointLessOrEqual(childEnd, start)) {
+          continue;
+        }
+        // ...and begin at or before the start of the range
+        if (pointLessThan(start, childStart)) {
+          break;
+        }
+
+        node = child;
+        descended = true;
+        break;
+      }
+    }
+
+    return node;
+  }
+
+  descendantsOfType(
+    type: string | string[],
+    startPosition?: Point,
+    endPosition?: Point,
+  ): SyntaxNode[] {
+    const types = new Set(Array.isArray(type) ? type : [type]);
+    const descendants: SyntaxNode[] = [];
+    const ends = this.tree.encoded.subtreeEnds;
+
+    for (let index = this.id + 1; index < ends[this.id]; index++) {
+      const node = this.tree.node(index);
+      if (!types.has(node.type)) {
+        continue;
+      }
+      if (startPosition && pointLessOrEqual(node.endPosition, startPosition)) {
+        continue;
+      }
+      if (endPosition && pointLessOrEqual(endPosition, node.startPosition)) {
+        continue;
+      }
+      descendants.push(node);
+    }
+
+    return descendants;
+  }
+}
+
+/**
+ * A minimal tree cursor over an `EncodedTree`, matching the subset of tree-sitter's
+ * `TreeCursor` used for depth-first traversals.
+ */
+export class EncodedTreeCursor {
+  private readonly tree: EncodedTree;
+  private index = 0;
+
+  constructor(tree: EncodedTree) {
+    this.tree = tree;
+  }
+
+  get currentNode(): SyntaxNode {
+    return this.tree.node(this.index);
+  }
+
+  gotoFirstChild(): boolean {
+    const first = this.index + 1;
+    if (first < this.tree.encoded.subtreeEnds[this.index]) {
+      this.index = first;
+      return true;
+    }
+    return false;
+  }
+
+  gotoNextSibling(): boolean {
+    const { parents, subtreeEnds } = this.tree.encoded;
+    const parent = parents[this.index];
+    if (parent < 0) {
+      return false;
+    }
+    const next = subtreeEnds[this.index];
+    if (next < subtreeEnds[parent]) {
+      this.index = next;
+      return true;
+    }
+    return false;
+  }
+
+  gotoParent(): boolean {
+    const parent = this.tree.encoded.parents[this.index];
+    if (parent < 0) {
+      return false;
+    }
+    this.index = parent;
+    return true;
+  }
+}
@@ -1,5 +1,6 @@
 import type { SyntaxNode } from "./ast-types.js";
 import { buildTimestamp, createSyntaxError } from "./builder.js";
+import { decodeDatetime, decodeDaterange, nativeTimeSpan } from "./time.js";
 import type {
   AstNode,
   Location,
@@ -831,10 +832,7 @@ function extractValueContent(node: SyntaxNode): ValueContent {
     case "datetime_value":
       return extractDatetimeValue(node);
     case "daterange":
-      return {
-        ...baseNode(node, "daterange"),
-        raw: node.text.trim(),
-      };
+      return extractDaterangeValue(node);
     case "number_value":
       return {
         ...baseNode(node, "number_value"),
@@ -865,12 +863,32 @@ function extractDatetimeValue(node: SyntaxNode): DatetimeValue {
   const timeNode = node.childForFieldName("time");
   const tzNode = node.childForFieldName("tz");
 
+  const value = node.text.trim();
+  const { start, end } = nativeTimeSpan(node) ?? decodeDatetime(value);
+
   return {
     ...baseNode(node, "datetime_value"),
-    value: node.text.trim(),
+    value,
     date: dateNode?.text ?? "",
     time: timeNode?.text ?? null,
     tz: tzNode?.text ?? null,
+    start,
+    end,
+  };
+}
+
+/**
+ * Extract a daterange value with its decoded span
+ */
+function extractDaterangeValue(node: SyntaxNode): DaterangeValue {
+  const raw = node.text.trim();
+  const { start, end } = nativeTimeSpan(node) ?? decodeDaterange(raw);
+
+  return {
+    ...baseNode(node, "daterange"),
+    raw,
+    start,
+    end,
   };
 }
 
@@ -896,10 +914,7 @@ function extractValueArray(node: SyntaxNode): ValueArray {
     } else if (child.type === "datetime_value") {
       elements.push(extractDatetimeValue(child));
     } else if (child.type === "daterange") {
-      elements.push({
-        ...baseNode(child, "daterange"),
-        raw: child.text.trim(),
-      });
+      elements.push(extractDaterangeValue(child));
     } else if (child.type === "number_value") {
       elements.push({
         ...baseNode(child, "number_value"),
@@ -1,6 +1,6 @@
 import { describe, it, expect } from "vitest";
 import { parseDocument } from "../parser.js";
-import { findNodeAtPosition } from "./node-at-position.js";
+import { findNodeAtPosition, findNodesAtPositions } from "./node-at-position.js";
 
 describe("findNodeAtPosition", () => {
   describe("title nodes", () => {
@@ -157,4 +157,42 @@ describe("findNodeAtPosition", () => {
       }
     });
   });
+
+  describe("findNodesAtPositions", () => {
+    it("resolves every position like findNodeAtPosition", () => {
+      const source = `# Notes
+
+\`\`\`thalo
+2026-01-05T18:00Z create lore "First" ^first #test
+  type: "fact"
+\`\`\`
+
+Text between blocks.
+
+\`\`\`thalo
+2026-01-05T19:00Z create lore "Second" ^second #test
+  related: ^first
+\`\`\`
+`;
+      const parsed = parseDocument(source, { fileType: "markdown" });
+      const positions = [
+        { line: 3, column: 39 },
+        { line: 7, column: 3 },
+        { line: 10, column: 5 },
+        { line: 11, column: 13 },
+        { line: 0, column: 0 },
+      ];
+
+      const results = findNodesAtPositions(parsed, positions);
+
+      expect(results).toEqual(positions.map((position) => findNodeAtPosition(parsed, position)));
+      expect(results.map((result) => result.kind)).toEqual([
+        "link",
+        "unknown",
+        "timestamp",
+        "link",
+        "unknown",
+      ]);
+    });
+  });
 });
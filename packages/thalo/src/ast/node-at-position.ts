@@ -6,6 +6,7 @@ import {
   type SourceMap,
   type Position,
 } from "../source-map.js";
+import { descendantForPosition, descendantsForPositions } from "./position-index.js";
 import type {
   Link,
   Tag,
@@ -330,24 +331,75 @@ export function findNodeAtPosition(
   const { block, blockPosition } = match;
   const point = positionToPoint(blockPosition);
 
-  // Use tree-sitter to find the deepest node at this position
-  // Type assertion: both native and web tree-sitter rootNode have compatible interfaces
-  const rootNode = block.tree.rootNode as SyntaxNode;
-  let node = rootNode.descendantForPosition(point);
+  // Find the deepest node at this position, searching only the entry that contains it
+  return contextOfNode(descendantForPosition(block.tree, point), point, block);
+}
 
-  if (!node) {
+/**
+ * Find the semantic contexts at many positions of one document, e.g. every link for document
+ * links or inlay hints.
+ *
+ * The positions are sorted, so the blocks and each block's entries are walked once for the
+ * whole batch instead of searched once per position.
+ *
+ * @param parsed - The parsed document (may contain multiple blocks for markdown)
+ * @param positions - File-absolute positions (0-based line and column)
+ * @returns The context at each position, in the same order
+ */
+export function findNodesAtPositions(
+  parsed: ParsedDocument<GenericTree>,
+  positions: readonly Position[],
+): NodeContext[] {
+  const order = positions.map((_, i) => i);
+  order.sort(
+    (a, b) => positions[a].line - positions[b].line || positions[a].column - positions[b].column,
+  );
+
+  const results: NodeContext[] = new Array(positions.length);
+  let i = 0;
+  while (i < order.length) {
+    const match = findBlockAtPosition(parsed.blocks, positions[order[i]]);
+    if (!match) {
+      results[order[i++]] = { kind: "unknown" };
+      continue;
+    }
+
+    // The sorted positions in the same block follow each other
+    const batch = [order[i]];
+    const points = [positionToPoint(match.blockPosition)];
+    for (i++; i < order.length; i++) {
+      const next = findBlockAtPosition([match.block], positions[order[i]]);
+      if (!next) {
+        break;
+      }
+      batch.push(order[i]);
+      points.push(positionToPoint(next.blockPosition));
+    }
+
+    const nodes = descendantsForPositions(match.block.tree, points);
+    batch.forEach((index, k) => {
+      results[index] = contextOfNode(nodes[k], points[k], match.block);
+    });
+  }
+  return results;
+}
+
+/**
+ * Classify the node found at a point, or the child of it ending exactly at the point.
+ */
+function contextOfNode(
+  found: SyntaxNode | null,
+  point: Point,
+  block: ParsedBlock,
+): NodeContext {
+  if (!found) {
     return { kind: "unknown" };
   }
 
   // Handle edge case: position is at the exact end of a node
   // In this case, descendantForPosition might return the parent node
   // Try to find a child node that ends exactly at this position
-  const endMatchingChild = findChildEndingAt(node, point);
-  if (endMatchingChild) {
-    node = endMatchingChild;
-  }
-
-  return classifyNode(node, point, block);
+  return classifyNode(findChildEndingAt(found, point) ?? found, point, block);
 }
 
 /**
@@ -0,0 +1,82 @@
+import { describe, it, expect } from "vitest";
+import { parseDocument } from "../parser.js";
+import { createParser } from "../parser.native.js";
+import { Document } from "../model/document.js";
+import type { GenericTree } from "../parser.shared.js";
+import { descendantForPosition, descendantsForPositions } from "./position-index.js";
+
+const source = `2026-01-05T18:00Z create lore "First" ^first #test
+  type: "fact"
+
+// A comment between entries
+2026-01-05T19:00Z create lore "Second" ^second #test
+  type: "insight"
+  related: ^first
+
+  # Section
+  Content.
+
+2026-01-05T20:00Z define-entity note "Note"
+  # Metadata
+  title: string
+`;
+
+/** Every point of `text`, including one past the end of each line and the line after it. */
+function allPoints(text: string): { row: number; column: number }[] {
+  const lines = text.split("\n");
+  const points = [];
+  for (let row = 0; row < lines.length + 1; row++) {
+    for (let column = 0; column <= (lines[row]?.length ?? 0) + 1; column++) {
+      points.push({ row, column });
+    }
+  }
+  return points;
+}
+
+function expectSameAsRoot(tree: GenericTree, text: string): void {
+  for (const point of allPoints(text)) {
+    const expected = tree.rootNode.descendantForPosition(point);
+    const found = descendantForPosition(tree, point);
+    expect([found?.type, found?.startIndex, found?.endIndex]).toEqual([
+      expected?.type,
+      expected?.startIndex,
+      expected?.endIndex,
+    ]);
+  }
+}
+
+describe("descendantForPosition", () => {
+  it("finds the same node as the root's descendantForPosition everywhere", () => {
+    const { tree } = parseDocument(source, { fileType: "thalo" }).blocks[0];
+    expectSameAsRoot(tree, source);
+  });
+
+  it("keeps the index right across a document's edits", () => {
+    const doc = new Document(createParser(), "test.thalo", source);
+    expectSameAsRoot(doc.blocks[0].tree, doc.source);
+
+    // Insert an entry between two others, edit inside one, and join two entries
+    doc.applyEdit(3, 0, 3, 0, '2026-01-05T18:30Z create lore "Inserted"\n  type: "fact"\n\n');
+    expectSameAsRoot(doc.blocks[0].tree, doc.source);
+    doc.applyEdit(1, 9, 1, 13, "insight, longer");
+    expectSameAsRoot(doc.blocks[0].tree, doc.source);
+    doc.applyEdit(2, 0, 6, 0, "");
+    expectSameAsRoot(doc.blocks[0].tree, doc.source);
+  });
+});
+
+describe("descendantsForPositions", () => {
+  it("finds what descendantForPosition finds at each point", () => {
+    const { tree } = parseDocument(source, { fileType: "thalo" }).blocks[0];
+    const points = allPoints(source);
+
+    const found = descendantsForPositions(tree, points);
+
+    expect(found.map((node) => [node?.type, node?.startIndex, node?.endIndex])).toEqual(
+      points.map((point) => {
+        const node = descendantForPosition(tree, point);
+        return [node?.type, node?.startIndex, node?.endIndex];
+      }),
+    );
+  });
+});
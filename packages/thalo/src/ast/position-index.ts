@@ -0,0 +1,266 @@
+/**
+ * A sorted index of a tree's top-level nodes (entries, comments) by position.
+ *
+ * Finding the node at a position with `descendantForPosition` scans the root's children one by
+ * one, which is linear in the number of entries for every lookup. The index keeps the
+ * children's ranges in a flat array, so the child containing a position is found by binary
+ * search and only that child's subtree is searched.
+ *
+ * The index is built on a tree's first lookup and carried over to the tree re-parsed from it
+ * by `updatePositionIndex`, which re-reads only the children in the edited and changed ranges.
+ */
+import type { Point, SyntaxNode } from "./ast-types.js";
+import type { GenericTree, TreeEdit, TreeRange } from "../parser.shared.js";
+
+interface TopLevelIndex {
+  /** Start row, start column, end row and end column of each of the root's children */
+  points: Int32Array;
+  /** The children read so far, by index; they belong to the indexed tree */
+  nodes: (SyntaxNode | undefined)[];
+}
+
+/**
+ * The child accessors tree-sitter and web-tree-sitter nodes have; `SyntaxNode` leaves them out.
+ */
+interface IndexedRoot extends SyntaxNode {
+  readonly childCount?: number;
+  child?(index: number): SyntaxNode | null;
+}
+
+/**
+ * Indexes by tree. A tree is immutable once parsed except for `edit`, after which its index
+ * must be passed on with `updatePositionIndex`.
+ */
+const indexes = new WeakMap<GenericTree, TopLevelIndex>();
+
+function childCount(root: IndexedRoot): number {
+  return root.childCount ?? root.children.length;
+}
+
+function childAt(root: IndexedRoot, index: number): SyntaxNode | null {
+  return root.child ? root.child(index) : (root.children[index] ?? null);
+}
+
+function writeRange(points: Int32Array, i: number, node: SyntaxNode | null): void {
+  // A missing child (web-tree-sitter may report null) is left empty at the previous end
+  const previousEnd = i > 0 ? { row: points[4 * i - 2], column: points[4 * i - 1] } : undefined;
+  const start = node?.startPosition ?? previousEnd ?? { row: 0, column: 0 };
+  const end = node?.endPosition ?? start;
+  points[4 * i] = start.row;
+  points[4 * i + 1] = start.column;
+  points[4 * i + 2] = end.row;
+  points[4 * i + 3] = end.column;
+}
+
+function buildIndex(tree: GenericTree): TopLevelIndex {
+  const children = tree.rootNode.children;
+  const points = new Int32Array(children.length * 4);
+  const nodes: (SyntaxNode | undefined)[] = new Array(children.length);
+  for (let i = 0; i < children.length; i++) {
+    writeRange(points, i, children[i]);
+    nodes[i] = children[i] ?? undefined;
+  }
+  return { points, nodes };
+}
+
+function getIndex(tree: GenericTree): TopLevelIndex {
+  let index = indexes.get(tree);
+  if (!index) {
+    index = buildIndex(tree);
+    indexes.set(tree, index);
+  }
+  return index;
+}
+
+function comparePoints(a: Point, b: Point): number {
+  return a.row - b.row || a.column - b.column;
+}
+
+/** Compare the point at `offset` in `points` with `point`. */
+function compareAt(points: Int32Array, offset: number, point: Point): number {
+  return points[offset] - point.row || points[offset + 1] - point.column;
+}
+
+/** Where a point at or after the end of `edit` in the edited text lies in the new text. */
+function shiftPoint(row: number, column: number, edit: TreeEdit): Point {
+  const { oldEndPosition, newEndPosition } = edit;
+  if (row === oldEndPosition.row) {
+    const shifted = newEndPosition.column + column - oldEndPosition.column;
+    return { row: newEndPosition.row, column: shifted };
+  }
+  return { row: row + newEndPosition.row - oldEndPosition.row, column };
+}
+
+/**
+ * Pass the index of `oldTree` on to `newTree`, re-parsed from it after `edit`.
+ *
+ * Outside the edit and the changed ranges the two trees have the same top-level nodes, so only
+ * the children overlapping them are read from `newTree`. Children before them are kept and
+ * children after them are shifted by the edit. Without changed ranges, i.e. when `newTree` was
+ * not parsed incrementally, the index is dropped and rebuilt on the next lookup.
+ *
+ * @param edit - The edit passed to `oldTree.edit`
+ * @param changedRanges - `oldTree.getChangedRanges(newTree)`
+ */
+export function updatePositionIndex(
+  oldTree: GenericTree,
+  newTree: GenericTree,
+  edit: TreeEdit,
+  changedRanges: readonly TreeRange[] | undefined,
+): void {
+  const old = indexes.get(oldTree);
+  indexes.delete(oldTree);
+  if (!old || !changedRanges) {
+    return;
+  }
+
+  // The part of the new text whose top-level nodes may differ
+  let dirtyStart: Point = edit.startPosition;
+  let dirtyEnd: Point = edit.newEndPosition;
+  for (const range of changedRanges) {
+    if (comparePoints(range.startPosition, dirtyStart) < 0) {
+      dirtyStart = range.startPosition;
+    }
+    if (comparePoints(range.endPosition, dirtyEnd) > 0) {
+      dirtyEnd = range.endPosition;
+    }
+  }
+
+  const count = old.points.length / 4;
+  let prefix = 0;
+  while (prefix < count && compareAt(old.points, 4 * prefix + 2, dirtyStart) < 0) {
+    prefix++;
+  }
+  let suffix = 0;
+  while (suffix < count - prefix) {
+    const i = count - 1 - suffix;
+    if (compareAt(old.points, 4 * i, edit.oldEndPosition) < 0) {
+      break;
+    }
+    const start = shiftPoint(old.points[4 * i], old.points[4 * i + 1], edit);
+    if (comparePoints(start, dirtyEnd) <= 0) {
+      break;
+    }
+    suffix++;
+  }
+
+  const root = newTree.rootNode as IndexedRoot;
+  const newCount = childCount(root);
+  const middle = newCount - prefix - suffix;
+  if (middle < 0) {
+    return;
+  }
+
+  const points = new Int32Array(newCount * 4);
+  points.set(old.points.subarray(0, 4 * prefix));
+  const nodes: (SyntaxNode | undefined)[] = new Array(newCount);
+  for (let i = prefix; i < prefix + middle; i++) {
+    const node = childAt(root, i);
+    writeRange(points, i, node);
+    nodes[i] = node ?? undefined;
+  }
+  for (let j = 0; j < suffix; j++) {
+    const from = 4 * (count - suffix + j);
+    const to = 4 * (prefix + middle + j);
+    const start = shiftPoint(old.points[from], old.points[from + 1], edit);
+    const end = shiftPoint(old.points[from + 2], old.points[from + 3], edit);
+    points[to] = start.row;
+    points[to + 1] = start.column;
+    points[to + 2] = end.row;
+    points[to + 3] = end.column;
+  }
+  indexes.set(newTree, { points, nodes });
+}
+
+/**
+ * From `first`, the first child whose end reaches the point, find the child to search, as in
+ * ts_node_descendant_for_point_range: skip children ending exactly at the point unless they
+ * are empty, and stop at the first child starting after it.
+ *
+ * @returns The index of the child, or -1 if no top-level node contains the point
+ */
+function childContaining(points: Int32Array, first: number, point: Point): number {
+  const count = points.length / 4;
+  for (let i = first; i < count; i++) {
+    const endsAtPoint = compareAt(points, 4 * i + 2, point) === 0;
+    const isEmpty = points[4 * i] === points[4 * i + 2] && points[4 * i + 1] === points[4 * i + 3];
+    if (endsAtPoint && !isEmpty) {
+      continue;
+    }
+    if (compareAt(points, 4 * i, point) > 0) {
+      break;
+    }
+    return i;
+  }
+  return -1;
+}
+
+function descendantInChild(
+  tree: GenericTree,
+  index: TopLevelIndex,
+  child: number,
+  point: Point,
+): SyntaxNode | null {
+  if (child < 0) {
+    return tree.rootNode;
+  }
+  let node = index.nodes[child];
+  if (!node) {
+    node = childAt(tree.rootNode as IndexedRoot, child) ?? undefined;
+    index.nodes[child] = node;
+  }
+  return node ? node.descendantForPosition(point) : tree.rootNode;
+}
+
+/**
+ * Find the smallest node of a tree spanning a point, like `rootNode.descendantForPosition`,
+ * searching only the top-level node that contains it.
+ *
+ * @param tree - The tree to search
+ * @param point - A block-relative point
+ * @returns The deepest node at the point, or the root if no top-level node contains it
+ */
+export function descendantForPosition(tree: GenericTree, point: Point): SyntaxNode | null {
+  const index = getIndex(tree);
+  const { points } = index;
+
+  // The first child whose end reaches the point
+  let lo = 0;
+  let hi = points.length / 4;
+  while (lo < hi) {
+    const mid = (lo + hi) >>> 1;
+    if (compareAt(points, 4 * mid + 2, point) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  return descendantInChild(tree, index, childContaining(points, lo, point), point);
+}
+
+/**
+ * `descendantForPosition` for many points of one tree, in one pass over the top-level nodes.
+ *
+ * @param tree - The tree to search
+ * @param points - Block-relative points, sorted in ascending order
+ * @returns The deepest node at each point, in the same order
+ */
+export function descendantsForPositions(
+  tree: GenericTree,
+  points: readonly Point[],
+): (SyntaxNode | null)[] {
+  const index = getIndex(tree);
+  const count = index.points.length / 4;
+  const result: (SyntaxNode | null)[] = [];
+
+  // The first child whose end reaches the current point only moves forward
+  let first = 0;
+  for (const point of points) {
+    while (first < count && compareAt(index.points, 4 * first + 2, point) < 0) {
+      first++;
+    }
+    result.push(descendantInChild(tree, index, childContaining(index.points, first, point), point));
+  }
+  return result;
+}
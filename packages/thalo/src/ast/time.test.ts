@@ -0,0 +1,81 @@
+import { describe, it, expect } from "vitest";
+import { decodeDatetime, decodeDaterange, epochMinutes, parseTimestampMinutes } from "./time.js";
+import { createWorkspace } from "../parser.native.js";
+import type { InstanceEntry } from "./ast-types.js";
+
+const minutes = (iso: string) => Date.parse(iso) / 60_000;
+
+describe("epochMinutes", () => {
+  it("converts civil time with an offset to UTC minutes", () => {
+    expect(epochMinutes(2026, 1, 5, 18, 30, 330)).toBe(minutes("2026-01-05T13:00Z"));
+  });
+
+  it("carries out-of-range fields like Date.UTC", () => {
+    expect(epochMinutes(2026, 13, 1)).toBe(minutes("2027-01-01T00:00Z"));
+    expect(epochMinutes(2026, 1, 0)).toBe(minutes("2025-12-31T00:00Z"));
+  });
+});
+
+describe("decodeDatetime", () => {
+  it("decodes a date to the whole day", () => {
+    expect(decodeDatetime("2026-01-05")).toEqual({
+      start: minutes("2026-01-05T00:00Z"),
+      end: minutes("2026-01-06T00:00Z"),
+    });
+  });
+
+  it("decodes a time to a one-minute instant", () => {
+    const start = minutes("2026-01-05T17:00Z");
+    expect(decodeDatetime("2026-01-05T18:00+01:00")).toEqual({ start, end: start + 1 });
+    expect(decodeDatetime("2026-01-05T17:00")).toEqual({ start, end: start + 1 });
+  });
+
+  it("returns NaN bounds for other text", () => {
+    expect(decodeDatetime("yesterday").start).toBeNaN();
+  });
+});
+
+describe("decodeDaterange", () => {
+  it.each([
+    ["2026 Q2", "2026-04-01T00:00Z", "2026-07-01T00:00Z"],
+    ["2026-02", "2026-02-01T00:00Z", "2026-03-01T00:00Z"],
+    ["2024 ~ 2025", "2024-01-01T00:00Z", "2026-01-01T00:00Z"],
+    ["2024-03 ~ 2024-05", "2024-03-01T00:00Z", "2024-06-01T00:00Z"],
+    ["2024-03-01 ~ 2024-03-31", "2024-03-01T00:00Z", "2024-04-01T00:00Z"],
+  ])("decodes %s", (raw, start, end) => {
+    expect(decodeDaterange(raw)).toEqual({ start: minutes(start), end: minutes(end) });
+  });
+
+  it("leaves open-ended ranges unbounded", () => {
+    expect(decodeDaterange("2025-06 ~")).toEqual({
+      start: minutes("2025-06-01T00:00Z"),
+      end: Infinity,
+    });
+  });
+});
+
+describe("parseTimestampMinutes", () => {
+  it("parses grammar timestamps and other ISO strings", () => {
+    expect(parseTimestampMinutes("2026-01-05T18:00+01:00")).toBe(minutes("2026-01-05T17:00Z"));
+    expect(parseTimestampMinutes("2026-01-05T17:00:30Z")).toBe(minutes("2026-01-05T17:00Z"));
+    expect(parseTimestampMinutes("never")).toBeNaN();
+  });
+});
+
+describe("decoded spans in the AST", () => {
+  it("match the JS decoders", () => {
+    const model = createWorkspace().addDocument(
+      `2026-01-05T10:00+01:00 create lore "Title"
+  when: 2026-01-05
+  period: 2026 Q1
+`,
+      { filename: "a.thalo" },
+    );
+    const entry = model.ast.entries[0] as InstanceEntry;
+
+    expect(entry.header.timestamp.epochMinutes).toBe(minutes("2026-01-05T09:00Z"));
+    const [when, period] = entry.metadata.map((m) => m.value.content);
+    expect(when).toMatchObject(decodeDatetime("2026-01-05"));
+    expect(period).toMatchObject(decodeDaterange("2026 Q1"));
+  });
+});
@@ -0,0 +1,137 @@
+/**
+ * Integer decoding of timestamps, datetimes and dateranges.
+ *
+ * Every time-valued node decodes to a half-open `TimeSpan` in minutes since the Unix epoch,
+ * UTC, so ordering and range checks compare numbers instead of formatted strings. The native
+ * binding decodes the same spans while encoding a tree (see bindings/node/times.cc); these
+ * functions are the fallback for trees it did not encode, and must agree with it.
+ */
+import type { SyntaxNode } from "./ast-types.js";
+import { EncodedNode } from "./encoded-tree.js";
+
+/**
+ * A half-open interval [start, end) in minutes since the Unix epoch, UTC.
+ *
+ * Instants span one minute, dates one day and periods their whole length. Open-ended ranges
+ * end at `Infinity`; undecodable text gives `NaN` for both bounds.
+ */
+export interface TimeSpan {
+  start: number;
+  end: number;
+}
+
+const MINUTES_PER_DAY = 24 * 60;
+
+const UNDECODABLE: TimeSpan = { start: NaN, end: NaN };
+
+/**
+ * Minutes since the epoch of a civil date and time. Out-of-range fields carry over like
+ * `Date.UTC`; a missing timezone is UTC.
+ */
+export function epochMinutes(
+  year: number,
+  month: number,
+  day: number,
+  hour = 0,
+  minute = 0,
+  offsetMinutes = 0,
+): number {
+  return Date.UTC(year, month - 1, day) / 60_000 + hour * 60 + minute - offsetMinutes;
+}
+
+function parseOffset(tz: string | undefined): number {
+  if (!tz || tz === "Z") {
+    return 0;
+  }
+  const sign = tz[0] === "-" ? -1 : 1;
+  return sign * (parseInt(tz.slice(1, 3), 10) * 60 + parseInt(tz.slice(4, 6), 10));
+}
+
+const DATETIME = /^(\d{4})-(\d{2})-(\d{2})(?:T(\d{2}):(\d{2})(Z|[+-]\d{2}:\d{2})?)?$/;
+const QUARTER = /^(\d{4}) +Q(\d)$/;
+const PERIOD = /^(\d{4})(?:-(\d{2})(?:-(\d{2}))?)?$/;
+
+/**
+ * Decode `YYYY-MM-DD` with an optional `THH:MM` and timezone: a day, or a one-minute instant.
+ *
+ * This also decodes header timestamps, whose text always includes the time.
+ */
+export function decodeDatetime(text: string): TimeSpan {
+  const match = DATETIME.exec(text);
+  if (!match) {
+    return UNDECODABLE;
+  }
+  const [, y, mo, d, h, mi, tz] = match;
+  if (h === undefined) {
+    const start = epochMinutes(+y, +mo, +d);
+    return { start, end: start + MINUTES_PER_DAY };
+  }
+  const start = epochMinutes(+y, +mo, +d, +h, +mi, parseOffset(tz));
+  return { start, end: start + 1 };
+}
+
+function decodePeriod(text: string): TimeSpan | undefined {
+  const match = PERIOD.exec(text);
+  if (!match) {
+    return undefined;
+  }
+  const [, y, mo, d] = match;
+  if (mo === undefined) {
+    return { start: epochMinutes(+y, 1, 1), end: epochMinutes(+y + 1, 1, 1) };
+  }
+  if (d === undefined) {
+    return { start: epochMinutes(+y, +mo, 1), end: epochMinutes(+y, +mo + 1, 1) };
+  }
+  return { start: epochMinutes(+y, +mo, +d), end: epochMinutes(+y, +mo, +d + 1) };
+}
+
+/**
+ * Decode a daterange: `YYYY Qn`, a single period (`YYYY-MM`), or partial dates around `~`,
+ * where a missing end leaves the range open.
+ */
+export function decodeDaterange(text: string): TimeSpan {
+  const quarter = QUARTER.exec(text);
+  if (quarter) {
+    const month = (+quarter[2] - 1) * 3 + 1;
+    return {
+      start: epochMinutes(+quarter[1], month, 1),
+      end: epochMinutes(+quarter[1], month + 3, 1),
+    };
+  }
+
+  const tilde = text.indexOf("~");
+  if (tilde === -1) {
+    return decodePeriod(text.trim()) ?? UNDECODABLE;
+  }
+  const first = decodePeriod(text.slice(0, tilde).trim());
+  const rest = text.slice(tilde + 1).trim();
+  const last = rest === "" ? { start: Infinity, end: Infinity } : decodePeriod(rest);
+  if (!first || !last) {
+    return UNDECODABLE;
+  }
+  return { start: first.start, end: last.end };
+}
+
+/**
+ * Decode an ISO-like timestamp string, such as an `afterTimestamp` cut-off or a `ts:`
+ * checkpoint, to epoch minutes.
+ *
+ * Accepts the timestamp syntax of the grammar and falls back to `Date.parse` for anything
+ * else (e.g. seconds), flooring to the minute.
+ *
+ * @returns Minutes since the epoch, or NaN if the string is not a timestamp
+ */
+export function parseTimestampMinutes(text: string): number {
+  const span = decodeDatetime(text);
+  if (!Number.isNaN(span.start)) {
+    return span.start;
+  }
+  return Math.floor(Date.parse(text) / 60_000);
+}
+
+/**
+ * Get the span the native binding decoded for a node, if the node comes from an encoded tree.
+ */
+export function nativeTimeSpan(node: SyntaxNode): TimeSpan | undefined {
+  return node instanceof EncodedNode ? node.tree.timeSpan(node.id) : undefined;
+}
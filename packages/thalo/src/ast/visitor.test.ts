@@ -75,6 +75,7 @@ function createMockTimestamp(value: string, loc: Location): Timestamp {
       location: loc,
       syntaxNode: mockSyntaxNode(),
     },
+    epochMinutes: 29460600,
     location: loc,
     syntaxNode: mockSyntaxNode(),
   };
@@ -197,6 +198,7 @@ function createAstWithError(): SourceFile {
       syntaxNode: mockSyntaxNode(),
     },
     timezone: syntaxError,
+    epochMinutes: 29460600,
     location: mockLocation(0, 16),
     syntaxNode: mockSyntaxNode(),
   };
@@ -0,0 +1,54 @@
+/**
+ * Worker thread entry point for `checkFilesParallel`.
+ *
+ * Builds a workspace of the shard and the documents it depends on (see
+ * `CheckWorkerRequest.documents`), so schemas and links resolve as on the main thread, then runs
+ * entry-local rules on the shard only. Blocks come with the trees the main thread parsed, so
+ * they are not parsed again.
+ */
+
+import { parentPort, workerData } from "node:worker_threads";
+import type { EncodedSyntaxTree } from "../ast/encoded-tree.js";
+import { Workspace } from "../model/workspace.js";
+import { createPreparsedParser, createWorkspace, hasNativeExtraction } from "../parser.native.js";
+import type { SemanticModel } from "../semantic/analyzer.js";
+import { checkEntryLocalRulesOrdered } from "./check.js";
+import type { CheckWorkerRequest, CheckWorkerResponse } from "./parallel.js";
+
+async function main(request: CheckWorkerRequest): Promise<CheckWorkerResponse> {
+  const trees = new Map<string, EncodedSyntaxTree>();
+  for (const document of request.documents) {
+    for (const [source, tree] of document.trees) {
+      trees.set(source, tree);
+    }
+  }
+  const workspace = hasNativeExtraction()
+    ? new Workspace(createPreparsedParser(trees))
+    : createWorkspace();
+  for (const { file, source } of request.documents) {
+    workspace.addDocument(source, { filename: file });
+  }
+  const models = request.shard
+    .map((file) => workspace.getModel(file))
+    .filter((model): model is SemanticModel => model !== undefined);
+
+  return {
+    ok: true,
+    diagnostics: checkEntryLocalRulesOrdered(
+      workspace,
+      models,
+      request.config,
+      undefined,
+      request.firstModel,
+    ),
+  };
+}
+
+main(workerData as CheckWorkerRequest).then(
+  (response) => parentPort?.postMessage(response),
+  (error: unknown) =>
+    parentPort?.postMessage({
+      ok: false,
+      error: error instanceof Error ? error.message : String(error),
+    } satisfies CheckWorkerResponse),
+);
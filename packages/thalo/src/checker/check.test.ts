@@ -2,7 +2,16 @@ import { describe, it, expect, beforeEach } from "vitest";
 import type { SyntaxNode } from "tree-sitter";
 import { createWorkspace } from "../parser.native.js";
 import { Workspace } from "../model/workspace.js";
-import { check, checkModel, checkDocument, checkIncremental } from "./check.js";
+import {
+  check,
+  checkModel,
+  checkDocument,
+  checkIncremental,
+  checkEntryLocalRules,
+  checkSharedRules,
+  isEntryLocalRule,
+} from "./check.js";
+import { allRules } from "./rules/rules.js";
 import type {
   SourceFile,
   InstanceEntry,
@@ -70,6 +79,7 @@ function createAstWithSyntaxError(): SourceFile {
       syntaxNode: mockSyntaxNode(),
     },
     timezone: syntaxError,
+    epochMinutes: 29460600,
     location: mockLocation(0, 16),
     syntaxNode: mockSyntaxNode(),
   };
@@ -511,3 +521,56 @@ describe("checkIncremental", () => {
     expect(unresolvedLink).toBeDefined();
   });
 });
+
+describe("checkEntryLocalRules and checkSharedRules", () => {
+  it("together report the same diagnostics as check", () => {
+    const workspace = createWorkspace();
+    workspace.addDocument(
+      `2026-01-01T00:00Z define-entity lore "Lore entries"
+  # Metadata
+  type: "fact" | "insight"
+  related?: link
+
+  # Sections
+  Summary
+`,
+      { filename: "schema.thalo" },
+    );
+    workspace.addDocument(
+      `2026-01-05T18:00Z create lore "Test entry" ^dup
+  type: "wrong"
+  type: "fact"
+  related: ^nonexistent
+
+2026-01-04T18:00Z create journal "Unknown entity" ^dup
+  type: "fact"
+`,
+      { filename: "a.thalo" },
+    );
+    workspace.addDocument(
+      `2026-01-06T18:00Z create lore "Missing section"
+  type: "insight"
+  // unterminated
+`,
+      { filename: "b.thalo" },
+    );
+
+    const split = [
+      ...checkSharedRules(workspace),
+      ...checkEntryLocalRules(workspace, workspace.allModels()),
+    ];
+    const key = (d: { code: string; file: string; location: Location }) =>
+      `${d.file}:${d.location.startIndex}:${d.code}`;
+
+    expect(split.map(key).sort()).toEqual(check(workspace).map(key).sort());
+  });
+
+  it("classifies rules with cross-entry hooks as shared", () => {
+    const local = new Set(allRules.filter(isEntryLocalRule).map((rule) => rule.code));
+
+    expect(local.has("empty-section")).toBe(true);
+    expect(local.has("duplicate-metadata-key")).toBe(true);
+    expect(local.has("duplicate-link-id")).toBe(false);
+    expect(local.has("timestamp-out-of-order")).toBe(false);
+  });
+});
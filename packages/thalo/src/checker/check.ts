@@ -5,9 +5,9 @@ import type { Rule, Severity } from "./rules/rules.js";
 import { allRules } from "./rules/rules.js";
 import { toFileLocation, type SourceMap } from "../source-map.js";
 import { collectSyntaxErrors as collectSyntaxErrorNodes } from "../ast/visitor.js";
-import { buildWorkspaceIndex } from "./workspace-index.js";
+import { getWorkspaceIndex, type WorkspaceIndex } from "./workspace-index.js";
 import { runVisitors, runVisitorsOnModel, runVisitorsOnEntries } from "./visitor.js";
-import type { RuleVisitor } from "./visitor.js";
+import type { EntryContext, RuleVisitor } from "./visitor.js";
 import type { Location } from "../ast/ast-types.js";
 
 /**
@@ -59,6 +59,48 @@ export function getEffectiveSeverity(rule: Rule, config: CheckConfig): Severity
   return config.rules?.[rule.code] ?? rule.defaultSeverity;
 }
 
+/**
+ * When a diagnostic was reported in a single check pass: the phase (syntax errors, beforeCheck,
+ * entry visits, afterCheck), the index of the model visited, the start offset of the entry
+ * visited and the index of the rule in `allRules`.
+ */
+export type CheckOrder = [phase: number, model: number, entry: number, rule: number];
+
+/**
+ * A diagnostic together with when it was reported, so that diagnostics from a pass split
+ * across threads can be put back in the order `check` reports them (see `sortDiagnostics`).
+ */
+export interface OrderedDiagnostic {
+  diagnostic: Diagnostic;
+  order: CheckOrder;
+}
+
+const PHASE_SYNTAX = 0;
+const PHASE_BEFORE_CHECK = 1;
+const PHASE_VISIT = 2;
+const PHASE_AFTER_CHECK = 3;
+
+function compareOrder(a: CheckOrder, b: CheckOrder): number {
+  return a[0] - b[0] || a[1] - b[1] || a[2] - b[2] || a[3] - b[3];
+}
+
+/**
+ * Sort the diagnostics of split check passes into the order `check` reports them.
+ *
+ * The sort is stable, so diagnostics a rule reports on the same entry keep their order.
+ */
+export function sortDiagnostics(ordered: OrderedDiagnostic[]): Diagnostic[] {
+  return ordered.sort((a, b) => compareOrder(a.order, b.order)).map((d) => d.diagnostic);
+}
+
+/**
+ * Where tracked visitors record ordered diagnostics, and how they number models.
+ */
+interface Ordering {
+  models: ReadonlyMap<SemanticModel, number>;
+  into: OrderedDiagnostic[];
+}
+
 // eslint-disable-next-line @typescript-eslint/no-empty-function
 const noop = () => {};
 
@@ -106,8 +148,8 @@ export function check(workspace: Workspace, config: CheckConfig = {}): Diagnosti
     diagnostics.push(...collectSyntaxErrors(model.ast, model.file, model.sourceMap));
   }
 
-  // Build workspace index for efficient rule execution
-  const index = buildWorkspaceIndex(workspace);
+  // Get the workspace index, updated for whatever changed since the last check
+  const index = getWorkspaceIndex(workspace);
 
   // Get active rules and their visitors
   const activeRules = allRules.filter((r) => getEffectiveSeverity(r, config) !== "off");
@@ -119,6 +161,101 @@ export function check(workspace: Workspace, config: CheckConfig = {}): Diagnosti
   return diagnostics;
 }
 
+/**
+ * Whether a rule only ever looks at the entry it is visiting.
+ *
+ * Such rules have entry scope and no beforeCheck/afterCheck hooks, so running them over any
+ * partition of the workspace's models and concatenating the results gives the same
+ * diagnostics as a single pass. Everything else may correlate entries across files.
+ */
+export function isEntryLocalRule(rule: Rule): boolean {
+  return (
+    rule.dependencies.scope === "entry" && !rule.visitor.beforeCheck && !rule.visitor.afterCheck
+  );
+}
+
+/**
+ * Run only the entry-local rules (see `isEntryLocalRule`) on the given models.
+ *
+ * Together with `checkSharedRules` this covers everything `check` reports, which lets callers
+ * split the entry-local work across threads.
+ */
+export function checkEntryLocalRules(
+  workspace: Workspace,
+  models: Iterable<SemanticModel>,
+  config: CheckConfig = {},
+  index: WorkspaceIndex = getWorkspaceIndex(workspace),
+): Diagnostic[] {
+  return checkEntryLocalRulesOrdered(workspace, models, config, index).map((d) => d.diagnostic);
+}
+
+/**
+ * `checkEntryLocalRules`, with each diagnostic tagged for `sortDiagnostics`.
+ *
+ * @param firstModel - Index of the first of `models` among the models of the full pass
+ */
+export function checkEntryLocalRulesOrdered(
+  workspace: Workspace,
+  models: Iterable<SemanticModel>,
+  config: CheckConfig = {},
+  index: WorkspaceIndex = getWorkspaceIndex(workspace),
+  firstModel = 0,
+): OrderedDiagnostic[] {
+  const modelList = [...models];
+  const ordering: Ordering = {
+    models: new Map(modelList.map((model, i) => [model, firstModel + i])),
+    into: [],
+  };
+
+  const localRules = allRules.filter(
+    (r) => isEntryLocalRule(r) && getEffectiveSeverity(r, config) !== "off",
+  );
+  const visitors = localRules.map((rule) => createTrackedVisitor(rule, config, [], ordering));
+
+  for (const model of modelList) {
+    runVisitorsOnEntries(visitors, model.ast.entries, model, workspace, index, noop);
+  }
+
+  return ordering.into;
+}
+
+/**
+ * Collect syntax errors and run every rule that is not entry-local over the whole workspace.
+ */
+export function checkSharedRules(
+  workspace: Workspace,
+  config: CheckConfig = {},
+  index: WorkspaceIndex = getWorkspaceIndex(workspace),
+): Diagnostic[] {
+  return checkSharedRulesOrdered(workspace, config, index).map((d) => d.diagnostic);
+}
+
+/**
+ * `checkSharedRules`, with each diagnostic tagged for `sortDiagnostics`.
+ */
+export function checkSharedRulesOrdered(
+  workspace: Workspace,
+  config: CheckConfig = {},
+  index: WorkspaceIndex = getWorkspaceIndex(workspace),
+): OrderedDiagnostic[] {
+  const models = workspace.allModels();
+  const ordering: Ordering = { models: new Map(models.map((model, i) => [model, i])), into: [] };
+
+  models.forEach((model, i) => {
+    for (const diagnostic of collectSyntaxErrors(model.ast, model.file, model.sourceMap)) {
+      ordering.into.push({ diagnostic, order: [PHASE_SYNTAX, i, 0, 0] });
+    }
+  });
+
+  const sharedRules = allRules.filter(
+    (r) => !isEntryLocalRule(r) && getEffectiveSeverity(r, config) !== "off",
+  );
+  const visitors = sharedRules.map((rule) => createTrackedVisitor(rule, config, [], ordering));
+  runVisitors(visitors, workspace, index, noop);
+
+  return ordering.into;
+}
+
 /**
  * Check a single model for issues
  */
@@ -131,8 +268,8 @@ export function checkModel(
 
   diagnostics.push(...collectSyntaxErrors(model.ast, model.file, model.sourceMap));
 
-  // Build workspace index
-  const index = buildWorkspaceIndex(workspace);
+  // Get the workspace index
+  const index = getWorkspaceIndex(workspace);
 
   // Get active rules and their visitors
   const activeRules = allRules.filter((r) => getEffectiveSeverity(r, config) !== "off");
@@ -181,8 +318,8 @@ export function checkIncremental(
   // Always collect syntax errors
   diagnostics.push(...collectSyntaxErrors(model.ast, model.file, model.sourceMap));
 
-  // Build index
-  const index = buildWorkspaceIndex(workspace);
+  // Get the index, updated for just the changed files
+  const index = getWorkspaceIndex(workspace);
 
   // Partition rules by scope and dependencies
   const { entryRules, documentRules, workspaceRules } = partitionRulesByScope(
@@ -216,38 +353,59 @@ export function checkIncremental(
 /**
  * Create a visitor that tracks diagnostics for a specific rule.
  * Assumes the rule has already been filtered to ensure severity !== "off".
+ *
+ * With `ordering`, diagnostics are tagged and recorded there instead of in `diagnostics`.
  */
 function createTrackedVisitor(
   rule: Rule,
   config: CheckConfig,
   diagnostics: Diagnostic[],
+  ordering?: Ordering,
 ): RuleVisitor {
   // Safe: callers filter out rules with severity === "off" before calling this function
   const severity = getEffectiveSeverity(rule, config) as Exclude<Severity, "off">;
   const v = rule.visitor;
+  const ruleIndex = allRules.indexOf(rule);
 
-  const wrapCtx = <T extends object>(ctx: T) => ({
+  const wrapCtx = <T extends object>(ctx: T, order?: () => CheckOrder) => ({
     ...ctx,
     report: (partial: PartialDiagnostic) => {
-      diagnostics.push(createDiagnostic(partial, rule.code, severity));
+      const diagnostic = createDiagnostic(partial, rule.code, severity);
+      if (ordering && order) {
+        ordering.into.push({ diagnostic, order: order() });
+      } else {
+        diagnostics.push(diagnostic);
+      }
     },
   });
+  const hookOrder = (phase: number) => (): CheckOrder => [phase, 0, 0, ruleIndex];
+  const entryOrder =
+    (entry: Entry, ctx: EntryContext) => (): CheckOrder => [
+      PHASE_VISIT,
+      ordering?.models.get(ctx.model) ?? -1,
+      entry.location.startIndex,
+      ruleIndex,
+    ];
 
   return {
-    beforeCheck: v.beforeCheck ? (ctx) => v.beforeCheck!(wrapCtx(ctx)) : undefined,
+    beforeCheck: v.beforeCheck
+      ? (ctx) => v.beforeCheck!(wrapCtx(ctx, hookOrder(PHASE_BEFORE_CHECK)))
+      : undefined,
     visitInstanceEntry: v.visitInstanceEntry
-      ? (entry, ctx) => v.visitInstanceEntry!(entry, wrapCtx(ctx))
+      ? (entry, ctx) => v.visitInstanceEntry!(entry, wrapCtx(ctx, entryOrder(entry, ctx)))
       : undefined,
     visitSchemaEntry: v.visitSchemaEntry
-      ? (entry, ctx) => v.visitSchemaEntry!(entry, wrapCtx(ctx))
+      ? (entry, ctx) => v.visitSchemaEntry!(entry, wrapCtx(ctx, entryOrder(entry, ctx)))
       : undefined,
     visitSynthesisEntry: v.visitSynthesisEntry
-      ? (entry, ctx) => v.visitSynthesisEntry!(entry, wrapCtx(ctx))
+      ? (entry, ctx) => v.visitSynthesisEntry!(entry, wrapCtx(ctx, entryOrder(entry, ctx)))
       : undefined,
     visitActualizeEntry: v.visitActualizeEntry
-      ? (entry, ctx) => v.visitActualizeEntry!(entry, wrapCtx(ctx))
+      ? (entry, ctx) => v.visitActualizeEntry!(entry, wrapCtx(ctx, entryOrder(entry, ctx)))
+      : undefined,
+    afterCheck: v.afterCheck
+      ? (ctx) => v.afterCheck!(wrapCtx(ctx, hookOrder(PHASE_AFTER_CHECK)))
       : undefined,
-    afterCheck: v.afterCheck ? (ctx) => v.afterCheck!(wrapCtx(ctx)) : undefined,
   };
 }
 
@@ -0,0 +1,92 @@
+import { describe, it, expect } from "vitest";
+import { mkdtempSync, writeFileSync } from "node:fs";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { loadWorkspaceFromFiles } from "../files.js";
+import { check } from "./check.js";
+import { checkFilesParallel } from "./parallel.js";
+
+describe("checkFilesParallel", () => {
+  it("reports the same diagnostics as check when run on the calling thread", async () => {
+    const dir = mkdtempSync(join(tmpdir(), "thalo-check-"));
+    const files = [join(dir, "schema.thalo"), join(dir, "entries.thalo")];
+    writeFileSync(
+      files[0],
+      `2026-01-01T00:00Z define-entity lore "Lore entries"
+  # Metadata
+  type: "fact" | "insight"
+`,
+    );
+    writeFileSync(
+      files[1],
+      `2026-01-05T18:00Z create lore "Entry" ^dup
+  type: "wrong"
+  type: "fact"
+
+2026-01-04T18:00Z create journal "Unknown" ^dup
+`,
+    );
+
+    const { diagnostics } = await checkFilesParallel(files, { threads: 1 });
+    const expected = check(await loadWorkspaceFromFiles(files));
+    const key = (d: (typeof diagnostics)[number]) => `${d.file}:${d.location.startIndex}:${d.code}`;
+
+    expect(diagnostics.map(key).sort()).toEqual(expected.map(key).sort());
+    expect(diagnostics.length).toBeGreaterThan(0);
+  });
+
+  it("reports the same diagnostics as check, in the same order, on worker threads", async () => {
+    const dir = mkdtempSync(join(tmpdir(), "thalo-check-"));
+    const files = ["schema", "a", "b", "c"].map((name) => join(dir, `${name}.thalo`));
+    writeFileSync(
+      files[0],
+      `2026-01-01T00:00Z define-entity lore "Lore entries"
+  # Metadata
+  type: "fact" | "insight"
+  subject: string
+`,
+    );
+    writeFileSync(
+      files[1],
+      `2026-01-05T18:00Z create lore "First" ^first
+  type: "wrong"
+  type: "fact"
+  subject: "a"
+
+2026-01-04T18:00Z create journal "Unknown entity" ^dup
+`,
+    );
+    writeFileSync(
+      files[2],
+      `2026-01-06T18:00Z update lore "Supersedes across files" ^second
+  type: "fact"
+  subject: "b"
+  supersedes: ^first
+
+2026-01-07T18:00Z update lore "Supersedes an update" ^dup
+  type: "insight"
+  supersedes: ^second
+`,
+    );
+    writeFileSync(
+      files[3],
+      `2026-01-08T18:00Z create lore "Missing fields"
+  unknown: "x"
+
+2026-01-09T18:00Z actualize-synthesis ^nowhere
+  updated: 2026-01-09T18:00Z
+`,
+    );
+
+    const { diagnostics } = await checkFilesParallel(files, {
+      threads: 2,
+      minEntriesPerWorker: 1,
+    });
+    const expected = check(await loadWorkspaceFromFiles(files));
+    const key = (d: (typeof diagnostics)[number]) =>
+      `${d.file}:${d.location.startIndex}:${d.code}:${d.message}`;
+
+    expect(diagnostics.map(key)).toEqual(expected.map(key));
+    expect(new Set(diagnostics.map((d) => d.file)).size).toBeGreaterThan(2);
+  });
+});
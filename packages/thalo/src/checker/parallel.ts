@@ -0,0 +1,236 @@
+/**
+ * Node.js-only parallel checker.
+ *
+ * Entry-local rules (see `isEntryLocalRule`) make up most of the rule set and never correlate
+ * entries with each other, so their work is split into contiguous shards of files and run on
+ * worker threads. Rules that correlate entries across files or documents, and syntax errors,
+ * are collected on the calling thread while the workers run.
+ *
+ * Workspaces cannot be shared between threads, so each worker builds a workspace of its own. It
+ * holds only what entry-local rules can see: the shard, the files defining schemas and the files
+ * defining the links the shard refers to. Every file is parsed once, on the calling thread; the
+ * workers get the encoded syntax trees with the sources and only build the semantic models.
+ *
+ * @module @rejot-dev/thalo/checker/parallel
+ */
+
+import { createRequire } from "node:module";
+import { availableParallelism } from "node:os";
+import { resolve } from "node:path";
+import { pathToFileURL } from "node:url";
+import { Worker } from "node:worker_threads";
+import { EncodedTree, type EncodedSyntaxTree } from "../ast/encoded-tree.js";
+import type { Workspace } from "../model/workspace.js";
+import { loadWorkspaceFromFiles } from "../files.js";
+import { getWorkspaceIndex } from "./workspace-index.js";
+import {
+  checkEntryLocalRulesOrdered,
+  checkSharedRulesOrdered,
+  sortDiagnostics,
+  type CheckConfig,
+  type Diagnostic,
+  type OrderedDiagnostic,
+} from "./check.js";
+
+/**
+ * Options for checkFilesParallel
+ */
+export interface ParallelCheckOptions {
+  /** Checker configuration (rule overrides, etc.) */
+  config?: CheckConfig;
+  /** Maximum number of worker threads (default: available parallelism minus one) */
+  threads?: number;
+  /** Persistent syntax tree cache for loading the files on the calling thread */
+  cacheDir?: string;
+  /** Don't start a worker for fewer entries than this (default: 2000) */
+  minEntriesPerWorker?: number;
+}
+
+/**
+ * A document sent to a check worker, with the syntax trees the calling thread parsed for it.
+ */
+export interface CheckWorkerDocument {
+  file: string;
+  source: string;
+  /** The encoded tree of each block by its source; blocks left out are parsed by the worker */
+  trees: [source: string, tree: EncodedSyntaxTree][];
+}
+
+/**
+ * The message a check worker receives.
+ */
+export interface CheckWorkerRequest {
+  /** The shard and the documents it depends on, in workspace load order */
+  documents: CheckWorkerDocument[];
+  /** Files whose entries this worker checks */
+  shard: string[];
+  /** Index of the shard's first file among the files of the whole workspace */
+  firstModel: number;
+  config: CheckConfig;
+}
+
+/**
+ * The message a check worker replies with.
+ */
+export type CheckWorkerResponse =
+  | { ok: true; diagnostics: OrderedDiagnostic[] }
+  | { ok: false; error: string };
+
+/**
+ * Don't start a worker for fewer entries than this; building its models costs more.
+ */
+const MIN_ENTRIES_PER_WORKER = 2000;
+
+/**
+ * Load and check files, running entry-local rules on worker threads.
+ *
+ * Reports the same diagnostics as `check(await loadWorkspaceFromFiles(files))`, in the same
+ * order.
+ *
+ * @param files - Files to load and check
+ * @param options - Check options
+ * @returns The diagnostics and the workspace they were computed on
+ */
+export async function checkFilesParallel(
+  files: string[],
+  options: ParallelCheckOptions = {},
+): Promise<{ workspace: Workspace; diagnostics: Diagnostic[] }> {
+  const { config = {}, cacheDir, minEntriesPerWorker = MIN_ENTRIES_PER_WORKER } = options;
+  const paths = files.map((file) => resolve(file));
+  const workspace = await loadWorkspaceFromFiles(paths, { bulkExtraction: true, cacheDir });
+
+  const threads = options.threads ?? availableParallelism() - 1;
+  const shards = shardFiles(workspace, threads, minEntriesPerWorker);
+  let firstModel = 0;
+  const workers = shards.map((shard) => {
+    const request: CheckWorkerRequest = {
+      documents: shardContext(workspace, shard).map((file) => workerDocument(workspace, file)),
+      shard,
+      firstModel,
+      config,
+    };
+    firstModel += shard.length;
+    return runWorker(request);
+  });
+
+  const index = getWorkspaceIndex(workspace);
+  const ordered = checkSharedRulesOrdered(workspace, config, index);
+  if (shards.length === 0) {
+    ordered.push(...checkEntryLocalRulesOrdered(workspace, workspace.allModels(), config, index));
+  }
+  for (const shardDiagnostics of await Promise.all(workers)) {
+    ordered.push(...shardDiagnostics);
+  }
+
+  return { workspace, diagnostics: sortDiagnostics(ordered) };
+}
+
+/**
+ * Split the workspace's files into contiguous shards of roughly equal entry counts.
+ *
+ * @returns One shard per worker, or none if the work is too small to be worth a worker
+ */
+function shardFiles(
+  workspace: Workspace,
+  maxThreads: number,
+  minEntriesPerWorker: number,
+): string[][] {
+  const models = workspace.allModels();
+  const totalEntries = models.reduce((sum, model) => sum + model.ast.entries.length, 0);
+  const count = Math.min(maxThreads, Math.floor(totalEntries / Math.max(minEntriesPerWorker, 1)));
+  if (count < 2) {
+    return [];
+  }
+
+  const shards: string[][] = [];
+  let shard: string[] = [];
+  let entries = 0;
+  for (const model of models) {
+    shard.push(model.file);
+    entries += model.ast.entries.length;
+    if (entries >= (totalEntries * (shards.length + 1)) / count && shards.length < count - 1) {
+      shards.push(shard);
+      shard = [];
+    }
+  }
+  shards.push(shard);
+  return shards;
+}
+
+/**
+ * The files a worker loads for a shard: the shard, every file defining schemas and the files
+ * defining the links the shard refers to, in workspace load order. Since the last definition
+ * of a link wins, this resolves links to the same definitions as the whole workspace does.
+ */
+function shardContext(workspace: Workspace, shard: string[]): string[] {
+  const needed = new Set(shard);
+  for (const model of workspace.allModels()) {
+    if (model.schemaEntries.length > 0) {
+      needed.add(model.file);
+    }
+  }
+  for (const file of shard) {
+    for (const id of workspace.getModel(file)?.linkIndex.references.keys() ?? []) {
+      const definition = workspace.getLinkDefinition(id);
+      if (definition) {
+        needed.add(definition.file);
+      }
+    }
+  }
+  return workspace
+    .allModels()
+    .map((model) => model.file)
+    .filter((file) => needed.has(file));
+}
+
+/**
+ * A document of the workspace as sent to a worker. Trees that are not encoded (without the
+ * binding's bulk extraction) cannot be sent, so the worker parses those blocks itself.
+ */
+function workerDocument(workspace: Workspace, file: string): CheckWorkerDocument {
+  const model = workspace.getModel(file)!;
+  const trees: CheckWorkerDocument["trees"] = [];
+  for (const block of model.blocks) {
+    if (block.tree instanceof EncodedTree) {
+      trees.push([block.source, block.tree.encoded]);
+    }
+  }
+  return { file, source: model.source, trees };
+}
+
+/**
+ * Start a check worker. Running from the TypeScript sources (vitest, the development
+ * condition), there is no compiled check-worker.js next to this module, so the worker runs
+ * check-worker.ts through tsx instead, unless the process already runs under tsx.
+ */
+function startWorker(request: CheckWorkerRequest): Worker {
+  if (!import.meta.url.endsWith(".ts")) {
+    return new Worker(new URL("./check-worker.js", import.meta.url), { workerData: request });
+  }
+  const execArgv = [...process.execArgv];
+  if (!execArgv.some((arg) => arg.includes("tsx"))) {
+    const tsx = pathToFileURL(createRequire(import.meta.url).resolve("tsx")).href;
+    execArgv.push("--import", tsx);
+  }
+  return new Worker(new URL("./check-worker.ts", import.meta.url), {
+    workerData: request,
+    execArgv,
+  });
+}
+
+function runWorker(request: CheckWorkerRequest): Promise<OrderedDiagnostic[]> {
+  return new Promise((resolvePromise, reject) => {
+    const worker = startWorker(request);
+    worker.once("message", (response: CheckWorkerResponse) => {
+      if (response.ok) {
+        resolvePromise(response.diagnostics);
+      } else {
+        reject(new Error(response.error));
+      }
+      void worker.terminate();
+    });
+    worker.once("error", reject);
+    // Only matters if the worker dies without replying; settling again is a no-op
+    worker.once("exit", (code) => reject(new Error(`Check worker exited with code ${code}`)));
+  });
+}
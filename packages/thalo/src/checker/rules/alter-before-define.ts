@@ -18,22 +18,22 @@ const visitor: RuleVisitor = {
       }
 
       // Find the earliest define timestamp
-      let earliestDefine: IndexedEntry<SchemaEntry> | null = null;
-      let earliestDefineTs = "";
-
+      let earliestDefine: IndexedEntry<SchemaEntry> = defineEntries[0];
       for (const entry of defineEntries) {
-        const ts = formatTimestamp(entry.entry.header.timestamp);
-        if (!earliestDefine || ts < earliestDefineTs) {
+        if (
+          entry.entry.header.timestamp.epochMinutes <
+          earliestDefine.entry.header.timestamp.epochMinutes
+        ) {
           earliestDefine = entry;
-          earliestDefineTs = ts;
         }
       }
+      const earliestDefineMinutes = earliestDefine.entry.header.timestamp.epochMinutes;
+      const earliestDefineTs = formatTimestamp(earliestDefine.entry.header.timestamp);
 
       // Check each alter entry
       for (const { entry, file, sourceMap } of alterEntries) {
-        const alterTs = formatTimestamp(entry.header.timestamp);
-
-        if (alterTs < earliestDefineTs) {
+        if (entry.header.timestamp.epochMinutes < earliestDefineMinutes) {
+          const alterTs = formatTimestamp(entry.header.timestamp);
           ctx.report({
             message: `alter-entity for '${entityName}' has timestamp ${alterTs} which is before the define-entity at ${earliestDefineTs}.`,
             file,
@@ -1,6 +1,7 @@
 import type { Rule, RuleCategory } from "../rules/rules.js";
 import type { RuleVisitor, VisitorContext } from "../visitor.js";
 import type { Entry } from "../../ast/ast-types.js";
+import { NO_SYMBOL } from "../../semantic/symbols.js";
 
 const category: RuleCategory = "instance";
 
@@ -10,10 +11,26 @@ const visitor: RuleVisitor = {
 
     // Check each file independently since timestamps are per-file
     for (const model of workspace.allModels()) {
+      // Entries with equal timestamps share an instant, so only entries whose instant occurs
+      // more than once among those without a link ID (from the header columns) can collide
+      const { headers } = model;
+      const instantCounts = new Map<number, number>();
+      for (let row = 0; row < headers.length; row++) {
+        if (headers.links[row] === NO_SYMBOL && headers.targets[row] === NO_SYMBOL) {
+          const instant = headers.epochMinutes[row];
+          instantCounts.set(instant, (instantCounts.get(instant) ?? 0) + 1);
+        }
+      }
+
       // Track entries by timestamp+type (the merge identity key)
       const entriesByIdentity = new Map<string, Entry[]>();
 
-      for (const entry of model.ast.entries) {
+      for (let row = 0; row < headers.length; row++) {
+        if ((instantCounts.get(headers.epochMinutes[row]) ?? 0) < 2) {
+          continue;
+        }
+        const entry = model.ast.entries[row];
+
         // Get timestamp
         const timestamp = getEntryTimestamp(entry);
         if (!timestamp) {
@@ -75,6 +75,21 @@ describe("timestamp-out-of-order rule", () => {
     expect(warning).toBeUndefined();
   });
 
+  it("compares timestamps with different timezones as instants", () => {
+    workspace.addDocument(
+      `2026-01-05T18:00+02:00 create lore "Earlier instant" #test
+  type: fact
+
+2026-01-05T17:00Z create lore "Later instant" #test
+  type: insight
+`,
+      { filename: "test.thalo" },
+    );
+
+    const diagnostics = check(workspace);
+    expect(diagnostics.filter((d) => d.code === "timestamp-out-of-order")).toHaveLength(0);
+  });
+
   it("reports multiple out-of-order entries", () => {
     workspace.addDocument(
       `2026-01-05T19:00Z create lore "Third" #test
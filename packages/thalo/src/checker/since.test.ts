@@ -0,0 +1,107 @@
+import { describe, it, expect } from "vitest";
+import { execFileSync } from "node:child_process";
+import { mkdtempSync, realpathSync, rmSync, writeFileSync } from "node:fs";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { createWorkspace } from "../parser.native.js";
+import { check } from "./check.js";
+import { checkFiles, checkFilesSince, dependencyClosure } from "./since.js";
+
+const schema = `2026-01-01T00:00Z define-entity lore "Lore entries"
+  # Metadata
+  type: "fact" | "insight"
+`;
+
+const linked = `2026-01-05T18:00Z create lore "Linked" ^linked
+  type: "fact"
+`;
+
+const referencing = `2026-01-06T18:00Z create lore "Referencing"
+  type: "fact"
+  related: ^linked
+`;
+
+const unrelated = `2026-01-07T18:00Z create journal "Unrelated"
+  type: "fact"
+`;
+
+describe("dependencyClosure", () => {
+  const workspace = createWorkspace();
+  workspace.addDocument(schema, { filename: "schema.thalo" });
+  workspace.addDocument(linked, { filename: "linked.thalo" });
+  workspace.addDocument(referencing, { filename: "referencing.thalo" });
+  workspace.addDocument(unrelated, { filename: "unrelated.thalo" });
+
+  it("adds the users of entities a file defines", () => {
+    expect([...dependencyClosure(workspace, ["schema.thalo"])].sort()).toEqual([
+      "linked.thalo",
+      "referencing.thalo",
+      "schema.thalo",
+    ]);
+  });
+
+  it("adds the files sharing a link but not the other users of an entity", () => {
+    expect([...dependencyClosure(workspace, ["linked.thalo"])].sort()).toEqual([
+      "linked.thalo",
+      "referencing.thalo",
+    ]);
+    expect([...dependencyClosure(workspace, ["unrelated.thalo"])]).toEqual(["unrelated.thalo"]);
+  });
+
+  it("counts the names of earlier versions", () => {
+    const before = createWorkspace();
+    before.addDocument(unrelated + `\n${linked}`, { filename: "unrelated.thalo" });
+    const closure = dependencyClosure(workspace, ["unrelated.thalo"], before.allModels());
+    expect([...closure].sort()).toEqual(["linked.thalo", "referencing.thalo", "unrelated.thalo"]);
+  });
+});
+
+describe("checkFiles", () => {
+  it("reports what check reports for the given files", () => {
+    const workspace = createWorkspace();
+    workspace.addDocument(schema, { filename: "schema.thalo" });
+    workspace.addDocument(`${unrelated}\n${referencing}`, { filename: "a.thalo" });
+    workspace.addDocument(unrelated, { filename: "b.thalo" });
+
+    const files = new Set(["a.thalo"]);
+    const key = (d: { file: string; code: string; location: { startIndex: number } }) =>
+      `${d.file}:${d.location.startIndex}:${d.code}`;
+    const expected = check(workspace).filter((d) => files.has(d.file));
+
+    expect(checkFiles(workspace, files).map(key).sort()).toEqual(expected.map(key).sort());
+    expect(expected.length).toBeGreaterThan(0);
+  });
+});
+
+describe("checkFilesSince", () => {
+  it("checks the files changed since a commit and their dependents", async () => {
+    const dir = realpathSync(mkdtempSync(join(tmpdir(), "thalo-since-")));
+    const git = (...args: string[]) => execFileSync("git", args, { cwd: dir });
+    try {
+      git("init", "-q");
+      git("config", "user.email", "test@example.com");
+      git("config", "user.name", "Test");
+      const files = ["schema.thalo", "linked.thalo", "referencing.thalo", "unrelated.thalo"].map(
+        (name) => join(dir, name),
+      );
+      [schema, linked, referencing, unrelated].forEach((source, i) =>
+        writeFileSync(files[i], source),
+      );
+      git("add", ".");
+      git("commit", "-q", "-m", "base");
+
+      // Dropping ^linked breaks the reference in an unchanged file
+      writeFileSync(files[1], linked.replace(" ^linked", ""));
+      const result = await checkFilesSince(files, "HEAD", { cwd: dir });
+
+      expect(result.changedFiles).toEqual([files[1]]);
+      expect(result.checkedFiles).toEqual([files[1], files[2]]);
+      expect(result.diagnostics.map((d) => [d.file, d.code])).toContainEqual([
+        files[2],
+        "unresolved-link",
+      ]);
+    } finally {
+      rmSync(dir, { recursive: true, force: true });
+    }
+  });
+});
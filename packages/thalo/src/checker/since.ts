@@ -0,0 +1,255 @@
+/**
+ * Node.js-only check of the files changed since a git commit.
+ *
+ * A change to a file can only change the diagnostics of files that share a name with it: the
+ * entities it defines or alters, and the link ids it defines or references. Checking since a
+ * commit runs the rules on the changed files and those dependents only; every other file reports
+ * what it reported at that commit, which was checked when it was merged. Names the changed files
+ * had at the commit count too, so removing a definition re-checks the files that used it.
+ *
+ * The whole workspace is still loaded, since rules resolve names across it. Pass a `cacheDir` to
+ * take the unchanged files' syntax trees from the parse cache instead of parsing them again.
+ *
+ * @module @rejot-dev/thalo/checker/since
+ */
+
+import { existsSync } from "node:fs";
+import { extname, resolve } from "node:path";
+import type { Workspace } from "../model/workspace.js";
+import type { SemanticModel } from "../semantic/analyzer.js";
+import { KIND_SCHEMA } from "../semantic/header-store.js";
+import { getSynthesisSources } from "../services/synthesis.js";
+import { createWorkspace } from "../parser.native.js";
+import { loadWorkspaceFromFiles } from "../files.js";
+import {
+  detectGitContext,
+  getFileAtCommit,
+  getFilesChangedSince,
+  getMergeBase,
+  getUncommittedFiles,
+} from "../git/git.js";
+import { getWorkspaceIndex, type WorkspaceIndex } from "./workspace-index.js";
+import {
+  checkEntryLocalRules,
+  checkSharedRules,
+  type CheckConfig,
+  type Diagnostic,
+} from "./check.js";
+
+/**
+ * Options for checkFilesSince
+ */
+export interface SinceCheckOptions {
+  /** Checker configuration (rule overrides, etc.) */
+  config?: CheckConfig;
+  /** Persistent syntax tree cache for loading the workspace */
+  cacheDir?: string;
+  /** Directory inside the git repository (default: the current directory) */
+  cwd?: string;
+}
+
+/**
+ * Result of checkFilesSince
+ */
+export interface SinceCheckResult {
+  workspace: Workspace;
+  /** Diagnostics of `checkedFiles` */
+  diagnostics: Diagnostic[];
+  /** Loaded files changed since the commit, committed or not */
+  changedFiles: string[];
+  /** The changed files and the files depending on them, in load order */
+  checkedFiles: string[];
+}
+
+/**
+ * Names through which a file's changes reach other files.
+ */
+interface SharedNames {
+  /** Entities defined or altered */
+  entities: Set<string>;
+  /** Link ids defined or referenced */
+  links: Set<string>;
+}
+
+function collectSharedNames(model: SemanticModel, names: SharedNames): void {
+  const { headers } = model;
+  for (let row = 0; row < headers.length; row++) {
+    if (headers.kinds[row] === KIND_SCHEMA) {
+      names.entities.add(headers.symbols.name(headers.entities[row]));
+    }
+  }
+  for (const id of model.linkIndex.definitions.keys()) {
+    names.links.add(id);
+  }
+  for (const id of model.linkIndex.references.keys()) {
+    names.links.add(id);
+  }
+}
+
+function hasAnyKey(map: ReadonlyMap<string, unknown>, keys: ReadonlySet<string>): boolean {
+  if (map.size < keys.size) {
+    for (const key of map.keys()) {
+      if (keys.has(key)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  for (const key of keys) {
+    if (map.has(key)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Get the files whose diagnostics may change when `changedFiles` change: the changed files
+ * themselves, files that define, alter or use (in instances or synthesis queries) an entity they
+ * define or alter, and files that define or reference a link id they define or reference.
+ *
+ * @param workspace - The workspace with the current version of every file
+ * @param changedFiles - Changed files in the workspace; others are ignored
+ * @param previous - Earlier versions of changed or deleted files, whose names count as well
+ * @param index - The workspace's index
+ */
+export function dependencyClosure(
+  workspace: Workspace,
+  changedFiles: Iterable<string>,
+  previous: Iterable<SemanticModel> = [],
+  index: WorkspaceIndex = getWorkspaceIndex(workspace),
+): Set<string> {
+  const closure = new Set<string>();
+  const names: SharedNames = { entities: new Set(), links: new Set() };
+  for (const file of changedFiles) {
+    const model = workspace.getModel(file);
+    if (model) {
+      closure.add(file);
+      collectSharedNames(model, names);
+    }
+  }
+  for (const model of previous) {
+    collectSharedNames(model, names);
+  }
+
+  for (const entity of names.entities) {
+    for (const { file } of index.defineEntitiesByName.get(entity) ?? []) {
+      closure.add(file);
+    }
+    for (const { file } of index.alterEntitiesByName.get(entity) ?? []) {
+      closure.add(file);
+    }
+    for (const { file } of index.entriesUsingEntity.get(entity) ?? []) {
+      closure.add(file);
+    }
+  }
+  if (names.entities.size > 0) {
+    for (const { entry, file } of index.synthesisEntries) {
+      if (getSynthesisSources(entry).some((query) => names.entities.has(query.entity))) {
+        closure.add(file);
+      }
+    }
+  }
+
+  // Each model's link index covers every kind of definition and reference, duplicates included
+  if (names.links.size > 0) {
+    for (const model of workspace.allModels()) {
+      const { definitions, references } = model.linkIndex;
+      if (hasAnyKey(definitions, names.links) || hasAnyKey(references, names.links)) {
+        closure.add(model.file);
+      }
+    }
+  }
+
+  return closure;
+}
+
+/**
+ * Check only some files of a workspace, resolving names against all of it.
+ *
+ * Entry-local rules run on those files' entries alone; the other rules run over the workspace
+ * and are filtered to those files.
+ */
+export function checkFiles(
+  workspace: Workspace,
+  files: ReadonlySet<string>,
+  config: CheckConfig = {},
+  index: WorkspaceIndex = getWorkspaceIndex(workspace),
+): Diagnostic[] {
+  const models = workspace.allModels().filter((model) => files.has(model.file));
+  const diagnostics = checkSharedRules(workspace, config, index).filter((d) => files.has(d.file));
+  diagnostics.push(...checkEntryLocalRules(workspace, models, config, index));
+  return diagnostics;
+}
+
+/**
+ * Load files and check the ones changed since `ref`, and their dependents (see
+ * `dependencyClosure`).
+ *
+ * Changes are taken since the merge base of `ref` and HEAD, so on a branch `ref` can be its base
+ * branch; uncommitted changes count as well.
+ *
+ * @param files - Files to load
+ * @param ref - Commit, branch or tag to compare against
+ * @param options - Check options
+ * @throws If `cwd` is not in a git repository or `ref` has no merge base with HEAD
+ */
+export async function checkFilesSince(
+  files: string[],
+  ref: string,
+  options: SinceCheckOptions = {},
+): Promise<SinceCheckResult> {
+  const { config = {}, cacheDir, cwd = process.cwd() } = options;
+  const git = await detectGitContext(cwd);
+  if (!git.isGitRepo || !git.rootDir) {
+    throw new Error(`Not a git repository: ${cwd}`);
+  }
+  const base = await getMergeBase(ref, "HEAD", cwd);
+  if (!base) {
+    throw new Error(`Unknown commit or no common history with HEAD: ${ref}`);
+  }
+
+  // Only checked, never edited, so read-only snapshot trees will do
+  const workspace = await loadWorkspaceFromFiles(
+    files.map((file) => resolve(file)),
+    { bulkExtraction: true, cacheDir },
+  );
+  const loaded = new Set(workspace.files());
+  const extensions = new Set([...loaded].map((file) => extname(file)));
+
+  // Path at `base` of each changed path, relative to the repository root
+  const changes = new Map<string, string>();
+  for (const change of await getFilesChangedSince(base, cwd)) {
+    changes.set(change.path, change.oldPath ?? change.path);
+  }
+  for (const file of await getUncommittedFiles(cwd)) {
+    if (!changes.has(file)) {
+      changes.set(file, file);
+    }
+  }
+
+  const changedFiles: string[] = [];
+  const previous = createWorkspace();
+  for (const [current, atBase] of changes) {
+    const file = resolve(git.rootDir, current);
+    if (loaded.has(file)) {
+      changedFiles.push(file);
+    } else if (existsSync(file) || !extensions.has(extname(atBase))) {
+      // Not one of the checked files, and not a deleted one
+      continue;
+    }
+    const source = await getFileAtCommit(atBase, base, git.rootDir);
+    if (source !== null) {
+      previous.addDocument(source, { filename: resolve(git.rootDir, atBase) });
+    }
+  }
+
+  const index = getWorkspaceIndex(workspace);
+  const closure = dependencyClosure(workspace, changedFiles, previous.allModels(), index);
+  return {
+    workspace,
+    diagnostics: checkFiles(workspace, closure, config, index),
+    changedFiles,
+    checkedFiles: workspace.files().filter((file) => closure.has(file)),
+  };
+}
@@ -3,11 +3,15 @@ import { createWorkspace } from "../parser.native.js";
 import { Workspace } from "../model/workspace.js";
 import {
   buildWorkspaceIndex,
+  getWorkspaceIndex,
   getInstancesForEntity,
   getDefineEntriesForEntity,
   getAlterEntriesForEntity,
   getEntriesReferencingLink,
+  type IndexedEntry,
+  type WorkspaceIndex,
 } from "./workspace-index.js";
+import type { Entry } from "../ast/ast-types.js";
 
 describe("WorkspaceIndex", () => {
   let workspace: Workspace;
@@ -221,4 +225,75 @@ Summarize the lore entries.
       expect(getEntriesReferencingLink(index, "unknown")).toEqual([]);
     });
   });
+
+  describe("getWorkspaceIndex", () => {
+    const schema = `2026-01-01T00:00Z define-entity lore "Lore entity"
+  # Metadata
+  type: "fact"
+`;
+
+    /** Summarize an index by file and entry position, ignoring map key order */
+    function summarize(index: WorkspaceIndex) {
+      const describeEntry = (e: IndexedEntry<Entry>) => `${e.file}@${e.entry.location.startIndex}`;
+      const groups = (map: ReadonlyMap<string, IndexedEntry<Entry>[]>) =>
+        [...map.entries()]
+          .map(([key, entries]) => [key, entries.map(describeEntry)])
+          .sort(([a], [b]) => String(a).localeCompare(String(b)));
+
+      return {
+        instances: index.instanceEntries.map(describeEntry),
+        schemas: index.schemaEntries.map(describeEntry),
+        byEntity: groups(index.instancesByEntity),
+        referencing: groups(index.entriesReferencingLink),
+        byLinkId: [...index.instancesByLinkId.entries()]
+          .map(([key, entry]) => [key, describeEntry(entry)])
+          .sort(([a], [b]) => a.localeCompare(b)),
+      };
+    }
+
+    it("updates the same index object in place", () => {
+      workspace.addDocument(schema, { filename: "entities.thalo" });
+      const index = getWorkspaceIndex(workspace);
+
+      workspace.addDocument(`2026-01-05T18:00Z create lore "Entry" ^first\n  type: "fact"\n`, {
+        filename: "a.thalo",
+      });
+
+      expect(getWorkspaceIndex(workspace)).toBe(index);
+      expect(index.instanceEntries).toHaveLength(1);
+      expect(index.instancesByLinkId.get("first")?.file).toBe("a.thalo");
+    });
+
+    it("matches a full rebuild after edits, removals and re-adds", () => {
+      workspace.addDocument(schema, { filename: "entities.thalo" });
+      for (const name of ["a", "b", "c", "d"]) {
+        workspace.addDocument(
+          `2026-01-05T18:00Z create lore "Entry ${name}" ^shared\n  type: "fact"\n  related: ^${name}\n`,
+          { filename: `${name}.thalo` },
+        );
+      }
+      getWorkspaceIndex(workspace);
+
+      workspace.updateDocument(
+        "b.thalo",
+        `2026-01-05T18:00Z create lore "Entry b" ^b-only\n  type: "fact"\n\n2026-01-06T18:00Z create lore "Second" ^shared\n  type: "fact"\n`,
+      );
+      expect(summarize(getWorkspaceIndex(workspace))).toEqual(
+        summarize(buildWorkspaceIndex(workspace)),
+      );
+
+      workspace.removeDocument("c.thalo");
+      expect(summarize(getWorkspaceIndex(workspace))).toEqual(
+        summarize(buildWorkspaceIndex(workspace)),
+      );
+
+      workspace.addDocument(`2026-01-07T18:00Z create lore "Moved" ^shared\n  type: "fact"\n`, {
+        filename: "a.thalo",
+      });
+      expect(summarize(getWorkspaceIndex(workspace))).toEqual(
+        summarize(buildWorkspaceIndex(workspace)),
+      );
+      expect(getWorkspaceIndex(workspace).instancesByLinkId.get("shared")?.file).toBe("a.thalo");
+    });
+  });
 });
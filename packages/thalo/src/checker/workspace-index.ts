@@ -145,6 +145,77 @@ function getReferencedLinkIds(entry: Entry): string[] {
   return linkIds;
 }
 
+/**
+ * Add every entry of a model to an index builder.
+ */
+function indexModel(builder: WorkspaceIndexBuilder, model: SemanticModel): void {
+  const file = model.file;
+  const sourceMap = model.sourceMap;
+
+  for (const entry of model.ast.entries) {
+    const indexed = { entry, model, file, sourceMap };
+
+    // Safe casts below: switch narrows entry.type, so the indexed cast is valid
+    switch (entry.type) {
+      case "instance_entry": {
+        const instanceIndexed = indexed as IndexedEntry<InstanceEntry>;
+        builder.instanceEntries.push(instanceIndexed);
+
+        // Group by entity
+        const entityName = entry.header.entity;
+        addToMapArray(builder.instancesByEntity, entityName, instanceIndexed);
+        addToMapArray(builder.entriesUsingEntity, entityName, indexed as IndexedEntry<Entry>);
+
+        // Index by link ID if present
+        if (entry.header.link) {
+          builder.instancesByLinkId.set(entry.header.link.id, instanceIndexed);
+        }
+
+        // Track link references
+        for (const linkId of getReferencedLinkIds(entry)) {
+          addToMapArray(builder.entriesReferencingLink, linkId, indexed as IndexedEntry<Entry>);
+        }
+        break;
+      }
+
+      case "schema_entry": {
+        const schemaIndexed = indexed as IndexedEntry<SchemaEntry>;
+        builder.schemaEntries.push(schemaIndexed);
+
+        const entityName = entry.header.entityName.value;
+        if (entry.header.directive === "define-entity") {
+          addToMapArray(builder.defineEntitiesByName, entityName, schemaIndexed);
+        } else {
+          addToMapArray(builder.alterEntitiesByName, entityName, schemaIndexed);
+        }
+        break;
+      }
+
+      case "synthesis_entry": {
+        const synthesisIndexed = indexed as IndexedEntry<SynthesisEntry>;
+        builder.synthesisEntries.push(synthesisIndexed);
+
+        // Track link references
+        for (const linkId of getReferencedLinkIds(entry)) {
+          addToMapArray(builder.entriesReferencingLink, linkId, indexed as IndexedEntry<Entry>);
+        }
+        break;
+      }
+
+      case "actualize_entry": {
+        const actualizeIndexed = indexed as IndexedEntry<ActualizeEntry>;
+        builder.actualizeEntries.push(actualizeIndexed);
+
+        // Track link references (including target)
+        for (const linkId of getReferencedLinkIds(entry)) {
+          addToMapArray(builder.entriesReferencingLink, linkId, indexed as IndexedEntry<Entry>);
+        }
+        break;
+      }
+    }
+  }
+}
+
 /**
  * Build a WorkspaceIndex from a Workspace in a single pass.
  *
@@ -156,74 +227,281 @@ export function buildWorkspaceIndex(workspace: Workspace): WorkspaceIndex {
 
   // Single iteration over all models and entries
   for (const model of workspace.allModels()) {
-    const file = model.file;
-    const sourceMap = model.sourceMap;
-
-    for (const entry of model.ast.entries) {
-      const indexed = { entry, model, file, sourceMap };
-
-      // Safe casts below: switch narrows entry.type, so the indexed cast is valid
-      switch (entry.type) {
-        case "instance_entry": {
-          const instanceIndexed = indexed as IndexedEntry<InstanceEntry>;
-          builder.instanceEntries.push(instanceIndexed);
-
-          // Group by entity
-          const entityName = entry.header.entity;
-          addToMapArray(builder.instancesByEntity, entityName, instanceIndexed);
-          addToMapArray(builder.entriesUsingEntity, entityName, indexed as IndexedEntry<Entry>);
-
-          // Index by link ID if present
-          if (entry.header.link) {
-            builder.instancesByLinkId.set(entry.header.link.id, instanceIndexed);
-          }
+    indexModel(builder, model);
+  }
 
-          // Track link references
-          for (const linkId of getReferencedLinkIds(entry)) {
-            addToMapArray(builder.entriesReferencingLink, linkId, indexed as IndexedEntry<Entry>);
-          }
-          break;
-        }
+  return builder as WorkspaceIndex;
+}
 
-        case "schema_entry": {
-          const schemaIndexed = indexed as IndexedEntry<SchemaEntry>;
-          builder.schemaEntries.push(schemaIndexed);
+// ===================
+// Incremental maintenance
+// ===================
 
-          const entityName = entry.header.entityName.value;
-          if (entry.header.directive === "define-entity") {
-            addToMapArray(builder.defineEntitiesByName, entityName, schemaIndexed);
-          } else {
-            addToMapArray(builder.alterEntitiesByName, entityName, schemaIndexed);
-          }
-          break;
-        }
+/**
+ * What one file contributed to an index, and the model state it was computed from.
+ */
+interface FileContribution {
+  model: SemanticModel;
+  ast: SemanticModel["ast"];
+  sourceMap: SourceMap;
+  /** The file's entries, indexed as if it were the only file */
+  index: WorkspaceIndexBuilder;
+}
 
-        case "synthesis_entry": {
-          const synthesisIndexed = indexed as IndexedEntry<SynthesisEntry>;
-          builder.synthesisEntries.push(synthesisIndexed);
+/**
+ * A workspace's index, kept up to date by getWorkspaceIndex.
+ */
+interface IndexState {
+  index: WorkspaceIndexBuilder;
+  files: Map<string, FileContribution>;
+  /** Every instance defining each link ID, in workspace order (the index keeps the last) */
+  instancesWithLinkId: Map<string, IndexedEntry<InstanceEntry>[]>;
+}
 
-          // Track link references
-          for (const linkId of getReferencedLinkIds(entry)) {
-            addToMapArray(builder.entriesReferencingLink, linkId, indexed as IndexedEntry<Entry>);
-          }
-          break;
+const indexStates = new WeakMap<Workspace, IndexState>();
+
+const ARRAY_KEYS = [
+  "instanceEntries",
+  "schemaEntries",
+  "synthesisEntries",
+  "actualizeEntries",
+] as const;
+
+const GROUP_KEYS = [
+  "defineEntitiesByName",
+  "alterEntitiesByName",
+  "instancesByEntity",
+  "entriesReferencingLink",
+  "entriesUsingEntity",
+] as const;
+
+/**
+ * Get the WorkspaceIndex for a workspace, updating the previously returned index in place.
+ *
+ * Files whose model changed since the last call (detected by AST identity, which every
+ * Workspace update replaces) are removed from the index and re-added; all other files are
+ * left untouched, so the cost scales with the size of the change rather than the workspace.
+ * Every array in the index keeps workspace order, so rules see the same data as from
+ * buildWorkspaceIndex; only the iteration order of map keys may differ.
+ *
+ * The returned object is owned by the workspace and mutated by later calls: do not hold on
+ * to it across workspace updates.
+ */
+export function getWorkspaceIndex(workspace: Workspace): WorkspaceIndex {
+  const models = workspace.allModels();
+  let state = indexStates.get(workspace);
+
+  const changed: string[] = [];
+  if (state) {
+    const present = new Set<string>();
+    for (const model of models) {
+      present.add(model.file);
+      const contribution = state.files.get(model.file);
+      if (
+        !contribution ||
+        contribution.model !== model ||
+        contribution.ast !== model.ast ||
+        contribution.sourceMap !== model.sourceMap
+      ) {
+        changed.push(model.file);
+      }
+    }
+    for (const file of state.files.keys()) {
+      if (!present.has(file)) {
+        changed.push(file);
+      }
+    }
+  }
+
+  // Rebuilding from scratch is cheaper than patching most of the index
+  if (!state || changed.length > models.length / 2) {
+    state = buildIndexState(models);
+    indexStates.set(workspace, state);
+    return state.index as WorkspaceIndex;
+  }
+
+  if (changed.length === 0) {
+    return state.index as WorkspaceIndex;
+  }
+
+  const rank = new Map<string, number>();
+  models.forEach((model, i) => rank.set(model.file, i));
+  const changedLinkIds = new Set<string>();
+
+  for (const file of changed) {
+    const contribution = state.files.get(file);
+    if (contribution) {
+      removeContribution(state, contribution, changedLinkIds);
+      state.files.delete(file);
+    }
+  }
+
+  for (const file of changed) {
+    const model = workspace.getModel(file);
+    if (model) {
+      const contribution = createContribution(model);
+      insertContribution(state, contribution, rank, changedLinkIds);
+      state.files.set(file, contribution);
+    }
+  }
+
+  for (const linkId of changedLinkIds) {
+    const instances = state.instancesWithLinkId.get(linkId);
+    if (instances) {
+      state.index.instancesByLinkId.set(linkId, instances[instances.length - 1]);
+    } else {
+      state.index.instancesByLinkId.delete(linkId);
+    }
+  }
+
+  return state.index as WorkspaceIndex;
+}
+
+function createContribution(model: SemanticModel): FileContribution {
+  const index = createEmptyBuilder();
+  indexModel(index, model);
+  return { model, ast: model.ast, sourceMap: model.sourceMap, index };
+}
+
+function buildIndexState(models: SemanticModel[]): IndexState {
+  const state: IndexState = {
+    index: createEmptyBuilder(),
+    files: new Map(),
+    instancesWithLinkId: new Map(),
+  };
+
+  for (const model of models) {
+    const contribution = createContribution(model);
+    state.files.set(model.file, contribution);
+
+    for (const key of ARRAY_KEYS) {
+      for (const item of contribution.index[key]) {
+        (state.index[key] as IndexedEntry<Entry>[]).push(item);
+      }
+    }
+    for (const key of GROUP_KEYS) {
+      const groups = state.index[key] as Map<string, IndexedEntry<Entry>[]>;
+      for (const [name, items] of contribution.index[key]) {
+        for (const item of items) {
+          addToMapArray(groups, name, item);
         }
+      }
+    }
+    for (const item of contribution.index.instanceEntries) {
+      if (item.entry.header.link) {
+        addToMapArray(state.instancesWithLinkId, item.entry.header.link.id, item);
+        state.index.instancesByLinkId.set(item.entry.header.link.id, item);
+      }
+    }
+  }
 
-        case "actualize_entry": {
-          const actualizeIndexed = indexed as IndexedEntry<ActualizeEntry>;
-          builder.actualizeEntries.push(actualizeIndexed);
+  return state;
+}
 
-          // Track link references (including target)
-          for (const linkId of getReferencedLinkIds(entry)) {
-            addToMapArray(builder.entriesReferencingLink, linkId, indexed as IndexedEntry<Entry>);
-          }
-          break;
+/**
+ * Remove a run of items that were inserted together.
+ */
+function spliceOut<T>(array: T[], items: readonly T[]): void {
+  if (items.length > 0) {
+    array.splice(array.indexOf(items[0]), items.length);
+  }
+}
+
+/**
+ * Insert one file's items before the first item from a later file, keeping workspace order.
+ */
+function spliceIn<T extends { file: string }>(
+  array: T[],
+  items: readonly T[],
+  rank: ReadonlyMap<string, number>,
+): void {
+  if (items.length === 0) {
+    return;
+  }
+  const itemRank = rank.get(items[0].file)!;
+  let low = 0;
+  let high = array.length;
+  while (low < high) {
+    const mid = (low + high) >>> 1;
+    if (rank.get(array[mid].file)! < itemRank) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  array.splice(low, 0, ...items);
+}
+
+function removeContribution(
+  state: IndexState,
+  contribution: FileContribution,
+  changedLinkIds: Set<string>,
+): void {
+  for (const key of ARRAY_KEYS) {
+    spliceOut(state.index[key] as IndexedEntry<Entry>[], contribution.index[key]);
+  }
+  for (const key of GROUP_KEYS) {
+    const groups = state.index[key] as Map<string, IndexedEntry<Entry>[]>;
+    for (const [name, items] of contribution.index[key]) {
+      const group = groups.get(name);
+      if (group) {
+        spliceOut(group, items);
+        if (group.length === 0) {
+          groups.delete(name);
         }
       }
     }
   }
+  for (const item of contribution.index.instanceEntries) {
+    const link = item.entry.header.link;
+    if (link) {
+      const instances = state.instancesWithLinkId.get(link.id)!;
+      instances.splice(instances.indexOf(item), 1);
+      if (instances.length === 0) {
+        state.instancesWithLinkId.delete(link.id);
+      }
+      changedLinkIds.add(link.id);
+    }
+  }
+}
 
-  return builder as WorkspaceIndex;
+function insertContribution(
+  state: IndexState,
+  contribution: FileContribution,
+  rank: ReadonlyMap<string, number>,
+  changedLinkIds: Set<string>,
+): void {
+  for (const key of ARRAY_KEYS) {
+    spliceIn(state.index[key] as IndexedEntry<Entry>[], contribution.index[key], rank);
+  }
+  for (const key of GROUP_KEYS) {
+    const groups = state.index[key] as Map<string, IndexedEntry<Entry>[]>;
+    for (const [name, items] of contribution.index[key]) {
+      const group = groups.get(name);
+      if (group) {
+        spliceIn(group, items, rank);
+      } else {
+        groups.set(name, [...items]);
+      }
+    }
+  }
+
+  // Group this file's instances per link ID, then slot each group in like the arrays above
+  const byLinkId = new Map<string, IndexedEntry<InstanceEntry>[]>();
+  for (const item of contribution.index.instanceEntries) {
+    if (item.entry.header.link) {
+      addToMapArray(byLinkId, item.entry.header.link.id, item);
+    }
+  }
+  for (const [linkId, items] of byLinkId) {
+    const instances = state.instancesWithLinkId.get(linkId);
+    if (instances) {
+      spliceIn(instances, items, rank);
+    } else {
+      state.instancesWithLinkId.set(linkId, items);
+    }
+    changedLinkIds.add(linkId);
+  }
 }
 
 /**
@@ -94,10 +94,21 @@ function toDiagnosticInfo(diagnostic: Diagnostic): DiagnosticInfo {
  */
 export function runCheck(workspace: Workspace, options: RunCheckOptions = {}): CheckResult {
   const { config = {}, minSeverity = "info" } = options;
+  return toCheckResult(check(workspace, config), workspace.files().length, minSeverity);
+}
 
-  // Run the checker
-  const diagnostics = check(workspace, config);
-
+/**
+ * Filter, sort and group raw checker diagnostics into a CheckResult.
+ *
+ * @param diagnostics - Diagnostics from the checker
+ * @param filesChecked - Number of files the diagnostics cover
+ * @param minSeverity - Minimum severity to include
+ */
+export function toCheckResult(
+  diagnostics: Diagnostic[],
+  filesChecked: number,
+  minSeverity: DiagnosticSeverity = "info",
+): CheckResult {
   // Filter by minimum severity
   const minSeverityOrder = SEVERITY_ORDER[minSeverity];
   const filteredDiagnostics = diagnostics.filter(
@@ -129,7 +140,7 @@ export function runCheck(workspace: Workspace, options: RunCheckOptions = {}): C
   const infoCount = filteredDiagnostics.filter((d) => d.severity === "info").length;
 
   return {
-    filesChecked: workspace.files().length,
+    filesChecked,
     diagnosticsByFile,
     errorCount,
     warningCount,
@@ -23,8 +23,7 @@ import {
  * Convert a timestamp to epoch milliseconds for correct comparison across timezones
  */
 function timestampToEpoch(ts: Timestamp): number {
-  const isoStr = formatTimestamp(ts);
-  return Date.parse(isoStr);
+  return ts.epochMinutes * 60_000;
 }
 
 /**
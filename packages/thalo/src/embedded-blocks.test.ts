@@ -1,5 +1,6 @@
 import { describe, it, expect, beforeEach } from "vitest";
 import { parseDocument } from "./parser.js";
+import { findThaloFences, sliceThaloFences } from "./parser.shared.js";
 import { createWorkspace } from "./parser.native.js";
 import { Workspace } from "./model/workspace.js";
 import { check } from "./checker/check.js";
@@ -90,6 +91,33 @@ More text.
     });
   });
 
+  describe("findThaloFences", () => {
+    it("finds the content range of each thalo fence", () => {
+      const source =
+        "# Title\n\n```thalo\nfirst\n```\n\n```js\nx\n```\n\n```thalo  \nsecond\n```\n";
+      const fences = sliceThaloFences(source, findThaloFences(source));
+
+      expect(fences.map((fence) => fence.source)).toEqual(["first\n", "second\n"]);
+      for (const fence of fences) {
+        expect(source.slice(fence.charOffset, fence.charOffset + fence.source.length)).toBe(
+          fence.source,
+        );
+      }
+      expect(fences[1].sourceMap.lineOffset).toBe(11);
+    });
+
+    it("locates empty blocks and blocks repeating the fence header", () => {
+      // Content that also occurs in the fence header must not be located by searching for it
+      const source = "```thalo\n```\n```thalo\nthalo\n```\n";
+      const fences = sliceThaloFences(source, findThaloFences(source));
+
+      expect(fences.map((fence) => [fence.charOffset, fence.source])).toEqual([
+        [9, ""],
+        [22, "thalo\n"],
+      ]);
+    });
+  });
+
   describe("Semantic Tokens", () => {
     // Token type index for "number" (used for timestamps and datetime values)
     const TIMESTAMP_TOKEN_TYPE = 9; // "number" in tokenTypes array
@@ -9,13 +9,37 @@
 
 import { readdir, readFile, stat } from "node:fs/promises";
 import { join, resolve } from "node:path";
-import { createWorkspace, type Workspace } from "./parser.native.js";
+import {
+  createWorkspace,
+  hasNativeLoader,
+  loadFilesNative,
+  type Workspace,
+} from "./parser.native.js";
 
 /**
  * Default file extensions for thalo files.
  */
 export const DEFAULT_EXTENSIONS = [".thalo", ".md"];
 
+/**
+ * Options for loading a workspace from disk.
+ */
+export interface LoadWorkspaceOptions {
+  /**
+   * Build syntax trees with the binding's bulk extraction, parsing `.thalo` files on the native
+   * loader threads (default false). The trees are read-only snapshots, so `Workspace.edit`
+   * re-parses a whole block instead of reparsing incrementally; turn this on for workspaces
+   * that are only checked or queried, like the CLI's. See `CreateWorkspaceOptions`.
+   */
+  bulkExtraction?: boolean;
+  /**
+   * Directory for a persistent syntax tree cache, e.g. `.thalo-cache`. Files whose content is
+   * unchanged since they were cached are not parsed again. Implies `bulkExtraction`. Needs the
+   * native binding; ignored otherwise.
+   */
+  cacheDir?: string;
+}
+
 /**
  * Collect all thalo files from a directory recursively.
  *
@@ -67,6 +91,7 @@ export async function collectThaloFiles(
  *
  * @param cwd - Working directory to load files from
  * @param extensions - File extensions to include (default: .thalo, .md)
+ * @param options - Load options
  * @returns The loaded workspace
  * @throws Error if directory doesn't exist or no files found
  *
@@ -80,6 +105,7 @@ export async function collectThaloFiles(
 export async function loadWorkspaceFromDirectory(
   cwd: string,
   extensions: string[] = DEFAULT_EXTENSIONS,
+  options: LoadWorkspaceOptions = {},
 ): Promise<Workspace> {
   const resolvedCwd = resolve(cwd);
 
@@ -103,21 +129,14 @@ export async function loadWorkspaceFromDirectory(
     throw new Error(`No ${extensions.join(" or ")} files found in ${cwd}`);
   }
 
-  // Create workspace and add documents
-  const workspace = createWorkspace();
-
-  for (const file of files) {
-    const source = await readFile(file, "utf-8");
-    workspace.addDocument(source, { filename: file });
-  }
-
-  return workspace;
+  return loadFilesIntoWorkspace(files, options);
 }
 
 /**
  * Load a workspace from specific files.
  *
  * @param files - Array of file paths to load
+ * @param options - Load options
  * @returns The loaded workspace
  *
  * @example
@@ -130,13 +149,40 @@ export async function loadWorkspaceFromDirectory(
  * ]);
  * ```
  */
-export async function loadWorkspaceFromFiles(files: string[]): Promise<Workspace> {
-  const workspace = createWorkspace();
+export async function loadWorkspaceFromFiles(
+  files: string[],
+  options: LoadWorkspaceOptions = {},
+): Promise<Workspace> {
+  return loadFilesIntoWorkspace(files.map((file) => resolve(file)), options);
+}
+
+/**
+ * Read and add files to a new workspace, in order.
+ *
+ * With a native binding, files are read in parallel on native threads first, and with bulk
+ * extraction also parsed there; the workspace then only has to build semantic models. Otherwise
+ * files are read one at a time.
+ *
+ * With a cache, files are only read up front; the workspace parses whatever the cache misses.
+ */
+async function loadFilesIntoWorkspace(
+  files: string[],
+  options: LoadWorkspaceOptions,
+): Promise<Workspace> {
+  const { bulkExtraction = false, cacheDir } = options;
+  const workspace = createWorkspace({ bulkExtraction, cacheDir });
+
+  if (hasNativeLoader()) {
+    const parse = bulkExtraction && cacheDir === undefined;
+    const sources = await loadFilesNative(files, { parse });
+    files.forEach((file, i) => workspace.addDocument(sources[i], { filename: file }));
+    return workspace;
+  }
 
   for (const file of files) {
-    const resolvedPath = resolve(file);
-    const source = await readFile(resolvedPath, "utf-8");
-    workspace.addDocument(source, { filename: resolvedPath });
+    // Read raw bytes so the native parser can consume them without re-encoding
+    const source = await readFile(file);
+    workspace.addDocument(source, { filename: file });
   }
 
   return workspace;
@@ -20,7 +20,7 @@ export interface GitContext {
 /**
  * Run a git command and return stdout, or null if it fails
  */
-async function runGit(
+export async function runGit(
   args: string[],
   cwd: string,
 ): Promise<{ stdout: string; stderr: string } | null> {
@@ -35,6 +35,32 @@ async function runGit(
   }
 }
 
+/**
+ * Convert a file path to the repo-root-relative, forward-slash form git expects.
+ *
+ * @param file - File path (relative to repo root or absolute)
+ * @param repoRoot - Root directory of the git repository
+ * @returns The git path, or null if an absolute path is outside the repo root
+ */
+export function toGitPath(file: string, repoRoot: string): string | null {
+  if (path.isAbsolute(file)) {
+    // For absolute paths, compute relative to repo root
+    const relativePath = path.relative(repoRoot, file);
+
+    // Guard against paths outside repo root
+    if (relativePath.startsWith("..")) {
+      return null;
+    }
+
+    // Normalize to POSIX forward slashes (git requires forward slashes on all platforms)
+    return relativePath.split(path.sep).join("/");
+  }
+
+  // For relative paths (e.g., from git diff output), they are already repo-root-relative
+  // Just normalize backslashes to forward slashes
+  return file.replace(/\\/g, "/");
+}
+
 /**
  * Detect git context for a directory.
  *
@@ -161,25 +187,9 @@ export async function getFileAtCommit(
   if (!rootResult) {
     return null;
   }
-  const repoRoot = rootResult.stdout.trim();
-
-  let gitPath: string;
-
-  if (path.isAbsolute(file)) {
-    // For absolute paths, compute relative to repo root
-    const relativePath = path.relative(repoRoot, file);
-
-    // Guard against paths outside repo root
-    if (relativePath.startsWith("..")) {
-      return null;
-    }
-
-    // Normalize to POSIX forward slashes (git requires forward slashes on all platforms)
-    gitPath = relativePath.split(path.sep).join("/");
-  } else {
-    // For relative paths (e.g., from git diff output), they are already repo-root-relative
-    // Just normalize backslashes to forward slashes
-    gitPath = file.replace(/\\/g, "/");
+  const gitPath = toGitPath(file, rootResult.stdout.trim());
+  if (gitPath === null) {
+    return null;
   }
 
   const result = await runGit(["show", `${commit}:${gitPath}`], cwd);
@@ -251,6 +261,16 @@ export async function isCommitAncestorOf(
   return result !== null && result.stdout.trim() === ancestorCommit;
 }
 
+/**
+ * Get the best common ancestor of two commits, e.g. where a branch forked from its base.
+ *
+ * @returns The merge base's hash, or null if there is none or either commit is unknown
+ */
+export async function getMergeBase(a: string, b: string, cwd: string): Promise<string | null> {
+  const result = await runGit(["merge-base", a, b], cwd);
+  return result?.stdout.trim() || null;
+}
+
 /**
  * Get the set of commits currently blamed for a line range.
  *
@@ -272,17 +292,9 @@ export async function getBlameCommitsForLineRange(
   if (!rootResult) {
     return new Set();
   }
-  const repoRoot = rootResult.stdout.trim();
-
-  let gitPath: string;
-  if (path.isAbsolute(file)) {
-    const relativePath = path.relative(repoRoot, file);
-    if (relativePath.startsWith("..")) {
-      return new Set();
-    }
-    gitPath = relativePath.split(path.sep).join("/");
-  } else {
-    gitPath = file.replace(/\\/g, "/");
+  const gitPath = toGitPath(file, rootResult.stdout.trim());
+  if (gitPath === null) {
+    return new Set();
   }
 
   const args = ["blame", "--porcelain", "-L", `${startLine},${endLine}`];
@@ -328,25 +340,9 @@ export async function wasFileModifiedSince(
   if (!rootResult) {
     return false;
   }
-  const repoRoot = rootResult.stdout.trim();
-
-  let gitPath: string;
-
-  if (path.isAbsolute(file)) {
-    // For absolute paths, compute relative to repo root
-    const relativePath = path.relative(repoRoot, file);
-
-    // Guard against paths outside repo root
-    if (relativePath.startsWith("..")) {
-      return false;
-    }
-
-    // Normalize to POSIX forward slashes (git requires forward slashes on all platforms)
-    gitPath = relativePath.split(path.sep).join("/");
-  } else {
-    // For relative paths (e.g., from git diff output), they are already repo-root-relative
-    // Just normalize backslashes to forward slashes
-    gitPath = file.replace(/\\/g, "/");
+  const gitPath = toGitPath(file, rootResult.stdout.trim());
+  if (gitPath === null) {
+    return false;
   }
 
   // Use git log with --follow to track through renames
@@ -392,15 +388,9 @@ export async function getUncommittedFiles(cwd: string, files?: string[]): Promis
   if (files && files.length > 0) {
     // Normalize file paths to be relative to repo root
     for (const file of files) {
-      let gitPath: string;
-      if (path.isAbsolute(file)) {
-        const relativePath = path.relative(repoRoot, file);
-        if (relativePath.startsWith("..")) {
-          continue; // Skip files outside repo
-        }
-        gitPath = relativePath.split(path.sep).join("/");
-      } else {
-        gitPath = file.replace(/\\/g, "/");
+      const gitPath = toGitPath(file, repoRoot);
+      if (gitPath === null) {
+        continue; // Skip files outside repo
       }
       args.push(gitPath);
     }
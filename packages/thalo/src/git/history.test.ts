@@ -0,0 +1,132 @@
+import { describe, it, expect, beforeAll, afterAll } from "vitest";
+import { GitHistory } from "./history.js";
+import { getBlameCommitsForLineRange, getFileAtCommit, isCommitAncestorOf } from "./git.js";
+import * as path from "node:path";
+import * as os from "node:os";
+import * as fs from "node:fs/promises";
+import { execFile } from "node:child_process";
+import { promisify } from "node:util";
+
+const execFileAsync = promisify(execFile);
+
+async function runGit(args: string[], cwd: string): Promise<string> {
+  const result = await execFileAsync("git", args, { cwd });
+  return result.stdout.toString();
+}
+
+describe("GitHistory", () => {
+  let tempDir: string;
+  const commits: string[] = [];
+  const file = "entries.thalo";
+  let history: GitHistory;
+
+  async function commit(content: string, message: string): Promise<void> {
+    await fs.writeFile(path.join(tempDir, file), content, "utf8");
+    await runGit(["add", file], tempDir);
+    await runGit(["commit", "-m", message], tempDir);
+    commits.push((await runGit(["rev-parse", "HEAD"], tempDir)).trim());
+  }
+
+  beforeAll(async () => {
+    tempDir = await fs.mkdtemp(path.join(os.tmpdir(), "thalo-git-history-"));
+    await runGit(["init"], tempDir);
+    await runGit(["config", "user.email", "test@example.com"], tempDir);
+    await runGit(["config", "user.name", "Test User"], tempDir);
+
+    await commit("a\nb\nc\nd\n", "first");
+    await commit("a\nB\nc\nd\n", "second");
+    await commit("a\nB\nc\nd\ne\nf\n", "third");
+
+    history = new GitHistory(tempDir, commits[2]);
+  });
+
+  afterAll(async () => {
+    history.close();
+    await fs.rm(tempDir, { recursive: true, force: true });
+  });
+
+  describe("getBlameCommitsForLineRange", () => {
+    it("should match per-range git blame", async () => {
+      const ranges: [number, number][] = [
+        [1, 1],
+        [1, 2],
+        [2, 2],
+        [3, 4],
+        [4, 6],
+        [1, 6],
+      ];
+      for (const [startLine, endLine] of ranges) {
+        const batched = await history.getBlameCommitsForLineRange(file, startLine, endLine);
+        const single = await getBlameCommitsForLineRange(file, startLine, endLine, tempDir);
+        expect(batched).toEqual(single);
+      }
+    });
+
+    it("should attribute lines to the commits that last changed them", async () => {
+      expect(await history.getBlameCommitsForLineRange(file, 2, 2)).toEqual(new Set([commits[1]]));
+      expect(await history.getBlameCommitsForLineRange(file, 5, 6)).toEqual(new Set([commits[2]]));
+    });
+
+    it("should ignore lines past the end of the file", async () => {
+      expect(await history.getBlameCommitsForLineRange(file, 6, 100)).toEqual(
+        new Set([commits[2]]),
+      );
+      expect(await history.getBlameCommitsForLineRange(file, 50, 100)).toEqual(new Set());
+    });
+
+    it("should return an empty set for files not at head", async () => {
+      expect(await history.getBlameCommitsForLineRange("missing.thalo", 1, 1)).toEqual(new Set());
+    });
+
+    it("should blame with ignored revs", async () => {
+      const ignoring = new GitHistory(tempDir, commits[2], [commits[1]]);
+      expect(await ignoring.getBlameCommitsForLineRange(file, 2, 2)).toEqual(
+        new Set([commits[0]]),
+      );
+    });
+  });
+
+  describe("isCommitSince", () => {
+    it("should agree with isCommitAncestorOf", async () => {
+      for (const commit of commits) {
+        for (const checkpoint of commits) {
+          const isAncestor = await isCommitAncestorOf(commit, checkpoint, tempDir);
+          expect(await history.isCommitSince(commit, checkpoint)).toBe(!isAncestor);
+        }
+      }
+    });
+
+    it("should treat every commit as changed for an unknown checkpoint", async () => {
+      expect(await history.isCommitSince(commits[0], "not-a-commit")).toBe(true);
+    });
+  });
+
+  describe("getFileAtCommit", () => {
+    it("should match git show for concurrent reads", async () => {
+      const reads = await Promise.all(commits.map((c) => history.getFileAtCommit(file, c)));
+      for (let i = 0; i < commits.length; i++) {
+        expect(reads[i]).toBe(await getFileAtCommit(file, commits[i], tempDir));
+      }
+    });
+
+    it("should handle absolute paths", async () => {
+      const repoRoot = (await runGit(["rev-parse", "--show-toplevel"], tempDir)).trim();
+      const content = await history.getFileAtCommit(path.join(repoRoot, file), commits[0]);
+      expect(content).toBe("a\nb\nc\nd\n");
+    });
+
+    it("should return null for missing files and non-blob objects", async () => {
+      expect(await history.getFileAtCommit("missing.thalo", commits[0])).toBeNull();
+      expect(await history.getFileAtCommit("", commits[0])).toBeNull();
+      const missingCommit = "0000000000000000000000000000000000000000";
+      expect(await history.getFileAtCommit(file, missingCommit)).toBeNull();
+    });
+
+    it("should keep answering from cache after close", async () => {
+      const fresh = new GitHistory(tempDir, commits[2]);
+      const before = await fresh.getFileAtCommit(file, commits[1]);
+      fresh.close();
+      expect(await fresh.getFileAtCommit(file, commits[1])).toBe(before);
+    });
+  });
+});
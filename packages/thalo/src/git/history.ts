@@ -0,0 +1,330 @@
+import { spawn, type ChildProcess } from "node:child_process";
+import type { Socket } from "node:net";
+import { runGit, toGitPath } from "./git.js";
+
+/**
+ * Batched, cached access to the history of a git repository at one HEAD commit.
+ *
+ * The helpers in `git.ts` spawn one git process per question, so checking many entries against
+ * a checkpoint forks a blame and a merge-base per entry. GitHistory asks git once per file and
+ * answers every later question from memory:
+ *
+ * - Each file is blamed once, with `git blame --incremental`, into a per-line commit table
+ * - The commits since a checkpoint are listed once, with `git rev-list <checkpoint>..<head>`
+ * - File contents at a commit are read through one long-lived `git cat-file --batch` process
+ *
+ * Everything is keyed by commit, so the results stay valid for as long as `head` is HEAD.
+ */
+export class GitHistory {
+  /** The commit that blame and rev-list results are relative to */
+  readonly head: string;
+  private readonly cwd: string;
+  private readonly ignoreRevs: string[] | null;
+  private repoRoot: Promise<string | null> | undefined;
+  private readonly blames = new Map<string, Promise<string[] | null>>();
+  private readonly commitsSince = new Map<string, Promise<Set<string> | null>>();
+  private readonly files = new Map<string, Promise<string | null>>();
+  private catFile: CatFileBatch | undefined;
+
+  /**
+   * @param cwd - Working directory
+   * @param head - Commit to blame files at, usually the current HEAD
+   * @param ignoreRevs - Revs whose changes blame should attribute to earlier commits
+   */
+  constructor(cwd: string, head: string, ignoreRevs: string[] | null = null) {
+    this.cwd = cwd;
+    this.head = head;
+    this.ignoreRevs = ignoreRevs;
+  }
+
+  private getRepoRoot(): Promise<string | null> {
+    this.repoRoot ??= runGit(["rev-parse", "--show-toplevel"], this.cwd).then(
+      (result) => result?.stdout.trim() ?? null,
+    );
+    return this.repoRoot;
+  }
+
+  private async getGitPath(file: string): Promise<string | null> {
+    const repoRoot = await this.getRepoRoot();
+    return repoRoot === null ? null : toGitPath(file, repoRoot);
+  }
+
+  /**
+   * Get the commit blamed for each line of a file at `head`, indexed by 0-based line.
+   */
+  private getBlame(gitPath: string): Promise<string[] | null> {
+    let blame = this.blames.get(gitPath);
+    if (!blame) {
+      blame = this.blame(gitPath);
+      this.blames.set(gitPath, blame);
+    }
+    return blame;
+  }
+
+  private async blame(gitPath: string): Promise<string[] | null> {
+    const args = ["blame", "--incremental"];
+    for (const rev of this.ignoreRevs ?? []) {
+      args.push("--ignore-rev", rev);
+    }
+    args.push(this.head, "--", gitPath);
+
+    const result = await runGit(args, this.cwd);
+    if (!result) {
+      return null;
+    }
+
+    // Each chunk starts with "<sha> <orig-line> <final-line> <num-lines>", followed by
+    // "<key> <value>" lines; the commit details are not needed. Chunks come in no particular
+    // order, but together cover every line once.
+    const lines: string[] = [];
+    const shas = new Map<string, string>();
+    for (const line of result.stdout.split("\n")) {
+      const header = /^([0-9a-f]{40,64}) \d+ (\d+) (\d+)$/.exec(line);
+      if (!header) {
+        continue;
+      }
+      let sha = shas.get(header[1]);
+      if (sha === undefined) {
+        sha = header[1];
+        shas.set(sha, sha);
+      }
+      const start = Number(header[2]) - 1;
+      const end = start + Number(header[3]);
+      for (let i = start; i < end; i++) {
+        lines[i] = sha;
+      }
+    }
+    return lines;
+  }
+
+  /**
+   * Get the set of commits blamed at `head` for a line range.
+   *
+   * The whole file is blamed on the first call for it; later ranges are answered from memory.
+   *
+   * @param file - File path (relative to repo root or absolute)
+   * @param startLine - 1-based inclusive start line
+   * @param endLine - 1-based inclusive end line
+   */
+  async getBlameCommitsForLineRange(
+    file: string,
+    startLine: number,
+    endLine: number,
+  ): Promise<Set<string>> {
+    const commits = new Set<string>();
+    const gitPath = await this.getGitPath(file);
+    if (gitPath === null) {
+      return commits;
+    }
+    const blame = await this.getBlame(gitPath);
+    if (!blame) {
+      return commits;
+    }
+    for (let line = Math.max(startLine, 1); line <= endLine && line <= blame.length; line++) {
+      const commit = blame[line - 1];
+      if (commit !== undefined) {
+        commits.add(commit);
+      }
+    }
+    return commits;
+  }
+
+  /**
+   * Check whether a commit reachable from `head` was made after a checkpoint, i.e. is not the
+   * checkpoint or one of its ancestors.
+   *
+   * Equivalent to `!isCommitAncestorOf(commit, checkpoint)` for such commits, but lists the
+   * commits since the checkpoint once instead of running a merge-base per commit.
+   */
+  async isCommitSince(commit: string, checkpoint: string): Promise<boolean> {
+    let since = this.commitsSince.get(checkpoint);
+    if (!since) {
+      since = runGit(["rev-list", `${checkpoint}..${this.head}`], this.cwd).then((result) =>
+        result ? new Set(result.stdout.split("\n").filter((line) => line.length > 0)) : null,
+      );
+      this.commitsSince.set(checkpoint, since);
+    }
+    // If the commits can't be listed, treat everything as changed
+    const commits = await since;
+    return commits === null || commits.has(commit);
+  }
+
+  /**
+   * Get file content at a specific commit.
+   *
+   * @param file - File path (relative to repo root or absolute)
+   * @param commit - Commit to retrieve content from
+   * @returns File content at that commit, or null if the file doesn't exist at the commit
+   */
+  async getFileAtCommit(file: string, commit: string): Promise<string | null> {
+    const gitPath = await this.getGitPath(file);
+    // cat-file reads one object name per line
+    if (gitPath === null || gitPath.includes("\n") || commit.includes("\n")) {
+      return null;
+    }
+
+    const object = `${commit}:${gitPath}`;
+    let content = this.files.get(object);
+    if (!content) {
+      this.catFile ??= new CatFileBatch(this.cwd);
+      content = this.catFile.read(object);
+      this.files.set(object, content);
+    }
+    return content;
+  }
+
+  /**
+   * Stop the cat-file process, if one was started. Cached results remain available.
+   */
+  close(): void {
+    this.catFile?.close();
+    this.catFile = undefined;
+  }
+}
+
+interface PendingRead {
+  resolve: (content: string | null) => void;
+}
+
+/**
+ * A `git cat-file --batch` process, reading blobs by object name.
+ *
+ * Requests are answered in order, so pending reads are a queue. The process is unref'd while
+ * no read is pending, so an idle process never keeps Node running; it exits when its stdin
+ * closes, at the latest when this process exits.
+ */
+class CatFileBatch {
+  private readonly child: ChildProcess | null;
+  private readonly pending: PendingRead[] = [];
+  private chunks: Buffer[] = [];
+  private buffered = 0;
+  /** Size of the object being read, once its header has been parsed */
+  private objectSize: number | undefined;
+  /** Whether the object being read is a blob; other objects are read as null */
+  private isBlob = false;
+  private closed = false;
+
+  constructor(cwd: string) {
+    try {
+      this.child = spawn("git", ["cat-file", "--batch"], {
+        cwd,
+        stdio: ["pipe", "pipe", "ignore"],
+      });
+    } catch {
+      this.child = null;
+      return;
+    }
+    this.child.stdout!.on("data", (chunk: Buffer) => this.onData(chunk));
+    this.child.on("error", () => this.fail());
+    this.child.on("close", () => this.fail());
+    this.child.stdin!.on("error", () => this.fail());
+    this.setActive(false);
+  }
+
+  read(object: string): Promise<string | null> {
+    const child = this.child;
+    if (!child || this.closed || !child.stdin!.writable) {
+      return Promise.resolve(null);
+    }
+    return new Promise((resolve) => {
+      if (this.pending.length === 0) {
+        this.setActive(true);
+      }
+      this.pending.push({ resolve });
+      child.stdin!.write(`${object}\n`);
+    });
+  }
+
+  close(): void {
+    this.child?.stdin!.end();
+  }
+
+  private setActive(active: boolean): void {
+    const child = this.child;
+    if (!child) {
+      return;
+    }
+    // The pipes are sockets, which hold their own references to the event loop
+    const stdout = child.stdout as Socket | null;
+    const stdin = child.stdin as Socket | null;
+    if (active) {
+      child.ref();
+      stdout?.ref();
+      stdin?.ref();
+    } else {
+      child.unref();
+      stdout?.unref();
+      stdin?.unref();
+    }
+  }
+
+  private onData(chunk: Buffer): void {
+    this.chunks.push(chunk);
+    this.buffered += chunk.length;
+
+    // Each response is "<oid> <type> <size>\n<content>\n", or "<object> missing\n"
+    for (;;) {
+      if (this.objectSize === undefined) {
+        const data = this.take(0);
+        const newline = data.indexOf(0x0a);
+        if (newline === -1) {
+          return;
+        }
+        const header = data.toString("utf8", 0, newline);
+        this.consume(newline + 1);
+
+        const match = /^[0-9a-f]+ (\S+) (\d+)$/.exec(header);
+        if (!match) {
+          this.settle(null);
+          continue;
+        }
+        this.objectSize = Number(match[2]);
+        this.isBlob = match[1] === "blob";
+      }
+
+      const size = this.objectSize;
+      if (this.buffered < size + 1) {
+        return;
+      }
+      const content = this.take(size).toString("utf8", 0, size);
+      this.consume(size + 1);
+      this.objectSize = undefined;
+      this.settle(this.isBlob ? content : null);
+    }
+  }
+
+  /** Get at least the first `length` buffered bytes (all of them if 0) as one buffer. */
+  private take(length: number): Buffer {
+    if (this.chunks.length > 1 && (length === 0 || this.chunks[0].length < length)) {
+      this.chunks = [Buffer.concat(this.chunks, this.buffered)];
+    }
+    return this.chunks[0] ?? Buffer.alloc(0);
+  }
+
+  /** Drop the first `length` buffered bytes. */
+  private consume(length: number): void {
+    const data = this.take(length);
+    const rest = data.subarray(length);
+    this.chunks = rest.length > 0 ? [rest] : [];
+    this.buffered -= length;
+  }
+
+  private settle(content: string | null): void {
+    const read = this.pending.shift();
+    read?.resolve(content);
+    if (this.pending.length === 0) {
+      this.setActive(false);
+    }
+  }
+
+  /** Answer every pending read with null, e.g. when the process exits. */
+  private fail(): void {
+    this.closed = true;
+    for (const read of this.pending.splice(0)) {
+      read.resolve(null);
+    }
+    this.chunks = [];
+    this.buffered = 0;
+    this.objectSize = undefined;
+  }
+}
@@ -345,5 +345,49 @@ describe("conflict-detector", () => {
       expect(conflicts).toHaveLength(1);
       expect(conflicts[0].message).toBe("Concurrent tag changes detected");
     });
+
+    it("only applies custom rules to matches with an unchanged side", () => {
+      const baseEntry = mockInstanceEntry({
+        timestamp: "2026-01-05T10:00Z",
+        directive: "create",
+        entity: "lore",
+        title: "Entry",
+        linkId: "e1",
+        metadata: [{ key: "status", value: "draft" }],
+      });
+
+      const theirsEntry = mockInstanceEntry({
+        timestamp: "2026-01-05T10:00Z",
+        directive: "create",
+        entity: "lore",
+        title: "Entry",
+        linkId: "e1",
+        metadata: [{ key: "status", value: "done" }],
+      });
+
+      const match: EntryMatch = {
+        identity: { linkId: "e1", entryType: "instance_entry" },
+        base: baseEntry,
+        ours: baseEntry,
+        theirs: theirsEntry,
+        oursUnchanged: true,
+      };
+
+      expect(detectConflicts([match])).toHaveLength(0);
+
+      const customRule = {
+        name: "always",
+        detect: (m: EntryMatch) => ({
+          type: "merge-error" as const,
+          message: "Custom rule ran",
+          location: 0,
+          identity: m.identity,
+        }),
+      };
+      const conflicts = detectConflicts([match], { conflictRules: [customRule] });
+
+      expect(conflicts).toHaveLength(1);
+      expect(conflicts[0].message).toBe("Custom rule ran");
+    });
   });
 });
@@ -120,9 +120,12 @@ export function detectConflicts(
   const conflicts: MergeConflict[] = [];
 
   const rules: ConflictRule[] = [...DEFAULT_CONFLICT_RULES, ...(options.conflictRules || [])];
+  const customRules = options.conflictRules || [];
 
   for (const match of matches) {
-    for (const rule of rules) {
+    // Every default rule needs both sides to have changed from base
+    const oneSideUnchanged = match.oursUnchanged || match.theirsUnchanged;
+    for (const rule of oneSideUnchanged ? customRules : rules) {
       const conflict = rule.detect(match);
       if (conflict) {
         conflicts.push(conflict);
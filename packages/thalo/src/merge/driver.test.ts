@@ -1,6 +1,6 @@
 import { describe, it, expect, beforeAll } from "vitest";
 import { mergeThaloFiles } from "./driver.js";
-import { initParser } from "../parser.node.js";
+import { initParser, createParser } from "../parser.node.js";
 
 describe("mergeThaloFiles", () => {
   beforeAll(async () => {
@@ -291,4 +291,48 @@ describe("mergeThaloFiles", () => {
       expect(result.content).toContain('type: "fact"');
     });
   });
+
+  describe("inputs and parsers", () => {
+    const base = `2026-01-01T00:00Z define-entity lore "Lore"
+
+2026-01-05T10:00Z create lore "Kept" ^kept
+  type: "fact"
+
+2026-01-05T11:00Z create lore "Entry" ^entry-1
+  type: "fact"`;
+    const ours = base.replace('"Kept"', '"Kept, renamed"');
+    const theirs = base + `\n  status: "reviewed"`;
+
+    it("merges UTF-8 bytes like strings", () => {
+      const encoder = new TextEncoder();
+
+      const fromBytes = mergeThaloFiles(
+        encoder.encode(base),
+        encoder.encode(ours),
+        encoder.encode(theirs),
+      );
+      const fromStrings = mergeThaloFiles(base, ours, theirs);
+
+      expect(fromBytes).toEqual(fromStrings);
+      expect(fromBytes.success).toBe(true);
+      expect(fromBytes.content).toContain('"Kept, renamed"');
+      expect(fromBytes.content).toContain('status: "reviewed"');
+    });
+
+    it("parses every version with the given parser", () => {
+      const parser = createParser();
+      const parsed: string[] = [];
+      const parseDocument = parser.parseDocument;
+      parser.parseDocument = (source, options) => {
+        parsed.push(source);
+        return parseDocument(source, options);
+      };
+
+      const result = mergeThaloFiles(base, ours, theirs, { parser });
+
+      expect(parsed).toEqual([base, ours, theirs]);
+      expect(result.stats.common).toBe(1);
+      expect(result.stats.autoMerged).toBe(2);
+    });
+  });
 });
@@ -1,8 +1,10 @@
 import { parseDocument } from "../parser.node.js";
+import { decodeUtf8, type GenericTree, type ThaloParser } from "../parser.shared.js";
 import { extractSourceFile } from "../ast/extract.js";
+import type { SourceFile } from "../ast/ast-types.js";
 import type { MergeResult } from "./merge-result-builder.js";
 import type { MergeConflict, ConflictRule } from "./conflict-detector.js";
-import { matchEntries } from "./entry-matcher.js";
+import { matchEntries, type EntryMatch } from "./entry-matcher.js";
 import { detectConflicts } from "./conflict-detector.js";
 import { buildMergedResult } from "./merge-result-builder.js";
 
@@ -28,6 +30,58 @@ export interface MergeOptions {
    * Applied after default rules
    */
   conflictRules?: ConflictRule[];
+
+  /**
+   * Parser for the three versions. Defaults to the parser set up by `initParser()`.
+   *
+   * A parser with a persistent cache, e.g. `createExtractionParser(openParseCache(dir))` from
+   * `@rejot-dev/thalo/native`, reuses trees across invocations: during a rebase, the base of
+   * each commit is usually the version a previous invocation saw as theirs.
+   */
+  parser?: ThaloParser<GenericTree>;
+}
+
+/**
+ * A version of a file to merge: its text, or its UTF-8 bytes as read from disk. Parsers that
+ * support it parse bytes in place, and reuse trees parsed for them by `loadFilesNative`.
+ */
+export type MergeInput = string | Uint8Array;
+
+/**
+ * Parse one version of a file.
+ */
+function parseVersion(
+  input: MergeInput,
+  parser: ThaloParser<GenericTree> | undefined,
+): Pick<SourceFile, "entries" | "syntaxErrors"> {
+  const { source, utf8 } =
+    typeof input === "string" ? { source: input, utf8: undefined } : decodeUtf8(input);
+  const options = { fileType: "thalo" as const, utf8 };
+  const doc = parser ? parser.parseDocument(source, options) : parseDocument(source, options);
+  return doc.blocks.length > 0
+    ? extractSourceFile(doc.blocks[0].tree.rootNode)
+    : { entries: [], syntaxErrors: [] };
+}
+
+/**
+ * Mark the sides of each match whose source text is the same as base.
+ *
+ * In a typical merge most entries are untouched on at least one side. Comparing their text
+ * lets conflict detection and merging skip the field-by-field comparison of those entries.
+ */
+function markUnchangedSides(matches: EntryMatch[]): void {
+  for (const match of matches) {
+    if (!match.base) {
+      continue;
+    }
+    const baseText = match.base.syntaxNode.text;
+    if (match.ours && match.ours.syntaxNode.text === baseText) {
+      match.oursUnchanged = true;
+    }
+    if (match.theirs && match.theirs.syntaxNode.text === baseText) {
+      match.theirsUnchanged = true;
+    }
+  }
 }
 
 /**
@@ -66,28 +120,16 @@ export interface MergeOptions {
  * ```
  */
 export function mergeThaloFiles(
-  base: string,
-  ours: string,
-  theirs: string,
+  base: MergeInput,
+  ours: MergeInput,
+  theirs: MergeInput,
   options: MergeOptions = {},
 ): MergeResult {
+  const oursText = typeof ours === "string" ? ours : decodeUtf8(ours).source;
   try {
-    const baseDoc = parseDocument(base, { fileType: "thalo" });
-    const oursDoc = parseDocument(ours, { fileType: "thalo" });
-    const theirsDoc = parseDocument(theirs, { fileType: "thalo" });
-
-    const baseAst =
-      baseDoc.blocks.length > 0
-        ? extractSourceFile(baseDoc.blocks[0].tree.rootNode)
-        : { entries: [], syntaxErrors: [] };
-    const oursAst =
-      oursDoc.blocks.length > 0
-        ? extractSourceFile(oursDoc.blocks[0].tree.rootNode)
-        : { entries: [], syntaxErrors: [] };
-    const theirsAst =
-      theirsDoc.blocks.length > 0
-        ? extractSourceFile(theirsDoc.blocks[0].tree.rootNode)
-        : { entries: [], syntaxErrors: [] };
+    const baseAst = parseVersion(base, options.parser);
+    const oursAst = parseVersion(ours, options.parser);
+    const theirsAst = parseVersion(theirs, options.parser);
 
     // Surface syntax errors as parse-error conflicts
     const syntaxErrorConflicts: MergeConflict[] = [];
@@ -122,7 +164,7 @@ export function mergeThaloFiles(
     if (syntaxErrorConflicts.length > 0) {
       return {
         success: false,
-        content: ours,
+        content: oursText,
         conflicts: syntaxErrorConflicts,
         stats: {
           totalEntries: 0,
@@ -136,6 +178,7 @@ export function mergeThaloFiles(
     }
 
     const matches = matchEntries(baseAst.entries, oursAst.entries, theirsAst.entries);
+    markUnchangedSides(matches);
 
     const conflicts = detectConflicts(matches, options);
 
@@ -146,7 +189,7 @@ export function mergeThaloFiles(
     const errorMessage = error instanceof Error ? error.message : String(error);
     return {
       success: false,
-      content: ours,
+      content: oursText,
       conflicts: [
         {
           type: "merge-error",
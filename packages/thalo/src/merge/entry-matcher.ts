@@ -48,16 +48,29 @@ export interface EntryMatch {
    * null if entry was deleted in theirs
    */
   theirs: Entry | null;
+
+  /**
+   * True if ours has the same source text as base, as checked by the merge driver.
+   * Such a side is unchanged, so no default conflict rule applies and merging takes the other.
+   */
+  oursUnchanged?: boolean;
+
+  /**
+   * True if theirs has the same source text as base, as checked by the merge driver.
+   */
+  theirsUnchanged?: boolean;
 }
 
 /**
  * Match entries across three versions based on identity
  *
  * Algorithm:
- * 1. Build identity map for each version (link ID or timestamp)
- * 2. Compute union of all identities
- * 3. For each identity, find corresponding entry in each version
- * 4. Return matched triplets
+ * 1. Number each distinct identity (link ID or timestamp) in order of first appearance
+ * 2. Place each version's entries in the match with that number
+ * 3. Return matched triplets
+ *
+ * Each entry costs one lookup of its serialized identity; matches are then addressed by their
+ * number rather than through a map per version and a union of all keys.
  *
  * @param base - Entries from base version (common ancestor)
  * @param ours - Entries from ours version (local/current)
@@ -65,65 +78,38 @@ export interface EntryMatch {
  * @returns Array of matched entry triplets
  */
 export function matchEntries(base: Entry[], ours: Entry[], theirs: Entry[]): EntryMatch[] {
-  const baseMap = buildIdentityMap(base, "base");
-  const oursMap = buildIdentityMap(ours, "ours");
-  const theirsMap = buildIdentityMap(theirs, "theirs");
-
-  const allIdentities = new Set<string>();
-  for (const id of baseMap.keys()) {
-    allIdentities.add(id);
-  }
-  for (const id of oursMap.keys()) {
-    allIdentities.add(id);
-  }
-  for (const id of theirsMap.keys()) {
-    allIdentities.add(id);
-  }
-
+  const ids = new Map<string, number>();
   const matches: EntryMatch[] = [];
-  for (const idKey of allIdentities) {
-    const identity = parseIdentityKey(idKey);
-    matches.push({
-      identity,
-      base: baseMap.get(idKey) || null,
-      ours: oursMap.get(idKey) || null,
-      theirs: theirsMap.get(idKey) || null,
-    });
-  }
-
-  return matches;
-}
 
-/**
- * Build a map from identity key to entry
- *
- * Precondition: Each version must not contain duplicate identities.
- * Callers should validate inputs via the checker module's duplicate-link-id
- * and duplicate-timestamp rules before invoking the merge driver.
- *
- * @param entries - Array of entries to map
- * @param versionName - Name of version for error messages (e.g., "base", "ours", "theirs")
- * @returns Map from serialized identity to entry
- * @throws Error if duplicate identity is found within the version
- */
-function buildIdentityMap(entries: Entry[], versionName: string): Map<string, Entry> {
-  const map = new Map<string, Entry>();
-
-  for (const entry of entries) {
-    const identity = getEntryIdentity(entry);
-    const key = serializeIdentity(identity);
-
-    if (map.has(key)) {
-      throw new Error(
-        `Duplicate identity '${key}' found in ${versionName} version. ` +
-          `Ensure inputs are validated via checker rules before merging.`,
-      );
+  const place = (entries: Entry[], version: "base" | "ours" | "theirs"): void => {
+    for (const entry of entries) {
+      const key = serializeIdentity(getEntryIdentity(entry));
+      let id = ids.get(key);
+      if (id === undefined) {
+        id = matches.length;
+        ids.set(key, id);
+        matches.push({ identity: parseIdentityKey(key), base: null, ours: null, theirs: null });
+      }
+
+      // Precondition: Each version must not contain duplicate identities.
+      // Callers should validate inputs via the checker module's duplicate-link-id
+      // and duplicate-timestamp rules before invoking the merge driver.
+      const match = matches[id];
+      if (match[version]) {
+        throw new Error(
+          `Duplicate identity '${key}' found in ${version} version. ` +
+            `Ensure inputs are validated via checker rules before merging.`,
+        );
+      }
+      match[version] = entry;
     }
+  };
 
-    map.set(key, entry);
-  }
+  place(base, "base");
+  place(ours, "ours");
+  place(theirs, "theirs");
 
-  return map;
+  return matches;
 }
 
 /**
@@ -168,6 +168,50 @@ describe("entry-merger", () => {
       expect(result).toBe(baseEntry);
     });
 
+    it("takes the other side when one side is marked unchanged", () => {
+      const base = mockInstanceEntry({
+        timestamp: "2026-01-05T10:00Z",
+        directive: "create",
+        entity: "lore",
+        title: "Original",
+        linkId: "e1",
+      });
+
+      const changed = mockInstanceEntry({
+        timestamp: "2026-01-05T10:00Z",
+        directive: "create",
+        entity: "lore",
+        title: "Modified",
+        linkId: "e1",
+      });
+
+      const identity = { linkId: "e1", entryType: "instance_entry" };
+
+      const theirsChanged: EntryMatch = {
+        identity,
+        base,
+        ours: base,
+        theirs: changed,
+        oursUnchanged: true,
+      };
+      const oursChanged: EntryMatch = {
+        identity,
+        base,
+        ours: changed,
+        theirs: base,
+        theirsUnchanged: true,
+      };
+      const neitherChanged: EntryMatch = {
+        ...theirsChanged,
+        theirs: base,
+        theirsUnchanged: true,
+      };
+
+      expect(mergeEntry(theirsChanged)).toBe(changed);
+      expect(mergeEntry(oursChanged)).toBe(changed);
+      expect(mergeEntry(neitherChanged)).toBe(base);
+    });
+
     it("merges non-conflicting metadata changes from both sides", () => {
       const baseEntry = mockInstanceEntry({
         timestamp: "2026-01-05T10:00Z",
@@ -31,6 +31,14 @@ export function mergeEntry(match: EntryMatch): Entry | null {
   }
 
   if (base && ours && theirs) {
+    // A side with the same source text as base is unchanged without comparing entries
+    if (match.oursUnchanged) {
+      return match.theirsUnchanged || entriesEqual(base, theirs) ? base : theirs;
+    }
+    if (match.theirsUnchanged) {
+      return entriesEqual(base, ours) ? base : ours;
+    }
+
     const oursChanged = !entriesEqual(base, ours);
     const theirsChanged = !entriesEqual(base, theirs);
 
@@ -122,7 +122,8 @@ export function buildMergedResult(
         } else if (!match.base && !match.ours && match.theirs) {
           stats.theirsOnly++;
         } else if (match.base && match.ours && match.theirs) {
-          if (entriesEqual(match.base, match.ours) && entriesEqual(match.base, match.theirs)) {
+          const oursEqual = match.oursUnchanged || entriesEqual(match.base, match.ours);
+          if (oursEqual && (match.theirsUnchanged || entriesEqual(match.base, match.theirs))) {
             stats.common++;
           } else {
             stats.autoMerged++;
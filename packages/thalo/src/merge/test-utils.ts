@@ -31,6 +31,7 @@ import type {
   QuotedValue,
   LinkValue,
 } from "../ast/ast-types.js";
+import { epochMinutes } from "../ast/time.js";
 
 /**
  * Creates a mock Location object
@@ -115,6 +116,7 @@ export function mockTimestamp(value: string, startIndex = 0, endIndex = 17): Tim
     date: datePart,
     time: timePart,
     timezone: timezonePart,
+    epochMinutes: epochMinutes(year, month, day, hour, minute, offsetMinutes),
     location: mockLocation(startIndex, endIndex),
     syntaxNode: mockSyntaxNode(),
   };
@@ -15,9 +15,10 @@ export type { FragmentType, ParsedFragment } from "./fragment.js";
 
 // Model classes
 export { Workspace } from "./model/workspace.js";
-export type { DocumentBlock, EditRange, EditResult } from "./model/document.js";
+export type { ChangedLines, DocumentBlock, EditRange, EditResult } from "./model/document.js";
 export type { Position as LinePosition } from "./model/line-index.js";
-export type { InvalidationResult } from "./model/workspace.js";
+export type { InvalidationResult, WorkspaceOptions } from "./model/workspace.js";
+export type { TreeRetention } from "./model/tree-retention.js";
 export type {
   ModelSchemaEntry,
   ModelTypeExpression,
@@ -42,6 +43,19 @@ export type {
   SemanticModelDirtyFlags,
   SemanticUpdateResult,
 } from "./semantic/analyzer.js";
+export { SymbolTable, NO_SYMBOL } from "./semantic/symbols.js";
+export {
+  ENTRY_KINDS,
+  DIRECTIVES,
+  KIND_INSTANCE,
+  KIND_SCHEMA,
+  KIND_SYNTHESIS,
+  KIND_ACTUALIZE,
+  headerKind,
+  headerDirective,
+  headerTags,
+} from "./semantic/header-store.js";
+export type { HeaderStore, HeaderDirective } from "./semantic/header-store.js";
 
 // Schema
 export { TypeExpr } from "./schema/registry.js";
@@ -62,7 +76,7 @@ export type {
 export { isSyntaxError } from "./ast/ast-types.js";
 
 // AST node-at-position utility
-export { findNodeAtPosition } from "./ast/node-at-position.js";
+export { findNodeAtPosition, findNodesAtPositions } from "./ast/node-at-position.js";
 export type {
   NodeContext,
   LinkContext,
@@ -94,15 +108,21 @@ export * from "./services/definition.js";
 export * from "./services/references.js";
 export {
   extractSemanticTokens,
+  updateSemanticTokens,
   encodeSemanticTokens,
+  diffSemanticTokens,
   tokenTypes,
   tokenModifiers,
   type SemanticToken,
+  type SemanticTokensEdit,
+  type SemanticTokensSource,
+  type LineRange,
   type TokenType,
   type TokenModifier,
 } from "./services/semantic-tokens.js";
 export * from "./services/entity-navigation.js";
 export * from "./services/query.js";
+export { compileQueries, executePlan, type QueryPlan } from "./services/query-plan.js";
 export * from "./services/hover.js";
 export * from "./services/synthesis.js";
 
@@ -116,7 +136,7 @@ export type {
   ConflictRule,
 } from "./merge/conflict-detector.js";
 export type { EntryMatch, EntryIdentity } from "./merge/entry-matcher.js";
-export type { MergeOptions } from "./merge/driver.js";
+export type { MergeOptions, MergeInput } from "./merge/driver.js";
 
 // Constants
 export * from "./constants.js";
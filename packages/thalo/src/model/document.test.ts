@@ -178,6 +178,25 @@ console.log("not thalo");
       expect(doc.lineIndex.lineCount).toBe(3);
       expect(doc.source).toBe("line1\nnewline2\nline3");
     });
+
+    it("should parse from the rope across many chunks", () => {
+      let source = "";
+      for (let i = 0; i < 200; i++) {
+        source += `2024-01-01T12:00Z create fact "Entry ${i}" ^e${i}\n  key: "✓ ${i}"\n\n`;
+      }
+      const doc = createDocument("test.thalo", source);
+
+      // Rename every tenth entry, editing from the end so earlier lines keep their numbers
+      for (let i = 190; i >= 0; i -= 10) {
+        doc.applyEdit(i * 3, 31, i * 3, 31 + `Entry ${i}`.length, `Renamed ${i}`);
+      }
+
+      const fresh = parser.parse(doc.source);
+      expect(doc.blocks[0].tree.rootNode.toString()).toBe(fresh.rootNode.toString());
+      expect(doc.blocks[0].tree.rootNode.text).toBe(doc.source);
+      expect(doc.text.length).toBe(doc.source.length);
+      expect(doc.source).toContain('"Renamed 190" ^e190');
+    });
   });
 
   describe("applyEdit - markdown files", () => {
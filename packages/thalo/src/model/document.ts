@@ -1,7 +1,10 @@
 import type { SourceMap } from "../source-map.js";
-import { createSourceMap, identitySourceMap } from "../source-map.js";
-import type { ThaloParser, GenericTree, FileType } from "../parser.shared.js";
+import { identitySourceMap } from "../source-map.js";
+import { sliceThaloFences } from "../parser.shared.js";
+import type { ThaloParser, GenericTree, FileType, TreeEdit, TreeRange } from "../parser.shared.js";
 import { LineIndex, computeEdit } from "./line-index.js";
+import { updatePositionIndex } from "../ast/position-index.js";
+import type { Rope } from "./rope.js";
 
 /** Position type compatible with tree-sitter Point */
 interface Point {
@@ -48,18 +51,49 @@ export interface EditResult {
   modifiedBlockIndices: number[];
   /** Whether a full reparse was required */
   fullReparse: boolean;
+  /** The lines whose syntax may have changed, unless the edit needed a full reparse */
+  changedLines?: ChangedLines;
 }
 
 /**
- * Regex to match fenced thalo code blocks in markdown.
- * Captures the content between ```thalo and ```
+ * Lines whose syntax may differ after an edit: lines [startLine, oldEndLine] of the old text
+ * became lines [startLine, newEndLine] of the new text, and every later line moved by
+ * `newEndLine - oldEndLine`.
  */
-const THALO_FENCE_REGEX = /^```thalo\s*\n([\s\S]*?)^```/gm;
+export interface ChangedLines {
+  startLine: number;
+  oldEndLine: number;
+  newEndLine: number;
+}
+
+/**
+ * Get the lines an edit may have changed: the edited lines, widened to cover the ranges whose
+ * structure tree-sitter reports as changed. The ranges are relative to a block starting at
+ * file line `lineOffset`.
+ */
+function changedLines(
+  edit: EditRange,
+  ranges: readonly TreeRange[],
+  lineOffset: number,
+): ChangedLines {
+  let startLine = edit.startPosition.row;
+  let newEndLine = edit.newEndPosition.row;
+  for (const range of ranges) {
+    startLine = Math.min(startLine, lineOffset + range.startPosition.row);
+    newEndLine = Math.max(newEndLine, lineOffset + range.endPosition.row);
+  }
+  const lineDelta = edit.newEndPosition.row - edit.oldEndPosition.row;
+  return { startLine, oldEndLine: newEndLine - lineDelta, newEndLine };
+}
 
 /**
  * A Document owns the source text and Tree-sitter tree(s) for a file,
  * providing efficient incremental edit operations.
  *
+ * The text is kept in a `Rope`, so an edit splices the rope and its line index in O(log n)
+ * and tree-sitter reads .thalo files from the rope directly. The flat source string is only
+ * built when someone asks for it.
+ *
  * The Document is parser-agnostic - it accepts any parser that implements
  * the ThaloParser interface.
  */
@@ -68,7 +102,6 @@ export class Document<T extends GenericTree = GenericTree> {
   readonly fileType: FileType;
 
   private parser: ThaloParser<T>;
-  private _source: string;
   private _blocks: DocumentBlock<T>[];
   private _lineIndex: LineIndex;
 
@@ -83,17 +116,23 @@ export class Document<T extends GenericTree = GenericTree> {
   constructor(parser: ThaloParser<T>, filename: string, source: string, fileType?: FileType) {
     this.parser = parser;
     this.filename = filename;
-    this._source = source;
     this.fileType = fileType ?? Document.detectFileType(filename, source);
-    this._lineIndex = new LineIndex(this._source);
-    this._blocks = this.parseBlocks(this._source);
+    this._lineIndex = new LineIndex(source);
+    this._blocks = this.parseBlocks(source);
   }
 
   /**
    * Get the current source text.
    */
   get source(): string {
-    return this._source;
+    return this._lineIndex.text.toString();
+  }
+
+  /**
+   * Get the current source text as a rope, without flattening it.
+   */
+  get text(): Rope {
+    return this._lineIndex.text;
   }
 
   /**
@@ -130,22 +169,16 @@ export class Document<T extends GenericTree = GenericTree> {
     // Compute edit parameters
     const edit = computeEdit(this._lineIndex, startLine, startColumn, endLine, endColumn, newText);
 
-    // Apply the edit to get new source
-    const newSource =
-      this._source.slice(0, edit.startIndex) + newText + this._source.slice(edit.oldEndIndex);
-
     // Check if this is a markdown file and if block boundaries might have changed
     const blockBoundariesChanged =
       this.fileType === "markdown" && this.mightAffectBlockBoundaries(edit, newText);
 
-    // Update source and line index
-    const oldSource = this._source;
-    this._source = newSource;
-    this._lineIndex = new LineIndex(newSource);
+    // Splice the text and line index
+    this._lineIndex = this._lineIndex.applyEdit(edit.startIndex, edit.oldEndIndex, newText);
 
     // For markdown files with potential boundary changes, do a full reparse
     if (blockBoundariesChanged) {
-      this._blocks = this.parseBlocks(newSource);
+      this._blocks = this.parseBlocks(this.source);
       return {
         blockBoundariesChanged: true,
         modifiedBlockIndices: this._blocks.map((_, i) => i),
@@ -156,10 +189,10 @@ export class Document<T extends GenericTree = GenericTree> {
     // For thalo files or markdown edits within a single block, use incremental parsing
     if (this.fileType === "thalo") {
       // Single block, always incremental
-      return this.applyIncrementalEdit(edit, oldSource, newSource, newText);
+      return this.applyIncrementalEdit(edit);
     } else {
       // Markdown: find affected block(s)
-      return this.applyMarkdownEdit(edit, oldSource, newSource, newText);
+      return this.applyMarkdownEdit(edit);
     }
   }
 
@@ -176,7 +209,6 @@ export class Document<T extends GenericTree = GenericTree> {
    * Replace the entire document content (for full sync).
    */
   replaceContent(newSource: string): void {
-    this._source = newSource;
     this._lineIndex = new LineIndex(newSource);
     this._blocks = this.parseBlocks(newSource);
   }
@@ -216,29 +248,26 @@ export class Document<T extends GenericTree = GenericTree> {
       ];
     }
 
-    // Extract thalo blocks from markdown
-    const blocks: DocumentBlock<T>[] = [];
-    let match: RegExpExecArray | null;
-
-    while ((match = THALO_FENCE_REGEX.exec(source)) !== null) {
-      const content = match[1];
-      const contentStart = match.index + match[0].indexOf(content);
-      const sourceMap = createSourceMap(source, contentStart, content);
-      const tree = this.parser.parse(content);
-
-      blocks.push({
-        source: content,
-        sourceMap,
-        tree,
-        startOffset: contentStart,
-        endOffset: contentStart + content.length,
-      });
+    // Extract thalo blocks from markdown. Blocks whose content did not change keep their
+    // tree, so re-finding the fences after an edit only parses the blocks that changed.
+    const unchanged = new Map<string, DocumentBlock<T>[]>();
+    for (const block of this._blocks ?? []) {
+      const list = unchanged.get(block.source);
+      if (list) {
+        list.push(block);
+      } else {
+        unchanged.set(block.source, [block]);
+      }
     }
 
-    // Reset regex state
-    THALO_FENCE_REGEX.lastIndex = 0;
-
-    return blocks;
+    const fences = sliceThaloFences(source, this.parser.findFences(source));
+    return fences.map(({ source: content, charOffset, sourceMap }) => ({
+      source: content,
+      sourceMap,
+      tree: unchanged.get(content)?.shift()?.tree ?? this.parser.parse(content),
+      startOffset: charOffset,
+      endOffset: charOffset + content.length,
+    }));
   }
 
   /**
@@ -246,7 +275,7 @@ export class Document<T extends GenericTree = GenericTree> {
    */
   private mightAffectBlockBoundaries(edit: EditRange, newText: string): boolean {
     // Check if the edit region or new text contains fence markers
-    const oldText = this._source.slice(edit.startIndex, edit.oldEndIndex);
+    const oldText = this._lineIndex.text.slice(edit.startIndex, edit.oldEndIndex);
     const hasFenceInOld = oldText.includes("```");
     const hasFenceInNew = newText.includes("```");
 
@@ -274,35 +303,37 @@ export class Document<T extends GenericTree = GenericTree> {
   /**
    * Apply incremental edit to a thalo file (single block).
    */
-  private applyIncrementalEdit(
-    edit: EditRange,
-    _oldSource: string,
-    newSource: string,
-    _newText: string,
-  ): EditResult {
+  private applyIncrementalEdit(edit: EditRange): EditResult {
     const block = this._blocks[0];
 
     // Tell tree-sitter about the edit
-    block.tree.edit({
+    const treeEdit: TreeEdit = {
       startIndex: edit.startIndex,
       oldEndIndex: edit.oldEndIndex,
       newEndIndex: edit.newEndIndex,
       startPosition: edit.startPosition,
       oldEndPosition: edit.oldEndPosition,
       newEndPosition: edit.newEndPosition,
-    });
+    };
+    block.tree.edit(treeEdit);
 
-    // Reparse with the old tree for incremental parsing
-    const newTree = this.parser.parseIncremental(newSource, block.tree);
+    // Reparse with the old tree for incremental parsing, reading the rope directly
+    const text = this._lineIndex.text;
+    const newTree = this.parser.parseIncremental(text, block.tree);
+    const ranges = block.tree.getChangedRanges?.(newTree);
+    updatePositionIndex(block.tree, newTree, treeEdit, ranges);
+    const changedRanges = ranges ?? [];
 
-    // Update the block
+    // Update the block; its source string is only built if it is read
     this._blocks = [
       {
-        source: newSource,
+        get source() {
+          return text.toString();
+        },
         sourceMap: identitySourceMap(),
         tree: newTree,
         startOffset: 0,
-        endOffset: newSource.length,
+        endOffset: text.length,
       },
     ];
 
@@ -310,18 +341,14 @@ export class Document<T extends GenericTree = GenericTree> {
       blockBoundariesChanged: false,
       modifiedBlockIndices: [0],
       fullReparse: false,
+      changedLines: changedLines(edit, changedRanges, 0),
     };
   }
 
   /**
    * Apply edit to a markdown file, updating affected blocks incrementally.
    */
-  private applyMarkdownEdit(
-    edit: EditRange,
-    _oldSource: string,
-    newSource: string,
-    _newText: string,
-  ): EditResult {
+  private applyMarkdownEdit(edit: EditRange): EditResult {
     // Find which block(s) contain the edit
     const affectedBlockIndices: number[] = [];
 
@@ -336,27 +363,30 @@ export class Document<T extends GenericTree = GenericTree> {
     if (affectedBlockIndices.length === 0) {
       // Edit is outside all thalo blocks (in markdown content)
       // Just need to update block offsets
-      this.updateBlockOffsets(edit, newSource);
+      this.updateBlockOffsets(edit);
       return {
         blockBoundariesChanged: false,
         modifiedBlockIndices: [],
         fullReparse: false,
+        changedLines: changedLines(edit, [], 0),
       };
     }
 
     if (affectedBlockIndices.length === 1) {
       // Edit is within a single block - can use incremental parsing
       const blockIndex = affectedBlockIndices[0];
-      this.updateSingleBlockIncremental(blockIndex, edit, newSource);
+      const { lineOffset } = this._blocks[blockIndex].sourceMap;
+      const changedRanges = this.updateSingleBlockIncremental(blockIndex, edit);
       return {
         blockBoundariesChanged: false,
         modifiedBlockIndices: affectedBlockIndices,
         fullReparse: false,
+        changedLines: changedLines(edit, changedRanges, lineOffset),
       };
     }
 
     // Edit spans multiple blocks - do a full reparse
-    this._blocks = this.parseBlocks(newSource);
+    this._blocks = this.parseBlocks(this.source);
     return {
       blockBoundariesChanged: false,
       modifiedBlockIndices: this._blocks.map((_, i) => i),
@@ -364,10 +394,19 @@ export class Document<T extends GenericTree = GenericTree> {
     };
   }
 
+  /**
+   * Get the source map of a block starting at `charOffset` in the current text, from the line
+   * index rather than by scanning the text before it.
+   */
+  private sourceMapAt(charOffset: number, lineCount: number): SourceMap {
+    const { line, column } = this._lineIndex.offsetToPosition(charOffset);
+    return Object.freeze({ charOffset, lineOffset: line, columnOffset: column, lineCount });
+  }
+
   /**
    * Update block offsets after an edit outside all blocks.
    */
-  private updateBlockOffsets(edit: EditRange, newSource: string): void {
+  private updateBlockOffsets(edit: EditRange): void {
     const delta = edit.newEndIndex - edit.oldEndIndex;
 
     this._blocks = this._blocks.map((block) => {
@@ -377,7 +416,7 @@ export class Document<T extends GenericTree = GenericTree> {
           ...block,
           startOffset: block.startOffset + delta,
           endOffset: block.endOffset + delta,
-          sourceMap: createSourceMap(newSource, block.startOffset + delta, block.source),
+          sourceMap: this.sourceMapAt(block.startOffset + delta, block.sourceMap.lineCount),
         };
       }
       return block;
@@ -386,12 +425,10 @@ export class Document<T extends GenericTree = GenericTree> {
 
   /**
    * Update a single block using incremental parsing.
+   *
+   * @returns The block-relative ranges whose structure changed
    */
-  private updateSingleBlockIncremental(
-    blockIndex: number,
-    edit: EditRange,
-    newSource: string,
-  ): void {
+  private updateSingleBlockIncremental(blockIndex: number, edit: EditRange): TreeRange[] {
     const oldBlock = this._blocks[blockIndex];
 
     // Convert edit to block-relative coordinates
@@ -404,7 +441,8 @@ export class Document<T extends GenericTree = GenericTree> {
 
     // Extract the new block content
     // Need to find the new block boundaries in the edited source
-    const newBlockSource = newSource.slice(oldBlock.startOffset, newBlockEndOffset);
+    const text = this._lineIndex.text;
+    const newBlockSource = text.slice(oldBlock.startOffset, newBlockEndOffset);
 
     // Compute block-relative edit
     const blockRelativeNewEndIndex = blockRelativeStartIndex + (edit.newEndIndex - edit.startIndex);
@@ -418,28 +456,33 @@ export class Document<T extends GenericTree = GenericTree> {
       edit.oldEndPosition.row === oldBlock.sourceMap.lineOffset
         ? edit.oldEndPosition.column - oldBlock.sourceMap.columnOffset
         : edit.oldEndPosition.column,
-      newSource.slice(edit.startIndex, edit.newEndIndex),
+      text.slice(edit.startIndex, edit.newEndIndex),
     );
 
     // Tell tree-sitter about the edit
-    oldBlock.tree.edit({
+    const treeEdit: TreeEdit = {
       startIndex: blockRelativeStartIndex,
       oldEndIndex: blockRelativeOldEndIndex,
       newEndIndex: blockRelativeNewEndIndex,
       startPosition: blockRelativeEdit.startPosition,
       oldEndPosition: blockRelativeEdit.oldEndPosition,
       newEndPosition: blockRelativeEdit.newEndPosition,
-    });
+    };
+    oldBlock.tree.edit(treeEdit);
 
     // Reparse with the old tree
     const newTree = this.parser.parseIncremental(newBlockSource, oldBlock.tree);
+    const ranges = oldBlock.tree.getChangedRanges?.(newTree);
+    updatePositionIndex(oldBlock.tree, newTree, treeEdit, ranges);
+    const changedRanges = ranges ?? [];
 
     // Update blocks array
+    const lineCount = newBlockSource.split("\n").length;
     this._blocks = this._blocks.map((block, i) => {
       if (i === blockIndex) {
         return {
           source: newBlockSource,
-          sourceMap: createSourceMap(newSource, oldBlock.startOffset, newBlockSource),
+          sourceMap: this.sourceMapAt(oldBlock.startOffset, lineCount),
           tree: newTree,
           startOffset: oldBlock.startOffset,
           endOffset: newBlockEndOffset,
@@ -450,10 +493,11 @@ export class Document<T extends GenericTree = GenericTree> {
           ...block,
           startOffset: block.startOffset + delta,
           endOffset: block.endOffset + delta,
-          sourceMap: createSourceMap(newSource, block.startOffset + delta, block.source),
+          sourceMap: this.sourceMapAt(block.startOffset + delta, block.sourceMap.lineCount),
         };
       }
       return block;
     });
+    return changedRanges;
   }
 }
@@ -162,6 +162,42 @@ describe("LineIndex", () => {
       expect(offset).toBe(8);
     });
   });
+
+  describe("applyEdit", () => {
+    it("should match an index built from the edited text", () => {
+      let source = "line1\nline2\nline3\n".repeat(200);
+      let index = new LineIndex(source);
+
+      for (const [start, end, text] of [
+        [6, 11, "changed"],
+        [0, 0, "\n\n"],
+        [100, 3000, "x"],
+        [50, 52, "a\nb\nc"],
+      ] as const) {
+        index = index.applyEdit(start, end, text);
+        source = source.slice(0, start) + text + source.slice(end);
+      }
+
+      const expected = new LineIndex(source);
+      expect(index.lineCount).toBe(expected.lineCount);
+      for (let offset = 0; offset <= source.length; offset += 7) {
+        expect(index.offsetToPosition(offset)).toEqual(expected.offsetToPosition(offset));
+      }
+      for (let line = 0; line < expected.lineCount; line++) {
+        expect(index.getLineStart(line)).toBe(expected.getLineStart(line));
+        expect(index.getLineEnd(line)).toBe(expected.getLineEnd(line));
+      }
+    });
+
+    it("should leave the original index unchanged", () => {
+      const index = new LineIndex("hello\nworld");
+      const edited = index.applyEdit(5, 6, " ");
+
+      expect(index.lineCount).toBe(2);
+      expect(edited.lineCount).toBe(1);
+      expect(edited.text.toString()).toBe("hello world");
+    });
+  });
 });
 
 describe("computeEdit", () => {
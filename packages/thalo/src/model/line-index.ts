@@ -1,3 +1,5 @@
+import { Rope } from "./rope.js";
+
 /**
  * A simple position (line and column).
  * Both are 0-based to match tree-sitter's Point type.
@@ -20,35 +22,32 @@ interface Point {
 
 /**
  * LineIndex provides O(log n) offset-to-position and position-to-offset conversions.
- * It maintains an array of line start offsets for efficient lookups.
+ *
+ * It is a view over a `Rope`, whose nodes count the newlines below them, so an index for an
+ * edited text is derived with `applyEdit` in O(log n) instead of rescanning the whole source.
  */
 export class LineIndex {
-  /** Array of character offsets where each line starts */
-  private readonly lineStarts: number[];
-  /** Total length of the source text */
-  private readonly length: number;
+  /** The indexed text */
+  readonly text: Rope;
 
-  constructor(source: string) {
-    this.lineStarts = [0]; // Line 0 starts at offset 0
-    this.length = source.length;
+  constructor(source: string | Rope) {
+    this.text = typeof source === "string" ? Rope.from(source) : source;
+  }
 
-    for (let i = 0; i < source.length; i++) {
-      if (source[i] === "\n") {
-        this.lineStarts.push(i + 1);
-      }
-    }
+  /** Total length of the source text */
+  private get length(): number {
+    return this.text.length;
   }
 
   /**
    * Get the number of lines in the source.
    */
   get lineCount(): number {
-    return this.lineStarts.length;
+    return this.text.lineCount;
   }
 
   /**
    * Convert a character offset to a Position (line, column).
-   * Uses binary search for O(log n) performance.
    *
    * @param offset - 0-based character offset
    * @returns Position with 0-based line and column
@@ -57,21 +56,8 @@ export class LineIndex {
     // Clamp offset to valid range
     const clampedOffset = Math.max(0, Math.min(offset, this.length));
 
-    // Binary search to find the line
-    let low = 0;
-    let high = this.lineStarts.length - 1;
-
-    while (low < high) {
-      const mid = Math.floor((low + high + 1) / 2);
-      if (this.lineStarts[mid] <= clampedOffset) {
-        low = mid;
-      } else {
-        high = mid - 1;
-      }
-    }
-
-    const line = low;
-    const column = clampedOffset - this.lineStarts[line];
+    const line = this.text.lineAt(clampedOffset);
+    const column = clampedOffset - this.text.lineStart(line);
 
     return { line, column };
   }
@@ -86,14 +72,11 @@ export class LineIndex {
     const { line, column } = position;
 
     // Clamp line to valid range
-    const clampedLine = Math.max(0, Math.min(line, this.lineStarts.length - 1));
-    const lineStart = this.lineStarts[clampedLine];
+    const clampedLine = Math.max(0, Math.min(line, this.lineCount - 1));
+    const lineStart = this.text.lineStart(clampedLine);
 
     // Calculate max column for this line
-    const lineEnd =
-      clampedLine < this.lineStarts.length - 1
-        ? this.lineStarts[clampedLine + 1] - 1 // Don't include the newline
-        : this.length;
+    const lineEnd = this.getLineEnd(clampedLine);
     const maxColumn = lineEnd - lineStart;
 
     // Clamp column to valid range
@@ -124,10 +107,7 @@ export class LineIndex {
    * @returns Character offset, or -1 if line is out of range
    */
   getLineStart(line: number): number {
-    if (line < 0 || line >= this.lineStarts.length) {
-      return -1;
-    }
-    return this.lineStarts[line];
+    return this.text.lineStart(line);
   }
 
   /**
@@ -137,14 +117,28 @@ export class LineIndex {
    * @returns Character offset, or -1 if line is out of range
    */
   getLineEnd(line: number): number {
-    if (line < 0 || line >= this.lineStarts.length) {
+    if (line < 0 || line >= this.lineCount) {
       return -1;
     }
-    if (line === this.lineStarts.length - 1) {
+    if (line === this.lineCount - 1) {
       return this.length;
     }
     // Return position before the newline character
-    return this.lineStarts[line + 1] - 1;
+    return this.text.lineStart(line + 1) - 1;
+  }
+
+  /**
+   * Get the index of the text with [startOffset, oldEndOffset) replaced by `newText`.
+   *
+   * Costs O(log n + newText.length); this index is unchanged.
+   *
+   * @param startOffset - Start of the edit range
+   * @param oldEndOffset - End of the old text being replaced
+   * @param newText - The new text being inserted
+   * @returns A new LineIndex for the edited source
+   */
+  applyEdit(startOffset: number, oldEndOffset: number, newText: string): LineIndex {
+    return new LineIndex(this.text.splice(startOffset, oldEndOffset, newText));
   }
 
   /**
@@ -163,8 +157,7 @@ export class LineIndex {
     _newText: string,
     fullNewSource: string,
   ): LineIndex {
-    // For now, just rebuild from scratch
-    // A more sophisticated implementation could incrementally update lineStarts
+    // Without the old index there is nothing to update; see applyEdit
     return new LineIndex(fullNewSource);
   }
 }
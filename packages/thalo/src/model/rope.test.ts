@@ -0,0 +1,92 @@
+import { describe, it, expect } from "vitest";
+import { Rope } from "./rope.js";
+
+/** A long text spanning many chunks, with lines of varying length and some astral characters. */
+function sample(): string {
+  let text = "";
+  for (let i = 0; i < 500; i++) {
+    text += `line ${i} ${"x".repeat(i % 37)}${i % 11 === 0 ? " 🚀" : ""}\n`;
+  }
+  return text;
+}
+
+function readChunks(rope: Rope): string[] {
+  const chunks: string[] = [];
+  for (let index = 0; index < rope.length; ) {
+    const chunk = rope.chunkAt(index);
+    chunks.push(chunk);
+    index += chunk.length;
+  }
+  return chunks;
+}
+
+describe("Rope", () => {
+  it("round-trips text", () => {
+    const text = sample();
+    const rope = Rope.from(text);
+    expect(rope.length).toBe(text.length);
+    expect(rope.toString()).toBe(text);
+    expect(rope.lineCount).toBe(text.split("\n").length);
+    expect(Rope.from("").toString()).toBe("");
+    expect(Rope.from("").lineCount).toBe(1);
+  });
+
+  it("splices like string slicing", () => {
+    let text = sample();
+    let rope = Rope.from(text);
+    for (const [start, end, insert] of [
+      [10, 10, "inserted"],
+      [500, 2500, ""],
+      [0, 3, "\n\n"],
+      [text.length - 500, text.length + 10, "end\n"],
+      [1234, 1240, "🚀".repeat(700)],
+    ] as const) {
+      rope = rope.splice(start, end, insert);
+      text = text.slice(0, start) + insert + text.slice(Math.min(end, text.length));
+      expect(rope.toString()).toBe(text);
+    }
+    expect(rope.slice(1000, 1300)).toBe(text.slice(1000, 1300));
+  });
+
+  it("keeps earlier versions intact", () => {
+    const original = Rope.from(sample());
+    const edited = original.splice(100, 200, "changed");
+    expect(original.toString()).toBe(sample());
+    expect(edited.toString()).not.toBe(sample());
+  });
+
+  it("reads back whole text through chunkAt without splitting surrogate pairs", () => {
+    const rope = Rope.from(sample()).splice(2047, 2047, "🚀🚀");
+    const chunks = readChunks(rope);
+    expect(chunks.length).toBeGreaterThan(1);
+    expect(chunks.join("")).toBe(rope.toString());
+    for (const chunk of chunks) {
+      const last = chunk.charCodeAt(chunk.length - 1);
+      expect(last >= 0xd800 && last <= 0xdbff).toBe(false);
+    }
+    expect(rope.chunkAt(rope.length)).toBe("");
+  });
+
+  it("maps between offsets and lines", () => {
+    let text = sample();
+    let rope = Rope.from(text);
+    for (let i = 0; i < 50; i++) {
+      rope = rope.splice(i * 97, i * 97 + 3, "a\nb");
+      text = text.slice(0, i * 97) + "a\nb" + text.slice(i * 97 + 3);
+    }
+
+    const starts = [0];
+    for (let i = 0; i < text.length; i++) {
+      if (text[i] === "\n") {
+        starts.push(i + 1);
+      }
+    }
+    expect(rope.lineCount).toBe(starts.length);
+    starts.forEach((start, line) => {
+      expect(rope.lineStart(line)).toBe(start);
+      expect(rope.lineAt(start)).toBe(line);
+    });
+    expect(rope.lineStart(starts.length)).toBe(-1);
+    expect(rope.lineAt(text.length)).toBe(starts.length - 1);
+  });
+});
@@ -0,0 +1,350 @@
+/**
+ * Immutable text stored as a balanced tree of chunks.
+ *
+ * Splicing copies only the O(log n) nodes on the paths to the edited chunks, so editing a large
+ * document never rebuilds or rescans the whole text, and every earlier version stays valid (a
+ * tree-sitter tree can keep reading the version it was parsed from). Each node also counts the
+ * newlines below it, so offset/line conversions are O(log n) plus a scan of one chunk.
+ *
+ * The tree is a treap: chunks are in-order, and random priorities keep it balanced in
+ * expectation without rebalancing logic.
+ */
+
+/** Chunks built from new text are at most this many UTF-16 code units. */
+const MAX_CHUNK = 1024;
+/** Chunks smaller than this next to an edit are merged into the inserted text. */
+const MIN_CHUNK = 256;
+
+interface RopeNode {
+  text: string;
+  /** Newlines in `text` */
+  newlines: number;
+  priority: number;
+  left: RopeNode | null;
+  right: RopeNode | null;
+  /** Code units in this subtree */
+  length: number;
+  /** Newlines in this subtree */
+  lines: number;
+}
+
+function countNewlines(text: string): number {
+  let count = 0;
+  for (let i = text.indexOf("\n"); i !== -1; i = text.indexOf("\n", i + 1)) {
+    count++;
+  }
+  return count;
+}
+
+function lengthOf(node: RopeNode | null): number {
+  return node ? node.length : 0;
+}
+
+function linesOf(node: RopeNode | null): number {
+  return node ? node.lines : 0;
+}
+
+function withChildren(node: RopeNode, left: RopeNode | null, right: RopeNode | null): RopeNode {
+  return {
+    text: node.text,
+    newlines: node.newlines,
+    priority: node.priority,
+    left,
+    right,
+    length: lengthOf(left) + node.text.length + lengthOf(right),
+    lines: linesOf(left) + node.newlines + linesOf(right),
+  };
+}
+
+function leaf(text: string): RopeNode {
+  const newlines = countNewlines(text);
+  return {
+    text,
+    newlines,
+    priority: Math.random(),
+    left: null,
+    right: null,
+    length: text.length,
+    lines: newlines,
+  };
+}
+
+/** Concatenate two trees, `a` before `b`. */
+function merge(a: RopeNode | null, b: RopeNode | null): RopeNode | null {
+  if (!a) {
+    return b;
+  }
+  if (!b) {
+    return a;
+  }
+  if (a.priority > b.priority) {
+    return withChildren(a, a.left, merge(a.right, b));
+  }
+  return withChildren(b, merge(a, b.left), b.right);
+}
+
+/** Split a tree into its first `offset` code units and the rest. */
+function split(node: RopeNode | null, offset: number): [RopeNode | null, RopeNode | null] {
+  if (!node) {
+    return [null, null];
+  }
+  const leftLength = lengthOf(node.left);
+  if (offset <= leftLength) {
+    const [a, b] = split(node.left, offset);
+    return [a, withChildren(node, b, node.right)];
+  }
+  const textEnd = leftLength + node.text.length;
+  if (offset >= textEnd) {
+    const [a, b] = split(node.right, offset - textEnd);
+    return [withChildren(node, node.left, a), b];
+  }
+  const cut = offset - leftLength;
+  return [
+    merge(node.left, leaf(node.text.slice(0, cut))),
+    merge(leaf(node.text.slice(cut)), node.right),
+  ];
+}
+
+function firstNode(node: RopeNode | null): RopeNode | null {
+  while (node?.left) {
+    node = node.left;
+  }
+  return node;
+}
+
+function lastNode(node: RopeNode | null): RopeNode | null {
+  while (node?.right) {
+    node = node.right;
+  }
+  return node;
+}
+
+/**
+ * Build a treap over `text` in chunks of at most MAX_CHUNK, in linear time: chunks are pushed
+ * in order onto the right spine, popping every node with a lower priority.
+ */
+function build(text: string): RopeNode | null {
+  const spine: RopeNode[] = [];
+  for (let start = 0; start < text.length; start += MAX_CHUNK) {
+    const node = leaf(text.slice(start, start + MAX_CHUNK));
+    let popped: RopeNode | null = null;
+    while (spine.length > 0 && spine[spine.length - 1].priority < node.priority) {
+      const top = spine.pop()!;
+      top.right = popped;
+      popped = top;
+    }
+    node.left = popped;
+    spine.push(node);
+  }
+
+  let root: RopeNode | null = null;
+  for (let i = spine.length - 1; i >= 0; i--) {
+    spine[i].right = root;
+    root = spine[i];
+  }
+  computeTotals(root);
+  return root;
+}
+
+function computeTotals(node: RopeNode | null): void {
+  if (!node) {
+    return;
+  }
+  computeTotals(node.left);
+  computeTotals(node.right);
+  node.length = lengthOf(node.left) + node.text.length + lengthOf(node.right);
+  node.lines = linesOf(node.left) + node.newlines + linesOf(node.right);
+}
+
+function collect(node: RopeNode | null, start: number, end: number, out: string[]): void {
+  if (!node || start >= end) {
+    return;
+  }
+  const leftLength = lengthOf(node.left);
+  if (start < leftLength) {
+    collect(node.left, start, Math.min(end, leftLength), out);
+  }
+  const textEnd = leftLength + node.text.length;
+  if (start < textEnd && end > leftLength) {
+    const from = Math.max(start - leftLength, 0);
+    const to = Math.min(end - leftLength, node.text.length);
+    out.push(from === 0 && to === node.text.length ? node.text : node.text.slice(from, to));
+  }
+  if (end > textEnd) {
+    collect(node.right, Math.max(start - textEnd, 0), end - textEnd, out);
+  }
+}
+
+function isHighSurrogate(unit: number): boolean {
+  return unit >= 0xd800 && unit <= 0xdbff;
+}
+
+/**
+ * An immutable text. Offsets are UTF-16 code units, like JS string indices.
+ */
+export class Rope {
+  private readonly root: RopeNode | null;
+  private flat: string | undefined;
+
+  private constructor(root: RopeNode | null, flat?: string) {
+    this.root = root;
+    this.flat = flat;
+  }
+
+  /**
+   * Create a rope holding `text`.
+   */
+  static from(text: string): Rope {
+    return new Rope(build(text), text);
+  }
+
+  /** Length in UTF-16 code units */
+  get length(): number {
+    return lengthOf(this.root);
+  }
+
+  /** Number of lines, i.e. newlines + 1 */
+  get lineCount(): number {
+    return linesOf(this.root) + 1;
+  }
+
+  /**
+   * Replace the code units in [start, end) with `text`, returning the new rope.
+   */
+  splice(start: number, end: number, text: string): Rope {
+    const length = this.length;
+    start = Math.max(0, Math.min(start, length));
+    end = Math.max(start, Math.min(end, length));
+
+    let [before, after] = split(this.root, start);
+    after = split(after, end - start)[1];
+
+    // Fold small neighbouring chunks into the inserted text, so repeated small edits at one
+    // place (typing) grow a chunk instead of leaving a trail of tiny ones
+    let middle = text;
+    const last = lastNode(before);
+    if (last && last.text.length < MIN_CHUNK) {
+      before = split(before, lengthOf(before) - last.text.length)[0];
+      middle = last.text + middle;
+    }
+    const first = firstNode(after);
+    if (first && first.text.length < MIN_CHUNK) {
+      after = split(after, first.text.length)[1];
+      middle = middle + first.text;
+    }
+
+    return new Rope(merge(merge(before, build(middle)), after));
+  }
+
+  /**
+   * Get the text in [start, end).
+   */
+  slice(start = 0, end = this.length): string {
+    if (this.flat !== undefined) {
+      return this.flat.slice(start, end);
+    }
+    start = Math.max(0, start);
+    end = Math.min(end, this.length);
+    const out: string[] = [];
+    collect(this.root, start, end, out);
+    return out.length === 1 ? out[0] : out.join("");
+  }
+
+  /**
+   * Get the text from `index` to the end of the chunk containing it, or "" at the end.
+   *
+   * This is the shape of tree-sitter's read callback, so parsers can read the rope without
+   * it ever being flattened. A chunk ending in a high surrogate is extended into the next,
+   * so a read never stops in the middle of a code point.
+   */
+  chunkAt(index: number): string {
+    let node = this.root;
+    let offset = index;
+    while (node) {
+      const leftLength = lengthOf(node.left);
+      if (offset < leftLength) {
+        node = node.left;
+        continue;
+      }
+      offset -= leftLength;
+      if (offset < node.text.length) {
+        const text = offset === 0 ? node.text : node.text.slice(offset);
+        return isHighSurrogate(text.charCodeAt(text.length - 1))
+          ? text + this.chunkAt(index + text.length)
+          : text;
+      }
+      offset -= node.text.length;
+      node = node.right;
+    }
+    return "";
+  }
+
+  /**
+   * Count the newlines before `offset`: the 0-based line that `offset` is on.
+   */
+  lineAt(offset: number): number {
+    let node = this.root;
+    let line = 0;
+    while (node) {
+      const leftLength = lengthOf(node.left);
+      if (offset < leftLength) {
+        node = node.left;
+        continue;
+      }
+      line += linesOf(node.left);
+      offset -= leftLength;
+      if (offset < node.text.length) {
+        return line + countNewlines(node.text.slice(0, offset));
+      }
+      line += node.newlines;
+      offset -= node.text.length;
+      node = node.right;
+    }
+    return line;
+  }
+
+  /**
+   * Get the offset at which a 0-based line starts, or -1 if there is no such line.
+   */
+  lineStart(line: number): number {
+    if (line < 0 || line >= this.lineCount) {
+      return -1;
+    }
+    // Line n starts right after the n-th newline
+    let node = this.root;
+    let remaining = line;
+    let offset = 0;
+    while (node && remaining > 0) {
+      const leftLines = linesOf(node.left);
+      if (remaining <= leftLines) {
+        node = node.left;
+        continue;
+      }
+      remaining -= leftLines;
+      offset += lengthOf(node.left);
+      if (remaining <= node.newlines) {
+        let index = -1;
+        for (; remaining > 0; remaining--) {
+          index = node.text.indexOf("\n", index + 1);
+        }
+        return offset + index + 1;
+      }
+      remaining -= node.newlines;
+      offset += node.text.length;
+      node = node.right;
+    }
+    return offset;
+  }
+
+  /**
+   * Get the whole text. The string is built once per rope and cached.
+   */
+  toString(): string {
+    if (this.flat === undefined) {
+      const out: string[] = [];
+      collect(this.root, 0, this.length, out);
+      this.flat = out.join("");
+    }
+    return this.flat;
+  }
+}
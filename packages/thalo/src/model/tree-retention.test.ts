@@ -0,0 +1,144 @@
+import { describe, it, expect } from "vitest";
+import type { InstanceEntry } from "../ast/ast-types.js";
+import { findNodeAtPosition } from "../ast/node-at-position.js";
+import { createParser } from "../parser.native.js";
+import { Workspace } from "./workspace.js";
+import { LazySyntaxNode } from "./tree-retention.js";
+
+const source = `2026-01-05T10:00Z define-entity lore "Lore"
+  # Metadata
+  subject: link
+
+2026-01-05T11:00Z create lore "First entry" ^first #notes
+  subject: ^self
+
+2026-01-05T12:00Z create lore "Second entry" ^second
+  subject: ^first
+`;
+
+/** A parser that counts its full parses */
+function countingParser() {
+  const parser = createParser();
+  const counter = {
+    parses: 0,
+    parser: {
+      ...parser,
+      parse(text: string) {
+        counter.parses++;
+        return parser.parse(text);
+      },
+    },
+  };
+  return counter;
+}
+
+describe("tree retention", () => {
+  it("keeps the same model as a workspace that keeps its trees", () => {
+    const kept = new Workspace(createParser());
+    const released = new Workspace(createParser(), { treeRetention: "release" });
+    kept.addDocument(source, { filename: "test.thalo" });
+    released.addDocument(source, { filename: "test.thalo" });
+
+    const keptModel = kept.getModel("test.thalo")!;
+    const releasedModel = released.getModel("test.thalo")!;
+    expect(releasedModel.ast.entries.map((e) => e.location)).toEqual(
+      keptModel.ast.entries.map((e) => e.location),
+    );
+    expect([...releasedModel.linkIndex.definitions.keys()]).toEqual([
+      ...keptModel.linkIndex.definitions.keys(),
+    ]);
+  });
+
+  it("replaces syntax nodes with handles that only re-parse when needed", () => {
+    const counter = countingParser();
+    const { parser } = counter;
+    const workspace = new Workspace(parser, { treeRetention: "release" });
+    workspace.addDocument(source, { filename: "test.thalo" });
+    const parsesAfterLoad = counter.parses;
+
+    const entry = workspace.getModel("test.thalo")!.ast.entries[1] as InstanceEntry;
+    expect(entry.syntaxNode).toBeInstanceOf(LazySyntaxNode);
+    expect(entry.syntaxNode.type).toBe("data_entry");
+    expect(entry.header.title.syntaxNode.text).toBe('"First entry"');
+    expect(counter.parses).toBe(parsesAfterLoad);
+
+    expect(entry.header.title.syntaxNode.startPosition).toEqual({ row: 4, column: 30 });
+    expect(entry.header.title.syntaxNode.parent?.type).toBe("data_entry");
+    expect(counter.parses).toBe(parsesAfterLoad + 1);
+  });
+
+  it("re-parses blocks for position lookups", () => {
+    const workspace = new Workspace(createParser(), { treeRetention: "release" });
+    workspace.addDocument(source, { filename: "test.thalo" });
+    const model = workspace.getModel("test.thalo")!;
+
+    const context = findNodeAtPosition({ blocks: model.blocks }, { line: 7, column: 13 });
+    expect(context).toMatchObject({ kind: "link", linkId: "first" });
+  });
+
+  it("releases the least recently restored trees past the limit", () => {
+    const counter = countingParser();
+    const { parser } = counter;
+    const workspace = new Workspace(parser, { treeRetention: "release", restoredTreeLimit: 1 });
+    workspace.addDocument(source, { filename: "a.thalo" });
+    workspace.addDocument(source, { filename: "b.thalo" });
+    const tree = (file: string) => workspace.getModel(file)!.blocks[0].tree;
+
+    const start = counter.parses;
+    tree("a.thalo");
+    tree("a.thalo");
+    expect(counter.parses).toBe(start + 1);
+
+    // Restoring b releases a again
+    tree("b.thalo");
+    tree("a.thalo");
+    expect(counter.parses).toBe(start + 3);
+
+    workspace.releaseRestoredTrees();
+    tree("a.thalo");
+    expect(counter.parses).toBe(start + 4);
+  });
+
+  it("leaves nodes taken from a released tree usable", () => {
+    const parser = createParser();
+    let parses = 0;
+    let deletes = 0;
+    const deleting = {
+      ...parser,
+      parse(text: string) {
+        parses++;
+        // Stand in for a web tree, which has to be deleted explicitly
+        return Object.assign(parser.parse(text), { delete: () => deletes++ });
+      },
+    };
+    const workspace = new Workspace(deleting, { treeRetention: "release" });
+    workspace.addDocument(source, { filename: "test.thalo" });
+
+    const entry = workspace.getModel("test.thalo")!.ast.entries[1] as InstanceEntry;
+    const parent = entry.header.title.syntaxNode.parent!;
+    const deletesAfterLoad = deletes;
+    const parsesAfterLoad = parses;
+    workspace.releaseRestoredTrees();
+
+    expect(deletes).toBe(deletesAfterLoad);
+    expect(parent.type).toBe("data_entry");
+    expect(parent.childForFieldName("title")?.text).toBe('"First entry"');
+
+    // The handle resolves its node in a fresh tree
+    expect(entry.header.title.syntaxNode.parent?.type).toBe("data_entry");
+    expect(parses).toBe(parsesAfterLoad + 1);
+  });
+
+  it("keeps the trees of documents edited incrementally", () => {
+    const counter = countingParser();
+    const { parser } = counter;
+    const workspace = new Workspace(parser, { treeRetention: "release" });
+    workspace.updateDocument("test.thalo", source);
+
+    const entry = workspace.getModel("test.thalo")!.ast.entries[1];
+    expect(entry.syntaxNode).not.toBeInstanceOf(LazySyntaxNode);
+    const parses = counter.parses;
+    expect(workspace.getModel("test.thalo")!.blocks[0].tree.rootNode.type).toBe("source_file");
+    expect(counter.parses).toBe(parses);
+  });
+});
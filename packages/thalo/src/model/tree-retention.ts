@@ -0,0 +1,252 @@
+/**
+ * Dropping syntax trees once a document's AST and semantic model are built.
+ *
+ * A workspace normally keeps every block's tree, because each AST node's `syntaxNode` points
+ * into it. With `treeRetention: "release"` the workspace swaps the trees for `ReleasedTree`s:
+ * each holds only the block source and re-parses it the first time a tree is needed again.
+ * `syntaxNode` becomes a `LazySyntaxNode` handle. It answers `type`, `startIndex`, `endIndex`
+ * and `text` from what it recorded, and resolves the real node, re-parsing, for anything else.
+ */
+import type { Point, SyntaxNode } from "../ast/ast-types.js";
+import type { GenericTree, ParsedBlock, ThaloParser } from "../parser.shared.js";
+import type { SemanticModel } from "../semantic/analyzer.js";
+
+/**
+ * Whether a workspace keeps the syntax trees of documents added with `addDocument`:
+ *
+ * - `"keep"` (default): every tree stays alive, as it was parsed
+ * - `"release"`: trees are dropped once the document is analyzed, and re-parsed on demand
+ */
+export type TreeRetention = "keep" | "release";
+
+/**
+ * The tree of one released block, re-parsed from its source when it is needed.
+ */
+export class ReleasedTree {
+  readonly source: string;
+  private parser: ThaloParser<GenericTree>;
+  private onRestore: (tree: ReleasedTree) => void;
+  private tree: GenericTree | null = null;
+  /** The nodes handles resolved in the current tree, dropped with it */
+  private nodes = new Map<LazySyntaxNode, SyntaxNode>();
+
+  constructor(
+    source: string,
+    parser: ThaloParser<GenericTree>,
+    onRestore: (tree: ReleasedTree) => void,
+  ) {
+    this.source = source;
+    this.parser = parser;
+    this.onRestore = onRestore;
+  }
+
+  /** Whether the tree is currently parsed. */
+  get isRestored(): boolean {
+    return this.tree !== null;
+  }
+
+  /** Get the tree, re-parsing the source if it was released. */
+  get(): GenericTree {
+    if (!this.tree) {
+      this.tree = this.parser.parse(this.source);
+      this.onRestore(this);
+    }
+    return this.tree;
+  }
+
+  /** Get a handle's node in the current tree, re-parsing the source if it was released. */
+  resolve(handle: LazySyntaxNode): SyntaxNode {
+    let node = this.nodes.get(handle);
+    if (!node) {
+      const { type, startIndex, endIndex } = handle;
+      const found = findNode(this.get().rootNode, type, startIndex, endIndex);
+      if (!found) {
+        throw new Error(`Could not find ${type} at ${startIndex}-${endIndex} after re-parsing`);
+      }
+      node = found;
+      this.nodes.set(handle, node);
+    }
+    return node;
+  }
+
+  /**
+   * Drop the tree and the nodes resolved from it. The tree is not deleted, even a web tree:
+   * nodes handed out by `LazySyntaxNode` may still be in use, so it is left to the garbage
+   * collector once they are gone.
+   */
+  release(): void {
+    this.tree = null;
+    this.nodes.clear();
+  }
+}
+
+/**
+ * A `syntaxNode` whose tree was released. It is found again in the re-parsed tree by its type
+ * and range.
+ */
+export class LazySyntaxNode implements SyntaxNode {
+  readonly type: string;
+  readonly startIndex: number;
+  readonly endIndex: number;
+  private tree: ReleasedTree;
+
+  constructor(tree: ReleasedTree, type: string, startIndex: number, endIndex: number) {
+    this.tree = tree;
+    this.type = type;
+    this.startIndex = startIndex;
+    this.endIndex = endIndex;
+  }
+
+  /** The node in the current tree, re-parsing the block if needed. */
+  resolve(): SyntaxNode {
+    return this.tree.resolve(this);
+  }
+
+  get text(): string {
+    return this.tree.source.slice(this.startIndex, this.endIndex);
+  }
+
+  get id(): number {
+    return this.resolve().id;
+  }
+  get startPosition(): Point {
+    return this.resolve().startPosition;
+  }
+  get endPosition(): Point {
+    return this.resolve().endPosition;
+  }
+  get namedChildren(): readonly (SyntaxNode | null)[] {
+    return this.resolve().namedChildren;
+  }
+  get children(): readonly (SyntaxNode | null)[] {
+    return this.resolve().children;
+  }
+  get parent(): SyntaxNode | null {
+    return this.resolve().parent;
+  }
+  get hasError(): boolean {
+    return this.resolve().hasError;
+  }
+  childForFieldName(fieldName: string): SyntaxNode | null {
+    return this.resolve().childForFieldName(fieldName);
+  }
+  childrenForFieldName(fieldName: string): (SyntaxNode | null)[] {
+    return this.resolve().childrenForFieldName(fieldName);
+  }
+  descendantForPosition(start: Point, end?: Point): SyntaxNode | null {
+    return this.resolve().descendantForPosition(start, end);
+  }
+  descendantsOfType(
+    type: string | string[],
+    startPosition?: Point,
+    endPosition?: Point,
+  ): (SyntaxNode | null)[] {
+    return this.resolve().descendantsOfType(type, startPosition, endPosition);
+  }
+}
+
+/**
+ * Find the node of `type` spanning exactly [start, end): descend through the children that
+ * contain the range, then fall back to a scan for zero-width nodes on a child boundary.
+ */
+function findNode(root: SyntaxNode, type: string, start: number, end: number): SyntaxNode | null {
+  let node: SyntaxNode | null = root;
+  while (node) {
+    if (node.type === type && node.startIndex === start && node.endIndex === end) {
+      return node;
+    }
+    let next: SyntaxNode | null = null;
+    for (const child of node.children) {
+      if (child && child.startIndex <= start && end <= child.endIndex) {
+        next = child;
+        break;
+      }
+    }
+    node = next;
+  }
+  return (
+    root
+      .descendantsOfType(type)
+      .find((n): n is SyntaxNode => n !== null && n.startIndex === start && n.endIndex === end) ??
+    null
+  );
+}
+
+function deleteTree(tree: GenericTree): void {
+  // web-tree-sitter trees live in WASM memory; native and encoded trees are garbage collected
+  (tree as { delete?: () => void }).delete?.();
+}
+
+/**
+ * Replace every `syntaxNode` under `value` with a handle into `tree`. Handles are shared by AST
+ * nodes that pointed at the same syntax node.
+ */
+function replaceSyntaxNodes(
+  value: unknown,
+  tree: ReleasedTree,
+  handles: Map<SyntaxNode, LazySyntaxNode>,
+): void {
+  if (Array.isArray(value)) {
+    for (const item of value) {
+      replaceSyntaxNodes(item, tree, handles);
+    }
+    return;
+  }
+  if (value === null || typeof value !== "object") {
+    return;
+  }
+
+  const record = value as Record<string, unknown>;
+  for (const key of Object.keys(record)) {
+    const child = record[key];
+    if (key === "syntaxNode") {
+      // Empty documents have no syntax node
+      if (child && !(child instanceof LazySyntaxNode)) {
+        const node = child as SyntaxNode;
+        let handle = handles.get(node);
+        if (!handle) {
+          handle = new LazySyntaxNode(tree, node.type, node.startIndex, node.endIndex);
+          handles.set(node, handle);
+        }
+        record[key] = handle;
+      }
+    } else if (key !== "location") {
+      replaceSyntaxNodes(child, tree, handles);
+    }
+  }
+}
+
+/**
+ * Release the trees of a freshly analyzed model: its blocks get trees that re-parse on demand,
+ * and its AST's syntax nodes become `LazySyntaxNode`s.
+ *
+ * @param onRestore - Called whenever one of the trees is re-parsed
+ * @returns The released trees, one per block
+ */
+export function releaseModelTrees(
+  model: SemanticModel,
+  parser: ThaloParser<GenericTree>,
+  onRestore: (tree: ReleasedTree) => void,
+): ReleasedTree[] {
+  const released = model.blocks.map((block) => new ReleasedTree(block.source, parser, onRestore));
+
+  // The AST is extracted from the first block only. Its nodes are read before any tree is
+  // deleted; nothing else holds nodes of these trees yet.
+  if (released.length > 0) {
+    replaceSyntaxNodes(model.ast, released[0], new Map());
+  }
+  for (const block of model.blocks) {
+    deleteTree(block.tree);
+  }
+
+  model.blocks = model.blocks.map(
+    (block, i): ParsedBlock<GenericTree> => ({
+      source: block.source,
+      sourceMap: block.sourceMap,
+      get tree() {
+        return released[i].get();
+      },
+    }),
+  );
+  return released;
+}
@@ -212,4 +212,37 @@ describe("Workspace", () => {
     expect(ws.linkIndex.definitions.has("first")).toBe(false);
     expect(ws.linkIndex.definitions.has("second")).toBe(true);
   });
+
+  it("should accept UTF-8 bytes with the same result as a string", () => {
+    const source = `# Notes — café ☕
+
+\`\`\`thalo
+2026-01-05T10:00Z create lore "Naïve 🚀 entry" ^naive
+  subject: ^self
+\`\`\`
+`;
+    const fromString = createWorkspace({ bulkExtraction: true });
+    const fromBytes = createWorkspace({ bulkExtraction: true });
+    fromString.addDocument(source, { filename: "notes.md" });
+    fromBytes.addDocument(new TextEncoder().encode(source), { filename: "notes.md" });
+
+    const expected = fromString.getModel("notes.md")!;
+    const actual = fromBytes.getModel("notes.md")!;
+    expect(actual.source).toBe(source);
+    expect(actual.ast.entries).toHaveLength(1);
+    expect(actual.ast.entries[0].location).toEqual(expected.ast.entries[0].location);
+    expect(actual.linkIndex.definitions.has("naive")).toBe(true);
+  });
+
+  it("should decode invalid UTF-8 bytes leniently", () => {
+    const ws = createWorkspace({ bulkExtraction: true });
+    const bytes = new Uint8Array([
+      ...new TextEncoder().encode('2026-01-05T10:00Z create lore "Broken '),
+      0xff,
+      ...new TextEncoder().encode('"\n'),
+    ]);
+    ws.addDocument(bytes, { filename: "broken.thalo" });
+
+    expect(ws.getModel("broken.thalo")!.source).toContain("\ufffd");
+  });
 });
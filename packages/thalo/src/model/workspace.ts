@@ -127,15 +127,42 @@ import type {
   LinkDefinition,
   LinkReference,
 } from "../semantic/analyzer.js";
-import type { ThaloParser, GenericTree, FileType } from "../parser.shared.js";
+import { decodeUtf8, type ThaloParser, type GenericTree, type FileType } from "../parser.shared.js";
 import { extractSourceFile } from "../ast/extract.js";
 import { analyze, updateSemanticModel } from "../semantic/analyzer.js";
 import { SchemaRegistry } from "../schema/registry.js";
 import { identitySourceMap } from "../source-map.js";
-import { Document, type EditResult } from "./document.js";
+import { Document, type ChangedLines, type EditResult } from "./document.js";
 import { LineIndex, computeEdit } from "./line-index.js";
+import { releaseModelTrees, type ReleasedTree, type TreeRetention } from "./tree-retention.js";
+import {
+  KIND_INSTANCE,
+  buildHeaderStore,
+  releaseHeaderStore,
+} from "../semantic/header-store.js";
+import { NO_SYMBOL, SymbolTable } from "../semantic/symbols.js";
 import { formatTimestamp } from "../formatters.js";
 
+/**
+ * Options for creating a workspace
+ */
+export interface WorkspaceOptions {
+  /**
+   * Whether to keep the syntax trees of documents added with `addDocument` (default `"keep"`).
+   * With `"release"`, trees are dropped once a document is analyzed and re-parsed when
+   * something needs them, e.g. a hover. This saves memory in batch runs such as `thalo check`.
+   * Documents edited through `applyEdit` or `updateDocument` always keep their trees.
+   */
+  treeRetention?: TreeRetention;
+  /**
+   * With `treeRetention: "release"`, how many re-parsed trees to keep before releasing the
+   * least recently restored one again (default 8).
+   */
+  restoredTreeLimit?: number;
+}
+
+const DEFAULT_RESTORED_TREE_LIMIT = 8;
+
 /**
  * Options for adding a document to the workspace
  */
@@ -161,6 +188,8 @@ export interface InvalidationResult {
   changedEntityNames: string[];
   /** Link IDs that were added or removed */
   changedLinkIds: string[];
+  /** For an incremental edit, the lines of the file whose syntax may have changed */
+  changedLines?: ChangedLines;
 }
 
 /**
@@ -193,6 +222,7 @@ export class Workspace {
   private models = new Map<string, SemanticModel>();
   private documents = new Map<string, Document<GenericTree>>();
   private _schemaRegistry = new SchemaRegistry();
+  private _symbols = new SymbolTable();
   private _linkIndex: LinkIndex = {
     definitions: new Map(),
     references: new Map(),
@@ -204,14 +234,23 @@ export class Workspace {
   // entityName -> Set of files that use this entity (as instances)
   private entityDependencies = new Map<string, Set<string>>();
 
+  private treeRetention: TreeRetention;
+  private restoredTreeLimit: number;
+  // file -> its released trees, and those that have been re-parsed, least recently restored first
+  private releasedTrees = new Map<string, ReleasedTree[]>();
+  private restoredTrees = new Set<ReleasedTree>();
+
   /**
    * Create a new Workspace.
    *
    * @param parser - A ThaloParser instance. For Node.js, use createParser() from "@rejot-dev/thalo".
    *                 For browser, use createParser() from "@rejot-dev/thalo/web".
    */
-  constructor(parser: ThaloParser<GenericTree>) {
+  constructor(parser: ThaloParser<GenericTree>, options: WorkspaceOptions = {}) {
     this.parser = parser;
+    this.treeRetention = options.treeRetention ?? "keep";
+    // The tree being restored counts too, so at least one must fit
+    this.restoredTreeLimit = Math.max(1, options.restoredTreeLimit ?? DEFAULT_RESTORED_TREE_LIMIT);
   }
 
   /**
@@ -221,6 +260,13 @@ export class Workspace {
     return this._schemaRegistry;
   }
 
+  /**
+   * Get the table the names of every document's entries are interned in.
+   */
+  get symbols(): SymbolTable {
+    return this._symbols;
+  }
+
   /**
    * Get the combined link index for all documents.
    */
@@ -230,15 +276,22 @@ export class Workspace {
 
   /**
    * Add a document to the workspace.
+   *
+   * The source may be given as UTF-8 bytes (e.g. a Buffer from `fs.readFile`). Parsers that
+   * support it then read those bytes directly instead of re-encoding the decoded string.
    */
-  addDocument(source: string, options: AddDocumentOptions): SemanticModel {
+  addDocument(source: string | Uint8Array, options: AddDocumentOptions): SemanticModel {
     const { filename, fileType } = options;
+    let utf8: Uint8Array | undefined;
+    if (typeof source !== "string") {
+      ({ source, utf8 } = decodeUtf8(source));
+    }
 
     // Remove existing document if present
     this.removeDocument(filename);
 
     // Parse and create SemanticModel
-    const parsed = this.parser.parseDocument(source, { fileType, filename });
+    const parsed = this.parser.parseDocument(source, { fileType, filename, utf8 });
     if (parsed.blocks.length === 0) {
       // Empty document - create minimal model
       const emptyLocation = {
@@ -262,6 +315,7 @@ export class Workspace {
         sourceMap: identitySourceMap(),
         blocks: [],
         linkIndex: { definitions: new Map(), references: new Map() },
+        headers: buildHeaderStore([], this._symbols),
         schemaEntries: [],
       };
       this.models.set(filename, model);
@@ -277,7 +331,12 @@ export class Workspace {
       source,
       sourceMap: block.sourceMap,
       blocks: parsed.blocks,
+      symbols: this._symbols,
     });
+    if (this.treeRetention === "release") {
+      const onRestore = (tree: ReleasedTree): void => this.trackRestoredTree(tree);
+      this.releasedTrees.set(filename, releaseModelTrees(model, this.parser, onRestore));
+    }
     this.models.set(filename, model);
 
     // Update schema registry with converted schema entries
@@ -298,11 +357,14 @@ export class Workspace {
    * Remove a document from the workspace
    */
   removeDocument(file: string): void {
-    if (!this.models.has(file)) {
+    const model = this.models.get(file);
+    if (!model) {
       return;
     }
 
+    releaseHeaderStore(model.headers);
     this.models.delete(file);
+    this.dropReleasedTrees(file);
 
     // Rebuild schema registry and link index
     this.rebuild();
@@ -443,7 +505,9 @@ export class Workspace {
     const editResult = doc.applyEdit(startLine, startColumn, endLine, endColumn, newText);
 
     // Update the semantic model
-    return this.updateModelFromDocument(filename, doc, editResult);
+    const invalidation = this.updateModelFromDocument(filename, doc, editResult);
+    invalidation.changedLines = editResult.changedLines;
+    return invalidation;
   }
 
   /**
@@ -462,6 +526,8 @@ export class Workspace {
     } else {
       doc = new Document(this.parser, filename, newSource);
       this.documents.set(filename, doc);
+      // From now on the document keeps its trees for incremental edits
+      this.dropReleasedTrees(filename);
     }
 
     // Update the semantic model
@@ -508,13 +574,53 @@ export class Workspace {
     return Array.from(affected);
   }
 
+  /**
+   * Release every re-parsed tree of a released document again, e.g. when the editor goes idle.
+   * Does nothing unless the workspace was created with `treeRetention: "release"`.
+   */
+  releaseRestoredTrees(): void {
+    for (const tree of this.restoredTrees) {
+      tree.release();
+    }
+    this.restoredTrees.clear();
+  }
+
+  /**
+   * Forget the released trees of a file that was removed or is now edited as a Document.
+   */
+  private dropReleasedTrees(file: string): void {
+    for (const tree of this.releasedTrees.get(file) ?? []) {
+      tree.release();
+      this.restoredTrees.delete(tree);
+    }
+    this.releasedTrees.delete(file);
+  }
+
+  /**
+   * Record a re-parsed tree, releasing the least recently restored ones past the limit.
+   */
+  private trackRestoredTree(tree: ReleasedTree): void {
+    this.restoredTrees.delete(tree);
+    this.restoredTrees.add(tree);
+    for (const oldest of this.restoredTrees) {
+      if (this.restoredTrees.size <= this.restoredTreeLimit) {
+        break;
+      }
+      oldest.release();
+      this.restoredTrees.delete(oldest);
+    }
+  }
+
   /**
    * Clear all documents
    */
   clear(): void {
     this.models.clear();
     this.documents.clear();
+    this.releasedTrees.clear();
+    this.restoredTrees.clear();
     this._schemaRegistry.clear();
+    this._symbols = new SymbolTable();
     this._linkIndex = {
       definitions: new Map(),
       references: new Map(),
@@ -581,10 +687,11 @@ export class Workspace {
    * Update entity dependencies for a model
    */
   private updateEntityDependencies(model: SemanticModel): void {
-    // Track which entities this file uses
-    for (const entry of model.ast.entries) {
-      if (entry.type === "instance_entry") {
-        const entityName = entry.header.entity;
+    // Track which entities this file uses, from the header columns
+    const { headers } = model;
+    for (let row = 0; row < headers.length; row++) {
+      if (headers.kinds[row] === KIND_INSTANCE && headers.entities[row] !== NO_SYMBOL) {
+        const entityName = headers.symbols.name(headers.entities[row]);
         let deps = this.entityDependencies.get(entityName);
         if (!deps) {
           deps = new Set();
@@ -665,8 +772,12 @@ export class Workspace {
         sourceMap: identitySourceMap(),
         blocks: [],
         linkIndex: { definitions: new Map(), references: new Map() },
+        headers: buildHeaderStore([], this._symbols),
         schemaEntries: [],
       };
+      if (oldModel) {
+        releaseHeaderStore(oldModel.headers);
+      }
       this.models.set(filename, model);
       this.rebuild();
 
@@ -717,6 +828,7 @@ export class Workspace {
         source: doc.source,
         sourceMap: newSourceMap,
         blocks: newBlocks,
+        symbols: this._symbols,
       });
 
       // Track what changed compared to old model
@@ -765,6 +877,9 @@ export class Workspace {
         result.schemasChanged = result.changedEntityNames.length > 0;
       }
 
+      if (oldModel) {
+        releaseHeaderStore(oldModel.headers);
+      }
       this.models.set(filename, model);
       this.rebuild();
     }
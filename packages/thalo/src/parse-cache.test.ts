@@ -0,0 +1,87 @@
+import { describe, it, expect, vi } from "vitest";
+import { mkdtempSync, readdirSync, writeFileSync } from "node:fs";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { ParseCache, deserializeTree, serializeTree } from "./parse-cache.js";
+import type { EncodedSyntaxTree } from "./ast/encoded-tree.js";
+import { createWorkspace, hasNativeExtraction } from "./parser.native.js";
+
+const tree: EncodedSyntaxTree = {
+  nodeCount: 3,
+  types: new Uint16Array([1, 2, 0xffff]),
+  flags: new Uint8Array([1, 3, 8]),
+  ranges: new Uint32Array([0, 20, 0, 0, 1, 0, 0, 10, 0, 0, 0, 10, 10, 20, 0, 10, 1, 0]),
+  fields: new Uint16Array([0, 4, 0]),
+  parents: new Int32Array([-1, 0, 0]),
+  subtreeEnds: new Uint32Array([3, 2, 3]),
+  timeNodes: new Uint32Array([1]),
+  times: new Float64Array([29453760, 29453761]),
+};
+
+const source = new TextEncoder().encode('2026-01-01T00:00Z create lore "Cached"\n');
+
+function tempDir(): string {
+  return mkdtempSync(join(tmpdir(), "thalo-cache-"));
+}
+
+describe("serializeTree", () => {
+  it("round-trips every array", () => {
+    const decoded = deserializeTree(serializeTree(tree));
+    expect(decoded).toEqual(tree);
+  });
+
+  it("rejects truncated or foreign data", () => {
+    const bytes = serializeTree(tree);
+    expect(deserializeTree(bytes.subarray(0, bytes.length - 1))).toBeUndefined();
+    expect(deserializeTree(new Uint8Array(bytes.length))).toBeUndefined();
+  });
+});
+
+describe("ParseCache", () => {
+  it("returns stored trees by content", () => {
+    const cache = new ParseCache(tempDir(), "grammar");
+
+    expect(cache.get(source)).toBeUndefined();
+    cache.set(source, tree);
+    expect(cache.get(source)).toEqual(tree);
+    expect(cache.get(new TextEncoder().encode("other"))).toBeUndefined();
+  });
+
+  it("does not share entries between grammars", () => {
+    const dir = tempDir();
+    new ParseCache(dir, "grammar-1").set(source, tree);
+
+    expect(new ParseCache(dir, "grammar-2").get(source)).toBeUndefined();
+  });
+
+  it("treats corrupt entries as misses", () => {
+    const dir = tempDir();
+    const cache = new ParseCache(dir, "grammar");
+    cache.set(source, tree);
+    for (const file of readdirSync(dir)) {
+      writeFileSync(join(dir, file), "garbage");
+    }
+
+    expect(cache.get(source)).toBeUndefined();
+  });
+});
+
+describe.skipIf(!hasNativeExtraction())("createWorkspace with cacheDir", () => {
+  it("builds the same model from cached trees without parsing", async () => {
+    const dir = tempDir();
+    const text = new TextDecoder().decode(source);
+
+    const cold = createWorkspace({ cacheDir: dir }).addDocument(text, { filename: "a.thalo" });
+    expect(readdirSync(dir)).toHaveLength(1);
+
+    const { default: thalo } = await import("@rejot-dev/tree-sitter-thalo");
+    const extract = vi.spyOn(thalo, "extractEntriesFromBuffer");
+    const warm = createWorkspace({ cacheDir: dir }).addDocument(text, { filename: "a.thalo" });
+
+    expect(extract).not.toHaveBeenCalled();
+    expect(warm.ast.entries.map((entry) => entry.syntaxNode.text)).toEqual(
+      cold.ast.entries.map((entry) => entry.syntaxNode.text),
+    );
+    extract.mockRestore();
+  });
+});
@@ -0,0 +1,174 @@
+/**
+ * Node.js-only on-disk cache of encoded syntax trees.
+ *
+ * Each entry stores the `EncodedSyntaxTree` for one parsed source (a `.thalo` file or a
+ * markdown block), keyed by a hash of the source bytes and the grammar that parsed them. The
+ * arrays are laid out back to back in a single file, so a cached tree is read with one
+ * `readFileSync` and viewed in place without decoding.
+ *
+ * Only syntax trees are cached: ASTs and semantic indexes hold references to syntax nodes and
+ * entries, and are rebuilt from the cached tree in a single linear pass.
+ */
+
+import { createHash } from "node:crypto";
+import { mkdirSync, readFileSync, renameSync, writeFileSync } from "node:fs";
+import { join } from "node:path";
+import type { EncodedSyntaxTree } from "./ast/encoded-tree.js";
+
+/** Bump whenever the file layout or the meaning of the encoded arrays changes. */
+const CACHE_FORMAT_VERSION = 2;
+
+/** "THLC" */
+const MAGIC = 0x434c4854;
+
+/** magic, format version, node count, decoded time count */
+const HEADER_SIZE = 16;
+
+/** Bytes per node: ranges (6 × u32), parents, subtreeEnds (u32), types, fields (u16), flags */
+const BYTES_PER_NODE = 6 * 4 + 4 + 4 + 2 + 2 + 1;
+
+/** Bytes per decoded time: start and end (f64), node index (u32) */
+const BYTES_PER_TIME = 2 * 8 + 4;
+
+/**
+ * Serialize an encoded tree into the cache file layout.
+ *
+ * Arrays are written widest element first, so every view is aligned when the file is read
+ * back into a buffer starting at offset 0.
+ */
+export function serializeTree(tree: EncodedSyntaxTree): Uint8Array {
+  const n = tree.nodeCount;
+  const timeNodes = tree.timeNodes ?? new Uint32Array(0);
+  const times = tree.times ?? new Float64Array(0);
+  const size = HEADER_SIZE + n * BYTES_PER_NODE + timeNodes.length * BYTES_PER_TIME;
+  const bytes = new Uint8Array(size);
+  const header = new Uint32Array(bytes.buffer, 0, 4);
+  header[0] = MAGIC;
+  header[1] = CACHE_FORMAT_VERSION;
+  header[2] = n;
+  header[3] = timeNodes.length;
+
+  let offset = HEADER_SIZE;
+  for (const array of [
+    times,
+    tree.ranges,
+    tree.parents,
+    tree.subtreeEnds,
+    timeNodes,
+    tree.types,
+    tree.fields,
+    tree.flags,
+  ]) {
+    bytes.set(new Uint8Array(array.buffer, array.byteOffset, array.byteLength), offset);
+    offset += array.byteLength;
+  }
+  return bytes;
+}
+
+/**
+ * Read a tree written by `serializeTree`. The returned arrays are views into `bytes`.
+ *
+ * @returns The tree, or undefined if `bytes` is not a cache file of the current format
+ */
+export function deserializeTree(bytes: Uint8Array): EncodedSyntaxTree | undefined {
+  if (bytes.byteLength < HEADER_SIZE) {
+    return undefined;
+  }
+  if (bytes.byteOffset % 8 !== 0) {
+    bytes = bytes.slice();
+  }
+
+  const header = new Uint32Array(bytes.buffer, bytes.byteOffset, 4);
+  const n = header[2];
+  const t = header[3];
+  if (
+    header[0] !== MAGIC ||
+    header[1] !== CACHE_FORMAT_VERSION ||
+    bytes.byteLength !== HEADER_SIZE + n * BYTES_PER_NODE + t * BYTES_PER_TIME
+  ) {
+    return undefined;
+  }
+
+  const { buffer } = bytes;
+  const times = bytes.byteOffset + HEADER_SIZE;
+  const ranges = times + t * 2 * 8;
+  const parents = ranges + n * 6 * 4;
+  const subtreeEnds = parents + n * 4;
+  const timeNodes = subtreeEnds + n * 4;
+  const types = timeNodes + t * 4;
+  const fields = types + n * 2;
+  const flags = fields + n * 2;
+
+  return {
+    nodeCount: n,
+    ranges: new Uint32Array(buffer, ranges, n * 6),
+    parents: new Int32Array(buffer, parents, n),
+    subtreeEnds: new Uint32Array(buffer, subtreeEnds, n),
+    types: new Uint16Array(buffer, types, n),
+    fields: new Uint16Array(buffer, fields, n),
+    flags: new Uint8Array(buffer, flags, n),
+    timeNodes: new Uint32Array(buffer, timeNodes, t),
+    times: new Float64Array(buffer, times, t * 2),
+  };
+}
+
+/**
+ * A directory of cached syntax trees.
+ *
+ * Reads and writes are synchronous so the cache can sit behind the synchronous parser
+ * interface. Unreadable or corrupt entries are treated as misses, and failed writes are
+ * ignored: the cache only ever costs a re-parse.
+ */
+export class ParseCache {
+  /** The cache directory */
+  readonly dir: string;
+  private readonly grammarFingerprint: string;
+  private created = false;
+
+  /**
+   * @param dir - Directory to store entries in; created on the first write
+   * @param grammarFingerprint - Identifies the grammar build (version, ABI, build id); entries
+   *                             written by a different build are never read
+   */
+  constructor(dir: string, grammarFingerprint: string) {
+    this.dir = dir;
+    this.grammarFingerprint = `${CACHE_FORMAT_VERSION}:${grammarFingerprint}`;
+  }
+
+  /**
+   * Get the cached tree for `source`, if any.
+   */
+  get(source: Uint8Array): EncodedSyntaxTree | undefined {
+    let bytes: Uint8Array;
+    try {
+      bytes = readFileSync(this.path(source));
+    } catch {
+      return undefined;
+    }
+    return deserializeTree(bytes);
+  }
+
+  /**
+   * Store the tree parsed from `source`.
+   */
+  set(source: Uint8Array, tree: EncodedSyntaxTree): void {
+    const path = this.path(source);
+    try {
+      if (!this.created) {
+        mkdirSync(this.dir, { recursive: true });
+        this.created = true;
+      }
+      // Write then rename, so concurrent runs never read a partial entry
+      const temporary = `${path}.${process.pid}.tmp`;
+      writeFileSync(temporary, serializeTree(tree));
+      renameSync(temporary, path);
+    } catch {
+      // A read-only or full disk only disables caching
+    }
+  }
+
+  private path(source: Uint8Array): string {
+    const hash = createHash("sha256").update(this.grammarFingerprint).update(source);
+    return join(this.dir, `${hash.digest("hex")}.bin`);
+  }
+}
@@ -0,0 +1,40 @@
+import { describe, it, expect } from "vitest";
+import { diffParseStats, type ParseStats } from "./parse-stats.js";
+
+function stats(base: number, maxParseNs: number): ParseStats {
+  return {
+    parses: base,
+    bytes: base * 100,
+    parseNs: base * 1000,
+    maxParseNs,
+    scanner: {
+      scans: base * 10,
+      errorRecovery: base,
+      tokens: { indent: base * 3, contentBlank: base * 2, errorSentinel: 0 },
+      memoHits: base,
+      lookaheadChars: base * 7,
+    },
+  };
+}
+
+describe("diffParseStats", () => {
+  it("subtracts every counter", () => {
+    expect(diffParseStats(stats(5, 900), stats(2, 900))).toEqual({
+      parses: 3,
+      bytes: 300,
+      parseNs: 3000,
+      maxParseNs: 0,
+      scanner: {
+        scans: 30,
+        errorRecovery: 3,
+        tokens: { indent: 9, contentBlank: 6, errorSentinel: 0 },
+        memoHits: 3,
+        lookaheadChars: 21,
+      },
+    });
+  });
+
+  it("keeps a new maximum from the later read", () => {
+    expect(diffParseStats(stats(5, 1200), stats(2, 900)).maxParseNs).toBe(1200);
+  });
+});
@@ -0,0 +1,59 @@
+/**
+ * Parse and scanner counters from the native binding (see bindings/node/stats.h).
+ *
+ * Collection is switched on with `setParseStatsEnabled` from `@rejot-dev/thalo/native`; the
+ * counters only ever grow, so the cost of one parse is the difference of two reads around it.
+ */
+
+/**
+ * Structurally identical to the `ParseStats` returned by `getStats()` in
+ * `@rejot-dev/tree-sitter-thalo`.
+ */
+export interface ParseStats {
+  /** Parses made by the binding itself */
+  parses: number;
+  /** Bytes of source those parses covered (two per code unit for strings) */
+  bytes: number;
+  /** Wall time spent in those parses, in nanoseconds */
+  parseNs: number;
+  /** The longest single parse, in nanoseconds */
+  maxParseNs: number;
+  scanner: {
+    /** Calls to the external scanner, including those from other parsers on the JS thread */
+    scans: number;
+    /** Calls that bailed out because the parser was in error recovery */
+    errorRecovery: number;
+    /** Tokens produced, per external token type */
+    tokens: { indent: number; contentBlank: number; errorSentinel: number };
+    /** Tokens served from the scanner's look-ahead memo */
+    memoHits: number;
+    /** Characters read past the end of each produced token, or read without producing one */
+    lookaheadChars: number;
+  };
+}
+
+/**
+ * The counters accumulated between two reads. `maxParseNs` is not a sum, so it is kept from
+ * `after` when a longer parse happened in between and is 0 otherwise.
+ */
+export function diffParseStats(after: ParseStats, before: ParseStats): ParseStats {
+  const { scanner } = after;
+  const { tokens } = scanner;
+  return {
+    parses: after.parses - before.parses,
+    bytes: after.bytes - before.bytes,
+    parseNs: after.parseNs - before.parseNs,
+    maxParseNs: after.maxParseNs > before.maxParseNs ? after.maxParseNs : 0,
+    scanner: {
+      scans: scanner.scans - before.scanner.scans,
+      errorRecovery: scanner.errorRecovery - before.scanner.errorRecovery,
+      tokens: {
+        indent: tokens.indent - before.scanner.tokens.indent,
+        contentBlank: tokens.contentBlank - before.scanner.tokens.contentBlank,
+        errorSentinel: tokens.errorSentinel - before.scanner.tokens.errorSentinel,
+      },
+      memoHits: scanner.memoHits - before.scanner.memoHits,
+      lookaheadChars: scanner.lookaheadChars - before.scanner.lookaheadChars,
+    },
+  };
+}
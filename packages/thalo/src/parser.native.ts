@@ -6,24 +6,62 @@ import Parser, { type Language, type Tree } from "tree-sitter";
 import thalo from "@rejot-dev/tree-sitter-thalo";
 import {
   createThaloParser,
+  withInputCallback,
+  detectFileType,
   type ThaloParser,
+  type GenericTree,
   type ParsedBlock as GenericParsedBlock,
   type ParsedDocument as GenericParsedDocument,
   type FileType,
   type ParseOptions,
 } from "./parser.shared.js";
-import { Workspace } from "./model/workspace.js";
+import { Workspace, type WorkspaceOptions } from "./model/workspace.js";
+import type { SourceMap } from "./source-map.js";
+import { ParseCache } from "./parse-cache.js";
+import type { ParseStats } from "./parse-stats.js";
+import {
+  EncodedTree,
+  type EncodedLanguage,
+  type EncodedSyntaxTree,
+} from "./ast/encoded-tree.js";
 
 // Re-export shared types specialized to native Tree type
 export type ParsedBlock = GenericParsedBlock<Tree>;
 export type ParsedDocument = GenericParsedDocument<Tree>;
 export type { FileType, ParseOptions, ThaloParser };
+export type { ParseStats } from "./parse-stats.js";
+export { diffParseStats } from "./parse-stats.js";
+export { EncodedTree, type EncodedSyntaxTree } from "./ast/encoded-tree.js";
 
 // Re-export Workspace for convenience
 export { Workspace } from "./model/workspace.js";
 
-// Cached parser instance for createWorkspace
+// Cached parser instances for createWorkspace
 let cachedParser: ThaloParser<Tree> | null = null;
+let cachedExtractionParser: ThaloParser<GenericTree> | null = null;
+const cachingParsers = new Map<string, ThaloParser<GenericTree>>();
+
+// Trees parsed ahead of time by loadFiles, keyed by the Buffer they were parsed from
+const preparsedTrees = new WeakMap<Uint8Array, EncodedSyntaxTree>();
+
+/**
+ * Options for createWorkspace
+ */
+export interface CreateWorkspaceOptions extends WorkspaceOptions {
+  /**
+   * Build syntax trees through the binding's bulk `extractEntries` entry point, which walks
+   * each tree once in C++ instead of once per node from JS. The resulting trees are read-only
+   * snapshots, so incremental edits re-parse the whole block. Intended for batch loading
+   * (CLI, CI); falls back to the regular parser if the binding lacks `extractEntries`.
+   */
+  bulkExtraction?: boolean;
+  /**
+   * Directory for a persistent cache of syntax trees, e.g. `.thalo-cache`. Sources whose
+   * content and grammar match a cached entry are not parsed again. Implies `bulkExtraction`;
+   * ignored if the binding lacks it.
+   */
+  cacheDir?: string;
+}
 
 /**
  * Create a native ThaloParser instance.
@@ -47,7 +85,281 @@ export function createParser(): ThaloParser<Tree> {
   const tsParser = new Parser();
   tsParser.setLanguage(thalo as unknown as Language);
 
-  return createThaloParser(tsParser);
+  return createThaloParser({ ...withInputCallback(tsParser), findFences: nativeFenceFinder() });
+}
+
+/**
+ * Get the binding's one-pass ```thalo fence search, if it has one. Without it the shared
+ * parser falls back to a regex.
+ */
+function nativeFenceFinder(): ((source: string) => Uint32Array) | undefined {
+  return typeof thalo.findThaloFences === "function"
+    ? (source) => thalo.findThaloFences(source)
+    : undefined;
+}
+
+/**
+ * Check whether the loaded native binding supports bulk extraction.
+ */
+export function hasNativeExtraction(): boolean {
+  return typeof thalo.extractEntries === "function";
+}
+
+/**
+ * Create a ThaloParser whose trees are decoded from the binding's bulk `extractEntries`
+ * encoding rather than wrapping tree-sitter nodes.
+ *
+ * @param cache - Persistent cache to read trees from and write newly parsed trees to
+ * @throws Error if the native binding does not support bulk extraction
+ */
+export function createExtractionParser(cache?: ParseCache): ThaloParser<GenericTree> {
+  if (!hasNativeExtraction()) {
+    throw new Error("The native thalo binding does not support extractEntries; rebuild it.");
+  }
+
+  const language: EncodedLanguage = {
+    symbolNames: thalo.symbolNames,
+    fieldNames: thalo.fieldNames,
+  };
+
+  // Older bindings only accept strings; the shared parser then falls back to parse()
+  const hasBufferExtraction = typeof thalo.extractEntriesFromBuffer === "function";
+  const extractUtf8 = (bytes: Uint8Array): EncodedSyntaxTree => {
+    const preparsed = preparsedTrees.get(bytes);
+    if (preparsed) {
+      preparsedTrees.delete(bytes);
+      cache?.set(bytes, preparsed);
+      return preparsed;
+    }
+    let encoded = cache?.get(bytes);
+    if (!encoded) {
+      encoded = thalo.extractEntriesFromBuffer(bytes);
+      cache?.set(bytes, encoded);
+    }
+    return encoded;
+  };
+  const encoder = new TextEncoder();
+
+  return createThaloParser<GenericTree>({
+    parse(source: string): GenericTree {
+      // The cache is keyed by UTF-8 bytes, so cached string parses go through the byte path
+      const encoded =
+        cache && hasBufferExtraction
+          ? extractUtf8(encoder.encode(source))
+          : thalo.extractEntries(source);
+      return new EncodedTree(encoded, source, language);
+    },
+    parseUtf8: hasBufferExtraction
+      ? (bytes: Uint8Array, source: string): GenericTree =>
+          new EncodedTree(extractUtf8(bytes), source, language)
+      : undefined,
+    findFences: nativeFenceFinder(),
+  });
+}
+
+/**
+ * Create a ThaloParser that takes syntax trees parsed elsewhere, e.g. on another thread, instead
+ * of parsing: a source that is a key of `trees` gets that tree, anything else is extracted as
+ * by `createExtractionParser`.
+ *
+ * @param trees - Encoded trees by the source (a `.thalo` file or a markdown block) they encode
+ * @throws Error if the native binding does not support bulk extraction
+ */
+export function createPreparsedParser(
+  trees: ReadonlyMap<string, EncodedSyntaxTree>,
+): ThaloParser<GenericTree> {
+  if (!hasNativeExtraction()) {
+    throw new Error("The native thalo binding does not support extractEntries; rebuild it.");
+  }
+
+  const language: EncodedLanguage = {
+    symbolNames: thalo.symbolNames,
+    fieldNames: thalo.fieldNames,
+  };
+  return createThaloParser<GenericTree>({
+    parse(source: string): GenericTree {
+      const encoded = trees.get(source) ?? thalo.extractEntries(source);
+      return new EncodedTree(encoded, source, language);
+    },
+    findFences: nativeFenceFinder(),
+  });
+}
+
+/**
+ * Open the persistent syntax tree cache in `dir` for the loaded grammar.
+ *
+ * The build id changes with the parser, scanner and encoder sources, so a rebuild that changes
+ * the trees without a new grammar version does not serve stale ones.
+ */
+export function openParseCache(dir: string): ParseCache {
+  const fingerprint = [
+    thalo.grammarVersion ?? "unknown",
+    thalo.abiVersion ?? 0,
+    thalo.buildId ?? "unknown",
+    thalo.symbolNames.length,
+    thalo.fieldNames.length,
+  ].join(":");
+  return new ParseCache(dir, fingerprint);
+}
+
+/**
+ * Check whether the loaded native binding can read and parse files on native threads.
+ */
+export function hasNativeLoader(): boolean {
+  return typeof thalo.loadFiles === "function" && hasNativeExtraction();
+}
+
+/**
+ * Options for loadFilesNative
+ */
+export interface LoadFilesNativeOptions {
+  /**
+   * Parse `.thalo` files on the loader threads (default true). Turn this off when most trees
+   * will come from a parse cache instead.
+   */
+  parse?: boolean;
+
+  /**
+   * Parse every file as this type instead of detecting it from its extension, e.g. for the
+   * extensionless temporary files git passes to a merge driver.
+   */
+  fileType?: FileType;
+}
+
+/**
+ * Read files on the binding's native thread pool, parsing `.thalo` files on the same threads.
+ *
+ * Returns the raw contents in the order given. Passing a returned Buffer to
+ * `Workspace.addDocument` on a workspace from `createWorkspace({ bulkExtraction: true })` reuses
+ * the tree parsed in the background instead of parsing it again.
+ *
+ * @throws Error if the binding has no native loader, or a file cannot be read
+ */
+export async function loadFilesNative(
+  paths: string[],
+  options: LoadFilesNativeOptions = {},
+): Promise<Uint8Array[]> {
+  if (!hasNativeLoader()) {
+    throw new Error("The native thalo binding does not support loadFiles; rebuild it.");
+  }
+
+  const parse = options.parse ?? true;
+  const loaded = await thalo.loadFiles(
+    paths.map((path) => ({
+      path,
+      parse: parse && (options.fileType ?? detectFileType(path)) === "thalo",
+    })),
+  );
+  return loaded.map(({ source, tree }) => {
+    if (tree) {
+      preparsedTrees.set(source, tree);
+    }
+    return source;
+  });
+}
+
+/**
+ * Options for streamBlocks
+ */
+export interface StreamBlocksOptions {
+  /**
+   * Minimum size in bytes of each parsed chunk; a chunk is cut at the first entry after it
+   * reaches this size. Larger chunks mean fewer parses but more memory. Defaults to 1 MiB.
+   */
+  chunkSize?: number;
+}
+
+/**
+ * Check whether the loaded native binding can parse files in streamed chunks.
+ */
+export function hasNativeStreaming(): boolean {
+  return typeof thalo.EntryStream === "function" && hasNativeExtraction();
+}
+
+/**
+ * Parse a standalone `.thalo` file in chunks of whole entries, without reading the whole file
+ * into memory.
+ *
+ * Each block covers a run of consecutive entries; its source map places it within the file, so
+ * positions from `extractSourceFile(block.tree.rootNode)` translate with `toFilePosition` as
+ * for markdown blocks. Only the current chunk is kept alive, so the file can be larger than
+ * what fits in a single JS string.
+ *
+ * @throws Error if the binding does not support streaming, or the file cannot be read
+ */
+export function* streamBlocks(
+  path: string,
+  options: StreamBlocksOptions = {},
+): Generator<GenericParsedBlock<GenericTree>> {
+  if (!hasNativeStreaming()) {
+    throw new Error("The native thalo binding does not support EntryStream; rebuild it.");
+  }
+
+  const language: EncodedLanguage = {
+    symbolNames: thalo.symbolNames,
+    fieldNames: thalo.fieldNames,
+  };
+  const decoder = new TextDecoder("utf-8", { ignoreBOM: true });
+  const stream = new thalo.EntryStream(path, options.chunkSize);
+  let charOffset = 0;
+
+  try {
+    for (let chunk = stream.next(); chunk; chunk = stream.next()) {
+      const source = decoder.decode(chunk.source);
+      // Chunks that are not valid UTF-8 come back unparsed; parse the leniently decoded text
+      const tree = new EncodedTree(chunk.tree ?? thalo.extractEntries(source), source, language);
+
+      let lineCount = 1;
+      for (let i = source.indexOf("\n"); i !== -1; i = source.indexOf("\n", i + 1)) {
+        lineCount++;
+      }
+      const sourceMap: SourceMap = Object.freeze({
+        charOffset,
+        lineOffset: chunk.startRow,
+        columnOffset: 0,
+        lineCount,
+      });
+
+      charOffset += source.length;
+      yield { source, sourceMap, tree };
+    }
+  } finally {
+    stream.close();
+  }
+}
+
+/**
+ * Check whether the loaded native binding can count parses and scanner work.
+ */
+export function hasNativeStats(): boolean {
+  return typeof thalo.getStats === "function";
+}
+
+/**
+ * Turn the binding's parse and scanner counters on or off for the whole process. They are off
+ * by default. Scanner counters also cover the regular (node-tree-sitter) parser, as long as it
+ * parses on the thread that enabled them.
+ *
+ * @throws Error if the binding has no stats
+ */
+export function setParseStatsEnabled(enabled: boolean): void {
+  if (!hasNativeStats()) {
+    throw new Error("The native thalo binding does not support getStats; rebuild it.");
+  }
+  thalo.setStatsEnabled(enabled);
+}
+
+/**
+ * Read the binding's counters accumulated since they were last reset. Diff two reads with
+ * `diffParseStats` to measure the work in between.
+ *
+ * @throws Error if the binding has no stats
+ */
+export function readParseStats(): ParseStats {
+  if (!hasNativeStats()) {
+    throw new Error("The native thalo binding does not support getStats; rebuild it.");
+  }
+  return thalo.getStats();
 }
 
 /**
@@ -65,11 +377,28 @@ export function createParser(): ThaloParser<Tree> {
  * workspace.addDocument(source, { filename: "test.thalo" });
  * ```
  */
-export function createWorkspace(): Workspace {
+export function createWorkspace(options: CreateWorkspaceOptions = {}): Workspace {
+  const { bulkExtraction, cacheDir, ...workspaceOptions } = options;
+  if (cacheDir !== undefined && hasNativeExtraction()) {
+    let parser = cachingParsers.get(cacheDir);
+    if (!parser) {
+      parser = createExtractionParser(openParseCache(cacheDir));
+      cachingParsers.set(cacheDir, parser);
+    }
+    return new Workspace(parser, workspaceOptions);
+  }
+
+  if (bulkExtraction && hasNativeExtraction()) {
+    if (!cachedExtractionParser) {
+      cachedExtractionParser = createExtractionParser();
+    }
+    return new Workspace(cachedExtractionParser, workspaceOptions);
+  }
+
   if (!cachedParser) {
     cachedParser = createParser();
   }
-  return new Workspace(cachedParser);
+  return new Workspace(cachedParser, workspaceOptions);
 }
 
 /**
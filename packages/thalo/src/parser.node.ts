@@ -24,6 +24,7 @@
 
 import {
   createThaloParser,
+  withInputCallback,
   type ThaloParser,
   type ParsedBlock as GenericParsedBlock,
   type ParsedDocument as GenericParsedDocument,
@@ -32,7 +33,7 @@ import {
   type GenericTree,
 } from "./parser.shared.js";
 import type { Language as NativeLanguage } from "tree-sitter";
-import { Workspace } from "./model/workspace.js";
+import { Workspace, type WorkspaceOptions } from "./model/workspace.js";
 
 // Re-export shared types
 export type ParsedBlock = GenericParsedBlock<GenericTree>;
@@ -92,10 +93,14 @@ export async function initParser(): Promise<void> {
     testParser.setLanguage(thalo as unknown as NativeLanguage);
 
     // Native works! Set up the factory
+    const findFences =
+      typeof thalo.findThaloFences === "function"
+        ? (source: string) => thalo.findThaloFences(source)
+        : undefined;
     parserFactory = () => {
       const parser = new Parser();
       parser.setLanguage(thalo as unknown as NativeLanguage);
-      return createThaloParser(parser);
+      return createThaloParser({ ...withInputCallback(parser), findFences });
     };
     usingNative = true;
     return;
@@ -132,7 +137,7 @@ export async function initParser(): Promise<void> {
     parserFactory = () => {
       const parser = new Parser();
       parser.setLanguage(language);
-      return createThaloParser(parser);
+      return createThaloParser(withInputCallback(parser));
     };
     usingNative = false;
     return;
@@ -178,9 +183,10 @@ export function createParser(): ThaloParser<GenericTree> {
  * workspace.addDocument(source, { filename: "test.thalo" });
  * ```
  *
+ * @param options - Workspace options, e.g. `{ treeRetention: "release" }` for batch runs
  * @throws Error if `initParser()` has not been called
  */
-export function createWorkspace(): Workspace {
+export function createWorkspace(options: WorkspaceOptions = {}): Workspace {
   if (!parserFactory) {
     throw new Error(
       "Parser not initialized. Call `await initParser()` before using createWorkspace().",
@@ -189,7 +195,7 @@ export function createWorkspace(): Workspace {
   if (!cachedParser) {
     cachedParser = parserFactory();
   }
-  return new Workspace(cachedParser);
+  return new Workspace(cachedParser, options);
 }
 
 /**
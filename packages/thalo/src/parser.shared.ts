@@ -3,7 +3,7 @@
  * This module is platform-agnostic and works with any tree-sitter-like parser.
  */
 
-import { createSourceMap, identitySourceMap, type SourceMap } from "./source-map.js";
+import { createSourceMaps, identitySourceMap, type SourceMap } from "./source-map.js";
 import type { SyntaxNode } from "./ast/ast-types.js";
 
 /**
@@ -33,6 +33,38 @@ export interface GenericTree {
   readonly rootNode: SyntaxNode;
   /** Edit the tree for incremental parsing */
   edit(edit: TreeEdit): void;
+  /**
+   * Get the ranges whose syntactic structure differs in `other`, a tree re-parsed from this
+   * (edited) one. Trees that cannot be re-parsed incrementally do not have it.
+   */
+  getChangedRanges?(other: GenericTree): TreeRange[];
+}
+
+/**
+ * A range of a tree's text, as returned by tree-sitter's `getChangedRanges`.
+ */
+export interface TreeRange {
+  startIndex: number;
+  endIndex: number;
+  startPosition: { row: number; column: number };
+  endPosition: { row: number; column: number };
+}
+
+/**
+ * Tree-sitter's read callback: the text starting at a UTF-16 index, or "" at the end.
+ */
+export type ParseInput = (index: number) => string;
+
+/**
+ * Text that can be read in chunks, such as a `Rope`, so it can be parsed without being
+ * flattened into one string.
+ */
+export interface TextSource {
+  readonly length: number;
+  /** The text from `index` to the end of the chunk containing it, or "" at the end */
+  chunkAt(index: number): string;
+  /** The whole text */
+  toString(): string;
 }
 
 /**
@@ -40,6 +72,33 @@ export interface GenericTree {
  */
 export interface GenericParser<T extends GenericTree> {
   parse(source: string, oldTree?: T | null): T | null;
+  /**
+   * Optionally parse the UTF-8 encoding of `source` directly, skipping the re-encoding done by
+   * `parse`. `source` is the decoded text and must match `bytes` exactly.
+   */
+  parseUtf8?(bytes: Uint8Array, source: string): T | null;
+  /**
+   * Optionally parse text read through a callback. Parsers without it are given the text as
+   * one string.
+   */
+  parseInput?(input: ParseInput, oldTree?: T | null): T | null;
+  /**
+   * Optionally find ```thalo fences natively, returning what `findThaloFences` returns.
+   */
+  findFences?(source: string): Uint32Array;
+}
+
+/**
+ * Wrap a tree-sitter or web-tree-sitter parser, both of which also accept a read callback in
+ * place of the source string, as a GenericParser that reads callbacks.
+ */
+export function withInputCallback<T extends GenericTree>(tsParser: {
+  parse(input: string | ParseInput, oldTree?: T | null): T | null;
+}): GenericParser<T> {
+  return {
+    parse: (source, oldTree) => tsParser.parse(source, oldTree),
+    parseInput: (input, oldTree) => tsParser.parse(input, oldTree),
+  };
 }
 
 /**
@@ -75,6 +134,11 @@ export interface ParseOptions {
   fileType?: FileType;
   /** Optional filename (used for heuristics if fileType is not provided) */
   filename?: string;
+  /**
+   * The UTF-8 bytes `source` was decoded from, if the caller has them (e.g. a file that was
+   * read as a Buffer). Parsers that support it read these bytes directly.
+   */
+  utf8?: Uint8Array;
 }
 
 /**
@@ -83,6 +147,50 @@ export interface ParseOptions {
  */
 const THALO_FENCE_REGEX = /^```thalo\s*\n([\s\S]*?)^```/gm;
 
+/**
+ * Find the content of every ```thalo fence in a markdown source.
+ *
+ * The native binding does the same search in one pass over the text (see
+ * bindings/node/fences.cc); this is the fallback, and the two must agree.
+ *
+ * @returns Flat [start, end) pairs of character offsets, one per fence
+ */
+export function findThaloFences(source: string): Uint32Array {
+  const offsets: number[] = [];
+  let match: RegExpExecArray | null;
+  while ((match = THALO_FENCE_REGEX.exec(source)) !== null) {
+    // The content sits right before the closing ```
+    const end = match.index + match[0].length - 3;
+    offsets.push(end - match[1].length, end);
+  }
+  THALO_FENCE_REGEX.lastIndex = 0;
+  return Uint32Array.from(offsets);
+}
+
+/**
+ * The content of one ```thalo fence in a markdown source.
+ */
+export interface ThaloFence {
+  /** The thalo source inside the fence */
+  source: string;
+  /** Where the content starts in the markdown source */
+  charOffset: number;
+  /** Source map for the content */
+  sourceMap: SourceMap;
+}
+
+/**
+ * Cut the fences found by `findThaloFences` out of a markdown source, with their source maps.
+ */
+export function sliceThaloFences(source: string, fences: Uint32Array): ThaloFence[] {
+  const blocks: { source: string; charOffset: number }[] = [];
+  for (let i = 0; i + 1 < fences.length; i += 2) {
+    blocks.push({ source: source.slice(fences[i], fences[i + 1]), charOffset: fences[i] });
+  }
+  const maps = createSourceMaps(source, blocks);
+  return blocks.map((block, i) => ({ ...block, sourceMap: maps[i] }));
+}
+
 /**
  * Detect file type from filename extension.
  *
@@ -99,6 +207,43 @@ export function detectFileType(filename: string): FileType | undefined {
   return undefined;
 }
 
+/**
+ * Count the UTF-8 bytes needed to encode `text.slice(start, end)`.
+ *
+ * Assumes `text` was decoded from valid UTF-8, so surrogates always come in pairs; each half
+ * counts 2 bytes, giving 4 for the pair.
+ */
+export function utf8Length(text: string, start: number, end: number): number {
+  let length = 0;
+  for (let i = start; i < end; i++) {
+    const unit = text.charCodeAt(i);
+    if (unit < 0x80) {
+      length += 1;
+    } else if (unit < 0x800 || (unit >= 0xd800 && unit <= 0xdfff)) {
+      length += 2;
+    } else {
+      length += 3;
+    }
+  }
+  return length;
+}
+
+// Keep a leading BOM in the decoded text, like Buffer#toString, so offsets line up with the bytes
+const strictUtf8Decoder = new TextDecoder("utf-8", { fatal: true, ignoreBOM: true });
+const lenientUtf8Decoder = new TextDecoder("utf-8", { ignoreBOM: true });
+
+/**
+ * Decode a UTF-8 document. The bytes are returned alongside the text only when they are valid
+ * UTF-8; otherwise replacement characters would make byte and string offsets disagree.
+ */
+export function decodeUtf8(bytes: Uint8Array): { source: string; utf8: Uint8Array | undefined } {
+  try {
+    return { source: strictUtf8Decoder.decode(bytes), utf8: bytes };
+  } catch {
+    return { source: lenientUtf8Decoder.decode(bytes), utf8: undefined };
+  }
+}
+
 /**
  * The ThaloParser interface - a configured parser instance that can parse thalo source.
  */
@@ -116,8 +261,19 @@ export interface ThaloParser<T extends GenericTree = GenericTree> {
    *
    * Note: Before calling this with an oldTree, you must call oldTree.edit()
    * to inform tree-sitter about the changes made to the source.
+   *
+   * A `TextSource` is read chunk by chunk when the underlying parser supports read callbacks,
+   * and flattened otherwise.
+   */
+  parseIncremental(source: string | TextSource, oldTree?: T): T;
+
+  /**
+   * Find the content of every ```thalo fence in a markdown source, natively when the
+   * underlying parser supports it.
+   *
+   * @returns Flat [start, end) pairs of character offsets, one per fence
    */
-  parseIncremental(source: string, oldTree?: T): T;
+  findFences(source: string): Uint32Array;
 
   /**
    * Parse a document, automatically detecting if it's a .thalo file or markdown
@@ -150,6 +306,26 @@ export function createThaloParser<T extends GenericTree>(
     return tree;
   }
 
+  /**
+   * Parse a thalo source string, reading its UTF-8 bytes directly when the underlying parser
+   * supports it.
+   *
+   * @param source - The thalo source code to parse
+   * @param bytes - The UTF-8 encoding of `source`, if available
+   * @returns The parsed tree-sitter Tree
+   * @throws Error if parsing fails
+   */
+  function parseWithBytes(source: string, bytes: Uint8Array | undefined): T {
+    if (!bytes || !tsParser.parseUtf8) {
+      return parse(source);
+    }
+    const tree = tsParser.parseUtf8(bytes, source);
+    if (!tree) {
+      throw new Error("Failed to parse source");
+    }
+    return tree;
+  }
+
   /**
    * Parse a thalo source string with optional incremental parsing.
    *
@@ -158,14 +334,28 @@ export function createThaloParser<T extends GenericTree>(
    * @returns The parsed tree-sitter Tree
    * @throws Error if parsing fails
    */
-  function parseIncremental(source: string, oldTree?: T): T {
-    const tree = tsParser.parse(source, oldTree);
+  function parseIncremental(source: string | TextSource, oldTree?: T): T {
+    let tree: T | null;
+    if (typeof source === "string") {
+      tree = tsParser.parse(source, oldTree);
+    } else if (tsParser.parseInput) {
+      tree = tsParser.parseInput((index) => source.chunkAt(index), oldTree);
+    } else {
+      tree = tsParser.parse(source.toString(), oldTree);
+    }
     if (!tree) {
       throw new Error("Failed to parse source");
     }
     return tree;
   }
 
+  /**
+   * Find the ```thalo fences of a markdown source, natively if the parser can.
+   */
+  function findFences(source: string): Uint32Array {
+    return tsParser.findFences ? tsParser.findFences(source) : findThaloFences(source);
+  }
+
   /**
    * Extract thalo code blocks from markdown source.
    *
@@ -174,24 +364,35 @@ export function createThaloParser<T extends GenericTree>(
    * code block found.
    *
    * @param source - The markdown source containing thalo code blocks
+   * @param bytes - The UTF-8 encoding of `source`, if available
    * @returns A ParsedDocument containing the extracted thalo blocks
    */
-  function extractThaloBlocks(source: string): ParsedDocument<T> {
+  function extractThaloBlocks(source: string, bytes?: Uint8Array): ParsedDocument<T> {
     const blocks: ParsedBlock<T>[] = [];
-    let match: RegExpExecArray | null;
+    // Pure ASCII sources have identical char and byte offsets
+    const ascii = bytes !== undefined && bytes.length === source.length;
+    let charCursor = 0;
+    let byteCursor = 0;
+
+    for (const { source: content, charOffset, sourceMap } of sliceThaloFences(
+      source,
+      findFences(source),
+    )) {
+      let blockBytes: Uint8Array | undefined;
+      if (bytes) {
+        byteCursor += ascii ? charOffset - charCursor : utf8Length(source, charCursor, charOffset);
+        const byteLength = ascii ? content.length : utf8Length(content, 0, content.length);
+        blockBytes = bytes.subarray(byteCursor, byteCursor + byteLength);
+        charCursor = charOffset;
+      }
 
-    while ((match = THALO_FENCE_REGEX.exec(source)) !== null) {
-      const content = match[1];
-      const charOffset = match.index + match[0].indexOf(content);
-      const sourceMap = createSourceMap(source, charOffset, content);
       blocks.push({
         source: content,
         sourceMap,
-        tree: parse(content),
+        tree: parseWithBytes(content, blockBytes),
       });
     }
 
-    THALO_FENCE_REGEX.lastIndex = 0;
     return { blocks };
   }
 
@@ -202,11 +403,12 @@ export function createThaloParser<T extends GenericTree>(
    * source as a thalo file.
    *
    * @param source - The thalo source code
+   * @param bytes - The UTF-8 encoding of `source`, if available
    * @returns A ParsedDocument with a single block
    */
-  function parseThaloDocument(source: string): ParsedDocument<T> {
+  function parseThaloDocument(source: string, bytes?: Uint8Array): ParsedDocument<T> {
     return {
-      blocks: [{ source, sourceMap: identitySourceMap(), tree: parse(source) }],
+      blocks: [{ source, sourceMap: identitySourceMap(), tree: parseWithBytes(source, bytes) }],
     };
   }
 
@@ -222,35 +424,36 @@ export function createThaloParser<T extends GenericTree>(
    * @returns A ParsedDocument containing one or more parsed blocks
    */
   function parseDocument(source: string, options: ParseOptions = {}): ParsedDocument<T> {
-    const { fileType, filename } = options;
+    const { fileType, filename, utf8 } = options;
 
     if (fileType === "thalo") {
-      return parseThaloDocument(source);
+      return parseThaloDocument(source, utf8);
     }
     if (fileType === "markdown") {
-      return extractThaloBlocks(source);
+      return extractThaloBlocks(source, utf8);
     }
 
     if (filename) {
       const detected = detectFileType(filename);
       if (detected === "thalo") {
-        return parseThaloDocument(source);
+        return parseThaloDocument(source, utf8);
       }
       if (detected === "markdown") {
-        return extractThaloBlocks(source);
+        return extractThaloBlocks(source, utf8);
       }
     }
 
     if (source.includes("```thalo")) {
-      return extractThaloBlocks(source);
+      return extractThaloBlocks(source, utf8);
     }
 
-    return parseThaloDocument(source);
+    return parseThaloDocument(source, utf8);
   }
 
   return {
     parse,
     parseIncremental,
+    findFences,
     parseDocument,
   };
 }
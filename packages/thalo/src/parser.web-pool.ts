@@ -0,0 +1,292 @@
+/**
+ * Parse documents on a pool of Web Workers.
+ *
+ * web-tree-sitter parses on the calling thread, so loading a browser workspace of a few hundred
+ * files blocks the UI for the whole parse. A parser pool parses documents on workers, each with
+ * its own WASM instance, and receives their trees as transferred `EncodedSyntaxTree` buffers.
+ * The pool's `parser` hands those trees to a Workspace as `EncodedTree`s, and parses anything
+ * it has no tree for on the calling thread.
+ *
+ * @example
+ * ```typescript
+ * import { Workspace } from "@rejot-dev/thalo";
+ * import { createParserPool } from "@rejot-dev/thalo/web-pool";
+ *
+ * const pool = await createParserPool({ treeSitterWasm, languageWasm });
+ * const workspace = new Workspace(pool.parser);
+ *
+ * await pool.preparse(files);
+ * for (const { source, filename } of files) {
+ *   workspace.addDocument(source, { filename });
+ * }
+ * ```
+ *
+ * @module @rejot-dev/thalo/web-pool
+ */
+
+import type { Tree } from "web-tree-sitter";
+import { initTreeSitter, type CreateParserOptions, type WasmInput } from "./parser.web.js";
+import {
+  createThaloParser,
+  type FileType,
+  type GenericTree,
+  type ThaloParser,
+} from "./parser.shared.js";
+import { EncodedTree, type EncodedLanguage, type EncodedSyntaxTree } from "./ast/encoded-tree.js";
+
+/**
+ * Options for createParserPool
+ */
+export interface ParserPoolOptions extends CreateParserOptions {
+  /** Number of workers (default: hardware concurrency minus one, at least one) */
+  workers?: number;
+  /**
+   * Start a worker running `parser.web-worker.js`. Defaults to a module worker loaded from
+   * next to this module, which bundlers such as Vite pick up from the `new URL(...)` pattern.
+   */
+  createWorker?: () => Worker;
+}
+
+/**
+ * A document to parse on the pool.
+ */
+export interface PoolDocument {
+  source: string;
+  /** Used to detect the file type, as for `parseDocument` */
+  filename?: string;
+  fileType?: FileType;
+}
+
+/**
+ * One parsed thalo block, as sent back by a worker.
+ */
+export interface PooledBlock {
+  source: string;
+  tree: EncodedSyntaxTree;
+}
+
+/**
+ * A message sent to a parser worker.
+ */
+export type ParserWorkerRequest =
+  | { type: "init"; options: CreateParserOptions }
+  | { type: "parse"; id: number; documents: PoolDocument[] };
+
+/**
+ * A message a parser worker replies with.
+ */
+export type ParserWorkerResponse =
+  | { type: "ready" }
+  | { type: "parsed"; id: number; blocks: PooledBlock[] }
+  | { type: "error"; id?: number; error: string };
+
+/**
+ * A pool of parser workers and the parser that consumes their trees.
+ */
+export interface ParserPool {
+  /**
+   * Parser to create a Workspace with. Trees parsed by `preparse` are used once each, for the
+   * first parse of the same block source; other sources, and incremental re-parses after
+   * edits, are parsed on the calling thread.
+   */
+  readonly parser: ThaloParser<GenericTree>;
+
+  /**
+   * Parse documents on the workers, so that adding them to a workspace created with `parser`
+   * reuses their trees.
+   */
+  preparse(documents: PoolDocument[]): Promise<void>;
+
+  /**
+   * Stop the workers. `parser` keeps working, parsing on the calling thread.
+   */
+  terminate(): void;
+}
+
+/**
+ * A worker and the requests it has not answered yet.
+ */
+interface PoolWorker {
+  worker: Worker;
+  pending: Map<number, { resolve: (blocks: PooledBlock[]) => void; reject: (e: Error) => void }>;
+}
+
+function defaultWorkerCount(): number {
+  const concurrency = globalThis.navigator?.hardwareConcurrency ?? 2;
+  return Math.max(1, concurrency - 1);
+}
+
+function defaultCreateWorker(): Worker {
+  return new Worker(new URL("./parser.web-worker.js", import.meta.url), { type: "module" });
+}
+
+/**
+ * Compile WASM bytes once, so workers are sent a module instead of compiling the same bytes.
+ */
+async function compileWasm(input: WasmInput): Promise<WebAssembly.Module> {
+  return input instanceof WebAssembly.Module ? input : WebAssembly.compile(input as BufferSource);
+}
+
+/**
+ * Start a worker and wait until its parser is ready.
+ */
+function startWorker(
+  createWorker: () => Worker,
+  options: CreateParserOptions,
+): Promise<PoolWorker> {
+  return new Promise((resolve, reject) => {
+    const poolWorker: PoolWorker = { worker: createWorker(), pending: new Map() };
+    const { worker, pending } = poolWorker;
+
+    worker.onmessage = (event: MessageEvent<ParserWorkerResponse>) => {
+      const response = event.data;
+      if (response.type === "ready") {
+        resolve(poolWorker);
+        return;
+      }
+      if (response.id === undefined) {
+        if (response.type === "error") {
+          worker.terminate();
+          reject(new Error(`Parser worker failed to start: ${response.error}`));
+        }
+        return;
+      }
+      const request = pending.get(response.id);
+      pending.delete(response.id);
+      if (response.type === "parsed") {
+        request?.resolve(response.blocks);
+      } else {
+        request?.reject(new Error(response.error));
+      }
+    };
+    worker.onerror = (event) => {
+      const error = new Error(`Parser worker error: ${event.message}`);
+      for (const request of pending.values()) {
+        request.reject(error);
+      }
+      pending.clear();
+      reject(error);
+    };
+
+    worker.postMessage({ type: "init", options } satisfies ParserWorkerRequest);
+  });
+}
+
+/**
+ * Split documents into at most `count` contiguous shards of roughly equal source length.
+ */
+function shardDocuments(documents: PoolDocument[], count: number): PoolDocument[][] {
+  const total = documents.reduce((sum, document) => sum + document.source.length, 0);
+  const shards: PoolDocument[][] = [];
+  let shard: PoolDocument[] = [];
+  let length = 0;
+  for (const document of documents) {
+    shard.push(document);
+    length += document.source.length;
+    if (length >= (total * (shards.length + 1)) / count && shards.length < count - 1) {
+      shards.push(shard);
+      shard = [];
+    }
+  }
+  if (shard.length > 0) {
+    shards.push(shard);
+  }
+  return shards;
+}
+
+/**
+ * Create a parser pool: a parser on the calling thread, and workers that parse documents for it
+ * in the background.
+ *
+ * @throws Error if the WASM cannot be loaded or a worker fails to start
+ */
+export async function createParserPool(options: ParserPoolOptions): Promise<ParserPool> {
+  const { workers: workerCount = defaultWorkerCount(), createWorker = defaultCreateWorker } =
+    options;
+
+  const [treeSitterWasm, languageWasm, simdLanguageWasm] = await Promise.all([
+    compileWasm(options.treeSitterWasm),
+    compileWasm(options.languageWasm),
+    options.simdLanguageWasm ? compileWasm(options.simdLanguageWasm) : undefined,
+  ]);
+  const wasm: CreateParserOptions = { treeSitterWasm, languageWasm, simdLanguageWasm };
+
+  const { parser: tsParser, language } = await initTreeSitter(wasm);
+  const encodedLanguage: EncodedLanguage = {
+    symbolNames: language.types,
+    fieldNames: language.fields.map((field) => field ?? ""),
+  };
+
+  let workers = await Promise.all(
+    Array.from({ length: workerCount }, () => startWorker(createWorker, wasm)),
+  );
+  let nextId = 0;
+
+  // Trees sent back by the workers, by block source; a source can occur in several documents
+  const preparsed = new Map<string, EncodedSyntaxTree[]>();
+
+  const takePreparsed = (source: string): EncodedSyntaxTree | undefined => {
+    const trees = preparsed.get(source);
+    const tree = trees?.pop();
+    if (trees?.length === 0) {
+      preparsed.delete(source);
+    }
+    return tree;
+  };
+
+  // Encoded trees cannot be re-parsed incrementally, so edits after them parse from scratch
+  const localTree = (oldTree?: GenericTree | null): Tree | null =>
+    oldTree instanceof EncodedTree ? null : ((oldTree as Tree | null | undefined) ?? null);
+
+  const parser = createThaloParser<GenericTree>({
+    parse(source, oldTree) {
+      if (!oldTree) {
+        const encoded = takePreparsed(source);
+        if (encoded) {
+          return new EncodedTree(encoded, source, encodedLanguage);
+        }
+      }
+      return tsParser.parse(source, localTree(oldTree));
+    },
+    parseInput: (input, oldTree) => tsParser.parse(input, localTree(oldTree)),
+  });
+
+  const parseOn = (poolWorker: PoolWorker, documents: PoolDocument[]): Promise<PooledBlock[]> =>
+    new Promise((resolve, reject) => {
+      const id = nextId++;
+      poolWorker.pending.set(id, { resolve, reject });
+      poolWorker.worker.postMessage({ type: "parse", id, documents } satisfies ParserWorkerRequest);
+    });
+
+  return {
+    parser,
+
+    async preparse(documents) {
+      if (workers.length === 0) {
+        return;
+      }
+      const shards = shardDocuments(documents, workers.length);
+      const results = await Promise.all(shards.map((shard, i) => parseOn(workers[i], shard)));
+      for (const blocks of results) {
+        for (const { source, tree } of blocks) {
+          const trees = preparsed.get(source);
+          if (trees) {
+            trees.push(tree);
+          } else {
+            preparsed.set(source, [tree]);
+          }
+        }
+      }
+    },
+
+    terminate() {
+      for (const { worker, pending } of workers) {
+        worker.terminate();
+        for (const request of pending.values()) {
+          request.reject(new Error("Parser pool terminated"));
+        }
+      }
+      workers = [];
+    },
+  };
+}
@@ -0,0 +1,70 @@
+/**
+ * Web Worker entry point for `createParserPool`.
+ *
+ * Each worker runs its own web-tree-sitter instance. Documents are parsed as by
+ * `parseDocument`, and every block tree is sent back in the `EncodedSyntaxTree` layout with its
+ * buffers transferred, so nothing but the block sources is copied.
+ */
+
+import type { Tree } from "web-tree-sitter";
+import { initTreeSitter } from "./parser.web.js";
+import { createThaloParser, withInputCallback, type ThaloParser } from "./parser.shared.js";
+import { encodeTree, encodedTreeBuffers } from "./ast/encode-tree.js";
+import type { ParserWorkerRequest, ParserWorkerResponse, PooledBlock } from "./parser.web-pool.js";
+
+/**
+ * The parts of `DedicatedWorkerGlobalScope` used here.
+ */
+interface WorkerScope {
+  onmessage: ((event: MessageEvent<ParserWorkerRequest>) => void) | null;
+  postMessage(message: ParserWorkerResponse, transfer?: Transferable[]): void;
+}
+
+const scope = globalThis as unknown as WorkerScope;
+let parser: ThaloParser<Tree> | undefined;
+
+function errorMessage(error: unknown): string {
+  return error instanceof Error ? error.message : String(error);
+}
+
+function parse(request: Extract<ParserWorkerRequest, { type: "parse" }>): void {
+  if (!parser) {
+    scope.postMessage({ type: "error", id: request.id, error: "Parser worker not initialized" });
+    return;
+  }
+
+  const blocks: PooledBlock[] = [];
+  const transfer: ArrayBuffer[] = [];
+  for (const { source, filename, fileType } of request.documents) {
+    for (const block of parser.parseDocument(source, { filename, fileType }).blocks) {
+      const cursor = block.tree.walk();
+      const tree = encodeTree(cursor);
+      cursor.delete();
+      // Trees live in the WASM heap until deleted
+      block.tree.delete();
+      blocks.push({ source: block.source, tree });
+      transfer.push(...encodedTreeBuffers(tree));
+    }
+  }
+  scope.postMessage({ type: "parsed", id: request.id, blocks }, transfer);
+}
+
+scope.onmessage = (event) => {
+  const request = event.data;
+  if (request.type === "init") {
+    initTreeSitter(request.options).then(
+      ({ parser: tsParser }) => {
+        parser = createThaloParser(withInputCallback(tsParser));
+        scope.postMessage({ type: "ready" });
+      },
+      (error: unknown) => scope.postMessage({ type: "error", error: errorMessage(error) }),
+    );
+    return;
+  }
+
+  try {
+    parse(request);
+  } catch (error) {
+    scope.postMessage({ type: "error", id: request.id, error: errorMessage(error) });
+  }
+};
@@ -2,7 +2,7 @@ import { describe, it, expect, beforeAll } from "vitest";
 import { readFile } from "node:fs/promises";
 import { createRequire } from "node:module";
 import { dirname, join } from "node:path";
-import { createParser, type ThaloParser } from "./parser.web.js";
+import { createParser, supportsWasmSimd, type ThaloParser } from "./parser.web.js";
 import type { Tree } from "web-tree-sitter";
 import { isIdentityMap } from "./source-map.js";
 
@@ -273,3 +273,21 @@ describe("Web Parser with WebAssembly.Module", () => {
     expect(result.blocks[0].tree.rootNode.hasError).toBe(false);
   });
 });
+
+describe("SIMD language WASM", () => {
+  it("detects SIMD support", () => {
+    // Every Node.js version this package supports runs WASM SIMD
+    expect(supportsWasmSimd()).toBe(true);
+  });
+
+  it("uses the SIMD language module when the host supports it", async () => {
+    const parser = await createParser({
+      treeSitterWasm,
+      languageWasm: new Uint8Array([0, 97, 115, 109]),
+      simdLanguageWasm: languageWasm,
+    });
+
+    const tree = parser.parse(`2026-01-05T18:00Z create lore "Test" #test\n`);
+    expect(tree.rootNode.hasError).toBe(false);
+  });
+});
@@ -5,6 +5,7 @@
 import { Parser, Language, type Tree, type Node } from "web-tree-sitter";
 import {
   createThaloParser,
+  withInputCallback,
   type ThaloParser,
   type ParsedBlock as GenericParsedBlock,
   type ParsedDocument as GenericParsedDocument,
@@ -51,36 +52,53 @@ export interface CreateParserOptions {
    * - `WebAssembly.Module`: Pre-compiled WASM module (useful for Cloudflare Workers, etc.)
    */
   languageWasm: WasmInput;
+
+  /**
+   * The thalo language WASM built with 128-bit SIMD, `tree-sitter-thalo.simd.wasm` from
+   * `@rejot-dev/tree-sitter-thalo`. Used in place of `languageWasm` when the host supports
+   * WebAssembly SIMD (see `supportsWasmSimd`).
+   */
+  simdLanguageWasm?: WasmInput;
 }
 
 /**
- * Create a web ThaloParser instance using WASM.
- *
- * This initializes web-tree-sitter and loads the thalo language WASM.
- * Must be awaited before parsing.
- *
- * @example
- * ```typescript
- * import { createParser } from "@rejot-dev/thalo/web";
- *
- * // Option 1: Fetch both WASM files as bytes
- * const [treeSitterWasm, languageWasm] = await Promise.all([
- *   fetch("/wasm/tree-sitter.wasm").then(r => r.arrayBuffer()).then(b => new Uint8Array(b)),
- *   fetch("/wasm/tree-sitter-thalo.wasm").then(r => r.arrayBuffer()).then(b => new Uint8Array(b)),
- * ]);
- *
- * // Option 2: Use pre-compiled WebAssembly.Module (e.g., in Cloudflare Workers)
- * // import treeSitterWasm from "./tree-sitter.wasm";
- * // import languageWasm from "./tree-sitter-thalo.wasm";
- *
- * const parser = await createParser({ treeSitterWasm, languageWasm });
+ * Smallest module using a SIMD instruction (`i8x16.splat` / `i8x16.popcnt`), validated to
+ * detect support without instantiating anything.
+ */
+const SIMD_PROBE = new Uint8Array([
+  0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0, 10, 10, 1, 8, 0, 65, 0, 253,
+  15, 253, 98, 11,
+]);
+
+let simdSupported: boolean | undefined;
+
+/**
+ * Check whether the host supports WebAssembly 128-bit SIMD.
+ */
+export function supportsWasmSimd(): boolean {
+  if (simdSupported === undefined) {
+    try {
+      simdSupported = WebAssembly.validate(SIMD_PROBE);
+    } catch {
+      simdSupported = false;
+    }
+  }
+  return simdSupported;
+}
+
+/**
+ * Initialize web-tree-sitter and create a raw tree-sitter parser with the thalo language.
  *
- * const tree = parser.parse(source);
- * const doc = parser.parseDocument(source, { fileType: "thalo" });
- * ```
+ * Most callers want `createParser`; this is for code that needs the tree-sitter objects
+ * themselves, such as the parser pool workers.
  */
-export async function createParser(options: CreateParserOptions): Promise<ThaloParser<Tree>> {
-  const { treeSitterWasm, languageWasm } = options;
+export async function initTreeSitter(
+  options: CreateParserOptions,
+): Promise<{ parser: Parser; language: Language }> {
+  const { treeSitterWasm } = options;
+  const { simdLanguageWasm } = options;
+  const languageWasm =
+    simdLanguageWasm && supportsWasmSimd() ? simdLanguageWasm : options.languageWasm;
 
   // Initialize the tree-sitter runtime
   if (treeSitterWasm instanceof WebAssembly.Module) {
@@ -104,7 +122,7 @@ export async function createParser(options: CreateParserOptions): Promise<ThaloP
     });
   }
 
-  const tsParser = new Parser();
+  const parser = new Parser();
 
   // Load the language - supports both Uint8Array and WebAssembly.Module
   let language: Language;
@@ -115,7 +133,38 @@ export async function createParser(options: CreateParserOptions): Promise<ThaloP
     // Use standard load for bytes (async)
     language = await Language.load(languageWasm);
   }
-  tsParser.setLanguage(language);
+  parser.setLanguage(language);
+
+  return { parser, language };
+}
 
-  return createThaloParser(tsParser);
+/**
+ * Create a web ThaloParser instance using WASM.
+ *
+ * This initializes web-tree-sitter and loads the thalo language WASM.
+ * Must be awaited before parsing.
+ *
+ * @example
+ * ```typescript
+ * import { createParser } from "@rejot-dev/thalo/web";
+ *
+ * // Option 1: Fetch both WASM files as bytes
+ * const [treeSitterWasm, languageWasm] = await Promise.all([
+ *   fetch("/wasm/tree-sitter.wasm").then(r => r.arrayBuffer()).then(b => new Uint8Array(b)),
+ *   fetch("/wasm/tree-sitter-thalo.wasm").then(r => r.arrayBuffer()).then(b => new Uint8Array(b)),
+ * ]);
+ *
+ * // Option 2: Use pre-compiled WebAssembly.Module (e.g., in Cloudflare Workers)
+ * // import treeSitterWasm from "./tree-sitter.wasm";
+ * // import languageWasm from "./tree-sitter-thalo.wasm";
+ *
+ * const parser = await createParser({ treeSitterWasm, languageWasm });
+ *
+ * const tree = parser.parse(source);
+ * const doc = parser.parseDocument(source, { fileType: "thalo" });
+ * ```
+ */
+export async function createParser(options: CreateParserOptions): Promise<ThaloParser<Tree>> {
+  const { parser } = await initTreeSitter(options);
+  return createThaloParser(withInputCallback(parser));
 }
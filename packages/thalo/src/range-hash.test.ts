@@ -0,0 +1,28 @@
+import { describe, it, expect } from "vitest";
+import { hashRanges, loadRangeHasher } from "./range-hash.js";
+
+const source = 'a key: "✓" 😀';
+// [start, end) pairs: empty, "a", 'key: "✓"', the surrogate pair, and one clamped to the end
+const ranges = new Uint32Array([0, 0, 0, 1, 2, 10, 11, 13, 11, 99]);
+
+describe("hashRanges", () => {
+  it("computes 64-bit FNV-1a over UTF-16 code units", () => {
+    expect(Array.from(hashRanges(source, ranges))).toEqual([
+      0xcbf29ce4, 0x84222325, 0xaf63dc4c, 0x8601ec8c, 0xf96d77a4, 0x9da119fd, 0xe5e45a0a,
+      0x241b88d8, 0xe5e45a0a, 0x241b88d8,
+    ]);
+  });
+
+  it("hashes equal text at different offsets equally", () => {
+    const hashes = hashRanges("entry\nentry\nother", new Uint32Array([0, 5, 6, 11, 12, 17]));
+    expect([hashes[0], hashes[1]]).toEqual([hashes[2], hashes[3]]);
+    expect([hashes[0], hashes[1]]).not.toEqual([hashes[4], hashes[5]]);
+  });
+});
+
+describe("loadRangeHasher", () => {
+  it("agrees with the JS implementation", async () => {
+    const hasher = await loadRangeHasher();
+    expect(hasher(source, ranges)).toEqual(hashRanges(source, ranges));
+  });
+});
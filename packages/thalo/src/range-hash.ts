@@ -0,0 +1,61 @@
+/**
+ * 64-bit hashes of source ranges, used to tell which entries changed between two versions of
+ * a file without comparing their ASTs.
+ *
+ * The native binding provides the same hash as `hashRanges` (see bindings/node/hash.cc); this
+ * module is the fallback when it is unavailable, and the two must agree.
+ */
+
+/**
+ * Hash [start, end) ranges of UTF-16 code units, given as flat pairs.
+ *
+ * @returns The high and low 32-bit words of each range's hash, in order
+ */
+export type RangeHasher = (source: string, ranges: Uint32Array) => Uint32Array;
+
+const FNV_OFFSET_HIGH = 0xcbf29ce4;
+const FNV_OFFSET_LOW = 0x84222325;
+// The 64-bit FNV prime is 2^40 + 0x1b3
+const FNV_PRIME_LOW = 0x1b3;
+
+/**
+ * 64-bit FNV-1a over UTF-16 code units, in 32-bit halves: each unit is XORed in whole, then
+ * multiplied by the FNV prime.
+ */
+export const hashRanges: RangeHasher = (source, ranges) => {
+  const count = ranges.length >>> 1;
+  const hashes = new Uint32Array(count * 2);
+  for (let i = 0; i < count; i++) {
+    const end = Math.min(ranges[2 * i + 1], source.length);
+    const start = Math.min(ranges[2 * i], end);
+    let high = FNV_OFFSET_HIGH;
+    let low = FNV_OFFSET_LOW;
+    for (let j = start; j < end; j++) {
+      low ^= source.charCodeAt(j);
+      // low * 0x1b3 is below 2^41, so it is exact as a double
+      const product = (low >>> 0) * FNV_PRIME_LOW;
+      const carry = Math.floor(product / 0x1_0000_0000);
+      high = (Math.imul(high, FNV_PRIME_LOW) + carry + (low << 8)) | 0;
+      low = product | 0;
+    }
+    hashes[2 * i] = high;
+    hashes[2 * i + 1] = low;
+  }
+  return hashes;
+};
+
+/**
+ * Get the native range hasher if the binding is installed and provides one, or the JS
+ * implementation otherwise.
+ */
+export async function loadRangeHasher(): Promise<RangeHasher> {
+  try {
+    const { default: thalo } = await import("@rejot-dev/tree-sitter-thalo");
+    if (typeof thalo.hashRanges === "function") {
+      return (source, ranges) => thalo.hashRanges(source, ranges);
+    }
+  } catch {
+    // No native bindings for this platform
+  }
+  return hashRanges;
+}
@@ -104,6 +104,7 @@ function mockTimestamp(value: string): Timestamp {
       location: loc,
       syntaxNode: mockSyntaxNode(),
     },
+    epochMinutes: 29460600,
     location: loc,
     syntaxNode: mockSyntaxNode(),
   };
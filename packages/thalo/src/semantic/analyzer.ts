@@ -1,6 +1,8 @@
 import type { SourceFile, Entry, SchemaEntry, Metadata, Location } from "../ast/ast-types.js";
 import type { SourceMap } from "../source-map.js";
 import type { ParsedBlock, GenericTree } from "../parser.shared.js";
+import { buildHeaderStore, releaseHeaderStore, type HeaderStore } from "./header-store.js";
+import { SymbolTable } from "./symbols.js";
 
 // ===================
 // Link Index Types
@@ -77,6 +79,12 @@ export interface SemanticModel {
    */
   linkIndex: LinkIndex;
 
+  /**
+   * The entries' headers in columns, one row per entry of `ast.entries`. Names in the AST are
+   * interned in `headers.symbols`.
+   */
+  headers: HeaderStore;
+
   /**
    * Schema entries from this document.
    * These are used by the SchemaRegistry at the workspace level
@@ -129,18 +137,23 @@ export interface AnalyzeOptions {
   sourceMap: SourceMap;
   /** The parsed blocks (containing tree-sitter trees) */
   blocks: ParsedBlock<GenericTree>[];
+  /** The table to intern names in, shared by a workspace's documents (default: a new table) */
+  symbols?: SymbolTable;
 }
 
 /**
  * Analyze an AST to produce a SemanticModel.
  *
  * This function traverses the AST and builds indexes:
+ * - The header store, interning the AST's names
  * - Link definitions (entries with explicit ^linkId)
  * - Link references (^linkId in metadata values or actualize targets)
  * - Schema entries for later resolution by SchemaRegistry
  */
 export function analyze(ast: SourceFile, options: AnalyzeOptions): SemanticModel {
-  const { file, source, sourceMap, blocks } = options;
+  const { file, source, sourceMap, blocks, symbols = new SymbolTable() } = options;
+  // Interned first, so the link index is keyed by canonical strings
+  const headers = buildHeaderStore(ast.entries, symbols);
 
   return {
     ast,
@@ -149,6 +162,7 @@ export function analyze(ast: SourceFile, options: AnalyzeOptions): SemanticModel
     sourceMap,
     blocks,
     linkIndex: buildLinkIndex(ast, file),
+    headers,
     schemaEntries: collectSchemaEntries(ast),
   };
 }
@@ -305,6 +319,7 @@ export function updateSemanticModel(
 ): SemanticUpdateResult {
   const oldAst = model.ast;
   const file = model.file;
+  const headers = buildHeaderStore(newAst.entries, model.headers.symbols);
 
   // Track what changed
   const result: SemanticUpdateResult = {
@@ -382,6 +397,9 @@ export function updateSemanticModel(
   model.source = newSource;
   model.sourceMap = newSourceMap;
   model.blocks = newBlocks;
+  // The new headers already retain the names the document still holds
+  releaseHeaderStore(model.headers);
+  model.headers = headers;
   model.schemaEntries = newSchemaEntries;
   model.dirty = {
     linkIndex: false,
@@ -0,0 +1,150 @@
+import { describe, it, expect } from "vitest";
+import type { InstanceEntry } from "../ast/ast-types.js";
+import { createWorkspace } from "../parser.native.js";
+import {
+  KIND_ACTUALIZE,
+  KIND_INSTANCE,
+  KIND_SCHEMA,
+  KIND_SYNTHESIS,
+  headerDirective,
+  headerKind,
+  headerTags,
+} from "./header-store.js";
+import { NO_SYMBOL, SymbolTable } from "./symbols.js";
+
+const source = `2026-01-01T00:00Z define-entity lore "Lore" #schema
+  # Metadata
+  subject: link
+
+2026-01-05T10:00Z create lore "First" ^first #notes #ideas
+  subject: ^first
+
+2026-01-05T10:30+01:00 update lore "Second" #notes
+  subject: ^first
+
+2026-01-06T00:00Z define-synthesis "Summary" ^summary
+  sources: lore
+
+2026-01-07T00:00Z actualize-synthesis ^summary
+  updated: 2026-01-07T00:00Z
+`;
+
+describe("SymbolTable", () => {
+  it("hands out dense ids and canonical strings", () => {
+    const symbols = new SymbolTable();
+    const copy = ["lo", "re"].join("");
+
+    expect(symbols.intern("lore")).toBe(0);
+    expect(symbols.intern("opinion")).toBe(1);
+    expect(symbols.intern(copy)).toBe(0);
+    expect(symbols.canonical(copy)).toBe("lore");
+    expect(symbols.name(1)).toBe("opinion");
+    expect(symbols.lookup("journal")).toBe(NO_SYMBOL);
+    expect(symbols.size).toBe(2);
+    expect(() => symbols.name(2)).toThrow();
+  });
+
+  it("frees names once released and reuses their ids", () => {
+    const symbols = new SymbolTable();
+    const lore = symbols.intern("lore");
+    const opinion = symbols.intern("opinion");
+    symbols.retain([lore, opinion]);
+    symbols.retain([lore]);
+
+    symbols.release([lore, opinion]);
+    expect(symbols.lookup("lore")).toBe(lore);
+    expect(symbols.lookup("opinion")).toBe(NO_SYMBOL);
+    expect(() => symbols.name(opinion)).toThrow();
+    expect(symbols.size).toBe(1);
+
+    expect(symbols.intern("journal")).toBe(opinion);
+    expect(symbols.size).toBe(2);
+  });
+});
+
+describe("HeaderStore", () => {
+  it("stores one row per entry", () => {
+    const workspace = createWorkspace();
+    const model = workspace.addDocument(source, { filename: "test.thalo" });
+    const { headers } = model;
+    const { symbols } = headers;
+
+    expect(headers.length).toBe(model.ast.entries.length);
+    expect([...headers.kinds]).toEqual([
+      KIND_SCHEMA,
+      KIND_INSTANCE,
+      KIND_INSTANCE,
+      KIND_SYNTHESIS,
+      KIND_ACTUALIZE,
+    ]);
+    expect(model.ast.entries.map((_, row) => headerDirective(headers, row))).toEqual([
+      "define-entity",
+      "create",
+      "update",
+      "define-synthesis",
+      "actualize-synthesis",
+    ]);
+    expect(headerKind(headers, 1)).toBe("instance_entry");
+
+    // The update's +01:00 timestamp is half an hour before the create
+    expect(headers.epochMinutes[2] - headers.epochMinutes[1]).toBe(-30);
+    expect(headers.starts[1]).toBe(model.ast.entries[1].location.startIndex);
+    expect(headers.ends[1]).toBe(model.ast.entries[1].location.endIndex);
+
+    expect(symbols.name(headers.entities[0])).toBe("lore");
+    expect(headers.entities[1]).toBe(headers.entities[0]);
+    expect(headers.entities[3]).toBe(NO_SYMBOL);
+    expect(symbols.name(headers.links[1])).toBe("first");
+    expect(headers.links[2]).toBe(NO_SYMBOL);
+    expect(symbols.name(headers.links[3])).toBe("summary");
+    expect(headers.targets[4]).toBe(headers.links[3]);
+    expect([...headerTags(headers, 1)].map((id) => symbols.name(id))).toEqual(["notes", "ideas"]);
+    expect(headerTags(headers, 2)[0]).toBe(headerTags(headers, 1)[0]);
+    expect(headerTags(headers, 4).length).toBe(0);
+  });
+
+  it("shares one symbol table across a workspace's documents", () => {
+    const workspace = createWorkspace();
+    const a = workspace.addDocument(source, { filename: "a.thalo" });
+    const b = workspace.addDocument(source, { filename: "b.thalo" });
+
+    expect(a.headers.symbols).toBe(workspace.symbols);
+    expect(b.headers.symbols).toBe(workspace.symbols);
+    expect([...b.headers.entities]).toEqual([...a.headers.entities]);
+
+    const entry = b.ast.entries[1] as InstanceEntry;
+    expect(entry.header.tags[0].name).toBe(workspace.symbols.canonical("notes"));
+  });
+
+  it("is rebuilt on incremental updates", () => {
+    const workspace = createWorkspace();
+    workspace.updateDocument("test.thalo", source);
+    workspace.updateDocument(
+      "test.thalo",
+      source + `\n2026-01-08T00:00Z create lore "Third" ^third\n  subject: ^first\n`,
+    );
+
+    const { headers } = workspace.getModel("test.thalo")!;
+    expect(headers.length).toBe(6);
+    expect(workspace.symbols.name(headers.links[5])).toBe("third");
+  });
+
+  it("releases the names of replaced and removed documents", () => {
+    const workspace = createWorkspace();
+    workspace.addDocument(source, { filename: "a.thalo" });
+    const size = workspace.symbols.size;
+
+    workspace.updateDocument("b.thalo", source.replaceAll("lore", "opinion"));
+    workspace.updateDocument("b.thalo", source.replaceAll("lore", "journal"));
+    expect(workspace.symbols.lookup("opinion")).toBe(NO_SYMBOL);
+    expect(workspace.symbols.size).toBe(size + 1);
+
+    // Names the remaining document holds are kept
+    workspace.removeDocument("b.thalo");
+    expect(workspace.symbols.lookup("journal")).toBe(NO_SYMBOL);
+    expect(workspace.symbols.size).toBe(size);
+
+    workspace.removeDocument("a.thalo");
+    expect(workspace.symbols.size).toBe(0);
+  });
+});
@@ -0,0 +1,213 @@
+/**
+ * Columnar storage of entry headers.
+ *
+ * A `HeaderStore` holds one row per entry of a document, in `ast.entries` order, with each header
+ * field in its own typed array. Rules and indexes that only look at headers (ordering,
+ * duplicates, which entities a file uses) scan a few arrays instead of walking entry objects, and
+ * reach for `ast.entries[row]` only for the rows they report on.
+ */
+import type { Entry, Metadata, Tag } from "../ast/ast-types.js";
+import { NO_SYMBOL, type SymbolTable } from "./symbols.js";
+
+/** `HeaderStore.kinds` code of each entry type, indexing `ENTRY_KINDS`. */
+export const KIND_INSTANCE = 0;
+export const KIND_SCHEMA = 1;
+export const KIND_SYNTHESIS = 2;
+export const KIND_ACTUALIZE = 3;
+
+/** Entry types by their code in `HeaderStore.kinds`. */
+export const ENTRY_KINDS = [
+  "instance_entry",
+  "schema_entry",
+  "synthesis_entry",
+  "actualize_entry",
+] as const satisfies readonly Entry["type"][];
+
+/** Directives by their code in `HeaderStore.directives`. */
+export const DIRECTIVES = [
+  "create",
+  "update",
+  "define-entity",
+  "alter-entity",
+  "define-synthesis",
+  "actualize-synthesis",
+] as const;
+
+export type HeaderDirective = (typeof DIRECTIVES)[number];
+
+const KIND_CODES = new Map<string, number>(ENTRY_KINDS.map((kind, code) => [kind, code]));
+const DIRECTIVE_CODES = new Map<string, number>(
+  DIRECTIVES.map((directive, code) => [directive, code]),
+);
+
+/**
+ * The headers of a document's entries, one row per entry. Name columns hold ids into `symbols`,
+ * or `NO_SYMBOL`.
+ */
+export interface HeaderStore {
+  /** The table the name columns index */
+  readonly symbols: SymbolTable;
+  /** Number of rows */
+  readonly length: number;
+  /** Entry type per row, indexing `ENTRY_KINDS` */
+  readonly kinds: Uint8Array;
+  /** Directive per row, indexing `DIRECTIVES` */
+  readonly directives: Uint8Array;
+  /** Header timestamp per row in epoch minutes (UTC) */
+  readonly epochMinutes: Float64Array;
+  /** Start and end of each entry's source range, relative to its block like `entry.location` */
+  readonly starts: Uint32Array;
+  readonly ends: Uint32Array;
+  /** Entity per row: an instance's entity or a schema entry's entity name */
+  readonly entities: Int32Array;
+  /** Link id the entry defines: its `^link-id`, or a synthesis's required link */
+  readonly links: Int32Array;
+  /** Link id an actualize entry targets */
+  readonly targets: Int32Array;
+  /** Header tags of row `i` are `tags[tagOffsets[i]]` up to `tags[tagOffsets[i + 1]]` */
+  readonly tagOffsets: Uint32Array;
+  readonly tags: Int32Array;
+  /** Every id the document's entries hold, once each; retained in `symbols` until released */
+  readonly names: Int32Array;
+}
+
+/** Get the entry type of a row. */
+export function headerKind(store: HeaderStore, row: number): Entry["type"] {
+  return ENTRY_KINDS[store.kinds[row]];
+}
+
+/** Get the directive of a row. */
+export function headerDirective(store: HeaderStore, row: number): HeaderDirective {
+  return DIRECTIVES[store.directives[row]];
+}
+
+/** Get the tag ids of a row, as a view into `store.tags`. */
+export function headerTags(store: HeaderStore, row: number): Int32Array {
+  return store.tags.subarray(store.tagOffsets[row], store.tagOffsets[row + 1]);
+}
+
+/**
+ * Build the header store of a document's entries.
+ *
+ * This also interns the names in each entry (entity, link ids, tags, metadata keys and link
+ * values) in place, replacing them with the table's canonical strings. The names are retained
+ * in the table until `releaseHeaderStore`.
+ */
+export function buildHeaderStore(entries: readonly Entry[], symbols: SymbolTable): HeaderStore {
+  const length = entries.length;
+  const store = {
+    symbols,
+    length,
+    kinds: new Uint8Array(length),
+    directives: new Uint8Array(length),
+    epochMinutes: new Float64Array(length),
+    starts: new Uint32Array(length),
+    ends: new Uint32Array(length),
+    entities: new Int32Array(length).fill(NO_SYMBOL),
+    links: new Int32Array(length).fill(NO_SYMBOL),
+    targets: new Int32Array(length).fill(NO_SYMBOL),
+    tagOffsets: new Uint32Array(length + 1),
+    tags: new Int32Array(0),
+    names: new Int32Array(0),
+  };
+
+  const names = new Set<number>();
+  const intern = (name: string): number => {
+    const id = symbols.intern(name);
+    names.add(id);
+    return id;
+  };
+  const tags: number[] = [];
+  for (let row = 0; row < length; row++) {
+    const entry = entries[row];
+    store.kinds[row] = KIND_CODES.get(entry.type)!;
+    store.epochMinutes[row] = entry.header.timestamp.epochMinutes;
+    store.starts[row] = entry.location.startIndex;
+    store.ends[row] = entry.location.endIndex;
+    store.tagOffsets[row] = tags.length;
+
+    switch (entry.type) {
+      case "instance_entry": {
+        const { header } = entry;
+        store.directives[row] = DIRECTIVE_CODES.get(header.directive)!;
+        store.entities[row] = intern(header.entity);
+        header.entity = symbols.name(store.entities[row]) as typeof header.entity;
+        if (header.link) {
+          store.links[row] = intern(header.link.id);
+          header.link.id = symbols.name(store.links[row]);
+        }
+        internTags(header.tags, intern, symbols, tags);
+        internMetadata(entry.metadata, intern, symbols);
+        break;
+      }
+      case "schema_entry": {
+        const { header } = entry;
+        store.directives[row] = DIRECTIVE_CODES.get(header.directive)!;
+        store.entities[row] = intern(header.entityName.value);
+        header.entityName.value = symbols.name(store.entities[row]);
+        if (header.link) {
+          store.links[row] = intern(header.link.id);
+          header.link.id = symbols.name(store.links[row]);
+        }
+        internTags(header.tags, intern, symbols, tags);
+        break;
+      }
+      case "synthesis_entry": {
+        const { header } = entry;
+        store.directives[row] = DIRECTIVE_CODES.get("define-synthesis")!;
+        store.links[row] = intern(header.linkId.id);
+        header.linkId.id = symbols.name(store.links[row]);
+        internTags(header.tags, intern, symbols, tags);
+        internMetadata(entry.metadata, intern, symbols);
+        break;
+      }
+      case "actualize_entry": {
+        const { header } = entry;
+        store.directives[row] = DIRECTIVE_CODES.get("actualize-synthesis")!;
+        store.targets[row] = intern(header.target.id);
+        header.target.id = symbols.name(store.targets[row]);
+        internMetadata(entry.metadata, intern, symbols);
+        break;
+      }
+    }
+  }
+  store.tagOffsets[length] = tags.length;
+  store.tags = Int32Array.from(tags);
+  store.names = Int32Array.from(names);
+  symbols.retain(store.names);
+  return store;
+}
+
+/**
+ * Release the names a header store retains, once the document it belongs to is replaced or
+ * removed. Names no other document holds are freed.
+ */
+export function releaseHeaderStore(store: HeaderStore): void {
+  store.symbols.release(store.names);
+}
+
+type Intern = (name: string) => number;
+
+function internTags(tags: Tag[], intern: Intern, symbols: SymbolTable, ids: number[]): void {
+  for (const tag of tags) {
+    const id = intern(tag.name);
+    tag.name = symbols.name(id);
+    ids.push(id);
+  }
+}
+
+function internMetadata(metadata: Metadata[], intern: Intern, symbols: SymbolTable): void {
+  for (const m of metadata) {
+    m.key.value = symbols.name(intern(m.key.value));
+    const content = m.value.content;
+    if (content.type === "link_value") {
+      content.link.id = symbols.name(intern(content.link.id));
+    } else if (content.type === "value_array") {
+      for (const element of content.elements) {
+        if (element.type === "link") {
+          element.id = symbols.name(intern(element.id));
+        }
+      }
+    }
+  }
+}
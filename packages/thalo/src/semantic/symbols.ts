@@ -0,0 +1,80 @@
+/**
+ * Interned names shared by every document in a workspace.
+ *
+ * Entity names, metadata keys, tags and link ids repeat across thousands of entries, and each
+ * extracted AST node holds its own copy of the string. Interning swaps those copies for one
+ * canonical string per name, so the duplicates can be collected, and gives every name a small
+ * integer id that the columnar `HeaderStore` stores instead of a string.
+ */
+
+/** Id stored in place of a symbol where there is none (e.g. an entry without a `^link-id`). */
+export const NO_SYMBOL = -1;
+
+/**
+ * A reference-counted table of names. Each document's `HeaderStore` retains the ids it holds
+ * and releases them when the document is replaced or removed; a name no longer retained by any
+ * document is dropped and its id reused. Ids are small integers starting at 0 and stay valid
+ * while retained; names that were never retained are kept.
+ */
+export class SymbolTable {
+  private ids = new Map<string, number>();
+  private names: (string | undefined)[] = [];
+  private refs: number[] = [];
+  private free: number[] = [];
+
+  /** Number of live names. */
+  get size(): number {
+    return this.ids.size;
+  }
+
+  /** Get the id of `name`, adding it if it is new. */
+  intern(name: string): number {
+    let id = this.ids.get(name);
+    if (id === undefined) {
+      id = this.free.pop() ?? this.names.length;
+      this.names[id] = name;
+      this.refs[id] = 0;
+      this.ids.set(name, id);
+    }
+    return id;
+  }
+
+  /** Add a reference to each id. */
+  retain(ids: ArrayLike<number>): void {
+    for (let i = 0; i < ids.length; i++) {
+      this.refs[ids[i]]++;
+    }
+  }
+
+  /** Drop a reference to each id, freeing the names no longer referenced. */
+  release(ids: ArrayLike<number>): void {
+    for (let i = 0; i < ids.length; i++) {
+      const id = ids[i];
+      const name = this.names[id];
+      if (name !== undefined && this.refs[id] > 0 && --this.refs[id] === 0) {
+        this.ids.delete(name);
+        this.names[id] = undefined;
+        this.free.push(id);
+      }
+    }
+  }
+
+  /** Get the canonical copy of `name`, adding it if it is new. */
+  canonical(name: string): string {
+    return this.name(this.intern(name));
+  }
+
+  /** Get the id of `name` without adding it, or `NO_SYMBOL` if it is not interned. */
+  lookup(name: string): number {
+    return this.ids.get(name) ?? NO_SYMBOL;
+  }
+
+  /** Get the name of an id. */
+  name(id: number): string {
+    const name = this.names[id];
+    if (name === undefined) {
+      throw new Error(`Unknown symbol id ${id}`);
+    }
+    return name;
+  }
+}
@@ -239,6 +239,56 @@ describe("GitChangeTracker", () => {
       expect(result2.entries).toHaveLength(1);
       expect(result2.entries[0].header.link?.id).toBe("entry1");
     });
+
+    it("should answer blame checks against several checkpoints from one tracker", async () => {
+      const tempDir = await fs.mkdtemp(path.join(os.tmpdir(), "thalo-git-tracker-"));
+
+      await runGit(["init"], tempDir);
+      await runGit(["config", "user.email", "test@example.com"], tempDir);
+      await runGit(["config", "user.name", "Test User"], tempDir);
+
+      const file = "entries.thalo";
+      const entry1 = `2026-01-07T10:00Z create lore "Entry 1" ^entry1\n\n  # Content\n  One\n`;
+      const entry2 = `2026-01-07T11:00Z create lore "Entry 2" ^entry2\n\n  # Content\n  Two\n`;
+      const entry2Edited = entry2.replace("Two", "Two, edited");
+
+      await fs.writeFile(path.join(tempDir, file), `${entry1}\n${entry2}`, "utf8");
+      await runGit(["add", "."], tempDir);
+      await runGit(["commit", "-m", "base"], tempDir);
+      const baseCommit = (await runGit(["rev-parse", "HEAD"], tempDir)).trim();
+
+      // Blame-based detection is enabled by any ignore file; the ignored commit doesn't matter
+      await fs.writeFile(path.join(tempDir, ".git-blame-ignore-revs"), `${baseCommit}\n`, "utf8");
+      await runGit(["add", "."], tempDir);
+      await runGit(["commit", "-m", "ignore revs"], tempDir);
+      const ignoreCommit = (await runGit(["rev-parse", "HEAD"], tempDir)).trim();
+
+      await fs.writeFile(path.join(tempDir, file), `${entry1}\n${entry2Edited}`, "utf8");
+      await runGit(["add", file], tempDir);
+      await runGit(["commit", "-m", "edit entry 2"], tempDir);
+
+      const tempTracker = new GitChangeTracker({ cwd: tempDir });
+      const tempWorkspace = createWorkspace();
+      tempWorkspace.addDocument(`${entry1}\n${entry2Edited}`, { filename: file });
+
+      const sinceIgnore = await tempTracker.getChangedEntries(tempWorkspace, [loreQuery], {
+        type: "git",
+        value: ignoreCommit,
+      });
+      expect(sinceIgnore.entries.map((e) => e.header.link?.id)).toEqual(["entry2"]);
+
+      const sinceBase = await tempTracker.getChangedEntries(tempWorkspace, [loreQuery], {
+        type: "git",
+        value: baseCommit,
+      });
+      expect(sinceBase.entries.map((e) => e.header.link?.id)).toEqual(["entry2"]);
+
+      const sinceHead = await tempTracker.getChangedEntries(tempWorkspace, [loreQuery], {
+        type: "git",
+        value: sinceBase.currentMarker.value,
+      });
+      expect(sinceHead.entries).toEqual([]);
+    });
   });
 
   describe("getChangedSchemaEntries", () => {
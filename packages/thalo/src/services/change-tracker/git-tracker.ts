@@ -5,17 +5,15 @@ import {
   detectGitContext,
   getCurrentCommit,
   getFilesChangedSince,
-  getFileAtCommit,
   commitExists,
   getUncommittedFiles,
   getBlameIgnoreRevs,
-  getBlameCommitsForLineRange,
-  isCommitAncestorOf,
   type FileChange,
 } from "../../git/git.js";
+import { GitHistory } from "../../git/history.js";
 import { getEntryIdentity, serializeIdentity } from "../../merge/entry-matcher.js";
 import { entriesEqual } from "../../merge/entry-merger.js";
-import { entryMatchesQuery } from "../query.js";
+import { compileQueries } from "../query-plan.js";
 import { parseDocument } from "../../parser.node.js";
 import { extractSourceFile } from "../../ast/extract.js";
 import type {
@@ -39,12 +37,16 @@ import { UncommittedChangesError } from "./change-tracker.js";
  *    - Parse both versions
  *    - Compare entries by identity (linkId or timestamp)
  *    - Mark entries as changed if they're new or content differs
+ *
+ * Blame, rev-list and file content lookups go through a GitHistory for the current HEAD, so
+ * each file is blamed and read at most once however many queries are checked against it.
  */
 export class GitChangeTracker implements ChangeTracker {
   readonly type = "git" as const;
   private cwd: string;
   private force: boolean;
   private blameIgnoreRevs: string[] | null | undefined;
+  private history: GitHistory | undefined;
 
   constructor(options: ChangeTrackerOptions = {}) {
     this.cwd = options.cwd ?? process.cwd();
@@ -59,6 +61,17 @@ export class GitChangeTracker implements ChangeTracker {
     return this.blameIgnoreRevs;
   }
 
+  /**
+   * Get the history for a HEAD commit, reusing the cached one while HEAD hasn't moved.
+   */
+  private async getHistory(head: string): Promise<GitHistory> {
+    if (this.history?.head !== head) {
+      this.history?.close();
+      this.history = new GitHistory(this.cwd, head, await this.getIgnoreRevs());
+    }
+    return this.history;
+  }
+
   async getCurrentMarker(): Promise<ChangeMarker> {
     const commit = await getCurrentCommit(this.cwd);
     if (!commit) {
@@ -137,11 +150,18 @@ export class GitChangeTracker implements ChangeTracker {
     }
 
     // Find changed entries
+    const history = await this.getHistory(currentMarker.value);
     const changedEntries: InstanceEntry[] = [];
     const seenKeys = new Set<string>();
 
     for (const change of thaloChanges) {
-      const entries = await this.getChangedEntriesInFile(workspace, change, marker.value, queries);
+      const entries = await this.getChangedEntriesInFile(
+        workspace,
+        history,
+        change,
+        marker.value,
+        queries,
+      );
 
       for (const entry of entries) {
         // Include file path in dedup key to handle timestamp-based identities across files
@@ -197,11 +217,18 @@ export class GitChangeTracker implements ChangeTracker {
       return [];
     }
 
+    const { value: head } = await this.getCurrentMarker();
+    const history = await this.getHistory(head);
     const changedEntries: SchemaEntry[] = [];
     const seenKeys = new Set<string>();
 
     for (const change of thaloChanges) {
-      const entries = await this.getChangedSchemaEntriesInFile(workspace, change, marker.value);
+      const entries = await this.getChangedSchemaEntriesInFile(
+        workspace,
+        history,
+        change,
+        marker.value,
+      );
 
       for (const entry of entries) {
         const key = `${change.path}:${serializeIdentity(getEntryIdentity(entry))}`;
@@ -219,19 +246,14 @@ export class GitChangeTracker implements ChangeTracker {
    * Get all files that contain entries matching the queries.
    */
   private getSourceFiles(workspace: Workspace, queries: Query[]): string[] {
+    const plan = compileQueries(queries);
     const files = new Set<string>();
 
     for (const model of workspace.allModels()) {
       for (const entry of model.ast.entries) {
-        if (entry.type !== "instance_entry") {
-          continue;
-        }
-
-        for (const query of queries) {
-          if (entryMatchesQuery(entry, query)) {
-            files.add(model.file);
-            break;
-          }
+        if (entry.type === "instance_entry" && plan.matches(entry)) {
+          files.add(model.file);
+          break;
         }
       }
     }
@@ -261,6 +283,7 @@ export class GitChangeTracker implements ChangeTracker {
    * Get all entries matching the queries (for first run or fallback)
    */
   private getAllMatchingEntries(workspace: Workspace, queries: Query[]): InstanceEntry[] {
+    const plan = compileQueries(queries);
     const results: InstanceEntry[] = [];
     const seen = new Set<string>();
 
@@ -276,12 +299,9 @@ export class GitChangeTracker implements ChangeTracker {
           continue;
         }
 
-        for (const query of queries) {
-          if (entryMatchesQuery(entry, query)) {
-            results.push(entry);
-            seen.add(key);
-            break;
-          }
+        if (plan.matches(entry)) {
+          results.push(entry);
+          seen.add(key);
         }
       }
     }
@@ -325,6 +345,7 @@ export class GitChangeTracker implements ChangeTracker {
    */
   private async getChangedEntriesInFile(
     workspace: Workspace,
+    history: GitHistory,
     change: FileChange,
     markerCommit: string,
     queries: Query[],
@@ -339,6 +360,7 @@ export class GitChangeTracker implements ChangeTracker {
     const currentEntries = model.ast.entries.filter(
       (e): e is InstanceEntry => e.type === "instance_entry",
     );
+    const plan = compileQueries(queries);
 
     // If a blame ignore-revs file exists, use blame-based change detection.
     // This allows users to ignore formatting-only commits (e.g. via `.git-blame-ignore-revs`)
@@ -347,50 +369,13 @@ export class GitChangeTracker implements ChangeTracker {
     if (ignoreRevs) {
       const changed: InstanceEntry[] = [];
 
-      // Normalize end line: tree-sitter endPosition is exclusive.
-      function locationToLineRange(entry: InstanceEntry): { startLine: number; endLine: number } {
-        const startRow = entry.location.startPosition.row;
-        const endRow = entry.location.endPosition.row;
-        const endCol = entry.location.endPosition.column;
-        const startLine = startRow + 1;
-        const endLine = endCol === 0 ? endRow : endRow + 1;
-        return { startLine, endLine: Math.max(startLine, endLine) };
-      }
-
       for (const entry of currentEntries) {
         // Check if entry matches any query
-        let matchesQuery = false;
-        for (const query of queries) {
-          if (entryMatchesQuery(entry, query)) {
-            matchesQuery = true;
-            break;
-          }
-        }
-        if (!matchesQuery) {
+        if (!plan.matches(entry)) {
           continue;
         }
 
-        const { startLine, endLine } = locationToLineRange(entry);
-        const blamedCommits = await getBlameCommitsForLineRange(
-          change.path,
-          startLine,
-          endLine,
-          this.cwd,
-          ignoreRevs,
-        );
-
-        let isChanged = false;
-        for (const commit of blamedCommits) {
-          // If the blamed commit is not an ancestor of the marker, then the entry
-          // has changes "after" the marker (including merges), after applying ignore-revs.
-          const isBeforeMarker = await isCommitAncestorOf(commit, markerCommit, this.cwd);
-          if (!isBeforeMarker) {
-            isChanged = true;
-            break;
-          }
-        }
-
-        if (isChanged) {
+        if (await this.isBlamedSince(history, change.path, entry, markerCommit)) {
           changed.push(entry);
         }
       }
@@ -400,7 +385,7 @@ export class GitChangeTracker implements ChangeTracker {
 
     // Get old file content - use oldPath for renames, otherwise current path
     const pathAtCommit = change.oldPath ?? change.path;
-    const oldContent = await getFileAtCommit(pathAtCommit, markerCommit, this.cwd);
+    const oldContent = await history.getFileAtCommit(pathAtCommit, markerCommit);
 
     // Build map of old entries
     const oldEntryMap = new Map<string, Entry>();
@@ -428,15 +413,7 @@ export class GitChangeTracker implements ChangeTracker {
 
     for (const entry of currentEntries) {
       // Check if entry matches any query
-      let matchesQuery = false;
-      for (const query of queries) {
-        if (entryMatchesQuery(entry, query)) {
-          matchesQuery = true;
-          break;
-        }
-      }
-
-      if (!matchesQuery) {
+      if (!plan.matches(entry)) {
         continue;
       }
 
@@ -459,6 +436,7 @@ export class GitChangeTracker implements ChangeTracker {
    */
   private async getChangedSchemaEntriesInFile(
     workspace: Workspace,
+    history: GitHistory,
     change: FileChange,
     markerCommit: string,
   ): Promise<SchemaEntry[]> {
@@ -475,35 +453,8 @@ export class GitChangeTracker implements ChangeTracker {
     if (ignoreRevs) {
       const changed: SchemaEntry[] = [];
 
-      function locationToLineRange(entry: SchemaEntry): { startLine: number; endLine: number } {
-        const startRow = entry.location.startPosition.row;
-        const endRow = entry.location.endPosition.row;
-        const endCol = entry.location.endPosition.column;
-        const startLine = startRow + 1;
-        const endLine = endCol === 0 ? endRow : endRow + 1;
-        return { startLine, endLine: Math.max(startLine, endLine) };
-      }
-
       for (const entry of currentEntries) {
-        const { startLine, endLine } = locationToLineRange(entry);
-        const blamedCommits = await getBlameCommitsForLineRange(
-          change.path,
-          startLine,
-          endLine,
-          this.cwd,
-          ignoreRevs,
-        );
-
-        let isChanged = false;
-        for (const commit of blamedCommits) {
-          const isBeforeMarker = await isCommitAncestorOf(commit, markerCommit, this.cwd);
-          if (!isBeforeMarker) {
-            isChanged = true;
-            break;
-          }
-        }
-
-        if (isChanged) {
+        if (await this.isBlamedSince(history, change.path, entry, markerCommit)) {
           changed.push(entry);
         }
       }
@@ -512,7 +463,7 @@ export class GitChangeTracker implements ChangeTracker {
     }
 
     const pathAtCommit = change.oldPath ?? change.path;
-    const oldContent = await getFileAtCommit(pathAtCommit, markerCommit, this.cwd);
+    const oldContent = await history.getFileAtCommit(pathAtCommit, markerCommit);
 
     const oldEntryMap = new Map<string, Entry>();
     if (oldContent) {
@@ -549,6 +500,36 @@ export class GitChangeTracker implements ChangeTracker {
     return changed;
   }
 
+  /**
+   * Check whether any line of an entry is blamed on a commit made after the marker.
+   *
+   * A blamed commit that is not an ancestor of the marker means the entry has changes "after"
+   * the marker (including merges), after applying ignore-revs.
+   */
+  private async isBlamedSince(
+    history: GitHistory,
+    file: string,
+    entry: Entry,
+    markerCommit: string,
+  ): Promise<boolean> {
+    // Normalize end line: tree-sitter endPosition is exclusive.
+    const startLine = entry.location.startPosition.row + 1;
+    const endRow = entry.location.endPosition.row;
+    const endLine = entry.location.endPosition.column === 0 ? endRow : endRow + 1;
+
+    const blamedCommits = await history.getBlameCommitsForLineRange(
+      file,
+      startLine,
+      Math.max(startLine, endLine),
+    );
+    for (const commit of blamedCommits) {
+      if (await history.isCommitSince(commit, markerCommit)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   /**
    * Find a model in the workspace by relative path.
    * Normalizes path separators for cross-platform compatibility.
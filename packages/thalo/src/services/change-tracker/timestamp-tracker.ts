@@ -1,7 +1,7 @@
 import type { Timestamp, InstanceEntry, SchemaEntry } from "../../ast/ast-types.js";
 import type { Query } from "../query.js";
 import type { Workspace } from "../../model/workspace.js";
-import { entryMatchesQuery } from "../query.js";
+import { compileQueries } from "../query-plan.js";
 import { formatTimestamp } from "../../formatters.js";
 import type { ChangeTracker, ChangeMarker, ChangedEntriesResult } from "./change-tracker.js";
 
@@ -9,9 +9,7 @@ import type { ChangeTracker, ChangeMarker, ChangedEntriesResult } from "./change
  * Convert a timestamp to epoch milliseconds for correct comparison across timezones
  */
 function timestampToEpoch(ts: Timestamp): number {
-  const isoStr = formatTimestamp(ts);
-  // Date.parse handles timezone offsets correctly
-  return Date.parse(isoStr);
+  return ts.epochMinutes * 60_000;
 }
 
 /**
@@ -63,6 +61,8 @@ export class TimestampChangeTracker implements ChangeTracker {
     // Convert to epoch for correct comparison across timezones
     const afterEpoch = afterTimestamp ? parseTimestampToEpoch(afterTimestamp) : null;
 
+    const plan = compileQueries(queries);
+
     const results: { entry: InstanceEntry; timestampEpoch: number }[] = [];
     const seen = new Set<string>();
 
@@ -90,12 +90,9 @@ export class TimestampChangeTracker implements ChangeTracker {
         }
 
         // Check if entry matches any of the queries
-        for (const query of queries) {
-          if (entryMatchesQuery(entry, query)) {
-            results.push({ entry, timestampEpoch });
-            seen.add(key);
-            break;
-          }
+        if (plan.matches(entry)) {
+          results.push({ entry, timestampEpoch });
+          seen.add(key);
         }
       }
     }
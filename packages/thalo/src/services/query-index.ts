@@ -0,0 +1,303 @@
+import type { Workspace } from "../model/workspace.js";
+import type { SemanticModel } from "../semantic/analyzer.js";
+import type { InstanceEntry } from "../ast/ast-types.js";
+import { KIND_INSTANCE } from "../semantic/header-store.js";
+
+/**
+ * An instance entry in the query index.
+ */
+export interface IndexedInstance {
+  entry: InstanceEntry;
+  file: string;
+  /** Position of the entry within its file's entries, for workspace-order tie-breaking */
+  position: number;
+  /**
+   * The header timestamp in epoch minutes, used for sorting and `afterTimestamp` cut-offs.
+   * `-Infinity` if the timestamp does not decode, so such entries sort first and are before
+   * every cut-off.
+   */
+  epochMinutes: number;
+}
+
+/**
+ * Postings lists over every instance entry in a workspace.
+ *
+ * Entries are identified by integer ids into `entries`; each map lists the ids of the entries
+ * with a given entity, tag, link or metadata value. The keys mirror how `entryMatchesQuery`
+ * evaluates conditions, so a query is an intersection of postings lists.
+ */
+export interface QueryIndex {
+  /** Indexed entries by id; ids of removed entries are `undefined` until reused */
+  readonly entries: readonly (IndexedInstance | undefined)[];
+  /** Entity name -> entry ids */
+  readonly byEntity: ReadonlyMap<string, ReadonlySet<number>>;
+  /** Header tag -> entry ids */
+  readonly byTag: ReadonlyMap<string, ReadonlySet<number>>;
+  /** Link id in the header or any metadata value -> entry ids */
+  readonly byLink: ReadonlyMap<string, ReadonlySet<number>>;
+  /** Metadata key -> raw value of its first occurrence -> entry ids */
+  readonly byField: ReadonlyMap<string, ReadonlyMap<string, ReadonlySet<number>>>;
+}
+
+interface MutableQueryIndex extends QueryIndex {
+  entries: (IndexedInstance | undefined)[];
+  byEntity: Map<string, Set<number>>;
+  byTag: Map<string, Set<number>>;
+  byLink: Map<string, Set<number>>;
+  byField: Map<string, Map<string, Set<number>>>;
+}
+
+/**
+ * The ids a file's entries were indexed under, and the AST they came from.
+ */
+interface FilePostings {
+  model: SemanticModel;
+  ast: SemanticModel["ast"];
+  ids: number[];
+}
+
+/**
+ * Every indexed entry in result order: by timestamp, then workspace order.
+ */
+export interface QueryTimeline {
+  /** Entry ids in result order */
+  readonly order: Uint32Array;
+  /** Position of each entry id within `order`, or -1 for unused ids */
+  readonly rank: Int32Array;
+}
+
+interface QueryIndexState {
+  index: MutableQueryIndex;
+  files: Map<string, FilePostings>;
+  freeIds: number[];
+  /** Built on demand; dropped whenever an entry is indexed or unindexed */
+  timeline: QueryTimeline | undefined;
+}
+
+const queryIndexStates = new WeakMap<Workspace, QueryIndexState>();
+
+function addPosting<K>(map: Map<K, Set<number>>, key: K, id: number): void {
+  const ids = map.get(key);
+  if (ids) {
+    ids.add(id);
+  } else {
+    map.set(key, new Set([id]));
+  }
+}
+
+function removePosting<K>(map: Map<K, Set<number>>, key: K, id: number): void {
+  const ids = map.get(key);
+  if (ids) {
+    ids.delete(id);
+    if (ids.size === 0) {
+      map.delete(key);
+    }
+  }
+}
+
+/**
+ * Call `visit` with every postings key of an entry, matching `entryMatchesQuery` semantics.
+ */
+function forEachPosting(
+  entry: InstanceEntry,
+  visit: {
+    entity(entity: string): void;
+    tag(tag: string): void;
+    link(link: string): void;
+    field(key: string, raw: string): void;
+  },
+): void {
+  visit.entity(entry.header.entity);
+
+  for (const tag of entry.header.tags) {
+    visit.tag(tag.name);
+  }
+
+  if (entry.header.link) {
+    visit.link(entry.header.link.id);
+  }
+
+  // Field conditions compare against the first occurrence of a key only
+  const seenKeys = new Set<string>();
+  for (const meta of entry.metadata) {
+    const content = meta.value.content;
+    if (content.type === "link_value") {
+      visit.link(content.link.id);
+    } else if (content.type === "value_array") {
+      for (const element of content.elements) {
+        if (element.type === "link") {
+          visit.link(element.id);
+        }
+      }
+    }
+
+    if (!seenKeys.has(meta.key.value)) {
+      seenKeys.add(meta.key.value);
+      visit.field(meta.key.value, meta.value.raw);
+    }
+  }
+}
+
+function indexFile(state: QueryIndexState, model: SemanticModel): void {
+  const { index } = state;
+  const ids: number[] = [];
+
+  const { headers } = model;
+  for (let position = 0; position < headers.length; position++) {
+    if (headers.kinds[position] !== KIND_INSTANCE) {
+      continue;
+    }
+
+    const entry = model.ast.entries[position] as InstanceEntry;
+    const id = state.freeIds.pop() ?? index.entries.length;
+    // NaN would make the timeline's order inconsistent and its binary search unreliable
+    const minutes = headers.epochMinutes[position];
+    index.entries[id] = {
+      entry,
+      file: model.file,
+      position,
+      epochMinutes: Number.isNaN(minutes) ? -Infinity : minutes,
+    };
+    ids.push(id);
+
+    forEachPosting(entry, {
+      entity: (entity) => addPosting(index.byEntity, entity, id),
+      tag: (tag) => addPosting(index.byTag, tag, id),
+      link: (link) => addPosting(index.byLink, link, id),
+      field(key, raw) {
+        let values = index.byField.get(key);
+        if (!values) {
+          values = new Map();
+          index.byField.set(key, values);
+        }
+        addPosting(values, raw, id);
+      },
+    });
+  }
+
+  state.files.set(model.file, { model, ast: model.ast, ids });
+  state.timeline = undefined;
+}
+
+function unindexFile(state: QueryIndexState, file: string, postings: FilePostings): void {
+  const { index } = state;
+
+  for (const id of postings.ids) {
+    const { entry } = index.entries[id]!;
+    forEachPosting(entry, {
+      entity: (entity) => removePosting(index.byEntity, entity, id),
+      tag: (tag) => removePosting(index.byTag, tag, id),
+      link: (link) => removePosting(index.byLink, link, id),
+      field(key, raw) {
+        const values = index.byField.get(key);
+        if (values) {
+          removePosting(values, raw, id);
+          if (values.size === 0) {
+            index.byField.delete(key);
+          }
+        }
+      },
+    });
+    index.entries[id] = undefined;
+    state.freeIds.push(id);
+  }
+
+  state.files.delete(file);
+  state.timeline = undefined;
+}
+
+/**
+ * Get the query index for a workspace, updating it in place for files that changed since the
+ * last call.
+ *
+ * Like `getWorkspaceIndex`, changes are detected by model and AST identity, so only the entries
+ * of edited, added or removed files are re-indexed.
+ */
+export function getQueryIndex(workspace: Workspace): QueryIndex {
+  return updateQueryIndex(workspace).index;
+}
+
+function updateQueryIndex(workspace: Workspace): QueryIndexState {
+  let state = queryIndexStates.get(workspace);
+  if (!state) {
+    state = {
+      index: {
+        entries: [],
+        byEntity: new Map(),
+        byTag: new Map(),
+        byLink: new Map(),
+        byField: new Map(),
+      },
+      files: new Map(),
+      freeIds: [],
+      timeline: undefined,
+    };
+    queryIndexStates.set(workspace, state);
+  }
+
+  const present = new Set<string>();
+  for (const model of workspace.allModels()) {
+    present.add(model.file);
+    const postings = state.files.get(model.file);
+    if (postings && postings.model === model && postings.ast === model.ast) {
+      continue;
+    }
+    if (postings) {
+      unindexFile(state, model.file, postings);
+    }
+    indexFile(state, model);
+  }
+
+  for (const [file, postings] of state.files) {
+    if (!present.has(file)) {
+      unindexFile(state, file, postings);
+    }
+  }
+
+  return state;
+}
+
+/**
+ * Get the query index of a workspace together with its entries in result order.
+ *
+ * The timeline is sorted once per change to the index, so timestamp cut-offs become a binary
+ * search over `order` and result ordering a comparison of integer ranks.
+ */
+export function getQueryTimeline(workspace: Workspace): {
+  index: QueryIndex;
+  timeline: QueryTimeline;
+} {
+  const state = updateQueryIndex(workspace);
+  if (!state.timeline) {
+    state.timeline = buildTimeline(workspace, state.index);
+  }
+  return { index: state.index, timeline: state.timeline };
+}
+
+function buildTimeline(workspace: Workspace, index: QueryIndex): QueryTimeline {
+  const fileRank = new Map(workspace.files().map((file, i) => [file, i]));
+  const ids: number[] = [];
+  index.entries.forEach((indexed, id) => {
+    if (indexed) {
+      ids.push(id);
+    }
+  });
+
+  ids.sort((a, b) => {
+    const x = index.entries[a]!;
+    const y = index.entries[b]!;
+    // Equal minutes, -Infinity included, fall through to workspace order
+    return (
+      (x.epochMinutes === y.epochMinutes ? 0 : x.epochMinutes - y.epochMinutes) ||
+      fileRank.get(x.file)! - fileRank.get(y.file)! ||
+      x.position - y.position
+    );
+  });
+
+  const order = Uint32Array.from(ids);
+  const rank = new Int32Array(index.entries.length).fill(-1);
+  order.forEach((id, i) => {
+    rank[id] = i;
+  });
+  return { order, rank };
+}
@@ -0,0 +1,149 @@
+import { describe, it, expect, beforeEach } from "vitest";
+import { createWorkspace } from "../parser.native.js";
+import { Workspace } from "../model/workspace.js";
+import type { InstanceEntry } from "../ast/ast-types.js";
+import { compileQueries, executePlan } from "./query-plan.js";
+import { entryMatchesQuery, type Query } from "./query.js";
+
+function titles(entries: InstanceEntry[]): (string | undefined)[] {
+  return entries.map((e) => e.header.title?.value);
+}
+
+describe("query plans", () => {
+  let workspace: Workspace;
+
+  beforeEach(() => {
+    workspace = createWorkspace();
+    workspace.addDocument(
+      `2026-01-01T00:00Z define-entity lore "Lore entries"
+  # Metadata
+  subject: string
+`,
+      { filename: "schema.thalo" },
+    );
+    workspace.addDocument(
+      `2026-01-05T10:00Z create lore "Entry 1" ^entry-1 #career #tech
+  subject: "work"
+
+2026-01-05T11:00Z create lore "Entry 2" #career
+  subject: ^entry-1
+
+2026-01-05T12:00Z create lore "Entry 3" #personal
+  subject: "life"
+`,
+      { filename: "entries.thalo" },
+    );
+  });
+
+  describe("compileQueries", () => {
+    it("returns the cached plan for the same array", () => {
+      const queries: Query[] = [{ entity: "lore", conditions: [{ kind: "tag", tag: "career" }] }];
+
+      expect(compileQueries(queries)).toBe(compileQueries(queries));
+    });
+
+    it("recompiles an array that was modified", () => {
+      const queries: Query[] = [{ entity: "lore", conditions: [{ kind: "tag", tag: "career" }] }];
+      const plan = compileQueries(queries);
+      queries.push({ entity: "lore", conditions: [{ kind: "tag", tag: "personal" }] });
+
+      expect(compileQueries(queries)).not.toBe(plan);
+      expect(compileQueries(queries).steps).toHaveLength(2);
+    });
+
+    it("drops duplicate queries and conditions", () => {
+      const plan = compileQueries([
+        {
+          entity: "lore",
+          conditions: [
+            { kind: "tag", tag: "career" },
+            { kind: "tag", tag: "career" },
+          ],
+        },
+        { entity: "lore", conditions: [{ kind: "tag", tag: "career" }] },
+      ]);
+
+      expect(plan.steps).toHaveLength(1);
+      expect(plan.steps[0].conditions).toHaveLength(1);
+    });
+
+    it("matches entries like entryMatchesQuery", () => {
+      const queries: Query[] = [
+        { entity: "lore", conditions: [{ kind: "link", link: "entry-1" }] },
+        { entity: "lore", conditions: [{ kind: "field", field: "subject", value: '"life"' }] },
+      ];
+      const plan = compileQueries(queries);
+      const entries = workspace.getModel("entries.thalo")!.ast.entries as InstanceEntry[];
+
+      for (const entry of entries) {
+        expect(plan.matches(entry)).toBe(queries.some((q) => entryMatchesQuery(entry, q)));
+      }
+      expect(entries.filter((e) => plan.matches(e))).toHaveLength(3);
+    });
+  });
+
+  describe("executePlan", () => {
+    it("intersects conditions of a query", () => {
+      const plan = compileQueries([
+        {
+          entity: "lore",
+          conditions: [
+            { kind: "tag", tag: "career" },
+            { kind: "link", link: "entry-1" },
+          ],
+        },
+      ]);
+
+      expect(titles(executePlan(workspace, plan))).toEqual(["Entry 1", "Entry 2"]);
+    });
+
+    it("returns only entries after afterTimestamp", () => {
+      const plan = compileQueries([{ entity: "lore", conditions: [] }]);
+
+      const after = executePlan(workspace, plan, { afterTimestamp: "2026-01-05T10:00Z" });
+      expect(titles(after)).toEqual(["Entry 2", "Entry 3"]);
+      expect(executePlan(workspace, plan, { afterTimestamp: "2026-01-05T12:00Z" })).toHaveLength(0);
+      expect(executePlan(workspace, plan, { afterTimestamp: "2026-01-01T00:00Z" })).toHaveLength(3);
+    });
+
+    it("orders entries whose timestamp does not decode first, before every cut-off", () => {
+      workspace.addDocument(
+        `2026-01-06T09:00Z create lore "Broken" #career
+  subject: "work"
+
+2026-01-06T10:00Z create lore "Entry 5" #career
+  subject: "work"
+`,
+        { filename: "broken.thalo" },
+      );
+      // What the header store holds for a timestamp that does not decode
+      workspace.getModel("broken.thalo")!.headers.epochMinutes[0] = NaN;
+      const plan = compileQueries([
+        { entity: "lore", conditions: [{ kind: "tag", tag: "career" }] },
+      ]);
+
+      expect(titles(executePlan(workspace, plan))).toEqual([
+        "Broken",
+        "Entry 1",
+        "Entry 2",
+        "Entry 5",
+      ]);
+      const after = executePlan(workspace, plan, { afterTimestamp: "2026-01-05T10:00Z" });
+      expect(titles(after)).toEqual(["Entry 2", "Entry 5"]);
+    });
+
+    it("reflects edits made after the plan was compiled", () => {
+      const plan = compileQueries([{ entity: "lore", conditions: [{ kind: "tag", tag: "tech" }] }]);
+      expect(executePlan(workspace, plan)).toHaveLength(1);
+
+      workspace.addDocument(
+        `2026-01-06T09:00Z create lore "Entry 4" #tech
+  subject: "work"
+`,
+        { filename: "more.thalo" },
+      );
+
+      expect(titles(executePlan(workspace, plan))).toEqual(["Entry 1", "Entry 4"]);
+    });
+  });
+});
@@ -0,0 +1,259 @@
+import type { Workspace } from "../model/workspace.js";
+import type { InstanceEntry } from "../ast/ast-types.js";
+import { getQueryTimeline, type QueryIndex, type QueryTimeline } from "./query-index.js";
+import type { Query, QueryCondition, QueryOptions } from "./query.js";
+import { parseTimestampMinutes } from "../ast/time.js";
+
+/**
+ * A test of one condition against an entry.
+ */
+export type EntryPredicate = (entry: InstanceEntry) => boolean;
+
+/**
+ * One query of a plan, with duplicate conditions removed.
+ */
+export interface QueryPlanStep {
+  entity: string;
+  conditions: QueryCondition[];
+  predicates: EntryPredicate[];
+}
+
+/**
+ * A list of queries (ORed together) compiled for repeated execution.
+ *
+ * Compiling removes duplicate queries and conditions and turns each condition into a
+ * predicate once, so neither condition strings nor condition kinds are looked at per entry.
+ */
+export interface QueryPlan {
+  /** The queries this plan was compiled from */
+  readonly queries: readonly Query[];
+  /** Check whether an entry matches any of the queries */
+  matches(entry: InstanceEntry): boolean;
+  /** The deduplicated queries, in order */
+  readonly steps: readonly QueryPlanStep[];
+}
+
+/**
+ * Plans by the query array they were compiled from, with the queries' key at compile time so
+ * an array that was modified afterwards is recompiled.
+ */
+const planCache = new WeakMap<readonly Query[], { key: string; plan: QueryPlan }>();
+
+function conditionKey(condition: QueryCondition): string {
+  switch (condition.kind) {
+    case "field":
+      return `field\0${condition.field}\0${condition.value}`;
+    case "tag":
+      return `tag\0${condition.tag}`;
+    case "link":
+      return `link\0${condition.link}`;
+  }
+}
+
+function queryKey(query: Query): string {
+  return [query.entity, ...query.conditions.map(conditionKey)].join("\0\0");
+}
+
+function compileCondition(condition: QueryCondition): EntryPredicate {
+  switch (condition.kind) {
+    case "field": {
+      const { field, value } = condition;
+      // Only the first occurrence of a key is compared, as in entryMatchesQuery
+      return (entry) => entry.metadata.find((m) => m.key.value === field)?.value.raw === value;
+    }
+    case "tag": {
+      const { tag } = condition;
+      return (entry) => entry.header.tags.some((t) => t.name === tag);
+    }
+    case "link": {
+      const { link } = condition;
+      return (entry) =>
+        entry.header.link?.id === link ||
+        entry.metadata.some((meta) => {
+          const content = meta.value.content;
+          if (content.type === "link_value") {
+            return content.link.id === link;
+          }
+          if (content.type === "value_array") {
+            return content.elements.some((e) => e.type === "link" && e.id === link);
+          }
+          return false;
+        });
+    }
+  }
+}
+
+/**
+ * Compile queries into a plan.
+ *
+ * Plans are cached by the identity of the `queries` array, so callers holding on to a query
+ * array (like the sources of a synthesis, see `getSynthesisSources`) compile it once.
+ *
+ * @param queries - The queries to compile
+ * @returns A plan matching entries that match any of the queries
+ */
+export function compileQueries(queries: readonly Query[]): QueryPlan {
+  const key = queries.map(queryKey).join("\0\0\0");
+  const cached = planCache.get(queries);
+  if (cached && cached.key === key) {
+    return cached.plan;
+  }
+
+  const steps: QueryPlanStep[] = [];
+  const seenQueries = new Set<string>();
+  for (const query of queries) {
+    const conditions: QueryCondition[] = [];
+    const seenConditions = new Set<string>();
+    for (const condition of query.conditions) {
+      const k = conditionKey(condition);
+      if (!seenConditions.has(k)) {
+        seenConditions.add(k);
+        conditions.push(condition);
+      }
+    }
+
+    const k = [query.entity, ...Array.from(seenConditions).sort()].join("\0\0");
+    if (seenQueries.has(k)) {
+      continue;
+    }
+    seenQueries.add(k);
+    steps.push({ entity: query.entity, conditions, predicates: conditions.map(compileCondition) });
+  }
+
+  const byEntity = new Map<string, QueryPlanStep[]>();
+  for (const step of steps) {
+    const list = byEntity.get(step.entity);
+    if (list) {
+      list.push(step);
+    } else {
+      byEntity.set(step.entity, [step]);
+    }
+  }
+
+  const plan: QueryPlan = {
+    queries,
+    steps,
+    matches(entry) {
+      const candidates = byEntity.get(entry.header.entity);
+      return (
+        candidates !== undefined &&
+        candidates.some((step) => step.predicates.every((predicate) => predicate(entry)))
+      );
+    },
+  };
+  planCache.set(queries, { key, plan });
+  return plan;
+}
+
+/**
+ * Get the postings list a query condition selects, or undefined if nothing matches it.
+ */
+function conditionPostings(
+  index: QueryIndex,
+  condition: QueryCondition,
+): ReadonlySet<number> | undefined {
+  switch (condition.kind) {
+    case "field":
+      return index.byField.get(condition.field)?.get(condition.value);
+    case "tag":
+      return index.byTag.get(condition.tag);
+    case "link":
+      return index.byLink.get(condition.link);
+  }
+}
+
+/**
+ * Find the position of the first entry in the timeline with a timestamp after `timestamp`.
+ * A cut-off that is not a timestamp excludes nothing.
+ */
+function timelineStart(index: QueryIndex, timeline: QueryTimeline, timestamp: string): number {
+  const cutoff = parseTimestampMinutes(timestamp);
+  if (Number.isNaN(cutoff)) {
+    return 0;
+  }
+  const { order } = timeline;
+  let lo = 0;
+  let hi = order.length;
+  while (lo < hi) {
+    const mid = (lo + hi) >>> 1;
+    if (index.entries[order[mid]]!.epochMinutes <= cutoff) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+/**
+ * Add the ids of every entry matching one plan step and positioned at or after `start` in the
+ * timeline.
+ */
+function collectStep(
+  index: QueryIndex,
+  timeline: QueryTimeline,
+  step: QueryPlanStep,
+  start: number,
+  matched: Set<number>,
+): void {
+  const lists: ReadonlySet<number>[] = [];
+  for (const postings of [
+    index.byEntity.get(step.entity),
+    ...step.conditions.map((condition) => conditionPostings(index, condition)),
+  ]) {
+    if (!postings) {
+      return;
+    }
+    lists.push(postings);
+  }
+
+  // The most selective list drives; the others are only probed for its candidates
+  lists.sort((a, b) => a.size - b.size);
+  const [driver, ...rest] = lists;
+  const { order, rank } = timeline;
+
+  if (order.length - start < driver.size) {
+    // The cut-off is more selective than any postings list: walk the tail of the timeline
+    for (let i = start; i < order.length; i++) {
+      const id = order[i];
+      if (lists.every((postings) => postings.has(id))) {
+        matched.add(id);
+      }
+    }
+    return;
+  }
+
+  for (const id of driver) {
+    if (rank[id] >= start && rest.every((postings) => postings.has(id))) {
+      matched.add(id);
+    }
+  }
+}
+
+/**
+ * Execute a compiled plan against the workspace.
+ *
+ * @param workspace - The workspace to query
+ * @param plan - The compiled queries
+ * @param options - Query options
+ * @returns Matching entries sorted by timestamp, then workspace order (deduplicated)
+ */
+export function executePlan(
+  workspace: Workspace,
+  plan: QueryPlan,
+  options: QueryOptions = {},
+): InstanceEntry[] {
+  const { index, timeline } = getQueryTimeline(workspace);
+  const start = options.afterTimestamp ? timelineStart(index, timeline, options.afterTimestamp) : 0;
+
+  // An entry matching several queries is returned once
+  const matched = new Set<number>();
+  for (const step of plan.steps) {
+    collectStep(index, timeline, step, start, matched);
+  }
+
+  const { rank } = timeline;
+  return Array.from(matched)
+    .sort((a, b) => rank[a] - rank[b])
+    .map((id) => index.entries[id]!.entry);
+}
@@ -217,6 +217,52 @@ describe("query service", () => {
       // Entry 1 matches both queries but should only appear once
       expect(results).toHaveLength(2);
     });
+
+    it("reflects documents edited, added and removed between queries", () => {
+      const queries: Query[] = [{ entity: "lore", conditions: [{ kind: "tag", tag: "career" }] }];
+      expect(executeQueries(workspace, queries)).toHaveLength(2);
+
+      workspace.updateDocument(
+        "entries.thalo",
+        `2026-01-05T10:00Z create lore "Entry 1" ^entry-1 #tech
+  type: "fact"
+  subject: "work"
+`,
+      );
+      expect(executeQueries(workspace, queries)).toHaveLength(0);
+
+      workspace.addDocument(
+        `2026-01-04T09:00Z create lore "Entry 4" ^entry-4 #career
+  type: "fact"
+  subject: "work"
+`,
+        { filename: "more.thalo" },
+      );
+      expect(executeQueries(workspace, queries).map((e) => e.header.title?.value)).toEqual([
+        "Entry 4",
+      ]);
+
+      workspace.removeDocument("more.thalo");
+      expect(executeQueries(workspace, queries)).toHaveLength(0);
+    });
+
+    it("orders results by timestamp, then workspace order", () => {
+      workspace.addDocument(
+        `2026-01-05T11:00Z create lore "Entry 2b" #career
+  type: "fact"
+  subject: "work"
+`,
+        { filename: "more.thalo" },
+      );
+      const results = executeQueries(workspace, [{ entity: "lore", conditions: [] }]);
+
+      expect(results.map((e) => e.header.title?.value)).toEqual([
+        "Entry 1",
+        "Entry 2",
+        "Entry 2b",
+        "Entry 3",
+      ]);
+    });
   });
 
   describe("formatQuery", () => {
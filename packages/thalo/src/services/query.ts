@@ -4,7 +4,7 @@ import type {
   Query as AstQuery,
   QueryCondition as AstQueryCondition,
 } from "../ast/ast-types.js";
-import { formatTimestamp } from "../formatters.js";
+import { compileQueries, executePlan } from "./query-plan.js";
 
 // ===================
 // Query Types
@@ -196,21 +196,13 @@ export function validateQueryEntities(workspace: Workspace, queries: Query[]): s
  */
 export interface QueryOptions {
   /**
-   * Only return entries with timestamps after this value.
+   * Only return entries with timestamps after this value (an ISO timestamp such as
+   * "2026-01-05T10:00Z"; instants are compared across timezones).
    * Useful for incremental updates.
    */
   afterTimestamp?: string | null;
 }
 
-/**
- * Result entry with file context for sorting and deduplication
- */
-interface QueryResultEntry {
-  entry: InstanceEntry;
-  file: string;
-  timestampStr: string;
-}
-
 /**
  * Get metadata value as string for a given key.
  * Returns the raw value (with quotes for quoted strings) to match query syntax.
@@ -309,47 +301,7 @@ export function executeQueries(
   queries: Query[],
   options: QueryOptions = {},
 ): InstanceEntry[] {
-  const { afterTimestamp } = options;
-  const results: QueryResultEntry[] = [];
-  // Track seen entries by file:position to avoid returning the same entry twice
-  // (can happen when entry matches multiple queries). We use position rather than
-  // semantic identity (timestamp+type) because query should return ALL physical entries.
-  const seen = new Set<string>();
-
-  for (const model of workspace.allModels()) {
-    for (const entry of model.ast.entries) {
-      if (entry.type !== "instance_entry") {
-        continue;
-      }
-
-      const timestampStr = formatTimestamp(entry.header.timestamp);
-      const key = `${model.file}:${entry.location.startPosition.row}:${entry.location.startPosition.column}`;
-
-      // Skip if we've already seen this entry
-      if (seen.has(key)) {
-        continue;
-      }
-
-      // Skip if entry is before the cutoff
-      if (afterTimestamp && timestampStr <= afterTimestamp) {
-        continue;
-      }
-
-      // Check if entry matches any of the queries
-      for (const query of queries) {
-        if (entryMatchesQuery(entry, query)) {
-          results.push({ entry, file: model.file, timestampStr });
-          seen.add(key);
-          break; // Entry matched, no need to check other queries
-        }
-      }
-    }
-  }
-
-  // Sort by timestamp
-  results.sort((a, b) => a.timestampStr.localeCompare(b.timestampStr));
-
-  return results.map((r) => r.entry);
+  return executePlan(workspace, compileQueries(queries), options);
 }
 
 /**
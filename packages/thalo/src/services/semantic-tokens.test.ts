@@ -0,0 +1,126 @@
+import { describe, it, expect } from "vitest";
+import { Document } from "../model/document.js";
+import { createParser } from "../parser.native.js";
+import {
+  extractSemanticTokens,
+  updateSemanticTokens,
+  encodeSemanticTokens,
+  diffSemanticTokens,
+} from "./semantic-tokens.js";
+
+const parser = createParser();
+
+function entries(count: number): string {
+  let source = "";
+  for (let i = 0; i < count; i++) {
+    source += `2026-01-05T18:00Z create lore "Entry ${i}" ^entry-${i} #tag\n`;
+    source += `  type: "fact"\n  subject: ^self\n\n`;
+  }
+  return source;
+}
+
+function markdown(...blocks: string[]): string {
+  return "# Title\n" + blocks.map((block) => "\n```thalo\n" + block + "```\n").join("");
+}
+
+describe("extractSemanticTokens", () => {
+  it("only returns tokens on the given lines", () => {
+    const doc = new Document(parser, "test.thalo", entries(10));
+    const all = extractSemanticTokens(doc);
+
+    const ranged = extractSemanticTokens(doc, { startLine: 8, endLine: 11 });
+
+    expect(ranged.length).toBeGreaterThan(0);
+    expect(ranged).toEqual(all.filter((token) => token.line >= 8 && token.line <= 11));
+  });
+
+  it("skips blocks outside the range", () => {
+    const source = markdown(entries(2), entries(2));
+    const doc = new Document(parser, "test.md", source);
+    const all = extractSemanticTokens(doc);
+
+    const ranged = extractSemanticTokens(doc, { startLine: 14, endLine: 100 });
+
+    expect(ranged).toEqual(all.filter((token) => token.line >= 14));
+    expect(ranged.every((token) => token.line >= 14)).toBe(true);
+  });
+});
+
+describe("updateSemanticTokens", () => {
+  it("matches a full extraction after edits", () => {
+    const doc = new Document(parser, "test.thalo", entries(20));
+    let tokens = extractSemanticTokens(doc);
+
+    const edits: [number, number, number, number, string][] = [
+      [4, 31, 4, 31, "Renamed "],
+      [9, 0, 9, 0, '2026-01-06T10:00Z create lore "New" #new\n  type: "fact"\n\n'],
+      [20, 0, 24, 0, ""],
+      [0, 0, 0, 0, "\n\n"],
+      [30, 0, 30, 0, "  extra: ^other\n"],
+    ];
+    for (const [startLine, startColumn, endLine, endColumn, text] of edits) {
+      const result = doc.applyEdit(startLine, startColumn, endLine, endColumn, text);
+      expect(result.changedLines).toBeDefined();
+      tokens = updateSemanticTokens(tokens, doc, result.changedLines!);
+      expect(tokens).toEqual(extractSemanticTokens(doc));
+    }
+  });
+
+  it("matches a full extraction when an edit changes later entries", () => {
+    const doc = new Document(parser, "test.thalo", entries(5));
+    const tokens = extractSemanticTokens(doc);
+
+    // An unterminated string changes how everything after it parses
+    const result = doc.applyEdit(0, 31, 0, 31, '"');
+
+    expect(updateSemanticTokens(tokens, doc, result.changedLines!)).toEqual(
+      extractSemanticTokens(doc),
+    );
+  });
+
+  it("matches a full extraction after an edit in a markdown block", () => {
+    const source = markdown(entries(3), entries(3));
+    const doc = new Document(parser, "test.md", source);
+    const tokens = extractSemanticTokens(doc);
+
+    const result = doc.applyEdit(4, 2, 4, 6, "kind");
+
+    expect(result.fullReparse).toBe(false);
+    expect(updateSemanticTokens(tokens, doc, result.changedLines!)).toEqual(
+      extractSemanticTokens(doc),
+    );
+  });
+});
+
+describe("diffSemanticTokens", () => {
+  it("returns no edits for equal tokens", () => {
+    expect(diffSemanticTokens([0, 0, 4, 1, 0], [0, 0, 4, 1, 0])).toEqual([]);
+  });
+
+  it("replaces the part between the common prefix and suffix", () => {
+    const previous = [0, 0, 4, 1, 0, 1, 2, 3, 5, 0, 1, 0, 6, 7, 0];
+    const next = [0, 0, 4, 1, 0, 1, 2, 8, 5, 0, 0, 4, 2, 6, 0, 1, 0, 6, 7, 0];
+
+    const edits = diffSemanticTokens(previous, next);
+
+    expect(edits).toEqual([{ start: 7, deleteCount: 2, data: [8, 5, 0, 0, 4, 2, 6] }]);
+    const applied = [...previous];
+    applied.splice(edits[0].start, edits[0].deleteCount, ...edits[0].data);
+    expect(applied).toEqual(next);
+  });
+
+  it("turns an encoded update into the encoding of the new tokens", () => {
+    const doc = new Document(parser, "test.thalo", entries(5));
+    const tokens = extractSemanticTokens(doc);
+    const previous = encodeSemanticTokens(tokens);
+
+    const result = doc.applyEdit(4, 48, 4, 48, "-renamed");
+    const next = encodeSemanticTokens(updateSemanticTokens(tokens, doc, result.changedLines!));
+
+    const applied = [...previous];
+    for (const edit of diffSemanticTokens(previous, next).reverse()) {
+      applied.splice(edit.start, edit.deleteCount, ...edit.data);
+    }
+    expect(applied).toEqual(encodeSemanticTokens(extractSemanticTokens(doc)));
+  });
+});
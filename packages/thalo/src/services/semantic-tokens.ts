@@ -1,6 +1,7 @@
 import type { SyntaxNode } from "../ast/ast-types.js";
-import type { ParsedDocument, GenericTree } from "../parser.shared.js";
+import type { ParsedBlock, GenericTree } from "../parser.shared.js";
 import type { SourceMap } from "../source-map.js";
+import type { ChangedLines } from "../model/document.js";
 
 /**
  * Semantic token types - these map to LSP's SemanticTokenTypes
@@ -73,15 +74,36 @@ export function getTokenModifiersMask(modifiers: TokenModifier[]): number {
   return mask;
 }
 
+/**
+ * Parsed blocks to extract tokens from: a `ParsedDocument`, or a workspace `Document`.
+ */
+export interface SemanticTokensSource {
+  readonly blocks: readonly ParsedBlock[];
+}
+
+/**
+ * An inclusive range of file lines (0-based).
+ */
+export interface LineRange {
+  startLine: number;
+  endLine: number;
+}
+
 /**
  * Extract semantic tokens from a parsed document.
  * Returns tokens with file-absolute positions (sourceMap applied).
+ *
+ * @param document - The parsed blocks
+ * @param range - Only return tokens starting on these lines; subtrees outside them are skipped
  */
-export function extractSemanticTokens(document: ParsedDocument): SemanticToken[] {
+export function extractSemanticTokens(
+  document: SemanticTokensSource,
+  range?: LineRange,
+): SemanticToken[] {
   const tokens: SemanticToken[] = [];
 
   for (const block of document.blocks) {
-    extractTokensFromTree(block.tree, block.sourceMap, tokens);
+    extractTokensFromTree(block.tree, block.sourceMap, tokens, range);
   }
 
   // Sort by position (line, then character)
@@ -95,6 +117,76 @@ export function extractSemanticTokens(document: ParsedDocument): SemanticToken[]
   return tokens;
 }
 
+/**
+ * Find the index of the first token on or after `line` in tokens sorted by position.
+ */
+function firstTokenOnOrAfter(tokens: readonly SemanticToken[], line: number): number {
+  let lo = 0;
+  let hi = tokens.length;
+  while (lo < hi) {
+    const mid = (lo + hi) >>> 1;
+    if (tokens[mid].line < line) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+/**
+ * Update the tokens of a document after an edit, re-extracting only the entries on the lines
+ * the edit changed.
+ *
+ * Tokens before the changed lines are kept and tokens after them are moved by the edit's line
+ * delta, so the result equals `extractSemanticTokens(document)` as long as `previous` were the
+ * document's tokens before the edit.
+ *
+ * @param previous - The tokens before the edit, sorted by position
+ * @param document - The parsed blocks after the edit
+ * @param changed - The lines the edit changed (see `EditResult.changedLines`)
+ */
+export function updateSemanticTokens(
+  previous: readonly SemanticToken[],
+  document: SemanticTokensSource,
+  changed: ChangedLines,
+): SemanticToken[] {
+  // Re-extract whole top-level entries, so no token is assembled from two versions of one
+  let startLine = changed.startLine;
+  let endLine = changed.newEndLine;
+  for (const block of document.blocks) {
+    const { lineOffset } = block.sourceMap;
+    for (const child of block.tree.rootNode.children) {
+      if (!child) {
+        continue;
+      }
+      const first = lineOffset + child.startPosition.row;
+      const last = lineOffset + child.endPosition.row;
+      if (first > endLine) {
+        break;
+      }
+      if (last >= startLine) {
+        startLine = Math.min(startLine, first);
+        endLine = Math.max(endLine, last);
+      }
+    }
+  }
+
+  const lineDelta = changed.newEndLine - changed.oldEndLine;
+  const before = firstTokenOnOrAfter(previous, startLine);
+  const after = firstTokenOnOrAfter(previous, endLine - lineDelta + 1);
+
+  const tokens = previous.slice(0, before);
+  for (const token of extractSemanticTokens(document, { startLine, endLine })) {
+    tokens.push(token);
+  }
+  for (let i = after; i < previous.length; i++) {
+    const token = previous[i];
+    tokens.push(lineDelta === 0 ? token : { ...token, line: token.line + lineDelta });
+  }
+  return tokens;
+}
+
 /**
  * Extract tokens from a tree-sitter tree
  */
@@ -102,14 +194,24 @@ function extractTokensFromTree(
   tree: GenericTree,
   sourceMap: SourceMap,
   tokens: SemanticToken[],
+  range?: LineRange,
 ): void {
   // eslint-disable-next-line @typescript-eslint/no-explicit-any
   const cursor = (tree as any).walk();
 
   // DFS traversal
   const visitNode = (node: SyntaxNode): void => {
+    if (
+      range &&
+      (sourceMap.lineOffset + node.endPosition.row < range.startLine ||
+        sourceMap.lineOffset + node.startPosition.row > range.endLine)
+    ) {
+      // No token in this subtree starts within the range
+      return;
+    }
+
     const token = getTokenForNode(node, sourceMap);
-    if (token) {
+    if (token && (!range || (token.line >= range.startLine && token.line <= range.endLine))) {
       tokens.push(token);
     }
 
@@ -333,3 +435,48 @@ export function encodeSemanticTokens(tokens: SemanticToken[]): number[] {
 
   return data;
 }
+
+/**
+ * An edit to an encoded token array, as in an LSP `SemanticTokensDelta`: replace
+ * `deleteCount` numbers at `start` with `data`.
+ */
+export interface SemanticTokensEdit {
+  start: number;
+  deleteCount: number;
+  data: number[];
+}
+
+/**
+ * Diff two encoded token arrays (see `encodeSemanticTokens`) into the edits turning
+ * `previous` into `next`: one edit replacing everything between their common prefix and
+ * suffix, or none if they are equal.
+ */
+export function diffSemanticTokens(
+  previous: readonly number[],
+  next: readonly number[],
+): SemanticTokensEdit[] {
+  const common = Math.min(previous.length, next.length);
+  let prefix = 0;
+  while (prefix < common && previous[prefix] === next[prefix]) {
+    prefix++;
+  }
+  if (prefix === previous.length && prefix === next.length) {
+    return [];
+  }
+
+  let suffix = 0;
+  while (
+    suffix < common - prefix &&
+    previous[previous.length - 1 - suffix] === next[next.length - 1 - suffix]
+  ) {
+    suffix++;
+  }
+
+  return [
+    {
+      start: prefix,
+      deleteCount: previous.length - prefix - suffix,
+      data: next.slice(prefix, next.length - suffix),
+    },
+  ];
+}
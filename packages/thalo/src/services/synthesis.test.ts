@@ -117,6 +117,25 @@ describe("synthesis service", () => {
       const sources = getSynthesisSources(syntheses[0]);
       expect(sources).toHaveLength(0);
     });
+
+    it("returns the same array for an unchanged synthesis", () => {
+      const workspace = createWorkspace();
+      const source = `2026-01-07T10:00Z define-synthesis "Profile" ^profile
+  sources: lore where subject = ^self
+`;
+      workspace.addDocument(source, { filename: "profile.thalo" });
+
+      const [synthesis] = workspace.allSynthesisEntries();
+      expect(getSynthesisSources(synthesis)).toBe(getSynthesisSources(synthesis));
+
+      workspace.addDocument(source.replace("^self", "^other"), { filename: "profile.thalo" });
+      const [edited] = workspace.allSynthesisEntries();
+      expect(getSynthesisSources(edited)[0].conditions[0]).toEqual({
+        kind: "field",
+        field: "subject",
+        value: "^other",
+      });
+    });
   });
 
   describe("getSynthesisPrompt", () => {
@@ -47,11 +47,28 @@ export { formatTimestamp } from "../formatters.js";
 // Re-export astQueryToModelQuery for backward compatibility
 export { astQueryToModelQuery } from "./query.js";
 
+/**
+ * Source queries by synthesis entry. Entries are replaced when their file is re-parsed, so an
+ * unchanged synthesis keeps returning the same array and its compiled query plan is reused.
+ */
+const synthesisSources = new WeakMap<SynthesisEntry, Query[]>();
+
 /**
  * Extract source queries from a synthesis entry's metadata.
  * Sources can be a single query or an array of queries.
+ *
+ * Repeated calls for the same entry return the same array; don't modify it.
  */
 export function getSynthesisSources(synthesis: SynthesisEntry): Query[] {
+  let sources = synthesisSources.get(synthesis);
+  if (!sources) {
+    sources = extractSynthesisSources(synthesis);
+    synthesisSources.set(synthesis, sources);
+  }
+  return sources;
+}
+
+function extractSynthesisSources(synthesis: SynthesisEntry): Query[] {
   const sourcesMeta = synthesis.metadata.find((m) => m.key.value === "sources");
   if (!sourcesMeta) {
     return [];
@@ -147,13 +164,15 @@ export function findLatestActualize(
         continue;
       }
 
-      const ts = formatTimestamp(entry.header.timestamp);
-      if (!latest || ts > latest.timestamp) {
+      if (
+        !latest ||
+        entry.header.timestamp.epochMinutes > latest.entry.header.timestamp.epochMinutes
+      ) {
         latest = {
           entry,
           file: model.file,
           target: entry.header.target.id,
-          timestamp: ts,
+          timestamp: formatTimestamp(entry.header.timestamp),
         };
       }
     }
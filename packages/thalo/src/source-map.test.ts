@@ -3,6 +3,7 @@ import {
   identitySourceMap,
   isIdentityMap,
   createSourceMap,
+  createSourceMaps,
   toFilePosition,
   toBlockPosition,
   toFileLocation,
@@ -93,6 +94,25 @@ describe("SourceMap", () => {
     });
   });
 
+  describe("createSourceMaps", () => {
+    it("gives the same maps as createSourceMap for each block", () => {
+      const source = "# Title\n\n```thalo\na\nb\n```\n\ntext ```thalo\n```thalo\nc\n```\n";
+      const blocks = [
+        { charOffset: 18, source: "a\nb\n" },
+        { charOffset: 32, source: "" },
+        { charOffset: 50, source: "c\n" },
+      ];
+      const maps = createSourceMaps(source, blocks);
+      expect(maps).toEqual(
+        blocks.map((block) => createSourceMap(source, block.charOffset, block.source)),
+      );
+    });
+
+    it("returns no maps for no blocks", () => {
+      expect(createSourceMaps("a\nb", [])).toEqual([]);
+    });
+  });
+
   describe("toFilePosition", () => {
     it("passes through position for identity map", () => {
       const map = identitySourceMap();
@@ -108,6 +108,49 @@ export function createSourceMap(
   });
 }
 
+/**
+ * Create the source maps of several embedded blocks in one pass over the file, giving the same
+ * maps as `createSourceMap` for each.
+ *
+ * @param fullSource - The complete source text of the containing file
+ * @param blocks - The blocks' start offsets and source texts, in file order
+ * @returns A SourceMap for each block
+ */
+export function createSourceMaps(
+  fullSource: string,
+  blocks: readonly { charOffset: number; source: string }[],
+): SourceMap[] {
+  const maps: SourceMap[] = [];
+  let cursor = 0;
+  let lineOffset = 0;
+  let lastNewlineIndex = -1;
+
+  for (const { charOffset, source } of blocks) {
+    for (let i = fullSource.indexOf("\n", cursor); i !== -1 && i < charOffset; ) {
+      lineOffset++;
+      lastNewlineIndex = i;
+      i = fullSource.indexOf("\n", i + 1);
+    }
+    cursor = Math.max(cursor, charOffset);
+
+    let lineCount = 1;
+    for (let i = source.indexOf("\n"); i !== -1; i = source.indexOf("\n", i + 1)) {
+      lineCount++;
+    }
+
+    maps.push(
+      Object.freeze({
+        charOffset,
+        lineOffset,
+        columnOffset: lastNewlineIndex === -1 ? charOffset : charOffset - lastNewlineIndex - 1,
+        lineCount,
+      }),
+    );
+  }
+
+  return maps;
+}
+
 /**
  * Convert a block-relative position to a file-absolute position.
  *
@@ -275,19 +318,36 @@ export interface BlockMatch<T extends { sourceMap: SourceMap }> {
 /**
  * Find which block (if any) contains a file-absolute position.
  *
- * @param blocks - Array of objects with sourceMap property
+ * Blocks are in file order and do not overlap, so only the last block starting at or before
+ * the position can contain it; it is found by binary search.
+ *
+ * @param blocks - Array of objects with sourceMap property, in file order
  * @param filePosition - Position relative to the file start (0-based)
  * @returns The matching block and block-relative position, or null if not in any block
  */
 export function findBlockAtPosition<T extends { sourceMap: SourceMap }>(
-  blocks: T[],
+  blocks: readonly T[],
   filePosition: Position,
 ): BlockMatch<T> | null {
-  for (const block of blocks) {
-    const blockPosition = toBlockPosition(block.sourceMap, filePosition);
-    if (blockPosition) {
-      return { block, blockPosition };
+  let lo = 0;
+  let hi = blocks.length;
+  while (lo < hi) {
+    const mid = (lo + hi) >>> 1;
+    const { lineOffset, columnOffset } = blocks[mid].sourceMap;
+    if (
+      lineOffset < filePosition.line ||
+      (lineOffset === filePosition.line && columnOffset <= filePosition.column)
+    ) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
     }
   }
-  return null;
+  if (lo === 0) {
+    return null;
+  }
+
+  const block = blocks[lo - 1];
+  const blockPosition = toBlockPosition(block.sourceMap, filePosition);
+  return blockPosition ? { block, blockPosition } : null;
 }
@@ -3,14 +3,28 @@ import fs from "node:fs";
 import path from "node:path";
 import { DEFAULT_EXTENSIONS } from "./files.js";
 import type { ThaloWorkspaceInterface, WorkspaceWatchOptions, WorkspaceWatchEvent } from "./api.js";
-import type { Entry } from "./ast/ast-types.js";
 import { getEntryIdentity, serializeIdentity } from "./merge/entry-matcher.js";
+import { hashRanges, type RangeHasher } from "./range-hash.js";
 
 type EntrySnapshot = {
   hash: string;
   entry: ReturnType<ThaloWorkspaceInterface["entriesInFile"]>[number];
 };
 
+/**
+ * The entries of a file as of its last change, with the hash of each entry's source text.
+ */
+type FileSnapshot = {
+  /** The source the entry locations index into */
+  source: string;
+  /** Entries by serialized identity */
+  entries: Map<string, EntrySnapshot>;
+  /** Entry hashes by the [start, end) range of their source text */
+  hashesByRange: Map<string, string>;
+};
+
+const EMPTY_SNAPSHOT: FileSnapshot = { source: "", entries: new Map(), hashesByRange: new Map() };
+
 function normalizeExtensions(extensions?: string[]): string[] {
   const normalized = (extensions && extensions.length > 0 ? extensions : DEFAULT_EXTENSIONS).map(
     (ext) => (ext.startsWith(".") ? ext : `.${ext}`),
@@ -22,55 +36,101 @@ function isWatchedFile(file: string, extensions: string[]): boolean {
   return extensions.some((ext) => file.endsWith(ext));
 }
 
-function stripForComparison(obj: unknown): unknown {
-  if (obj === null || obj === undefined) {
-    return obj;
-  }
-  if (Array.isArray(obj)) {
-    return obj.map(stripForComparison);
-  }
-  if (typeof obj === "object") {
-    const result: Record<string, unknown> = {};
-    for (const [key, value] of Object.entries(obj)) {
-      if (key === "syntaxNode" || key === "location") {
-        continue;
-      }
-      result[key] = stripForComparison(value);
-    }
-    return result;
-  }
-  return obj;
+function rangeKey(start: number, end: number): string {
+  return `${start}:${end}`;
 }
 
-function hashEntry(entry: Entry): string {
-  return JSON.stringify(stripForComparison(entry));
+/**
+ * Find the region that differs between two texts, as the length of their common prefix and of
+ * their common suffix (not overlapping the prefix).
+ */
+function diffBounds(previous: string, next: string): { prefix: number; suffix: number } {
+  const limit = Math.min(previous.length, next.length);
+  let prefix = 0;
+  while (prefix < limit && previous.charCodeAt(prefix) === next.charCodeAt(prefix)) {
+    prefix++;
+  }
+  let suffix = 0;
+  while (
+    suffix < limit - prefix &&
+    previous.charCodeAt(previous.length - 1 - suffix) === next.charCodeAt(next.length - 1 - suffix)
+  ) {
+    suffix++;
+  }
+  return { prefix, suffix };
 }
 
+/**
+ * Snapshot the entries of a file, hashing the source text of each.
+ *
+ * Entry hashes cover the entry's source range and nothing else, so an entry whose range lies
+ * entirely before or after the edited region of the file keeps the hash from `previous`; only
+ * entries intersecting the edit are rehashed, in one call to `hasher`.
+ */
 function buildSnapshotForFile(
   workspace: ThaloWorkspaceInterface,
   file: string,
-): Map<string, EntrySnapshot> {
+  hasher: RangeHasher,
+  previous: FileSnapshot = EMPTY_SNAPSHOT,
+): FileSnapshot {
   const model = workspace._internal.getModel(file);
   if (!model) {
-    return new Map();
+    return EMPTY_SNAPSHOT;
   }
 
+  // Entry locations are relative to the first block, like the entries themselves
+  const source = model.blocks[0]?.source ?? model.source;
   const wrapped = workspace.entriesInFile(file);
-  const snapshot = new Map<string, EntrySnapshot>();
+  const { prefix, suffix } = diffBounds(previous.source, source);
+  const shift = previous.source.length - source.length;
+  const suffixStart = source.length - suffix;
+
+  // Ranges come from the header columns; entries are only read for their identities
+  const { starts, ends } = model.headers;
+  const hashes: (string | undefined)[] = [];
+  const pending: number[] = [];
+  for (let index = 0; index < model.headers.length; index++) {
+    const startIndex = starts[index];
+    const endIndex = ends[index];
+    let hash: string | undefined;
+    if (endIndex <= prefix) {
+      hash = previous.hashesByRange.get(rangeKey(startIndex, endIndex));
+    } else if (startIndex >= suffixStart) {
+      hash = previous.hashesByRange.get(rangeKey(startIndex + shift, endIndex + shift));
+    }
+    if (hash === undefined) {
+      pending.push(index);
+    }
+    hashes.push(hash);
+  }
 
+  if (pending.length > 0) {
+    const ranges = new Uint32Array(pending.length * 2);
+    pending.forEach((index, i) => {
+      ranges[2 * i] = starts[index];
+      ranges[2 * i + 1] = ends[index];
+    });
+    const computed = hasher(source, ranges);
+    pending.forEach((index, i) => {
+      hashes[index] =
+        computed[2 * i].toString(16).padStart(8, "0") +
+        computed[2 * i + 1].toString(16).padStart(8, "0");
+    });
+  }
+
+  const entries = new Map<string, EntrySnapshot>();
+  const hashesByRange = new Map<string, string>();
   model.ast.entries.forEach((entry, index) => {
+    const hash = hashes[index]!;
+    hashesByRange.set(rangeKey(starts[index], ends[index]), hash);
     const wrappedEntry = wrapped[index];
     if (!wrappedEntry) {
       return;
     }
-    const identity = serializeIdentity(getEntryIdentity(entry));
-    snapshot.set(identity, {
-      hash: hashEntry(entry),
-      entry: wrappedEntry,
-    });
+    entries.set(serializeIdentity(getEntryIdentity(entry)), { hash, entry: wrappedEntry });
   });
 
-  return snapshot;
+  return { source, entries, hashesByRange };
 }
 
 function findCommonRoot(pathsList: string[]): string | null {
@@ -101,6 +161,7 @@ function findCommonRoot(pathsList: string[]): string | null {
 export function watchWorkspace(
   workspace: ThaloWorkspaceInterface,
   options: WorkspaceWatchOptions = {},
+  hasher: RangeHasher = hashRanges,
 ): AsyncIterable<WorkspaceWatchEvent> {
   const extensions = normalizeExtensions(options.extensions);
   const debounceMs = options.debounceMs ?? 100;
@@ -112,12 +173,12 @@ export function watchWorkspace(
     throw new Error("workspace.watch() requires a workspace with at least one file.");
   }
 
-  const fileSnapshots = new Map<string, Map<string, EntrySnapshot>>();
+  const fileSnapshots = new Map<string, FileSnapshot>();
   const knownFiles = new Set<string>();
 
   for (const file of files) {
     knownFiles.add(file);
-    fileSnapshots.set(file, buildSnapshotForFile(workspace, file));
+    fileSnapshots.set(file, buildSnapshotForFile(workspace, file, hasher));
   }
 
   const eventQueue: WorkspaceWatchEvent[] = [];
@@ -194,14 +255,14 @@ export function watchWorkspace(
         exists = false;
       }
 
-      const previousSnapshot = fileSnapshots.get(file) ?? new Map();
+      const previousSnapshot = fileSnapshots.get(file) ?? EMPTY_SNAPSHOT;
 
       if (!exists) {
         if (knownFiles.has(file)) {
           knownFiles.delete(file);
           fileSnapshots.delete(file);
           workspace._internal.removeDocument(file);
-          for (const snap of previousSnapshot.values()) {
+          for (const snap of previousSnapshot.entries.values()) {
             removed.push(snap.entry);
           }
           touchedFiles.push(file);
@@ -212,11 +273,11 @@ export function watchWorkspace(
       const source = await readFile(file, "utf-8");
       workspace._internal.updateDocument(file, source);
       knownFiles.add(file);
-      const nextSnapshot = buildSnapshotForFile(workspace, file);
+      const nextSnapshot = buildSnapshotForFile(workspace, file, hasher, previousSnapshot);
       fileSnapshots.set(file, nextSnapshot);
 
-      for (const [identity, next] of nextSnapshot) {
-        const prev = previousSnapshot.get(identity);
+      for (const [identity, next] of nextSnapshot.entries) {
+        const prev = previousSnapshot.entries.get(identity);
         if (!prev) {
           added.push(next.entry);
         } else if (prev.hash !== next.hash) {
@@ -224,8 +285,8 @@ export function watchWorkspace(
         }
       }
 
-      for (const [identity, prev] of previousSnapshot) {
-        if (!nextSnapshot.has(identity)) {
+      for (const [identity, prev] of previousSnapshot.entries) {
+        if (!nextSnapshot.entries.has(identity)) {
           removed.push(prev.entry);
         }
       }
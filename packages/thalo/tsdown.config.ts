@@ -6,6 +6,9 @@ export default defineConfig({
     "./src/parser.native.ts",
     "./src/parser.node.ts",
     "./src/parser.web.ts",
+    "./src/parser.web-pool.ts",
+    // Loaded by parser.web-pool.ts through a URL, so it is not reachable by imports
+    "./src/parser.web-worker.ts",
     "./src/services/semantic-tokens.ts",
     "./src/services/definition.ts",
     "./src/services/references.ts",
@@ -18,6 +21,10 @@ export default defineConfig({
     "./src/commands/actualize.ts",
     "./src/formatters.ts",
     "./src/files.ts",
+    "./src/checker/parallel.ts",
+    "./src/checker/since.ts",
+    // Loaded by checker/parallel.ts through a URL, so it is not reachable by imports
+    "./src/checker/check-worker.ts",
   ],
   dts: true,
   unbundle: true,